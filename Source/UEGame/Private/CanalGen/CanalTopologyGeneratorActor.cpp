@@ -1,7 +1,7 @@
 #include "CanalGen/CanalTopologyGeneratorActor.h"
 
 #include "CanalGen/CanalTopologyTileSetAsset.h"
-#include "Algo/Reverse.h"
+#include "Async/Async.h"
 #include "Components/HierarchicalInstancedStaticMeshComponent.h"
 #include "Components/SceneComponent.h"
 #include "Components/SplineComponent.h"
@@ -80,6 +80,12 @@ namespace
 	const FName kPropTagBin(TEXT("bin"));
 	const FName kPropTagFence(TEXT("fence"));
 
+	// Per-towpath-instance draws of the 'PROP' stream.
+	constexpr uint32 PropDensityDraw = 0;
+	constexpr uint32 PropTypeDraw = 1;
+	constexpr uint32 PropLateralDraw = 2;
+	constexpr uint32 PropYawDraw = 3;
+
 	void SetMaterialRandomizationParams(UMaterialInstanceDynamic* Material, const FLinearColor& Tint, const float Wetness)
 	{
 		if (!Material)
@@ -219,6 +225,7 @@ ACanalTopologyGeneratorActor::ACanalTopologyGeneratorActor()
 	SolveConfig.Seed = 1337;
 	SolveConfig.MaxAttempts = 8;
 	SolveConfig.MaxPropagationSteps = 100000;
+	SolveConfig.SpeculativeAttempts = 4;
 	SolveConfig.bRequireEntryExitPath = true;
 	SolveConfig.bRequireSingleWaterComponent = true;
 	SolveConfig.bAutoSelectBoundaryPorts = true;
@@ -237,7 +244,124 @@ void ACanalTopologyGeneratorActor::BeginPlay()
 	}
 }
 
+void ACanalTopologyGeneratorActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	CancelGeneration();
+	Super::EndPlay(EndPlayReason);
+}
+
+void ACanalTopologyGeneratorActor::BeginDestroy()
+{
+	CancelGeneration();
+	Super::BeginDestroy();
+}
+
 void ACanalTopologyGeneratorActor::GenerateTopology()
+{
+	FHexWfcSolveConfig TopologySolveConfig;
+	int32 DressingSeed = 0;
+	if (!BeginGeneration(TopologySolveConfig, DressingSeed))
+	{
+		return;
+	}
+
+	LastSolveResult = UCanalWfcBlueprintLibrary::SolveHexWfc(TileSet, GridConfig, TopologySolveConfig);
+	ApplySolvedTopology(TileSet->GetCompatibilityTable(), TopologySolveConfig, DressingSeed);
+}
+
+void ACanalTopologyGeneratorActor::GenerateTopologyAsync()
+{
+	FHexWfcSolveConfig TopologySolveConfig;
+	int32 DressingSeed = 0;
+	if (!BeginGeneration(TopologySolveConfig, DressingSeed))
+	{
+		return;
+	}
+
+	if (!TileSet->GetCompatibilityTable().IsBuilt())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Canal generation aborted: TileSet compatibility cache is not built."));
+		return;
+	}
+
+	PendingSolveConfig = TopologySolveConfig;
+	PendingDressingSeed = DressingSeed;
+	GenerationControl = MakeShared<FHexWfcSolveControl, ESPMode::ThreadSafe>();
+	PendingCompatibility = MakeShared<FCanalTileCompatibilityTable, ESPMode::ThreadSafe>(TileSet->GetCompatibilityTable());
+
+	// The worker gets its own copies so edits to the actor or tile set during the solve cannot race it.
+	PendingGeneration = Async(
+		EAsyncExecution::ThreadPool,
+		[Compatibility = PendingCompatibility,
+			Grid = GridConfig,
+			Config = TopologySolveConfig,
+			Control = GenerationControl]()
+		{
+			const FHexWfcSolver Solver(*Compatibility);
+			return Solver.Solve(Grid, Config, Control.Get());
+		});
+
+	GenerationTickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateUObject(this, &ACanalTopologyGeneratorActor::PollAsyncGeneration));
+}
+
+void ACanalTopologyGeneratorActor::CancelGeneration()
+{
+	if (!GenerationControl)
+	{
+		return;
+	}
+
+	// The solver checks the flag between propagation steps, so the worker returns almost immediately.
+	GenerationControl->Cancel();
+	PendingGeneration.Wait();
+	PendingGeneration = TFuture<FHexWfcSolveResult>();
+	FTSTicker::GetCoreTicker().RemoveTicker(GenerationTickerHandle);
+	GenerationTickerHandle.Reset();
+	GenerationControl.Reset();
+	PendingCompatibility.Reset();
+}
+
+bool ACanalTopologyGeneratorActor::IsGenerating() const
+{
+	return GenerationControl.IsValid();
+}
+
+bool ACanalTopologyGeneratorActor::PollAsyncGeneration(const float DeltaTime)
+{
+	if (!PendingGeneration.IsReady())
+	{
+		OnGenerationProgress.Broadcast(GenerationControl->GetProgress());
+		return true;
+	}
+
+	FHexWfcSolveResult Result = PendingGeneration.Get();
+	const TSharedPtr<const FCanalTileCompatibilityTable, ESPMode::ThreadSafe> Compatibility = MoveTemp(PendingCompatibility);
+	PendingGeneration = TFuture<FHexWfcSolveResult>();
+	GenerationTickerHandle.Reset();
+	GenerationControl.Reset();
+
+	// Variant indices in the result refer to the table the worker solved against. If the tile set changed since,
+	// they would pick the wrong tiles (or run past the end) in the live table, so the result is dropped.
+	LastSolveResult = MoveTemp(Result);
+	if (!TileSet)
+	{
+		LastSolveResult.bSolved = false;
+		LastSolveResult.Message = TEXT("TileSet was cleared during generation.");
+	}
+	else if (LastSolveResult.bSolved && TileSet->GetCompatibilityTable().GetContentHash() != Compatibility->GetContentHash())
+	{
+		LastSolveResult.bSolved = false;
+		LastSolveResult.Message = TEXT("TileSet changed during generation; the result was discarded.");
+	}
+	ApplySolvedTopology(*Compatibility, PendingSolveConfig, PendingDressingSeed);
+
+	OnGenerationProgress.Broadcast(1.0f);
+	OnGenerationFinished.Broadcast(LastSolveResult.bSolved);
+	return false;
+}
+
+bool ACanalTopologyGeneratorActor::BeginGeneration(FHexWfcSolveConfig& OutTopologySolveConfig, int32& OutDressingSeed)
 {
 	ClearGenerated();
 
@@ -250,7 +374,7 @@ void ACanalTopologyGeneratorActor::GenerateTopology()
 	if (!ValidateTileSet(ValidationError))
 	{
 		UE_LOG(LogTemp, Warning, TEXT("Canal generation aborted: %s"), *ValidationError);
-		return;
+		return false;
 	}
 
 	RefreshInstanceMeshes();
@@ -270,7 +394,31 @@ void ACanalTopologyGeneratorActor::GenerateTopology()
 	LastGenerationMetadata.TimeOfDayPreset = TimeOfDayPreset;
 	LastGenerationMetadata.FogDensity = FogDensity;
 
-	LastSolveResult = UCanalWfcBlueprintLibrary::SolveHexWfc(TileSet, GridConfig, TopologySolveConfig);
+	if (bStreamChunks)
+	{
+		FString ChunkError;
+		if (!ChunkConfig.EnsureValid(ChunkError))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Canal generation aborted: %s"), *ChunkError);
+			return false;
+		}
+
+		ChunkedSolver = MakeUnique<FHexWfcChunkedSolver>(TileSet->GetCompatibilityTable(), ChunkConfig, TopologySolveConfig);
+		ApplyPrototypeMaterials(DressingSeed);
+		UpdateStreamingFocus(GetActorLocation());
+		return false;
+	}
+
+	OutTopologySolveConfig = TopologySolveConfig;
+	OutDressingSeed = DressingSeed;
+	return true;
+}
+
+void ACanalTopologyGeneratorActor::ApplySolvedTopology(
+	const FCanalTileCompatibilityTable& Compatibility,
+	const FHexWfcSolveConfig& TopologySolveConfig,
+	const int32 DressingSeed)
+{
 	if (!LastSolveResult.bSolved)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("Canal solve failed: %s"), *LastSolveResult.Message);
@@ -292,37 +440,14 @@ void ACanalTopologyGeneratorActor::GenerateTopology()
 		LastGenerationMetadata.ExitPort = TopologySolveConfig.ExitPort;
 	}
 
-	const FCanalTileCompatibilityTable& Compatibility = TileSet->GetCompatibilityTable();
-
-	for (const FHexWfcCellResult& Cell : LastSolveResult.Cells)
-	{
-		const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(Cell.Variant.TileIndex);
-		if (!Tile)
-		{
-			continue;
-		}
-
-		const FVector Center = GetActorTransform().TransformPosition(GridLayout.AxialToWorld(Cell.Coord));
-		for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
-		{
-			const EHexDirection Direction = HexDirectionFromIndex(DirIndex);
-			const FVector NeighborPos = GetActorTransform().TransformPosition(GridLayout.AxialToWorld(Cell.Coord.Neighbor(Direction)));
-			const FVector DirectionVec = (NeighborPos - Center).GetSafeNormal();
-			const FVector SocketPos = Center + DirectionVec * (GridLayout.HexSize * SocketOffsetScale);
-			const FRotator Rotation = DirectionVec.Rotation();
-
-			const ECanalSocketType Socket = Tile->GetSocket(Direction, Cell.Variant.RotationSteps);
-			const FTransform InstanceXf(Rotation, SocketPos, InstanceScale);
-			AddSocketInstance(Socket, InstanceXf);
-		}
-	}
+	AddCellSocketInstances(Compatibility, LastSolveResult.Cells, &SocketInstanceIndices);
 
 	ApplyPrototypeMaterials(DressingSeed);
 	SpawnTowpathProps(DressingSeed);
 
 	if (bGenerateSpline)
 	{
-		BuildSplineFromSolvedCells(Compatibility, LastSolveResult.Cells);
+		ApplySplinePath(LastSolveResult.Water.WaterPath);
 	}
 	LastGenerationMetadata.SplinePointCount = WaterPathSpline->GetNumberOfSplinePoints();
 
@@ -344,19 +469,19 @@ void ACanalTopologyGeneratorActor::GenerateTopology()
 
 void ACanalTopologyGeneratorActor::ClearGenerated()
 {
+	CancelGeneration();
+	ChunkedSolver.Reset();
+
 	WaterInstances->ClearInstances();
 	BankInstances->ClearInstances();
 	TowpathInstances->ClearInstances();
 	LockInstances->ClearInstances();
 	RoadInstances->ClearInstances();
-	BollardPropInstances->ClearInstances();
-	RingPropInstances->ClearInstances();
-	SignPropInstances->ClearInstances();
-	LampPropInstances->ClearInstances();
-	BenchPropInstances->ClearInstances();
-	ReedsPropInstances->ClearInstances();
-	BinPropInstances->ClearInstances();
-	FencePropInstances->ClearInstances();
+	ClearTowpathProps();
+	SocketInstanceIndices.Reset();
+	ParkedSocketInstances.Reset();
+	StreamedChunkInstances.Reset();
+	RegionRerollCount = 0;
 
 	WaterPathSpline->ClearSplinePoints(false);
 	WaterPathSpline->UpdateSpline();
@@ -371,6 +496,171 @@ void ACanalTopologyGeneratorActor::ClearGenerated()
 	LastGenerationMetadata = FCanalGenerationMetadata();
 }
 
+bool ACanalTopologyGeneratorActor::RerollRegion(const FHexAxialCoord& Center, const int32 Radius, const int32 Seed)
+{
+	if (ChunkedSolver || !TileSet || !LastSolveResult.bSolved || SocketInstanceIndices.Num() != LastSolveResult.Cells.Num() * 6)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Canal region reroll needs a solved bounded grid. Run GenerateTopology first."));
+		return false;
+	}
+
+	TArray<FHexAxialCoord> Region;
+	GridConfig.GetCellsInRadius(Center, Radius, Region);
+	if (Region.Num() == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Canal region reroll: %s is outside the grid."), *Center.ToString());
+		return false;
+	}
+
+	// Keep the ports the full solve settled on; the cells outside the region were validated against them.
+	FHexWfcSolveConfig RegionConfig = SolveConfig;
+	RegionConfig.Seed = Seed;
+	if (LastSolveResult.bHasResolvedPorts)
+	{
+		RegionConfig.EntryPort = LastSolveResult.ResolvedEntryPort;
+		RegionConfig.ExitPort = LastSolveResult.ResolvedExitPort;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	FHexWfcSolveResult RegionResult = UCanalWfcBlueprintLibrary::SolveHexWfcRegion(TileSet, GridConfig, RegionConfig, LastSolveResult, Region);
+	if (!RegionResult.bSolved)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Canal region reroll failed: %s"), *RegionResult.Message);
+		return false;
+	}
+
+	// Only sides whose socket moves to another component need new instances; the rest keep theirs.
+	const FCanalTileCompatibilityTable& Compatibility = TileSet->GetCompatibilityTable();
+	TSet<UHierarchicalInstancedStaticMeshComponent*> TouchedComponents;
+	TArray<int32> RemovedTowpathInstances;
+	TArray<int32> AddedTowpathInstances;
+	int32 ChangedCells = 0;
+	for (const FHexAxialCoord& Coord : Region)
+	{
+		const int32 CellIndex = Coord.Q + Coord.R * GridConfig.Width;
+		const FCanalTileVariantRef& OldVariant = LastSolveResult.Cells[CellIndex].Variant;
+		const FCanalTileVariantRef& NewVariant = RegionResult.Cells[CellIndex].Variant;
+		if (OldVariant.TileIndex == NewVariant.TileIndex && OldVariant.RotationSteps == NewVariant.RotationSteps)
+		{
+			continue;
+		}
+
+		++ChangedCells;
+		const FCanalTopologyTileDefinition* OldTile = Compatibility.GetTileDefinition(OldVariant.TileIndex);
+		const FCanalTopologyTileDefinition* NewTile = Compatibility.GetTileDefinition(NewVariant.TileIndex);
+		for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
+		{
+			const EHexDirection Direction = HexDirectionFromIndex(DirIndex);
+			UHierarchicalInstancedStaticMeshComponent* OldComponent =
+				OldTile ? ResolveSocketComponent(OldTile->GetSocket(Direction, OldVariant.RotationSteps)) : nullptr;
+			UHierarchicalInstancedStaticMeshComponent* NewComponent =
+				NewTile ? ResolveSocketComponent(NewTile->GetSocket(Direction, NewVariant.RotationSteps)) : nullptr;
+			if (OldComponent == NewComponent)
+			{
+				continue;
+			}
+
+			const FTransform InstanceXf = GetSocketInstanceTransform(Coord, Direction);
+			int32& InstanceIndex = SocketInstanceIndices[CellIndex * 6 + DirIndex];
+			if (OldComponent && InstanceIndex != INDEX_NONE)
+			{
+				FTransform ParkedXf = InstanceXf;
+				ParkedXf.SetScale3D(FVector::ZeroVector);
+				OldComponent->UpdateInstanceTransform(InstanceIndex, ParkedXf, true, false, true);
+				ParkedSocketInstances.FindOrAdd(OldComponent).Add(InstanceIndex);
+				TouchedComponents.Add(OldComponent);
+				if (OldComponent == TowpathInstances.Get())
+				{
+					RemovedTowpathInstances.Add(InstanceIndex);
+				}
+			}
+
+			InstanceIndex = NewTile ? AddSocketInstance(NewTile->GetSocket(Direction, NewVariant.RotationSteps), InstanceXf) : INDEX_NONE;
+			if (NewComponent)
+			{
+				TouchedComponents.Add(NewComponent);
+				if (NewComponent == TowpathInstances.Get() && InstanceIndex != INDEX_NONE)
+				{
+					AddedTowpathInstances.Add(InstanceIndex);
+				}
+			}
+		}
+	}
+
+	for (UHierarchicalInstancedStaticMeshComponent* Component : TouchedComponents)
+	{
+		Component->MarkRenderStateDirty();
+	}
+
+	LastSolveResult = MoveTemp(RegionResult);
+
+	// Props sit on towpath instances, so only the towpath sides that changed get new ones.
+	RespawnTowpathProps(RemovedTowpathInstances, AddedTowpathInstances, LastGenerationMetadata.DressingSeed);
+
+	if (bGenerateSpline)
+	{
+		ApplySplinePath(LastSolveResult.Water.WaterPath);
+	}
+	LastGenerationMetadata.SplinePointCount = WaterPathSpline->GetNumberOfSplinePoints();
+
+	if (bDrawGridDebug)
+	{
+		DrawGridDebug(Compatibility);
+	}
+	if (ShouldRenderSemanticOverlay(false))
+	{
+		DrawSemanticOverlay(Compatibility);
+	}
+
+	UE_LOG(
+		LogTemp,
+		Log,
+		TEXT("Canal region rerolled around %s: %d of %d cells changed in %.2f ms"),
+		*Center.ToString(),
+		ChangedCells,
+		Region.Num(),
+		(FPlatformTime::Seconds() - StartTime) * 1000.0);
+	return true;
+}
+
+void ACanalTopologyGeneratorActor::RerollSelectedRegion()
+{
+	++RegionRerollCount;
+	RerollRegion(RerollCenter, RerollRadius, DeriveDeterministicStreamSeed(LastGenerationMetadata.TopologySeed, static_cast<uint32>(RegionRerollCount)));
+}
+
+void ACanalTopologyGeneratorActor::UpdateStreamingFocus(const FVector& WorldLocation)
+{
+	if (!ChunkedSolver || !TileSet)
+	{
+		return;
+	}
+
+	const FHexAxialCoord Focus = GridLayout.WorldToAxial(GetActorTransform().InverseTransformPosition(WorldLocation));
+	TArray<FIntPoint> Generated;
+	TArray<FIntPoint> Evicted;
+	if (!ChunkedSolver->UpdateFocus(Focus, &Generated, &Evicted))
+	{
+		return;
+	}
+
+	UpdateStreamedInstances(Generated, Evicted);
+	UE_LOG(
+		LogTemp,
+		Log,
+		TEXT("Canal chunks streamed around %s: +%d -%d, %d resident, %d failed"),
+		*Focus.ToString(),
+		Generated.Num(),
+		Evicted.Num(),
+		ChunkedSolver->GetNumResidentChunks(),
+		ChunkedSolver->GetNumFailedChunks());
+}
+
+int32 ACanalTopologyGeneratorActor::GetStreamedChunkCount() const
+{
+	return ChunkedSolver ? ChunkedSolver->GetNumResidentChunks() : 0;
+}
+
 bool ACanalTopologyGeneratorActor::HasGeneratedSpline() const
 {
 	return WaterPathSpline->GetNumberOfSplinePoints() >= 2;
@@ -440,21 +730,16 @@ void ACanalTopologyGeneratorActor::ApplyEnvironmentSettings()
 
 int32 ACanalTopologyGeneratorActor::GetTotalTowpathPropCount() const
 {
-	return BollardPropInstances->GetInstanceCount()
-		+ RingPropInstances->GetInstanceCount()
-		+ SignPropInstances->GetInstanceCount()
-		+ LampPropInstances->GetInstanceCount()
-		+ BenchPropInstances->GetInstanceCount()
-		+ ReedsPropInstances->GetInstanceCount()
-		+ BinPropInstances->GetInstanceCount()
-		+ FencePropInstances->GetInstanceCount();
+	return TowpathPropsByInstance.Num();
 }
 
 int32 ACanalTopologyGeneratorActor::GetTowpathPropCountByTag(const FName SemanticTag) const
 {
+	// Props hidden by a region reroll stay allocated for reuse but are not placed.
 	if (UHierarchicalInstancedStaticMeshComponent* const Component = ResolveTowpathPropComponent(SemanticTag))
 	{
-		return Component->GetInstanceCount();
+		const TArray<int32>* Parked = ParkedPropInstances.Find(Component);
+		return Component->GetInstanceCount() - (Parked ? Parked->Num() : 0);
 	}
 
 	return 0;
@@ -474,25 +759,28 @@ void ACanalTopologyGeneratorActor::GetTowpathPropSemanticTags(TArray<FName>& Out
 
 void ACanalTopologyGeneratorActor::ApplyPrototypeMaterials(const int32 DressingSeed)
 {
-	FRandomStream Random(DeriveDeterministicStreamSeed(DressingSeed, 0x4D41544Cu)); // 'MATL'
+	const FCanalCounterRandom Random(DressingSeed, 0x4D41544Cu); // 'MATL'
 
 	ApplyMaterialProfile(
 		WaterInstances,
 		WaterRuntimeMaterial,
 		WaterMaterialProfile,
 		Random,
+		0,
 		LastWaterMaterialRuntime);
 	ApplyMaterialProfile(
 		BankInstances,
 		BankRuntimeMaterial,
 		BankMaterialProfile,
 		Random,
+		1,
 		LastBankMaterialRuntime);
 	ApplyMaterialProfile(
 		TowpathInstances,
 		TowpathRuntimeMaterial,
 		TowpathMaterialProfile,
 		Random,
+		2,
 		LastTowpathMaterialRuntime);
 }
 
@@ -500,7 +788,8 @@ void ACanalTopologyGeneratorActor::ApplyMaterialProfile(
 	UHierarchicalInstancedStaticMeshComponent* Component,
 	TObjectPtr<UMaterialInstanceDynamic>& OutRuntimeMaterial,
 	const FCanalPrototypeMaterialProfile& Profile,
-	FRandomStream& Random,
+	const FCanalCounterRandom& Random,
+	const int32 ProfileIndex,
 	FCanalResolvedMaterialProfile& OutResolvedProfile)
 {
 	if (!Component)
@@ -518,18 +807,19 @@ void ACanalTopologyGeneratorActor::ApplyMaterialProfile(
 		return;
 	}
 
-	const auto Jitter = [&Random](const float Magnitude) -> float
+	// Draws are keyed by profile and channel, so each profile's jitter is independent of the others.
+	const auto Jitter = [&Random, ProfileIndex](const float Magnitude, const uint32 Channel) -> float
 	{
-		return Magnitude > 0.0f ? Random.FRandRange(-Magnitude, Magnitude) : 0.0f;
+		return Magnitude > 0.0f ? Random.FRandRange(-Magnitude, Magnitude, ProfileIndex, Channel) : 0.0f;
 	};
 
 	FLinearColor ResolvedTint = Profile.Tint;
-	ResolvedTint.R = FMath::Clamp(ResolvedTint.R + Jitter(Profile.TintJitter), 0.0f, 1.0f);
-	ResolvedTint.G = FMath::Clamp(ResolvedTint.G + Jitter(Profile.TintJitter), 0.0f, 1.0f);
-	ResolvedTint.B = FMath::Clamp(ResolvedTint.B + Jitter(Profile.TintJitter), 0.0f, 1.0f);
+	ResolvedTint.R = FMath::Clamp(ResolvedTint.R + Jitter(Profile.TintJitter, 0), 0.0f, 1.0f);
+	ResolvedTint.G = FMath::Clamp(ResolvedTint.G + Jitter(Profile.TintJitter, 1), 0.0f, 1.0f);
+	ResolvedTint.B = FMath::Clamp(ResolvedTint.B + Jitter(Profile.TintJitter, 2), 0.0f, 1.0f);
 	ResolvedTint.A = 1.0f;
 
-	const float ResolvedWetness = FMath::Clamp(Profile.Wetness + Jitter(Profile.WetnessJitter), 0.0f, 1.0f);
+	const float ResolvedWetness = FMath::Clamp(Profile.Wetness + Jitter(Profile.WetnessJitter, 3), 0.0f, 1.0f);
 
 	OutRuntimeMaterial = UMaterialInstanceDynamic::Create(SourceMaterial, this);
 	if (!OutRuntimeMaterial)
@@ -590,13 +880,21 @@ void ACanalTopologyGeneratorActor::SpawnTowpathProps(const int32 DressingSeed)
 		return;
 	}
 
-	FRandomStream Random(DeriveDeterministicStreamSeed(DressingSeed, 0x50524F50u)); // 'PROP'
+	// Every draw is keyed by towpath instance: whether it gets a prop, which one, and its jitter. Only the coverage
+	// pass below depends on earlier picks, and it draws from its own substream.
+	const FCanalCounterRandom Random(DressingSeed, 0x50524F50u); // 'PROP'
+	const TArray<int32>* ParkedTowpaths = ParkedSocketInstances.Find(TowpathInstances.Get());
 
 	TArray<int32> CandidateIndices;
 	CandidateIndices.Reserve(TowpathInstanceCount);
 	for (int32 InstanceIndex = 0; InstanceIndex < TowpathInstanceCount; ++InstanceIndex)
 	{
-		if (Random.FRand() <= TowpathPropDensity)
+		if (ParkedTowpaths && ParkedTowpaths->Contains(InstanceIndex))
+		{
+			continue;
+		}
+
+		if (Random.GetFraction(InstanceIndex, PropDensityDraw) <= TowpathPropDensity)
 		{
 			CandidateIndices.Add(InstanceIndex);
 		}
@@ -607,34 +905,93 @@ void ACanalTopologyGeneratorActor::SpawnTowpathProps(const int32 DressingSeed)
 	}
 
 	// Coverage-first placement so each configured semantic prop type appears at least once when possible.
-	for (const FCanalTowpathPropDefinition& Definition : TowpathPropDefinitions)
+	const FCanalCounterRandom CoverageRandom = Random.Substream(1);
+	for (int32 DefinitionIndex = 0; DefinitionIndex < TowpathPropDefinitions.Num(); ++DefinitionIndex)
 	{
+		const FCanalTowpathPropDefinition& Definition = TowpathPropDefinitions[DefinitionIndex];
 		if (Definition.SemanticTag.IsNone() || Definition.Weight <= 0.0f || CandidateIndices.Num() == 0)
 		{
 			continue;
 		}
 
-		const int32 Picked = Random.RandRange(0, CandidateIndices.Num() - 1);
+		const int32 Picked = CoverageRandom.RandRange(0, CandidateIndices.Num() - 1, DefinitionIndex);
 		const int32 TowpathInstanceIndex = CandidateIndices[Picked];
-		CandidateIndices.RemoveAtSwap(Picked);
+		CandidateIndices.RemoveAt(Picked);
 		PlaceTowpathPropAtInstance(Definition, TowpathInstanceIndex, Random);
 	}
 
-	while (CandidateIndices.Num() > 0)
+	for (const int32 TowpathInstanceIndex : CandidateIndices)
 	{
-		const FCanalTowpathPropDefinition* Definition = PickWeightedTowpathProp(Random);
+		const FCanalTowpathPropDefinition* Definition = PickWeightedTowpathProp(Random.GetFraction(TowpathInstanceIndex, PropTypeDraw));
+		if (!Definition)
+		{
+			break;
+		}
+
+		PlaceTowpathPropAtInstance(*Definition, TowpathInstanceIndex, Random);
+	}
+}
+
+void ACanalTopologyGeneratorActor::RespawnTowpathProps(
+	const TArray<int32>& RemovedTowpathInstances,
+	const TArray<int32>& AddedTowpathInstances,
+	const int32 DressingSeed)
+{
+	for (const int32 TowpathInstanceIndex : RemovedTowpathInstances)
+	{
+		TPair<UHierarchicalInstancedStaticMeshComponent*, int32> Prop;
+		if (!TowpathPropsByInstance.RemoveAndCopyValue(TowpathInstanceIndex, Prop))
+		{
+			continue;
+		}
+
+		FTransform ParkedXf;
+		Prop.Key->GetInstanceTransform(Prop.Value, ParkedXf, true);
+		ParkedXf.SetScale3D(FVector::ZeroVector);
+		Prop.Key->UpdateInstanceTransform(Prop.Value, ParkedXf, true, true, true);
+		ParkedPropInstances.FindOrAdd(Prop.Key).Add(Prop.Value);
+	}
+
+	if (!bSpawnTowpathProps || TowpathPropDensity <= 0.0f)
+	{
+		return;
+	}
+
+	// The same per-instance draws as SpawnTowpathProps. Its coverage pass is skipped: it depends on every candidate,
+	// so rerunning it would move props on towpath sides the reroll did not touch.
+	const FCanalCounterRandom Random(DressingSeed, 0x50524F50u); // 'PROP'
+	for (const int32 TowpathInstanceIndex : AddedTowpathInstances)
+	{
+		if (Random.GetFraction(TowpathInstanceIndex, PropDensityDraw) > TowpathPropDensity)
+		{
+			continue;
+		}
+
+		const FCanalTowpathPropDefinition* Definition = PickWeightedTowpathProp(Random.GetFraction(TowpathInstanceIndex, PropTypeDraw));
 		if (!Definition)
 		{
 			break;
 		}
 
-		const int32 Picked = Random.RandRange(0, CandidateIndices.Num() - 1);
-		const int32 TowpathInstanceIndex = CandidateIndices[Picked];
-		CandidateIndices.RemoveAtSwap(Picked);
 		PlaceTowpathPropAtInstance(*Definition, TowpathInstanceIndex, Random);
 	}
 }
 
+void ACanalTopologyGeneratorActor::ClearTowpathProps()
+{
+	TowpathPropsByInstance.Reset();
+	ParkedPropInstances.Reset();
+
+	BollardPropInstances->ClearInstances();
+	RingPropInstances->ClearInstances();
+	SignPropInstances->ClearInstances();
+	LampPropInstances->ClearInstances();
+	BenchPropInstances->ClearInstances();
+	ReedsPropInstances->ClearInstances();
+	BinPropInstances->ClearInstances();
+	FencePropInstances->ClearInstances();
+}
+
 UHierarchicalInstancedStaticMeshComponent* ACanalTopologyGeneratorActor::ResolveTowpathPropComponent(const FName SemanticTag) const
 {
 	if (SemanticTag == kPropTagBollard)
@@ -675,7 +1032,7 @@ UHierarchicalInstancedStaticMeshComponent* ACanalTopologyGeneratorActor::Resolve
 bool ACanalTopologyGeneratorActor::PlaceTowpathPropAtInstance(
 	const FCanalTowpathPropDefinition& Definition,
 	const int32 TowpathInstanceIndex,
-	FRandomStream& Random)
+	const FCanalCounterRandom& Random)
 {
 	UHierarchicalInstancedStaticMeshComponent* TargetComponent = ResolveTowpathPropComponent(Definition.SemanticTag);
 	if (!TargetComponent)
@@ -691,17 +1048,28 @@ bool ACanalTopologyGeneratorActor::PlaceTowpathPropAtInstance(
 
 	FVector Location = TowpathTransform.GetLocation();
 	Location += TowpathTransform.GetUnitAxis(EAxis::Z) * (TowpathPropZOffset + Definition.VerticalOffset);
-	Location += TowpathTransform.GetUnitAxis(EAxis::Y) * Random.FRandRange(-TowpathPropLateralJitter, TowpathPropLateralJitter);
+	Location += TowpathTransform.GetUnitAxis(EAxis::Y) * Random.FRandRange(-TowpathPropLateralJitter, TowpathPropLateralJitter, TowpathInstanceIndex, PropLateralDraw);
 
 	FRotator Rotation = TowpathTransform.Rotator();
-	Rotation.Yaw += Random.FRandRange(-TowpathPropYawJitter, TowpathPropYawJitter);
+	Rotation.Yaw += Random.FRandRange(-TowpathPropYawJitter, TowpathPropYawJitter, TowpathInstanceIndex, PropYawDraw);
 
 	const FTransform PropTransform(Rotation, Location, Definition.Scale);
-	TargetComponent->AddInstance(PropTransform, true);
+	int32 PropIndex = INDEX_NONE;
+	TArray<int32>* Parked = ParkedPropInstances.Find(TargetComponent);
+	if (Parked && Parked->Num() > 0)
+	{
+		PropIndex = Parked->Pop();
+		TargetComponent->UpdateInstanceTransform(PropIndex, PropTransform, true, true, true);
+	}
+	else
+	{
+		PropIndex = TargetComponent->AddInstance(PropTransform, true);
+	}
+	TowpathPropsByInstance.Add(TowpathInstanceIndex, TPair<UHierarchicalInstancedStaticMeshComponent*, int32>(TargetComponent, PropIndex));
 	return true;
 }
 
-const FCanalTowpathPropDefinition* ACanalTopologyGeneratorActor::PickWeightedTowpathProp(FRandomStream& Random) const
+const FCanalTowpathPropDefinition* ACanalTopologyGeneratorActor::PickWeightedTowpathProp(const float PickFraction) const
 {
 	float TotalWeight = 0.0f;
 	for (const FCanalTowpathPropDefinition& Definition : TowpathPropDefinitions)
@@ -716,7 +1084,7 @@ const FCanalTowpathPropDefinition* ACanalTopologyGeneratorActor::PickWeightedTow
 		return nullptr;
 	}
 
-	float Draw = Random.FRandRange(0.0f, TotalWeight);
+	float Draw = PickFraction * TotalWeight;
 	for (const FCanalTowpathPropDefinition& Definition : TowpathPropDefinitions)
 	{
 		if (Definition.Weight <= 0.0f || Definition.SemanticTag.IsNone())
@@ -777,168 +1145,150 @@ void ACanalTopologyGeneratorActor::RefreshInstanceMeshes()
 	RefreshTowpathPropMeshes();
 }
 
-void ACanalTopologyGeneratorActor::AddSocketInstance(const ECanalSocketType SocketType, const FTransform& WorldTransform)
+UHierarchicalInstancedStaticMeshComponent* ACanalTopologyGeneratorActor::ResolveSocketComponent(const ECanalSocketType SocketType) const
 {
 	switch (SocketType)
 	{
 	case ECanalSocketType::Water:
-		WaterInstances->AddInstance(WorldTransform, true);
-		break;
+		return WaterInstances;
 	case ECanalSocketType::Bank:
-		BankInstances->AddInstance(WorldTransform, true);
-		break;
+		return BankInstances;
 	case ECanalSocketType::TowpathL:
 	case ECanalSocketType::TowpathR:
-		TowpathInstances->AddInstance(WorldTransform, true);
-		break;
+		return TowpathInstances;
 	case ECanalSocketType::Lock:
-		LockInstances->AddInstance(WorldTransform, true);
-		break;
+		return LockInstances;
 	case ECanalSocketType::Road:
-		RoadInstances->AddInstance(WorldTransform, true);
-		break;
+		return RoadInstances;
 	default:
-		break;
+		return nullptr;
 	}
 }
 
-void ACanalTopologyGeneratorActor::BuildSplineFromSolvedCells(
-	const FCanalTileCompatibilityTable& Compatibility,
-	const TArray<FHexWfcCellResult>& Cells)
+FTransform ACanalTopologyGeneratorActor::GetSocketInstanceTransform(const FHexAxialCoord& Coord, const EHexDirection Direction) const
 {
-	TMap<FHexAxialCoord, const FHexWfcCellResult*> CellByCoord;
-	CellByCoord.Reserve(Cells.Num());
-	for (const FHexWfcCellResult& Cell : Cells)
+	const FVector Center = GetActorTransform().TransformPosition(GridLayout.AxialToWorld(Coord));
+	const FVector NeighborPos = GetActorTransform().TransformPosition(GridLayout.AxialToWorld(Coord.Neighbor(Direction)));
+	const FVector DirectionVec = (NeighborPos - Center).GetSafeNormal();
+	const FVector SocketPos = Center + DirectionVec * (GridLayout.HexSize * SocketOffsetScale);
+	return FTransform(DirectionVec.Rotation(), SocketPos, InstanceScale);
+}
+
+int32 ACanalTopologyGeneratorActor::AddSocketInstance(const ECanalSocketType SocketType, const FTransform& WorldTransform)
+{
+	UHierarchicalInstancedStaticMeshComponent* Component = ResolveSocketComponent(SocketType);
+	if (!Component)
 	{
-		CellByCoord.Add(Cell.Coord, &Cell);
+		return INDEX_NONE;
 	}
 
-	TArray<FHexAxialCoord> WaterCoords;
-	for (const FHexWfcCellResult& Cell : Cells)
+	TArray<int32>* Parked = ParkedSocketInstances.Find(Component);
+	if (Parked && Parked->Num() > 0)
 	{
-		if (IsWaterCell(Compatibility, Cell))
-		{
-			WaterCoords.Add(Cell.Coord);
-		}
+		const int32 InstanceIndex = Parked->Pop();
+		Component->UpdateInstanceTransform(InstanceIndex, WorldTransform, true, false, true);
+		return InstanceIndex;
 	}
 
-	if (WaterCoords.Num() < 2)
+	return Component->AddInstance(WorldTransform, true);
+}
+
+void ACanalTopologyGeneratorActor::AddCellSocketInstances(
+	const FCanalTileCompatibilityTable& Compatibility,
+	const TArray<FHexWfcCellResult>& Cells,
+	TArray<int32>* OutInstanceIndices)
+{
+	if (OutInstanceIndices)
 	{
-		return;
+		OutInstanceIndices->Init(INDEX_NONE, Cells.Num() * 6);
 	}
 
-	auto FindPath = [&](const FHexAxialCoord& Start, const FHexAxialCoord& Goal, TArray<FHexAxialCoord>& OutPath) -> bool
+	for (int32 CellIndex = 0; CellIndex < Cells.Num(); ++CellIndex)
 	{
-		TQueue<FHexAxialCoord> Queue;
-		TMap<FHexAxialCoord, FHexAxialCoord> Parent;
-		TSet<FHexAxialCoord> Visited;
-
-		Queue.Enqueue(Start);
-		Visited.Add(Start);
-
-		bool bFound = false;
-		while (!Queue.IsEmpty())
-		{
-			FHexAxialCoord Current;
-			Queue.Dequeue(Current);
-			if (Current == Goal)
-			{
-				bFound = true;
-				break;
-			}
-
-			const FHexWfcCellResult* CurrentCell = CellByCoord.FindRef(Current);
-			if (!CurrentCell)
-			{
-				continue;
-			}
-
-			for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
-			{
-				const EHexDirection Direction = HexDirectionFromIndex(DirIndex);
-				const FHexAxialCoord Neighbor = Current.Neighbor(Direction);
-				if (Visited.Contains(Neighbor))
-				{
-					continue;
-				}
-
-				const FHexWfcCellResult* NeighborCell = CellByCoord.FindRef(Neighbor);
-				if (!NeighborCell)
-				{
-					continue;
-				}
-
-				if (!IsWaterConnection(Compatibility, *CurrentCell, *NeighborCell, Direction))
-				{
-					continue;
-				}
-
-				Visited.Add(Neighbor);
-				Parent.Add(Neighbor, Current);
-				Queue.Enqueue(Neighbor);
-			}
-		}
-
-		if (!bFound)
+		const FHexWfcCellResult& Cell = Cells[CellIndex];
+		const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(Cell.Variant.TileIndex);
+		if (!Tile)
 		{
-			return false;
+			continue;
 		}
 
-		OutPath.Reset();
-		FHexAxialCoord Cursor = Goal;
-		OutPath.Add(Cursor);
-		while (Cursor != Start)
+		for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
 		{
-			const FHexAxialCoord* Prev = Parent.Find(Cursor);
-			if (!Prev)
+			const EHexDirection Direction = HexDirectionFromIndex(DirIndex);
+			const ECanalSocketType Socket = Tile->GetSocket(Direction, Cell.Variant.RotationSteps);
+			const int32 InstanceIndex = AddSocketInstance(Socket, GetSocketInstanceTransform(Cell.Coord, Direction));
+			if (OutInstanceIndices)
 			{
-				return false;
+				(*OutInstanceIndices)[CellIndex * 6 + DirIndex] = InstanceIndex;
 			}
-			Cursor = *Prev;
-			OutPath.Add(Cursor);
 		}
-		Algo::Reverse(OutPath);
-		return true;
-	};
+	}
+}
 
-	FHexAxialCoord Start = WaterCoords[0];
-	FHexAxialCoord Farthest = Start;
-	int32 BestDistance = -1;
-	for (const FHexAxialCoord& Candidate : WaterCoords)
+void ACanalTopologyGeneratorActor::UpdateStreamedInstances(const TArray<FIntPoint>& Generated, const TArray<FIntPoint>& Evicted)
+{
+	// Evicted instances are hidden (zero scale) and reused by the next chunk, so the instance count stays bounded by
+	// the resident budget instead of growing with every chunk ever streamed.
+	TSet<UHierarchicalInstancedStaticMeshComponent*> TouchedComponents;
+	for (const FIntPoint& ChunkCoord : Evicted)
 	{
-		const int32 Dist = Start.DistanceTo(Candidate);
-		if (Dist > BestDistance)
+		TArray<TPair<UHierarchicalInstancedStaticMeshComponent*, int32>> Instances;
+		if (!StreamedChunkInstances.RemoveAndCopyValue(ChunkCoord, Instances))
 		{
-			BestDistance = Dist;
-			Farthest = Candidate;
+			continue;
 		}
-	}
 
-	FHexAxialCoord End = Farthest;
-	BestDistance = -1;
-	for (const FHexAxialCoord& Candidate : WaterCoords)
-	{
-		const int32 Dist = Farthest.DistanceTo(Candidate);
-		if (Dist > BestDistance)
+		for (const TPair<UHierarchicalInstancedStaticMeshComponent*, int32>& Instance : Instances)
 		{
-			BestDistance = Dist;
-			End = Candidate;
+			FTransform ParkedXf;
+			Instance.Key->GetInstanceTransform(Instance.Value, ParkedXf, true);
+			ParkedXf.SetScale3D(FVector::ZeroVector);
+			Instance.Key->UpdateInstanceTransform(Instance.Value, ParkedXf, true, false, true);
+			ParkedSocketInstances.FindOrAdd(Instance.Key).Add(Instance.Value);
+			TouchedComponents.Add(Instance.Key);
 		}
 	}
 
-	if (SolveConfig.EntryPort.bEnabled && SolveConfig.ExitPort.bEnabled &&
-		CellByCoord.Contains(SolveConfig.EntryPort.Coord) && CellByCoord.Contains(SolveConfig.ExitPort.Coord))
+	for (UHierarchicalInstancedStaticMeshComponent* Component : TouchedComponents)
 	{
-		Start = SolveConfig.EntryPort.Coord;
-		End = SolveConfig.ExitPort.Coord;
+		Component->MarkRenderStateDirty();
 	}
 
-	TArray<FHexAxialCoord> Path;
-	if (!FindPath(Start, End, Path))
+	const FCanalTileCompatibilityTable& Compatibility = TileSet->GetCompatibilityTable();
+	for (const FIntPoint& ChunkCoord : Generated)
 	{
-		return;
+		// A chunk generated and evicted in the same update is no longer resident.
+		const FHexWfcChunk* Chunk = ChunkedSolver->FindChunk(ChunkCoord);
+		if (!Chunk || StreamedChunkInstances.Contains(ChunkCoord))
+		{
+			continue;
+		}
+
+		const TArray<FHexWfcCellResult>& Cells = Chunk->Result.Cells;
+		TArray<int32> InstanceIndices;
+		AddCellSocketInstances(Compatibility, Cells, &InstanceIndices);
+
+		TArray<TPair<UHierarchicalInstancedStaticMeshComponent*, int32>>& Instances = StreamedChunkInstances.Add(ChunkCoord);
+		Instances.Reserve(InstanceIndices.Num());
+		for (int32 CellIndex = 0; CellIndex < Cells.Num(); ++CellIndex)
+		{
+			const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(Cells[CellIndex].Variant.TileIndex);
+			for (int32 DirIndex = 0; Tile && DirIndex < 6; ++DirIndex)
+			{
+				const int32 InstanceIndex = InstanceIndices[CellIndex * 6 + DirIndex];
+				UHierarchicalInstancedStaticMeshComponent* Component =
+					ResolveSocketComponent(Tile->GetSocket(HexDirectionFromIndex(DirIndex), Cells[CellIndex].Variant.RotationSteps));
+				if (Component && InstanceIndex != INDEX_NONE)
+				{
+					Instances.Add(TPair<UHierarchicalInstancedStaticMeshComponent*, int32>(Component, InstanceIndex));
+				}
+			}
+		}
 	}
+}
 
+void ACanalTopologyGeneratorActor::ApplySplinePath(const TArray<FHexAxialCoord>& Path)
+{
 	WaterPathSpline->ClearSplinePoints(false);
 	for (int32 Index = 0; Index < Path.Num(); ++Index)
 	{
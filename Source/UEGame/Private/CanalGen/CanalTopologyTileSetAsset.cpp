@@ -1,6 +1,9 @@
 #include "CanalGen/CanalTopologyTileSetAsset.h"
 
 #include "CanalGen/CanalPrototypeTileSet.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/ObjectSaveContext.h"
 
 bool UCanalTopologyTileSetAsset::BuildCompatibilityCache(FString& OutError)
 {
@@ -77,7 +80,56 @@ const FCanalTileCompatibilityTable& UCanalTopologyTileSetAsset::GetCompatibility
 void UCanalTopologyTileSetAsset::PostLoad()
 {
 	Super::PostLoad();
+	if (!LoadCompiledCompatibility())
+	{
+		RebuildCompatibilityIfNeeded();
+	}
+}
+
+void UCanalTopologyTileSetAsset::PreSave(FObjectPreSaveContext SaveContext)
+{
+	Super::PreSave(SaveContext);
+
 	RebuildCompatibilityIfNeeded();
+	CompiledCompatibility.Reset();
+	if (Compatibility.IsBuilt())
+	{
+		FMemoryWriter Writer(CompiledCompatibility);
+		Compatibility.Serialize(Writer);
+	}
+}
+
+#if WITH_EDITOR
+void UCanalTopologyTileSetAsset::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	// Any edit under Tiles can change the table; it is rebuilt on next use and re-saved with the asset.
+	if (PropertyChangedEvent.GetMemberPropertyName() == GET_MEMBER_NAME_CHECKED(UCanalTopologyTileSetAsset, Tiles))
+	{
+		bCompatibilityBuilt = false;
+	}
+}
+#endif
+
+bool UCanalTopologyTileSetAsset::LoadCompiledCompatibility()
+{
+	if (CompiledCompatibility.Num() == 0)
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(CompiledCompatibility);
+	FCanalTileCompatibilityTable Loaded;
+	if (!Loaded.Serialize(Reader) || Loaded.GetContentHash() != FCanalTileCompatibilityTable::ComputeContentHash(Tiles))
+	{
+		UE_LOG(LogTemp, Log, TEXT("Canal tile set %s: saved compatibility table is stale, rebuilding."), *GetName());
+		return false;
+	}
+
+	Compatibility = MoveTemp(Loaded);
+	bCompatibilityBuilt = true;
+	return true;
 }
 
 void UCanalTopologyTileSetAsset::RebuildCompatibilityIfNeeded() const
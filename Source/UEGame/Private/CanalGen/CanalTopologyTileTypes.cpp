@@ -1,5 +1,7 @@
 #include "CanalGen/CanalTopologyTileTypes.h"
 
+#include "Hash/CityHash.h"
+
 namespace
 {
 	const TArray<FCanalTileVariantKey> EmptyVariants;
@@ -45,9 +47,22 @@ ECanalSocketType FCanalTopologyTileDefinition::GetSocket(const EHexDirection Dir
 bool FCanalTileCompatibilityTable::Build(const TArray<FCanalTopologyTileDefinition>& InTiles, FString* OutError)
 {
 	bBuilt = false;
+	ContentHash = 0;
 	TileDefinitions.Reset();
+	TileRotationPeriods.Reset();
 	AllVariants.Reset();
-	Compatibility.Reset();
+	VariantMultiplicities.Reset();
+	VariantIndexByKey.Reset();
+	VariantMaskWordCount = 0;
+	AllVariantsMask.Reset();
+	VariantSockets.Reset();
+	SocketMasks.Reset();
+	SocketBucketOffsets.Reset();
+	SocketBucketIndices.Reset();
+	for (TArray<FCanalTileVariantKey>& Bucket : SocketBucketVariants)
+	{
+		Bucket.Reset();
+	}
 
 	for (int32 TileIndex = 0; TileIndex < InTiles.Num(); ++TileIndex)
 	{
@@ -66,57 +81,280 @@ bool FCanalTileCompatibilityTable::Build(const TArray<FCanalTopologyTileDefiniti
 
 	for (int32 TileIndex = 0; TileIndex < TileDefinitions.Num(); ++TileIndex)
 	{
-		for (int32 Rotation = 0; Rotation < 6; ++Rotation)
+		// Rotating by the period reproduces the same sockets, so only rotations below it are distinct.
+		const TArray<ECanalSocketType>& TileSockets = TileDefinitions[TileIndex].Sockets;
+		int32 Period = 1;
+		for (; Period < 6; ++Period)
+		{
+			bool bSymmetric = true;
+			for (int32 SocketIndex = 0; bSymmetric && SocketIndex < 6; ++SocketIndex)
+			{
+				bSymmetric = TileSockets[SocketIndex] == TileSockets[(SocketIndex + Period) % 6];
+			}
+			if (bSymmetric)
+			{
+				break;
+			}
+		}
+		TileRotationPeriods.Add(static_cast<uint8>(Period));
+
+		for (int32 Rotation = 0; Rotation < Period; ++Rotation)
 		{
 			FCanalTileVariantKey Variant;
 			Variant.TileIndex = TileIndex;
 			Variant.RotationSteps = static_cast<uint8>(Rotation);
 			AllVariants.Add(Variant);
-			Compatibility.Add(Variant, FVariantAdjacency());
+			VariantMultiplicities.Add(static_cast<uint8>(6 / Period));
+
+			for (int32 DirectionIndex = 0; DirectionIndex < 6; ++DirectionIndex)
+			{
+				const ECanalSocketType Socket = TileDefinitions[TileIndex].GetSocket(HexDirectionFromIndex(DirectionIndex), Rotation);
+				VariantSockets.Add(static_cast<uint8>(Socket));
+			}
 		}
 	}
 
-	for (const FCanalTileVariantKey& Source : AllVariants)
+	VariantMaskWordCount = FMath::DivideAndRoundUp(AllVariants.Num(), 64);
+	AllVariantsMask.Init(0, VariantMaskWordCount);
+	for (int32 VariantIndex = 0; VariantIndex < AllVariants.Num(); ++VariantIndex)
 	{
-		FVariantAdjacency& Adjacency = Compatibility[Source];
-		for (int32 DirectionIndex = 0; DirectionIndex < 6; ++DirectionIndex)
-		{
-			const EHexDirection Direction = HexDirectionFromIndex(DirectionIndex);
-			TArray<FCanalTileVariantKey>& Allowed = Adjacency.ByDirection[DirectionIndex];
-			Allowed.Reserve(AllVariants.Num());
+		AllVariantsMask[VariantIndex / 64] |= (uint64(1) << (VariantIndex % 64));
+	}
 
-			for (const FCanalTileVariantKey& Target : AllVariants)
+	// Variants are visited in index order, so every bucket comes out sorted by (TileIndex, RotationSteps).
+	SocketMasks.Init(0, 6 * NumSocketTypes * VariantMaskWordCount);
+	SocketBucketOffsets.Reserve(6 * NumSocketTypes + 1);
+	SocketBucketIndices.Reserve(AllVariants.Num() * 6);
+	for (int32 Bucket = 0; Bucket < 6 * NumSocketTypes; ++Bucket)
+	{
+		const int32 DirectionIndex = Bucket / NumSocketTypes;
+		const int32 Socket = Bucket % NumSocketTypes;
+		uint64* Mask = &SocketMasks[Bucket * VariantMaskWordCount];
+		SocketBucketOffsets.Add(SocketBucketIndices.Num());
+		for (int32 VariantIndex = 0; VariantIndex < AllVariants.Num(); ++VariantIndex)
+		{
+			if (VariantSockets[VariantIndex * 6 + DirectionIndex] == Socket)
 			{
-				const FCanalTopologyTileDefinition& SourceTile = TileDefinitions[Source.TileIndex];
-				const FCanalTopologyTileDefinition& TargetTile = TileDefinitions[Target.TileIndex];
-				if (CanConnect(SourceTile, Source.RotationSteps, Direction, TargetTile, Target.RotationSteps))
-				{
-					Allowed.Add(Target);
-				}
+				Mask[VariantIndex / 64] |= (uint64(1) << (VariantIndex % 64));
+				SocketBucketIndices.Add(VariantIndex);
 			}
-
-			Allowed.Sort(&FCanalTileCompatibilityTable::IsDeterministicLess);
 		}
 	}
+	SocketBucketOffsets.Add(SocketBucketIndices.Num());
 
+	RebuildLookups();
+	ContentHash = ComputeContentHash(TileDefinitions);
 	bBuilt = true;
 	return true;
 }
 
+void FCanalTileCompatibilityTable::RebuildLookups()
+{
+	// Every rotation of a tile resolves to the variant it was folded into.
+	VariantIndexByKey.Reset();
+	for (int32 VariantIndex = 0; VariantIndex < AllVariants.Num(); ++VariantIndex)
+	{
+		const FCanalTileVariantKey& Variant = AllVariants[VariantIndex];
+		const int32 Period = TileRotationPeriods[Variant.TileIndex];
+		for (int32 Alias = Variant.RotationSteps; Alias < 6; Alias += Period)
+		{
+			FCanalTileVariantKey AliasKey = Variant;
+			AliasKey.RotationSteps = static_cast<uint8>(Alias);
+			VariantIndexByKey.Add(AliasKey, VariantIndex);
+		}
+	}
+
+	for (int32 Bucket = 0; Bucket < 6 * NumSocketTypes; ++Bucket)
+	{
+		SocketBucketVariants[Bucket].Reset();
+		for (int32 Entry = SocketBucketOffsets[Bucket]; Entry < SocketBucketOffsets[Bucket + 1]; ++Entry)
+		{
+			SocketBucketVariants[Bucket].Add(AllVariants[SocketBucketIndices[Entry]]);
+		}
+	}
+}
+
+uint64 FCanalTileCompatibilityTable::ComputeContentHash(const TArray<FCanalTopologyTileDefinition>& InTiles)
+{
+	uint64 Hash = CityHash64(reinterpret_cast<const char*>(&FormatVersion), sizeof(FormatVersion));
+	for (const FCanalTopologyTileDefinition& Tile : InTiles)
+	{
+		const FString TileId = Tile.TileId.ToString();
+		const uint8 bAllowAsBoundaryPort = Tile.bAllowAsBoundaryPort ? 1 : 0;
+		const int32 NumSockets = Tile.Sockets.Num();
+		Hash = CityHash64WithSeed(reinterpret_cast<const char*>(*TileId), TileId.Len() * sizeof(TCHAR), Hash);
+		Hash = CityHash64WithSeed(reinterpret_cast<const char*>(&NumSockets), sizeof(NumSockets), Hash);
+		Hash = CityHash64WithSeed(reinterpret_cast<const char*>(Tile.Sockets.GetData()), NumSockets * sizeof(ECanalSocketType), Hash);
+		Hash = CityHash64WithSeed(reinterpret_cast<const char*>(&Tile.Weight), sizeof(Tile.Weight), Hash);
+		Hash = CityHash64WithSeed(reinterpret_cast<const char*>(&bAllowAsBoundaryPort), sizeof(bAllowAsBoundaryPort), Hash);
+	}
+	return Hash;
+}
+
+bool FCanalTileCompatibilityTable::Serialize(FArchive& Ar)
+{
+	int32 Version = FormatVersion;
+	Ar << Version;
+	if (Ar.IsLoading())
+	{
+		*this = FCanalTileCompatibilityTable();
+		if (Version != FormatVersion)
+		{
+			return false;
+		}
+	}
+
+	int32 NumTiles = TileDefinitions.Num();
+	Ar << ContentHash;
+	Ar << NumTiles;
+	if (Ar.IsLoading())
+	{
+		if (NumTiles < 0 || NumTiles > MaxSerializedTiles)
+		{
+			return false;
+		}
+		TileDefinitions.SetNum(NumTiles);
+	}
+	for (FCanalTopologyTileDefinition& Tile : TileDefinitions)
+	{
+		Ar << Tile.TileId;
+		Ar << Tile.Sockets;
+		Ar << Tile.Weight;
+		Ar << Tile.bAllowAsBoundaryPort;
+	}
+
+	int32 NumVariants = AllVariants.Num();
+	Ar << NumVariants;
+	if (Ar.IsLoading())
+	{
+		// Each tile has at most six distinct rotations.
+		if (Ar.IsError() || NumVariants < 0 || NumVariants > TileDefinitions.Num() * 6)
+		{
+			*this = FCanalTileCompatibilityTable();
+			return false;
+		}
+		AllVariants.SetNum(NumVariants);
+	}
+	for (FCanalTileVariantKey& Variant : AllVariants)
+	{
+		Ar << Variant.TileIndex;
+		Ar << Variant.RotationSteps;
+	}
+
+	Ar << TileRotationPeriods;
+	Ar << VariantMultiplicities;
+	Ar << VariantMaskWordCount;
+	Ar << AllVariantsMask;
+	Ar << VariantSockets;
+	Ar << SocketMasks;
+	Ar << SocketBucketOffsets;
+	Ar << SocketBucketIndices;
+
+	if (Ar.IsLoading())
+	{
+		const int32 NumBuckets = 6 * NumSocketTypes;
+		bool bConsistent = !Ar.IsError()
+			&& TileRotationPeriods.Num() == TileDefinitions.Num()
+			&& VariantMultiplicities.Num() == AllVariants.Num()
+			&& VariantSockets.Num() == AllVariants.Num() * 6
+			&& VariantMaskWordCount == FMath::DivideAndRoundUp(AllVariants.Num(), 64)
+			&& AllVariantsMask.Num() == VariantMaskWordCount
+			&& SocketMasks.Num() == NumBuckets * VariantMaskWordCount
+			&& SocketBucketOffsets.Num() == NumBuckets + 1
+			&& SocketBucketOffsets.Last() == SocketBucketIndices.Num();
+		for (int32 TileIndex = 0; bConsistent && TileIndex < TileDefinitions.Num(); ++TileIndex)
+		{
+			bConsistent = TileDefinitions[TileIndex].Sockets.Num() == 6;
+		}
+		for (int32 VariantIndex = 0; bConsistent && VariantIndex < AllVariants.Num(); ++VariantIndex)
+		{
+			const int32 TileIndex = AllVariants[VariantIndex].TileIndex;
+			bConsistent = TileRotationPeriods.IsValidIndex(TileIndex)
+				&& TileRotationPeriods[TileIndex] >= 1
+				&& AllVariants[VariantIndex].RotationSteps < TileRotationPeriods[TileIndex]
+				&& VariantMultiplicities[VariantIndex] >= 1;
+		}
+		// Sockets index the bucket offsets and masks directly, so an out-of-range value would read past them.
+		for (int32 Entry = 0; bConsistent && Entry < VariantSockets.Num(); ++Entry)
+		{
+			bConsistent = VariantSockets[Entry] < NumSocketTypes;
+		}
+		for (int32 Bucket = 0; bConsistent && Bucket < NumBuckets; ++Bucket)
+		{
+			bConsistent = SocketBucketOffsets[Bucket] >= 0 && SocketBucketOffsets[Bucket] <= SocketBucketOffsets[Bucket + 1];
+		}
+		for (int32 Entry = 0; bConsistent && Entry < SocketBucketIndices.Num(); ++Entry)
+		{
+			bConsistent = AllVariants.IsValidIndex(SocketBucketIndices[Entry]);
+		}
+		if (!bConsistent)
+		{
+			*this = FCanalTileCompatibilityTable();
+			return false;
+		}
+
+		RebuildLookups();
+		bBuilt = true;
+	}
+
+	return !Ar.IsError();
+}
+
+uint8 FCanalTileCompatibilityTable::GetDomainSocketSet(const uint64* DomainBits, const int32 DirIndex) const
+{
+	uint8 SocketSet = 0;
+	for (int32 Socket = 0; Socket < NumSocketTypes; ++Socket)
+	{
+		const uint64* Mask = GetSocketVariantMask(DirIndex, Socket);
+		for (int32 WordIndex = 0; WordIndex < VariantMaskWordCount; ++WordIndex)
+		{
+			if ((DomainBits[WordIndex] & Mask[WordIndex]) != 0)
+			{
+				SocketSet |= static_cast<uint8>(1u << Socket);
+				break;
+			}
+		}
+	}
+	return SocketSet;
+}
+
 const TArray<FCanalTileVariantKey>& FCanalTileCompatibilityTable::GetCompatibleVariants(const FCanalTileVariantKey& Source, const EHexDirection OutDirection) const
 {
-	if (const FVariantAdjacency* Adjacency = Compatibility.Find(Source))
+	const int32 SourceIndex = FindVariantIndex(Source);
+	if (SourceIndex == INDEX_NONE)
 	{
-		return Adjacency->ByDirection[HexDirectionToIndex(OutDirection)];
+		return EmptyVariants;
 	}
-	return EmptyVariants;
+	return SocketBucketVariants[GetCompatibleBucket(SourceIndex, HexDirectionToIndex(OutDirection))];
+}
+
+int32 FCanalTileCompatibilityTable::FindVariantIndex(const FCanalTileVariantKey& Key) const
+{
+	const int32* Index = VariantIndexByKey.Find(Key);
+	return Index ? *Index : INDEX_NONE;
+}
+
+const uint64* FCanalTileCompatibilityTable::GetCompatibleVariantMask(const int32 SourceVariantIndex, const EHexDirection OutDirection) const
+{
+	check(AllVariants.IsValidIndex(SourceVariantIndex));
+	return &SocketMasks[GetCompatibleBucket(SourceVariantIndex, HexDirectionToIndex(OutDirection)) * VariantMaskWordCount];
+}
+
+TConstArrayView<int32> FCanalTileCompatibilityTable::GetCompatibleVariantIndices(const int32 SourceVariantIndex, const EHexDirection OutDirection) const
+{
+	check(AllVariants.IsValidIndex(SourceVariantIndex));
+	const int32 Bucket = GetCompatibleBucket(SourceVariantIndex, HexDirectionToIndex(OutDirection));
+	const int32 Begin = SocketBucketOffsets[Bucket];
+	return TConstArrayView<int32>(SocketBucketIndices.GetData() + Begin, SocketBucketOffsets[Bucket + 1] - Begin);
 }
 
 FCanalTileVariantRef FCanalTileCompatibilityTable::ToVariantRef(const FCanalTileVariantKey& Key) const
 {
 	FCanalTileVariantRef Ref;
 	Ref.TileIndex = Key.TileIndex;
-	Ref.RotationSteps = Key.RotationSteps;
+	Ref.RotationSteps = TileRotationPeriods.IsValidIndex(Key.TileIndex)
+		? Key.RotationSteps % TileRotationPeriods[Key.TileIndex]
+		: Key.RotationSteps;
 
 	if (TileDefinitions.IsValidIndex(Key.TileIndex))
 	{
@@ -154,24 +392,3 @@ FString FCanalTileCompatibilityTable::DescribeCompatibility(const FCanalTileVari
 
 	return Description;
 }
-
-bool FCanalTileCompatibilityTable::CanConnect(
-	const FCanalTopologyTileDefinition& Source,
-	const int32 SourceRotation,
-	const EHexDirection SourceDirection,
-	const FCanalTopologyTileDefinition& Target,
-	const int32 TargetRotation)
-{
-	const ECanalSocketType SourceSocket = Source.GetSocket(SourceDirection, SourceRotation);
-	const ECanalSocketType TargetSocket = Target.GetSocket(OppositeHexDirection(SourceDirection), TargetRotation);
-	return SourceSocket == TargetSocket;
-}
-
-bool FCanalTileCompatibilityTable::IsDeterministicLess(const FCanalTileVariantKey& A, const FCanalTileVariantKey& B)
-{
-	if (A.TileIndex != B.TileIndex)
-	{
-		return A.TileIndex < B.TileIndex;
-	}
-	return A.RotationSteps < B.RotationSteps;
-}
@@ -9,6 +9,526 @@
 #include "Misc/Parse.h"
 #include "Misc/Paths.h"
 
+namespace
+{
+	// One batch report: the run settings, the seed range it covers and its stats. Checkpoints are reports of a partial
+	// range, and the CSV form reads back into this so checkpoints can be resumed and shard reports merged.
+	struct FBatchReport
+	{
+		// Every parameter that affects results, in report order. Reports only combine when these match.
+		TArray<TPair<FString, FString>> Settings;
+
+		int32 ShardIndex = 0;
+		int32 ShardCount = 1;
+		int32 StartSeed = 1;
+
+		// One past the last processed seed, where a resumed run continues.
+		int32 NextSeed = 1;
+
+		bool bParallel = false;
+		FHexWfcBatchStats Stats;
+	};
+
+	const TCHAR* BoolString(const bool bValue)
+	{
+		return bValue ? TEXT("true") : TEXT("false");
+	}
+
+	// Scalar report entries in report order: seed range, stats, then settings.
+	TArray<TPair<FString, FString>> GetMetricRows(const FBatchReport& Report)
+	{
+		TArray<TPair<FString, FString>> Rows;
+		const auto AddRow = [&Rows](const TCHAR* Key, const FString& Value)
+		{
+			Rows.Add(TPair<FString, FString>(Key, Value));
+		};
+
+		// Totals are what reports are merged and resumed from; the averages next to them are derived here for
+		// reading and never read back. Phase times only exist as averages, so they keep nanosecond precision.
+		const FHexWfcBatchStats& Stats = Report.Stats;
+		const FHexWfcSolveProfile& Profile = Stats.AverageProfile;
+		const auto PerSeed = [&Stats](const double Total)
+		{
+			return Stats.NumSeedsProcessed > 0 ? Total / Stats.NumSeedsProcessed : 0.0;
+		};
+		AddRow(TEXT("shard_index"), FString::FromInt(Report.ShardIndex));
+		AddRow(TEXT("shard_count"), FString::FromInt(Report.ShardCount));
+		AddRow(TEXT("start_seed"), FString::FromInt(Report.StartSeed));
+		AddRow(TEXT("next_seed"), FString::FromInt(Report.NextSeed));
+		AddRow(TEXT("num_seeds_requested"), FString::FromInt(Stats.NumSeedsRequested));
+		AddRow(TEXT("num_seeds_processed"), FString::FromInt(Stats.NumSeedsProcessed));
+		AddRow(TEXT("num_solved"), FString::FromInt(Stats.NumSolved));
+		AddRow(TEXT("num_failed"), FString::FromInt(Stats.NumFailed));
+		AddRow(TEXT("num_contradictions"), FString::FromInt(Stats.NumContradictions));
+		AddRow(TEXT("num_time_budget_exceeded"), FString::FromInt(Stats.NumTimeBudgetExceeded));
+		AddRow(TEXT("num_single_component_failures"), FString::FromInt(Stats.NumSingleWaterComponentFailures));
+		AddRow(TEXT("total_attempts_used"), FString::Printf(TEXT("%lld"), Stats.TotalAttemptsUsed));
+		AddRow(TEXT("total_backtracks"), FString::Printf(TEXT("%lld"), Stats.TotalBacktracks));
+		AddRow(TEXT("total_propagation_steps"), FString::Printf(TEXT("%lld"), Stats.TotalPropagationSteps));
+		AddRow(TEXT("total_solve_time_seconds"), FString::Printf(TEXT("%.9f"), Stats.TotalSolveTimeSeconds));
+		AddRow(TEXT("contradiction_rate"), FString::Printf(TEXT("%.6f"), PerSeed(Stats.NumContradictions)));
+		AddRow(TEXT("average_attempts_used"), FString::Printf(TEXT("%.6f"), PerSeed(Stats.TotalAttemptsUsed)));
+		AddRow(TEXT("average_backtracks"), FString::Printf(TEXT("%.6f"), PerSeed(Stats.TotalBacktracks)));
+		AddRow(TEXT("average_solve_time_seconds"), FString::Printf(TEXT("%.9f"), PerSeed(Stats.TotalSolveTimeSeconds)));
+		AddRow(TEXT("average_prepare_seconds"), FString::Printf(TEXT("%.9f"), Profile.PrepareSeconds));
+		AddRow(TEXT("average_initialize_seconds"), FString::Printf(TEXT("%.9f"), Profile.InitializeSeconds));
+		AddRow(TEXT("average_carve_seconds"), FString::Printf(TEXT("%.9f"), Profile.CarveSeconds));
+		AddRow(TEXT("average_select_seconds"), FString::Printf(TEXT("%.9f"), Profile.SelectSeconds));
+		AddRow(TEXT("average_sample_seconds"), FString::Printf(TEXT("%.9f"), Profile.SampleSeconds));
+		AddRow(TEXT("average_propagate_seconds"), FString::Printf(TEXT("%.9f"), Profile.PropagateSeconds));
+		AddRow(TEXT("average_connectivity_seconds"), FString::Printf(TEXT("%.9f"), Profile.ConnectivitySeconds));
+		AddRow(TEXT("average_backtrack_seconds"), FString::Printf(TEXT("%.9f"), Profile.BacktrackSeconds));
+		AddRow(TEXT("average_validate_seconds"), FString::Printf(TEXT("%.9f"), Profile.ValidateSeconds));
+		AddRow(TEXT("average_propagation_steps"), FString::Printf(TEXT("%.3f"), PerSeed(Stats.TotalPropagationSteps)));
+		AddRow(TEXT("peak_domain_bytes"), FString::Printf(TEXT("%lld"), Profile.PeakDomainBytes));
+		AddRow(TEXT("peak_propagation_queue"), FString::FromInt(Profile.PeakPropagationQueue));
+		AddRow(TEXT("peak_undo_trail"), FString::FromInt(Profile.PeakUndoTrail));
+		AddRow(TEXT("elapsed_batch_time_seconds"), FString::Printf(TEXT("%.6f"), Stats.ElapsedBatchTimeSeconds));
+		AddRow(TEXT("batch_time_limit_exceeded"), BoolString(Stats.bBatchTimeLimitExceeded));
+		AddRow(TEXT("parallel"), BoolString(Report.bParallel));
+		Rows.Append(Report.Settings);
+		return Rows;
+	}
+
+	FString ToJson(const FBatchReport& Report)
+	{
+		const FHexWfcBatchStats& Stats = Report.Stats;
+
+		FString Json;
+		Json += TEXT("{\n");
+		for (const TPair<FString, FString>& Row : GetMetricRows(Report))
+		{
+			const bool bLiteral = Row.Value == TEXT("true") || Row.Value == TEXT("false") || Row.Value.IsNumeric();
+			const FString Value = bLiteral ? Row.Value : FString::Printf(TEXT("\"%s\""), *Row.Value);
+			Json += FString::Printf(TEXT("  \"%s\": %s,\n"), *Row.Key, *Value);
+		}
+
+		Json += TEXT("  \"attempt_histogram\": [\n");
+		for (int32 Index = 0; Index < Stats.AttemptHistogram.Num(); ++Index)
+		{
+			const FHexWfcAttemptHistogramBin& Bin = Stats.AttemptHistogram[Index];
+			Json += FString::Printf(TEXT("    {\"attempts\": %d, \"count\": %d}%s\n"), Bin.Attempts, Bin.Count, (Index + 1 < Stats.AttemptHistogram.Num()) ? TEXT(",") : TEXT(""));
+		}
+		Json += TEXT("  ],\n");
+
+		Json += TEXT("  \"backtrack_histogram\": [\n");
+		for (int32 Index = 0; Index < Stats.BacktrackHistogram.Num(); ++Index)
+		{
+			const FHexWfcBacktrackHistogramBin& Bin = Stats.BacktrackHistogram[Index];
+			Json += FString::Printf(
+				TEXT("    {\"min_backtracks\": %d, \"max_backtracks\": %d, \"count\": %d}%s\n"),
+				Bin.MinBacktracks,
+				Bin.MaxBacktracks,
+				Bin.Count,
+				(Index + 1 < Stats.BacktrackHistogram.Num()) ? TEXT(",") : TEXT(""));
+		}
+		Json += TEXT("  ],\n");
+
+		Json += TEXT("  \"tile_histogram\": [\n");
+		for (int32 Index = 0; Index < Stats.TileHistogram.Num(); ++Index)
+		{
+			const FHexWfcTileHistogramBin& Bin = Stats.TileHistogram[Index];
+			Json += FString::Printf(
+				TEXT("    {\"tile_id\": \"%s\", \"count\": %d, \"fraction\": %.6f}%s\n"),
+				*Bin.TileId.ToString(),
+				Bin.Count,
+				Bin.Fraction,
+				(Index + 1 < Stats.TileHistogram.Num()) ? TEXT(",") : TEXT(""));
+		}
+		Json += TEXT("  ]\n");
+		Json += TEXT("}\n");
+		return Json;
+	}
+
+	FString ToCsv(const FBatchReport& Report)
+	{
+		const FHexWfcBatchStats& Stats = Report.Stats;
+
+		FString Csv;
+		Csv += TEXT("metric,value\n");
+		for (const TPair<FString, FString>& Row : GetMetricRows(Report))
+		{
+			Csv += FString::Printf(TEXT("%s,%s\n"), *Row.Key, *Row.Value);
+		}
+
+		Csv += TEXT("\n");
+		Csv += TEXT("attempts,count\n");
+		for (const FHexWfcAttemptHistogramBin& Bin : Stats.AttemptHistogram)
+		{
+			Csv += FString::Printf(TEXT("%d,%d\n"), Bin.Attempts, Bin.Count);
+		}
+
+		Csv += TEXT("\n");
+		Csv += TEXT("min_backtracks,max_backtracks,count\n");
+		for (const FHexWfcBacktrackHistogramBin& Bin : Stats.BacktrackHistogram)
+		{
+			Csv += FString::Printf(TEXT("%d,%d,%d\n"), Bin.MinBacktracks, Bin.MaxBacktracks, Bin.Count);
+		}
+
+		Csv += TEXT("\n");
+		Csv += TEXT("tile_id,count,fraction\n");
+		for (const FHexWfcTileHistogramBin& Bin : Stats.TileHistogram)
+		{
+			Csv += FString::Printf(TEXT("%s,%d,%.6f\n"), *Bin.TileId.ToString(), Bin.Count, Bin.Fraction);
+		}
+		return Csv;
+	}
+
+	// Reads a CSV report or checkpoint. Metrics this build does not know become settings, so reports written with
+	// other parameters fail the settings check instead of merging silently.
+	bool ParseCsvReport(const FString& Csv, FBatchReport& OutReport, FString& OutError)
+	{
+		enum class ESection : uint8
+		{
+			None,
+			Metrics,
+			Attempts,
+			Backtracks,
+			Tiles
+		};
+
+		FBatchReport Report;
+		TArray<TPair<FString, FString>> Metrics;
+		ESection Section = ESection::None;
+
+		TArray<FString> Lines;
+		Csv.ParseIntoArrayLines(Lines, true);
+		for (const FString& RawLine : Lines)
+		{
+			const FString Line = RawLine.TrimStartAndEnd();
+			if (Line == TEXT("metric,value"))
+			{
+				Section = ESection::Metrics;
+				continue;
+			}
+			if (Line == TEXT("attempts,count"))
+			{
+				Section = ESection::Attempts;
+				continue;
+			}
+			if (Line == TEXT("min_backtracks,max_backtracks,count"))
+			{
+				Section = ESection::Backtracks;
+				continue;
+			}
+			if (Line == TEXT("tile_id,count,fraction"))
+			{
+				Section = ESection::Tiles;
+				continue;
+			}
+
+			TArray<FString> Fields;
+			Line.ParseIntoArray(Fields, TEXT(","), false);
+			if (Section == ESection::Metrics && Fields.Num() == 2)
+			{
+				Metrics.Add(TPair<FString, FString>(Fields[0], Fields[1]));
+			}
+			else if (Section == ESection::Attempts && Fields.Num() == 2)
+			{
+				FHexWfcAttemptHistogramBin& Bin = Report.Stats.AttemptHistogram.AddDefaulted_GetRef();
+				Bin.Attempts = FCString::Atoi(*Fields[0]);
+				Bin.Count = FCString::Atoi(*Fields[1]);
+			}
+			else if (Section == ESection::Backtracks && Fields.Num() == 3)
+			{
+				FHexWfcBacktrackHistogramBin& Bin = Report.Stats.BacktrackHistogram.AddDefaulted_GetRef();
+				Bin.MinBacktracks = FCString::Atoi(*Fields[0]);
+				Bin.MaxBacktracks = FCString::Atoi(*Fields[1]);
+				Bin.Count = FCString::Atoi(*Fields[2]);
+			}
+			else if (Section == ESection::Tiles && Fields.Num() == 3)
+			{
+				FHexWfcTileHistogramBin& Bin = Report.Stats.TileHistogram.AddDefaulted_GetRef();
+				Bin.TileId = FName(*Fields[0]);
+				Bin.Count = FCString::Atoi(*Fields[1]);
+				Bin.Fraction = FCString::Atof(*Fields[2]);
+			}
+			else
+			{
+				OutError = FString::Printf(TEXT("Unexpected report line '%s'."), *Line);
+				return false;
+			}
+		}
+
+		TMap<FString, FString> MetricByKey;
+		for (const TPair<FString, FString>& Metric : Metrics)
+		{
+			MetricByKey.Add(Metric.Key, Metric.Value);
+		}
+		for (const TCHAR* RequiredKey : {TEXT("start_seed"), TEXT("num_seeds_processed"), TEXT("total_attempts_used"), TEXT("total_backtracks"), TEXT("total_propagation_steps")})
+		{
+			if (!MetricByKey.Contains(RequiredKey))
+			{
+				OutError = FString::Printf(TEXT("Report has no %s metric."), RequiredKey);
+				return false;
+			}
+		}
+
+		const auto ReadInt32 = [&MetricByKey](const TCHAR* Key, int32& OutValue)
+		{
+			if (const FString* Value = MetricByKey.Find(Key))
+			{
+				OutValue = FCString::Atoi(**Value);
+			}
+		};
+		const auto ReadInt64 = [&MetricByKey](const TCHAR* Key, int64& OutValue)
+		{
+			if (const FString* Value = MetricByKey.Find(Key))
+			{
+				OutValue = FCString::Atoi64(**Value);
+			}
+		};
+		const auto ReadFloat = [&MetricByKey](const TCHAR* Key, float& OutValue)
+		{
+			if (const FString* Value = MetricByKey.Find(Key))
+			{
+				OutValue = FCString::Atof(**Value);
+			}
+		};
+		const auto ReadDouble = [&MetricByKey](const TCHAR* Key, double& OutValue)
+		{
+			if (const FString* Value = MetricByKey.Find(Key))
+			{
+				OutValue = FCString::Atod(**Value);
+			}
+		};
+		const auto ReadBool = [&MetricByKey](const TCHAR* Key, bool& OutValue)
+		{
+			if (const FString* Value = MetricByKey.Find(Key))
+			{
+				OutValue = *Value == TEXT("true");
+			}
+		};
+
+		FHexWfcBatchStats& Stats = Report.Stats;
+		FHexWfcSolveProfile& Profile = Stats.AverageProfile;
+		ReadInt32(TEXT("shard_index"), Report.ShardIndex);
+		ReadInt32(TEXT("shard_count"), Report.ShardCount);
+		ReadInt32(TEXT("start_seed"), Report.StartSeed);
+		ReadInt32(TEXT("num_seeds_requested"), Stats.NumSeedsRequested);
+		ReadInt32(TEXT("num_seeds_processed"), Stats.NumSeedsProcessed);
+		Report.NextSeed = Report.StartSeed + Stats.NumSeedsProcessed;
+		ReadInt32(TEXT("next_seed"), Report.NextSeed);
+		ReadInt32(TEXT("num_solved"), Stats.NumSolved);
+		ReadInt32(TEXT("num_failed"), Stats.NumFailed);
+		ReadInt32(TEXT("num_contradictions"), Stats.NumContradictions);
+		ReadInt32(TEXT("num_time_budget_exceeded"), Stats.NumTimeBudgetExceeded);
+		ReadInt32(TEXT("num_single_component_failures"), Stats.NumSingleWaterComponentFailures);
+		ReadInt64(TEXT("total_attempts_used"), Stats.TotalAttemptsUsed);
+		ReadInt64(TEXT("total_backtracks"), Stats.TotalBacktracks);
+		ReadInt64(TEXT("total_propagation_steps"), Stats.TotalPropagationSteps);
+		ReadDouble(TEXT("total_solve_time_seconds"), Stats.TotalSolveTimeSeconds);
+		ReadFloat(TEXT("average_prepare_seconds"), Profile.PrepareSeconds);
+		ReadFloat(TEXT("average_initialize_seconds"), Profile.InitializeSeconds);
+		ReadFloat(TEXT("average_carve_seconds"), Profile.CarveSeconds);
+		ReadFloat(TEXT("average_select_seconds"), Profile.SelectSeconds);
+		ReadFloat(TEXT("average_sample_seconds"), Profile.SampleSeconds);
+		ReadFloat(TEXT("average_propagate_seconds"), Profile.PropagateSeconds);
+		ReadFloat(TEXT("average_connectivity_seconds"), Profile.ConnectivitySeconds);
+		ReadFloat(TEXT("average_backtrack_seconds"), Profile.BacktrackSeconds);
+		ReadFloat(TEXT("average_validate_seconds"), Profile.ValidateSeconds);
+		ReadInt64(TEXT("peak_domain_bytes"), Profile.PeakDomainBytes);
+		ReadInt32(TEXT("peak_propagation_queue"), Profile.PeakPropagationQueue);
+		ReadInt32(TEXT("peak_undo_trail"), Profile.PeakUndoTrail);
+		ReadFloat(TEXT("elapsed_batch_time_seconds"), Stats.ElapsedBatchTimeSeconds);
+		ReadBool(TEXT("batch_time_limit_exceeded"), Stats.bBatchTimeLimitExceeded);
+		ReadBool(TEXT("parallel"), Report.bParallel);
+		Stats.UpdateAverages();
+
+		TSet<FString> KnownKeys;
+		for (const TPair<FString, FString>& Row : GetMetricRows(FBatchReport()))
+		{
+			KnownKeys.Add(Row.Key);
+		}
+		for (const TPair<FString, FString>& Metric : Metrics)
+		{
+			if (!KnownKeys.Contains(Metric.Key))
+			{
+				Report.Settings.Add(Metric);
+			}
+		}
+
+		OutReport = MoveTemp(Report);
+		return true;
+	}
+
+	bool LoadCsvReport(const FString& Path, FBatchReport& OutReport, FString& OutError)
+	{
+		FString Csv;
+		if (!FFileHelper::LoadFileToString(Csv, *Path))
+		{
+			OutError = FString::Printf(TEXT("Failed to read '%s'."), *Path);
+			return false;
+		}
+		if (!ParseCsvReport(Csv, OutReport, OutError))
+		{
+			OutError = FString::Printf(TEXT("%s: %s"), *Path, *OutError);
+			return false;
+		}
+		return true;
+	}
+
+	// Empty when the settings match, otherwise a description of the first difference.
+	FString DiffSettings(const TArray<TPair<FString, FString>>& Expected, const TArray<TPair<FString, FString>>& Actual)
+	{
+		for (int32 Index = 0; Index < FMath::Max(Expected.Num(), Actual.Num()); ++Index)
+		{
+			if (!Expected.IsValidIndex(Index) || !Actual.IsValidIndex(Index))
+			{
+				const TPair<FString, FString>& Extra = Expected.IsValidIndex(Index) ? Expected[Index] : Actual[Index];
+				return FString::Printf(TEXT("setting '%s' is only in one of them"), *Extra.Key);
+			}
+			if (Expected[Index].Key != Actual[Index].Key || Expected[Index].Value != Actual[Index].Value)
+			{
+				return FString::Printf(
+					TEXT("%s=%s vs %s=%s"),
+					*Expected[Index].Key,
+					*Expected[Index].Value,
+					*Actual[Index].Key,
+					*Actual[Index].Value);
+			}
+		}
+		return FString();
+	}
+
+	// Writes <BasePath>.json and <BasePath>.csv. Returns the commandlet exit code.
+	int32 WriteReports(const FBatchReport& Report, const FString& BasePath)
+	{
+		const FString JsonPath = BasePath + TEXT(".json");
+		const FString CsvPath = BasePath + TEXT(".csv");
+
+		if (!FFileHelper::SaveStringToFile(ToJson(Report), *JsonPath))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to write JSON report: %s"), *JsonPath);
+			return 3;
+		}
+
+		if (!FFileHelper::SaveStringToFile(ToCsv(Report), *CsvPath))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to write CSV report: %s"), *CsvPath);
+			return 4;
+		}
+
+		UE_LOG(LogTemp, Display, TEXT("Reports written: %s and %s"), *JsonPath, *CsvPath);
+		return 0;
+	}
+
+	// Combines reports of disjoint seed ranges of the same run into one report. Seeds that no report covers, such as
+	// a shard that stopped early or was left out, fail the merge unless bAllowPartial is set.
+	int32 MergeReports(const FString& MergeList, const FString& OutputDir, const FString& OutputPrefix, const bool bAllowPartial)
+	{
+		TArray<FString> Paths;
+		MergeList.ParseIntoArray(Paths, TEXT(","), true);
+
+		TArray<FBatchReport> Reports;
+		for (const FString& Path : Paths)
+		{
+			FString LoadError;
+			if (!LoadCsvReport(Path.TrimStartAndEnd(), Reports.AddDefaulted_GetRef(), LoadError))
+			{
+				UE_LOG(LogTemp, Error, TEXT("%s"), *LoadError);
+				return 2;
+			}
+		}
+		if (Reports.Num() == 0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Merge needs at least one CSV report."));
+			return 1;
+		}
+
+		Reports.Sort([](const FBatchReport& A, const FBatchReport& B)
+		{
+			return A.StartSeed < B.StartSeed;
+		});
+
+		FBatchReport Merged;
+		Merged.Settings = Reports[0].Settings;
+		Merged.StartSeed = Reports[0].StartSeed;
+		Merged.NextSeed = Reports[0].StartSeed;
+
+		TArray<FString> Gaps;
+		TArray<FHexWfcBatchStats> Parts;
+		for (const FBatchReport& Report : Reports)
+		{
+			const FString Difference = DiffSettings(Merged.Settings, Report.Settings);
+			if (!Difference.IsEmpty())
+			{
+				UE_LOG(LogTemp, Error, TEXT("Reports come from different runs and cannot be merged: %s."), *Difference);
+				return 2;
+			}
+			if (Report.StartSeed < Merged.NextSeed)
+			{
+				UE_LOG(LogTemp, Error, TEXT("Reports overlap at seed %d; merge each seed range once."), Report.StartSeed);
+				return 2;
+			}
+			if (Report.StartSeed > Merged.NextSeed)
+			{
+				Gaps.Add(FString::Printf(TEXT("seeds %d to %d are in none of the reports"), Merged.NextSeed, Report.StartSeed - 1));
+			}
+			if (Report.Stats.NumSeedsProcessed < Report.Stats.NumSeedsRequested)
+			{
+				Gaps.Add(FString::Printf(
+					TEXT("shard %d of %d stopped after %d of %d seeds"),
+					Report.ShardIndex,
+					Report.ShardCount,
+					Report.Stats.NumSeedsProcessed,
+					Report.Stats.NumSeedsRequested));
+			}
+
+			Merged.NextSeed = Report.NextSeed;
+			Merged.bParallel |= Report.bParallel;
+			Parts.Add(Report.Stats);
+		}
+
+		// Gaps only show between reports, so a missing first or last shard is found by its index instead.
+		TSet<int32> ShardIndices;
+		bool bSameShardCount = true;
+		for (const FBatchReport& Report : Reports)
+		{
+			ShardIndices.Add(Report.ShardIndex);
+			bSameShardCount &= Report.ShardCount == Reports[0].ShardCount;
+		}
+		for (int32 ShardIndex = 0; bSameShardCount && ShardIndex < Reports[0].ShardCount; ++ShardIndex)
+		{
+			if (!ShardIndices.Contains(ShardIndex))
+			{
+				Gaps.Add(FString::Printf(TEXT("shard %d of %d has no report"), ShardIndex, Reports[0].ShardCount));
+			}
+		}
+
+		if (Gaps.Num() > 0)
+		{
+			const FString Missing = FString::Join(Gaps, TEXT("; "));
+			if (!bAllowPartial)
+			{
+				UE_LOG(LogTemp, Error, TEXT("Reports do not cover the whole run: %s. Resume the missing shards, or pass -AllowPartialMerge."), *Missing);
+				return 2;
+			}
+			UE_LOG(LogTemp, Warning, TEXT("Merging a partial run: %s."), *Missing);
+		}
+
+		Merged.Stats = UCanalWfcBlueprintLibrary::MergeHexWfcBatchStats(Parts);
+		Merged.Stats.bBatchTimeLimitExceeded |= Gaps.Num() > 0;
+
+		IFileManager::Get().MakeDirectory(*OutputDir, true);
+		const FString Timestamp = FDateTime::UtcNow().ToString(TEXT("%Y%m%d_%H%M%S"));
+		const int32 ExitCode = WriteReports(Merged, OutputDir / FString::Printf(TEXT("%s_merged_%s"), *OutputPrefix, *Timestamp));
+		if (ExitCode == 0)
+		{
+			UE_LOG(
+				LogTemp,
+				Display,
+				TEXT("WFC batch merge complete: reports=%d solved=%d/%d seeds=%d..%d"),
+				Reports.Num(),
+				Merged.Stats.NumSolved,
+				Merged.Stats.NumSeedsProcessed,
+				Merged.StartSeed,
+				Merged.NextSeed - 1);
+		}
+		return ExitCode;
+	}
+}
+
 UCanalWfcBatchCommandlet::UCanalWfcBatchCommandlet()
 {
 	LogToConsole = true;
@@ -25,15 +545,30 @@ int32 UCanalWfcBatchCommandlet::Main(const FString& Params)
 	int32 NumSeeds = 1000;
 	int32 MaxAttempts = 8;
 	int32 MaxPropagationSteps = 100000;
+	int32 MaxBacktracks = 1000;
+	int32 SpeculativeAttempts = 1;
+	int32 ShardIndex = 0;
+	int32 ShardCount = 1;
+	int32 CheckpointEverySeeds = 1000;
 	float MaxSolveTimeSeconds = 0.0f;
+	float CarvedPathMeander = 2.0f;
 	float MaxBatchTimeSeconds = 0.0f;
 	FString OutputDir = FPaths::ProjectSavedDir() / TEXT("BatchReports");
 	FString OutputPrefix = TEXT("wfc_batch");
 	FString BiomeProfileString = TEXT("default");
+	FString PropagatorString = TEXT("Filter");
+	FString EntropyModeString = TEXT("CandidateCount");
+	FString TileSetPath;
+	FString MergeList;
 	bool bRequireEntryExitPath = true;
 	bool bRequireSingleWaterComponent = true;
 	bool bAutoSelectBoundaryPorts = true;
 	bool bDisallowUnassignedBoundaryWater = true;
+	bool bBitsetDomains = true;
+	bool bEnableBacktracking = false;
+	bool bPropagateConnectivity = false;
+	bool bCarveEntryExitPath = false;
+	bool bParallel = false;
 
 	FParse::Value(*Params, TEXT("GridWidth="), GridWidth);
 	FParse::Value(*Params, TEXT("GridHeight="), GridHeight);
@@ -41,32 +576,98 @@ int32 UCanalWfcBatchCommandlet::Main(const FString& Params)
 	FParse::Value(*Params, TEXT("NumSeeds="), NumSeeds);
 	FParse::Value(*Params, TEXT("MaxAttempts="), MaxAttempts);
 	FParse::Value(*Params, TEXT("MaxPropagationSteps="), MaxPropagationSteps);
+	FParse::Value(*Params, TEXT("MaxBacktracks="), MaxBacktracks);
+	FParse::Value(*Params, TEXT("SpeculativeAttempts="), SpeculativeAttempts);
+	FParse::Value(*Params, TEXT("ShardIndex="), ShardIndex);
+	FParse::Value(*Params, TEXT("ShardCount="), ShardCount);
+	FParse::Value(*Params, TEXT("CheckpointEverySeeds="), CheckpointEverySeeds);
+	FParse::Value(*Params, TEXT("CarvedPathMeander="), CarvedPathMeander);
 	FParse::Value(*Params, TEXT("MaxSolveTimeSeconds="), MaxSolveTimeSeconds);
 	FParse::Value(*Params, TEXT("MaxBatchTimeSeconds="), MaxBatchTimeSeconds);
 	FParse::Value(*Params, TEXT("OutputDir="), OutputDir);
 	FParse::Value(*Params, TEXT("OutputPrefix="), OutputPrefix);
 	FParse::Value(*Params, TEXT("BiomeProfile="), BiomeProfileString);
+	FParse::Value(*Params, TEXT("Propagator="), PropagatorString);
+	FParse::Value(*Params, TEXT("EntropyMode="), EntropyModeString);
+	FParse::Value(*Params, TEXT("TileSet="), TileSetPath);
+	// The list is comma-separated, which FParse::Value stops at by default.
+	FParse::Value(*Params, TEXT("Merge="), MergeList, false);
 	FParse::Bool(*Params, TEXT("RequireEntryExitPath="), bRequireEntryExitPath);
 	FParse::Bool(*Params, TEXT("RequireSingleWaterComponent="), bRequireSingleWaterComponent);
 	FParse::Bool(*Params, TEXT("AutoSelectBoundaryPorts="), bAutoSelectBoundaryPorts);
 	FParse::Bool(*Params, TEXT("DisallowUnassignedBoundaryWater="), bDisallowUnassignedBoundaryWater);
+	FParse::Bool(*Params, TEXT("BitsetDomains="), bBitsetDomains);
+	FParse::Bool(*Params, TEXT("EnableBacktracking="), bEnableBacktracking);
+	FParse::Bool(*Params, TEXT("PropagateConnectivity="), bPropagateConnectivity);
+	FParse::Bool(*Params, TEXT("CarveEntryExitPath="), bCarveEntryExitPath);
+	FParse::Bool(*Params, TEXT("Parallel="), bParallel);
+	const bool bResume = FParse::Param(*Params, TEXT("Resume"));
+	const bool bAllowPartialMerge = FParse::Param(*Params, TEXT("AllowPartialMerge"));
+
+	if (!MergeList.IsEmpty())
+	{
+		return MergeReports(MergeList, OutputDir, OutputPrefix, bAllowPartialMerge);
+	}
 
-	if (GridWidth <= 0 || GridHeight <= 0 || NumSeeds <= 0 || MaxAttempts <= 0 || MaxPropagationSteps <= 0)
+	if (GridWidth <= 0 || GridHeight <= 0 || NumSeeds <= 0 || MaxAttempts <= 0 || MaxPropagationSteps <= 0 || MaxBacktracks < 0 || SpeculativeAttempts <= 0)
 	{
-		UE_LOG(LogTemp, Error, TEXT("Invalid parameters. Require positive GridWidth/GridHeight/NumSeeds/MaxAttempts/MaxPropagationSteps."));
+		UE_LOG(LogTemp, Error, TEXT("Invalid parameters. Require positive GridWidth/GridHeight/NumSeeds/MaxAttempts/MaxPropagationSteps/SpeculativeAttempts and non-negative MaxBacktracks."));
 		return 1;
 	}
 
-	UCanalTopologyTileSetAsset* TileSetAsset = NewObject<UCanalTopologyTileSetAsset>(GetTransientPackage());
-	TileSetAsset->Tiles = FCanalPrototypeTileSet::BuildV0();
+	if (ShardCount <= 0 || ShardIndex < 0 || ShardIndex >= ShardCount || CheckpointEverySeeds < 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Invalid sharding. Require positive ShardCount, ShardIndex in [0, ShardCount) and non-negative CheckpointEverySeeds."));
+		return 1;
+	}
 
-	FString BuildError;
-	if (!TileSetAsset->BuildCompatibilityCache(BuildError))
+	EHexWfcPropagator Propagator = EHexWfcPropagator::Filter;
+	if (PropagatorString.Equals(TEXT("SupportCount"), ESearchCase::IgnoreCase))
 	{
-		UE_LOG(LogTemp, Error, TEXT("Failed to build prototype tile compatibility: %s"), *BuildError);
-		return 2;
+		Propagator = EHexWfcPropagator::SupportCount;
+	}
+	else if (!PropagatorString.Equals(TEXT("Filter"), ESearchCase::IgnoreCase))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Invalid Propagator '%s'. Expected Filter or SupportCount."), *PropagatorString);
+		return 1;
 	}
 
+	EHexWfcEntropyMode EntropyMode = EHexWfcEntropyMode::CandidateCount;
+	if (EntropyModeString.Equals(TEXT("WeightedShannon"), ESearchCase::IgnoreCase))
+	{
+		EntropyMode = EHexWfcEntropyMode::WeightedShannon;
+	}
+	else if (!EntropyModeString.Equals(TEXT("CandidateCount"), ESearchCase::IgnoreCase))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Invalid EntropyMode '%s'. Expected CandidateCount or WeightedShannon."), *EntropyModeString);
+		return 1;
+	}
+
+	// A saved tile set asset brings its compiled compatibility table; the prototype set is built in place.
+	UCanalTopologyTileSetAsset* TileSetAsset = nullptr;
+	if (!TileSetPath.IsEmpty())
+	{
+		TileSetAsset = LoadObject<UCanalTopologyTileSetAsset>(nullptr, *TileSetPath);
+		if (!TileSetAsset || !TileSetAsset->IsCompatibilityCacheBuilt())
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to load tile set '%s' with a valid compatibility table."), *TileSetPath);
+			return 2;
+		}
+	}
+	else
+	{
+		TileSetAsset = NewObject<UCanalTopologyTileSetAsset>(GetTransientPackage());
+		TileSetAsset->Tiles = FCanalPrototypeTileSet::BuildV0();
+
+		FString BuildError;
+		if (!TileSetAsset->BuildCompatibilityCache(BuildError))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to build prototype tile compatibility: %s"), *BuildError);
+			return 2;
+		}
+	}
+	const FString TileSetName = TileSetPath.IsEmpty() ? FString(TEXT("PrototypeV0")) : TileSetPath;
+
 	FHexWfcGridConfig GridConfig;
 	GridConfig.Width = GridWidth;
 	GridConfig.Height = GridHeight;
@@ -81,117 +682,152 @@ int32 UCanalWfcBatchCommandlet::Main(const FString& Params)
 	SolveConfig.bAutoSelectBoundaryPorts = bAutoSelectBoundaryPorts;
 	SolveConfig.bDisallowUnassignedBoundaryWater = bDisallowUnassignedBoundaryWater;
 	SolveConfig.BiomeProfile = FName(*BiomeProfileString);
+	SolveConfig.DomainMode = bBitsetDomains ? EHexWfcDomainMode::Bitset : EHexWfcDomainMode::CandidateList;
+	SolveConfig.Propagator = Propagator;
+	SolveConfig.EntropyMode = EntropyMode;
+	SolveConfig.bEnableBacktracking = bEnableBacktracking;
+	SolveConfig.MaxBacktracks = MaxBacktracks;
+	SolveConfig.bPropagateConnectivity = bPropagateConnectivity;
+	SolveConfig.SpeculativeAttempts = SpeculativeAttempts;
+	SolveConfig.bCarveEntryExitPath = bCarveEntryExitPath;
+	SolveConfig.CarvedPathMeander = CarvedPathMeander;
 
-	FHexWfcBatchConfig BatchConfig;
-	BatchConfig.StartSeed = StartSeed;
-	BatchConfig.NumSeeds = NumSeeds;
-	BatchConfig.MaxBatchTimeSeconds = FMath::Max(0.0f, MaxBatchTimeSeconds);
+	// Shards split the seed range into contiguous blocks, so each shard's checkpoint is a single resume point.
+	const int32 ShardFirstSeed = StartSeed + static_cast<int32>(static_cast<int64>(NumSeeds) * ShardIndex / ShardCount);
+	const int32 ShardEndSeed = StartSeed + static_cast<int32>(static_cast<int64>(NumSeeds) * (ShardIndex + 1) / ShardCount);
 
-	const FHexWfcBatchStats Stats = UCanalWfcBlueprintLibrary::RunHexWfcBatch(TileSetAsset, GridConfig, SolveConfig, BatchConfig);
+	FBatchReport Report;
+	Report.ShardIndex = ShardIndex;
+	Report.ShardCount = ShardCount;
+	Report.StartSeed = ShardFirstSeed;
+	Report.NextSeed = ShardFirstSeed;
+	Report.bParallel = bParallel;
+	Report.Stats.NumSeedsRequested = ShardEndSeed - ShardFirstSeed;
+	const auto AddSetting = [&Report](const TCHAR* Key, const FString& Value)
+	{
+		Report.Settings.Add(TPair<FString, FString>(Key, Value));
+	};
+	AddSetting(TEXT("grid_width"), FString::FromInt(GridConfig.Width));
+	AddSetting(TEXT("grid_height"), FString::FromInt(GridConfig.Height));
+	AddSetting(TEXT("tile_set"), TileSetName);
+	AddSetting(TEXT("biome_profile"), SolveConfig.BiomeProfile.ToString());
+	AddSetting(TEXT("max_attempts"), FString::FromInt(SolveConfig.MaxAttempts));
+	AddSetting(TEXT("max_propagation_steps"), FString::FromInt(SolveConfig.MaxPropagationSteps));
+	AddSetting(TEXT("max_solve_time_seconds"), FString::Printf(TEXT("%.3f"), SolveConfig.MaxSolveTimeSeconds));
+	AddSetting(TEXT("require_entry_exit_path"), BoolString(SolveConfig.bRequireEntryExitPath));
+	AddSetting(TEXT("require_single_water_component"), BoolString(SolveConfig.bRequireSingleWaterComponent));
+	AddSetting(TEXT("auto_select_boundary_ports"), BoolString(SolveConfig.bAutoSelectBoundaryPorts));
+	AddSetting(TEXT("disallow_unassigned_boundary_water"), BoolString(SolveConfig.bDisallowUnassignedBoundaryWater));
+	AddSetting(TEXT("bitset_domains"), BoolString(bBitsetDomains));
+	AddSetting(TEXT("propagator"), Propagator == EHexWfcPropagator::SupportCount ? TEXT("SupportCount") : TEXT("Filter"));
+	AddSetting(TEXT("entropy_mode"), EntropyMode == EHexWfcEntropyMode::WeightedShannon ? TEXT("WeightedShannon") : TEXT("CandidateCount"));
+	AddSetting(TEXT("enable_backtracking"), BoolString(SolveConfig.bEnableBacktracking));
+	AddSetting(TEXT("max_backtracks"), FString::FromInt(SolveConfig.MaxBacktracks));
+	AddSetting(TEXT("propagate_connectivity"), BoolString(SolveConfig.bPropagateConnectivity));
+	AddSetting(TEXT("speculative_attempts"), FString::FromInt(SolveConfig.SpeculativeAttempts));
+	AddSetting(TEXT("carve_entry_exit_path"), BoolString(SolveConfig.bCarveEntryExitPath));
+	AddSetting(TEXT("carved_path_meander"), FString::Printf(TEXT("%.3f"), SolveConfig.CarvedPathMeander));
 
 	IFileManager::Get().MakeDirectory(*OutputDir, true);
 
+	// Unsharded runs keep the plain prefix. The checkpoint name has no timestamp so a rerun finds it, and no .csv
+	// extension so scripts picking the newest report never pick it up.
+	const FString ShardPrefix = ShardCount > 1 ? FString::Printf(TEXT("%s_shard%dof%d"), *OutputPrefix, ShardIndex, ShardCount) : OutputPrefix;
+	const FString CheckpointPath = OutputDir / (ShardPrefix + TEXT(".ckpt"));
+
+	if (bResume && FPaths::FileExists(CheckpointPath))
+	{
+		FBatchReport Checkpoint;
+		FString LoadError;
+		if (!LoadCsvReport(CheckpointPath, Checkpoint, LoadError))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to load checkpoint: %s"), *LoadError);
+			return 2;
+		}
+
+		const FString Difference = DiffSettings(Report.Settings, Checkpoint.Settings);
+		if (!Difference.IsEmpty() || Checkpoint.StartSeed != ShardFirstSeed || Checkpoint.NextSeed > ShardEndSeed)
+		{
+			UE_LOG(
+				LogTemp,
+				Error,
+				TEXT("Checkpoint %s is from a different run (this run vs checkpoint: %s). Rerun without -Resume to start over."),
+				*CheckpointPath,
+				Difference.IsEmpty() ? TEXT("seed range differs") : *Difference);
+			return 2;
+		}
+
+		Report.NextSeed = Checkpoint.NextSeed;
+		Report.Stats = Checkpoint.Stats;
+		if (Report.NextSeed >= ShardEndSeed)
+		{
+			UE_LOG(LogTemp, Display, TEXT("Checkpoint %s already covers seeds %d..%d; writing its reports."), *CheckpointPath, ShardFirstSeed, ShardEndSeed - 1);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Display, TEXT("Resuming %s at seed %d of %d..%d."), *ShardPrefix, Report.NextSeed, ShardFirstSeed, ShardEndSeed - 1);
+		}
+	}
+
+	// Seeds run in chunks of CheckpointEverySeeds, each merged into the report and saved before the next starts, so
+	// a crash or time cutoff loses at most one chunk. MaxBatchTimeSeconds limits this process, not the whole run.
+	const double SessionStart = FPlatformTime::Seconds();
+	while (Report.NextSeed < ShardEndSeed)
+	{
+		FHexWfcBatchConfig BatchConfig;
+		BatchConfig.StartSeed = Report.NextSeed;
+		BatchConfig.NumSeeds = ShardEndSeed - Report.NextSeed;
+		BatchConfig.bRunInParallel = bParallel;
+		if (CheckpointEverySeeds > 0)
+		{
+			BatchConfig.NumSeeds = FMath::Min(BatchConfig.NumSeeds, CheckpointEverySeeds);
+		}
+		if (MaxBatchTimeSeconds > 0.0f)
+		{
+			BatchConfig.MaxBatchTimeSeconds = MaxBatchTimeSeconds - static_cast<float>(FPlatformTime::Seconds() - SessionStart);
+			if (BatchConfig.MaxBatchTimeSeconds <= 0.0f)
+			{
+				break;
+			}
+		}
+
+		const FHexWfcBatchStats ChunkStats = UCanalWfcBlueprintLibrary::RunHexWfcBatch(TileSetAsset, GridConfig, SolveConfig, BatchConfig);
+		Report.Stats = UCanalWfcBlueprintLibrary::MergeHexWfcBatchStats({Report.Stats, ChunkStats});
+		Report.Stats.NumSeedsRequested = ShardEndSeed - ShardFirstSeed;
+		Report.NextSeed += ChunkStats.NumSeedsProcessed;
+		Report.Stats.bBatchTimeLimitExceeded = Report.NextSeed < ShardEndSeed;
+
+		if (CheckpointEverySeeds > 0 && !FFileHelper::SaveStringToFile(ToCsv(Report), *CheckpointPath))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to write checkpoint: %s"), *CheckpointPath);
+			return 4;
+		}
+
+		if (ChunkStats.bBatchTimeLimitExceeded || ChunkStats.NumSeedsProcessed == 0)
+		{
+			break;
+		}
+	}
+	Report.Stats.bBatchTimeLimitExceeded = Report.NextSeed < ShardEndSeed;
+
 	const FString Timestamp = FDateTime::UtcNow().ToString(TEXT("%Y%m%d_%H%M%S"));
-	const FString BasePath = OutputDir / FString::Printf(TEXT("%s_%s"), *OutputPrefix, *Timestamp);
-	const FString JsonPath = BasePath + TEXT(".json");
-	const FString CsvPath = BasePath + TEXT(".csv");
-
-	FString Json;
-	Json += TEXT("{\n");
-	Json += FString::Printf(TEXT("  \"grid_width\": %d,\n"), GridConfig.Width);
-	Json += FString::Printf(TEXT("  \"grid_height\": %d,\n"), GridConfig.Height);
-	Json += FString::Printf(TEXT("  \"start_seed\": %d,\n"), BatchConfig.StartSeed);
-	Json += FString::Printf(TEXT("  \"num_seeds_requested\": %d,\n"), Stats.NumSeedsRequested);
-	Json += FString::Printf(TEXT("  \"num_seeds_processed\": %d,\n"), Stats.NumSeedsProcessed);
-	Json += FString::Printf(TEXT("  \"num_solved\": %d,\n"), Stats.NumSolved);
-	Json += FString::Printf(TEXT("  \"num_failed\": %d,\n"), Stats.NumFailed);
-	Json += FString::Printf(TEXT("  \"num_contradictions\": %d,\n"), Stats.NumContradictions);
-	Json += FString::Printf(TEXT("  \"num_time_budget_exceeded\": %d,\n"), Stats.NumTimeBudgetExceeded);
-	Json += FString::Printf(TEXT("  \"num_single_component_failures\": %d,\n"), Stats.NumSingleWaterComponentFailures);
-	Json += FString::Printf(TEXT("  \"contradiction_rate\": %.6f,\n"), Stats.ContradictionRate);
-	Json += FString::Printf(TEXT("  \"average_attempts_used\": %.6f,\n"), Stats.AverageAttemptsUsed);
-	Json += FString::Printf(TEXT("  \"average_solve_time_seconds\": %.6f,\n"), Stats.AverageSolveTimeSeconds);
-	Json += FString::Printf(TEXT("  \"elapsed_batch_time_seconds\": %.6f,\n"), Stats.ElapsedBatchTimeSeconds);
-	Json += FString::Printf(TEXT("  \"batch_time_limit_exceeded\": %s,\n"), Stats.bBatchTimeLimitExceeded ? TEXT("true") : TEXT("false"));
-	Json += FString::Printf(TEXT("  \"biome_profile\": \"%s\",\n"), *SolveConfig.BiomeProfile.ToString());
-	Json += FString::Printf(TEXT("  \"require_entry_exit_path\": %s,\n"), SolveConfig.bRequireEntryExitPath ? TEXT("true") : TEXT("false"));
-	Json += FString::Printf(TEXT("  \"require_single_water_component\": %s,\n"), SolveConfig.bRequireSingleWaterComponent ? TEXT("true") : TEXT("false"));
-	Json += FString::Printf(TEXT("  \"auto_select_boundary_ports\": %s,\n"), SolveConfig.bAutoSelectBoundaryPorts ? TEXT("true") : TEXT("false"));
-	Json += FString::Printf(TEXT("  \"disallow_unassigned_boundary_water\": %s,\n"), SolveConfig.bDisallowUnassignedBoundaryWater ? TEXT("true") : TEXT("false"));
-
-	Json += TEXT("  \"attempt_histogram\": [\n");
-	for (int32 Index = 0; Index < Stats.AttemptHistogram.Num(); ++Index)
-	{
-		const FHexWfcAttemptHistogramBin& Bin = Stats.AttemptHistogram[Index];
-		Json += FString::Printf(TEXT("    {\"attempts\": %d, \"count\": %d}%s\n"), Bin.Attempts, Bin.Count, (Index + 1 < Stats.AttemptHistogram.Num()) ? TEXT(",") : TEXT(""));
-	}
-	Json += TEXT("  ],\n");
-
-	Json += TEXT("  \"tile_histogram\": [\n");
-	for (int32 Index = 0; Index < Stats.TileHistogram.Num(); ++Index)
-	{
-		const FHexWfcTileHistogramBin& Bin = Stats.TileHistogram[Index];
-		Json += FString::Printf(
-			TEXT("    {\"tile_id\": \"%s\", \"count\": %d, \"fraction\": %.6f}%s\n"),
-			*Bin.TileId.ToString(),
-			Bin.Count,
-			Bin.Fraction,
-			(Index + 1 < Stats.TileHistogram.Num()) ? TEXT(",") : TEXT(""));
-	}
-	Json += TEXT("  ]\n");
-	Json += TEXT("}\n");
-
-	FString Csv;
-	Csv += TEXT("metric,value\n");
-	Csv += FString::Printf(TEXT("grid_width,%d\n"), GridConfig.Width);
-	Csv += FString::Printf(TEXT("grid_height,%d\n"), GridConfig.Height);
-	Csv += FString::Printf(TEXT("start_seed,%d\n"), BatchConfig.StartSeed);
-	Csv += FString::Printf(TEXT("num_seeds_requested,%d\n"), Stats.NumSeedsRequested);
-	Csv += FString::Printf(TEXT("num_seeds_processed,%d\n"), Stats.NumSeedsProcessed);
-	Csv += FString::Printf(TEXT("num_solved,%d\n"), Stats.NumSolved);
-	Csv += FString::Printf(TEXT("num_failed,%d\n"), Stats.NumFailed);
-	Csv += FString::Printf(TEXT("num_contradictions,%d\n"), Stats.NumContradictions);
-	Csv += FString::Printf(TEXT("num_time_budget_exceeded,%d\n"), Stats.NumTimeBudgetExceeded);
-	Csv += FString::Printf(TEXT("num_single_component_failures,%d\n"), Stats.NumSingleWaterComponentFailures);
-	Csv += FString::Printf(TEXT("contradiction_rate,%.6f\n"), Stats.ContradictionRate);
-	Csv += FString::Printf(TEXT("average_attempts_used,%.6f\n"), Stats.AverageAttemptsUsed);
-	Csv += FString::Printf(TEXT("average_solve_time_seconds,%.6f\n"), Stats.AverageSolveTimeSeconds);
-	Csv += FString::Printf(TEXT("elapsed_batch_time_seconds,%.6f\n"), Stats.ElapsedBatchTimeSeconds);
-	Csv += FString::Printf(TEXT("batch_time_limit_exceeded,%s\n"), Stats.bBatchTimeLimitExceeded ? TEXT("true") : TEXT("false"));
-	Csv += FString::Printf(TEXT("biome_profile,%s\n"), *SolveConfig.BiomeProfile.ToString());
-	Csv += FString::Printf(TEXT("require_entry_exit_path,%s\n"), SolveConfig.bRequireEntryExitPath ? TEXT("true") : TEXT("false"));
-	Csv += FString::Printf(TEXT("require_single_water_component,%s\n"), SolveConfig.bRequireSingleWaterComponent ? TEXT("true") : TEXT("false"));
-	Csv += FString::Printf(TEXT("auto_select_boundary_ports,%s\n"), SolveConfig.bAutoSelectBoundaryPorts ? TEXT("true") : TEXT("false"));
-	Csv += FString::Printf(TEXT("disallow_unassigned_boundary_water,%s\n"), SolveConfig.bDisallowUnassignedBoundaryWater ? TEXT("true") : TEXT("false"));
-
-	Csv += TEXT("\n");
-	Csv += TEXT("attempts,count\n");
-	for (const FHexWfcAttemptHistogramBin& Bin : Stats.AttemptHistogram)
-	{
-		Csv += FString::Printf(TEXT("%d,%d\n"), Bin.Attempts, Bin.Count);
-	}
-
-	Csv += TEXT("\n");
-	Csv += TEXT("tile_id,count,fraction\n");
-	for (const FHexWfcTileHistogramBin& Bin : Stats.TileHistogram)
-	{
-		Csv += FString::Printf(TEXT("%s,%d,%.6f\n"), *Bin.TileId.ToString(), Bin.Count, Bin.Fraction);
-	}
-
-	if (!FFileHelper::SaveStringToFile(Json, *JsonPath))
-	{
-		UE_LOG(LogTemp, Error, TEXT("Failed to write JSON report: %s"), *JsonPath);
-		return 3;
-	}
-
-	if (!FFileHelper::SaveStringToFile(Csv, *CsvPath))
-	{
-		UE_LOG(LogTemp, Error, TEXT("Failed to write CSV report: %s"), *CsvPath);
-		return 4;
-	}
-
-	UE_LOG(LogTemp, Display, TEXT("WFC batch complete: solved=%d/%d contradictions=%d"), Stats.NumSolved, Stats.NumSeedsProcessed, Stats.NumContradictions);
-	UE_LOG(LogTemp, Display, TEXT("Reports written: %s and %s"), *JsonPath, *CsvPath);
+	const int32 ExitCode = WriteReports(Report, OutputDir / FString::Printf(TEXT("%s_%s"), *ShardPrefix, *Timestamp));
+	if (ExitCode != 0)
+	{
+		return ExitCode;
+	}
+
+	UE_LOG(
+		LogTemp,
+		Display,
+		TEXT("WFC batch complete: solved=%d/%d contradictions=%d"),
+		Report.Stats.NumSolved,
+		Report.Stats.NumSeedsProcessed,
+		Report.Stats.NumContradictions);
+	if (Report.Stats.bBatchTimeLimitExceeded && CheckpointEverySeeds > 0)
+	{
+		UE_LOG(LogTemp, Display, TEXT("Stopped before seed %d; rerun with -Resume to continue from %s."), Report.NextSeed, *CheckpointPath);
+	}
 
 	return 0;
 }
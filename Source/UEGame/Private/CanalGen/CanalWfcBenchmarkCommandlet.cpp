@@ -0,0 +1,375 @@
+#include "CanalGen/CanalWfcBenchmarkCommandlet.h"
+
+#include "CanalGen/HexWfcBenchmark.h"
+#include "CanalGen/HexWfcSolver.h"
+#include "HAL/FileManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+	// "64" for a square grid or "96x64" for width x height.
+	bool ParseGridSize(const FString& Token, int32& OutWidth, int32& OutHeight)
+	{
+		FString WidthString;
+		FString HeightString;
+		if (!Token.Split(TEXT("x"), &WidthString, &HeightString))
+		{
+			WidthString = Token;
+			HeightString = Token;
+		}
+
+		OutWidth = FCString::Atoi(*WidthString);
+		OutHeight = FCString::Atoi(*HeightString);
+		return OutWidth > 0 && OutHeight > 0;
+	}
+}
+
+UCanalWfcBenchmarkCommandlet::UCanalWfcBenchmarkCommandlet()
+{
+	LogToConsole = true;
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+
+	HelpDescription = TEXT("Sweeps hex WFC solves over grid sizes, tile set scales and scenarios, and compares the results against a baseline CSV.");
+	HelpUsage = TEXT("UnrealEditor-Cmd <Project> -run=CanalWfcBenchmark [-Sizes=8,16,96x64] [-TileSetScales=1,2] [-Baseline=<csv>] [-UpdateBaseline] [-FailOnRegression]");
+	HelpParamNames = {
+		TEXT("Sizes"),
+		TEXT("TileSetScales"),
+		TEXT("Scenarios"),
+		TEXT("Propagator"),
+		TEXT("Baseline"),
+		TEXT("OutputDir"),
+		TEXT("OutputPrefix"),
+		TEXT("StartSeed"),
+		TEXT("SeedsPerCase"),
+		TEXT("Tolerance"),
+		TEXT("UpdateBaseline"),
+		TEXT("FailOnRegression"),
+		TEXT("NoScenarioLimits")};
+	HelpParamDescriptions = {
+		TEXT("Comma-separated grid sizes, N or WxH."),
+		TEXT("Comma-separated prototype tile set multipliers."),
+		TEXT("Comma-separated scenario names."),
+		TEXT("Filter or SupportCount."),
+		TEXT("Baseline CSV. Defaults to Config/Benchmarks/HexWfcBaseline.csv."),
+		TEXT("Directory for the JSON and CSV reports."),
+		TEXT("File name prefix for the reports."),
+		TEXT("First seed of every case."),
+		TEXT("Seeds solved per case."),
+		TEXT("Relative change that counts as a regression or improvement."),
+		TEXT("Write this run's results as the new baseline instead of comparing."),
+		TEXT("Exit with code 5 on any regression. The checked-in baseline holds counts only, so this gates solved/attempt/propagation-step counts, not timings or memory, until a baseline with timings is recorded on the reference host."),
+		TEXT("Run sizes above each scenario's cell limit.")};
+}
+
+int32 UCanalWfcBenchmarkCommandlet::Main(const FString& Params)
+{
+	FString SizesString = TEXT("8,16,32,64,128,256");
+	FString TileSetScalesString = TEXT("1,2");
+	FString ScenariosString = FString::Join(FHexWfcBenchmark::GetScenarioNames(), TEXT(","));
+	FString PropagatorString = TEXT("SupportCount");
+	FString BaselinePath = FPaths::ProjectConfigDir() / TEXT("Benchmarks/HexWfcBaseline.csv");
+	FString OutputDir = FPaths::ProjectSavedDir() / TEXT("BenchmarkReports");
+	FString OutputPrefix = TEXT("wfc_benchmark");
+	int32 StartSeed = 1;
+	int32 SeedsPerCase = 4;
+	float Tolerance = 0.15f;
+	bool bUpdateBaseline = false;
+	bool bFailOnRegression = false;
+	bool bNoScenarioLimits = false;
+
+	// List values contain commas, which FParse::Value stops at by default.
+	FParse::Value(*Params, TEXT("Sizes="), SizesString, false);
+	FParse::Value(*Params, TEXT("TileSetScales="), TileSetScalesString, false);
+	FParse::Value(*Params, TEXT("Scenarios="), ScenariosString, false);
+	FParse::Value(*Params, TEXT("Propagator="), PropagatorString);
+	const bool bExplicitBaseline = FParse::Value(*Params, TEXT("Baseline="), BaselinePath);
+	FParse::Value(*Params, TEXT("OutputDir="), OutputDir);
+	FParse::Value(*Params, TEXT("OutputPrefix="), OutputPrefix);
+	FParse::Value(*Params, TEXT("StartSeed="), StartSeed);
+	FParse::Value(*Params, TEXT("SeedsPerCase="), SeedsPerCase);
+	FParse::Value(*Params, TEXT("Tolerance="), Tolerance);
+	bUpdateBaseline = FParse::Param(*Params, TEXT("UpdateBaseline"));
+	bFailOnRegression = FParse::Param(*Params, TEXT("FailOnRegression"));
+	bNoScenarioLimits = FParse::Param(*Params, TEXT("NoScenarioLimits"));
+
+	TArray<FString> SizeTokens;
+	TArray<FString> ScaleTokens;
+	TArray<FString> Scenarios;
+	SizesString.ParseIntoArray(SizeTokens, TEXT(","), true);
+	TileSetScalesString.ParseIntoArray(ScaleTokens, TEXT(","), true);
+	ScenariosString.ParseIntoArray(Scenarios, TEXT(","), true);
+
+	TArray<FIntPoint> Sizes;
+	for (const FString& Token : SizeTokens)
+	{
+		int32 Width = 0;
+		int32 Height = 0;
+		if (!ParseGridSize(Token, Width, Height))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Invalid grid size '%s' in Sizes. Expected N or WxH with positive values."), *Token);
+			return 1;
+		}
+		Sizes.Add(FIntPoint(Width, Height));
+	}
+
+	TArray<int32> TileSetScales;
+	for (const FString& Token : ScaleTokens)
+	{
+		const int32 Scale = FCString::Atoi(*Token);
+		if (Scale <= 0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Invalid tile set scale '%s'. Expected a positive integer."), *Token);
+			return 1;
+		}
+		TileSetScales.Add(Scale);
+	}
+
+	for (const FString& Scenario : Scenarios)
+	{
+		if (!FHexWfcBenchmark::GetScenarioNames().Contains(Scenario))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Unknown scenario '%s'. Expected any of: %s."), *Scenario, *FString::Join(FHexWfcBenchmark::GetScenarioNames(), TEXT(", ")));
+			return 1;
+		}
+	}
+
+	if (Sizes.Num() == 0 || TileSetScales.Num() == 0 || Scenarios.Num() == 0 || SeedsPerCase <= 0 || Tolerance < 0.0f)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Invalid parameters. Require non-empty Sizes/TileSetScales/Scenarios, positive SeedsPerCase and non-negative Tolerance."));
+		return 1;
+	}
+
+	EHexWfcPropagator Propagator = EHexWfcPropagator::SupportCount;
+	if (PropagatorString.Equals(TEXT("Filter"), ESearchCase::IgnoreCase))
+	{
+		Propagator = EHexWfcPropagator::Filter;
+	}
+	else if (!PropagatorString.Equals(TEXT("SupportCount"), ESearchCase::IgnoreCase))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Invalid Propagator '%s'. Expected Filter or SupportCount."), *PropagatorString);
+		return 1;
+	}
+
+	// Without -UpdateBaseline a missing default baseline only means every case is new; a missing explicit one is an
+	// error, since the caller expected a comparison.
+	TMap<FString, FHexWfcBenchmarkResult> BaselineByCase;
+	int32 NumBaselineTimedCases = 0;
+	if (!bUpdateBaseline && FPaths::FileExists(BaselinePath))
+	{
+		FString BaselineCsv;
+		TArray<FHexWfcBenchmarkResult> BaselineResults;
+		FString ParseError;
+		if (!FFileHelper::LoadFileToString(BaselineCsv, *BaselinePath) || !FHexWfcBenchmark::ParseCsv(BaselineCsv, BaselineResults, ParseError))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to read benchmark baseline '%s': %s"), *BaselinePath, *ParseError);
+			return 2;
+		}
+		for (const FHexWfcBenchmarkResult& Baseline : BaselineResults)
+		{
+			BaselineByCase.Add(Baseline.CaseId, Baseline);
+			NumBaselineTimedCases += FHexWfcBenchmark::HasMachineMetrics(Baseline) ? 1 : 0;
+		}
+	}
+	else if (!bUpdateBaseline && bExplicitBaseline)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Benchmark baseline '%s' does not exist."), *BaselinePath);
+		return 2;
+	}
+
+	// A counts-only baseline cannot catch a throughput or memory regression, which is easy to miss when the gate
+	// still passes.
+	const bool bCountsOnlyBaseline = BaselineByCase.Num() > 0 && NumBaselineTimedCases == 0;
+	if (bFailOnRegression && bCountsOnlyBaseline)
+	{
+		UE_LOG(
+			LogTemp,
+			Warning,
+			TEXT("Benchmark baseline '%s' has no timing or memory columns. -FailOnRegression only gates solved/attempt/propagation-step counts; record timings with -UpdateBaseline on the reference host."),
+			*BaselinePath);
+	}
+
+	TArray<FHexWfcBenchmarkResult> Results;
+	TArray<FHexWfcBenchmarkComparison> Comparisons;
+	int32 NumSkipped = 0;
+	const double SweepStartTime = FPlatformTime::Seconds();
+	for (const int32 Scale : TileSetScales)
+	{
+		FCanalTileCompatibilityTable Compatibility;
+		FString BuildError;
+		if (!Compatibility.Build(FHexWfcBenchmark::BuildScaledPrototypeTileSet(Scale), &BuildError))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to build compatibility for tile set scale %d: %s"), Scale, *BuildError);
+			return 2;
+		}
+
+		for (const FString& Scenario : Scenarios)
+		{
+			for (const FIntPoint& Size : Sizes)
+			{
+				if (!bNoScenarioLimits && static_cast<int64>(Size.X) * Size.Y > FHexWfcBenchmark::GetScenarioMaxCells(Scenario))
+				{
+					++NumSkipped;
+					continue;
+				}
+
+				FHexWfcBenchmarkCase Case;
+				Case.Scenario = Scenario;
+				Case.GridWidth = Size.X;
+				Case.GridHeight = Size.Y;
+				Case.TileSetScale = Scale;
+
+				FHexWfcGridConfig Grid;
+				Grid.Width = Size.X;
+				Grid.Height = Size.Y;
+
+				FHexWfcSolveConfig Config;
+				FString ConfigError;
+				if (!FHexWfcBenchmark::MakeScenarioConfig(Scenario, Grid, Config, ConfigError))
+				{
+					UE_LOG(LogTemp, Error, TEXT("%s"), *ConfigError);
+					return 1;
+				}
+				Config.Propagator = Propagator;
+
+				const FHexWfcBenchmarkResult& Result = Results.Add_GetRef(FHexWfcBenchmark::RunCase(Compatibility, Case, Config, StartSeed, SeedsPerCase));
+				const FHexWfcBenchmarkResult* Baseline = BaselineByCase.Find(Result.CaseId);
+				const FHexWfcBenchmarkComparison& Comparison = Comparisons.Add_GetRef(
+					Baseline ? FHexWfcBenchmark::Compare(*Baseline, Result, Tolerance) : FHexWfcBenchmarkComparison());
+
+				UE_LOG(
+					LogTemp,
+					Display,
+					TEXT("%s: solved=%d/%d solves/s=%.2f ns/step=%.1f [%s]"),
+					*Result.CaseId,
+					Result.NumSolved,
+					Result.NumSeeds,
+					Result.SolvesPerSecond,
+					Result.NanosecondsPerPropagationStep,
+					FHexWfcBenchmark::LexVerdict(Comparison.Verdict));
+				for (const FString& Change : Comparison.Changes)
+				{
+					UE_LOG(LogTemp, Display, TEXT("  %s"), *Change);
+				}
+			}
+		}
+	}
+	const double SweepSeconds = FPlatformTime::Seconds() - SweepStartTime;
+
+	int32 NumRegressed = 0;
+	int32 NumImproved = 0;
+	int32 NumNew = 0;
+	for (const FHexWfcBenchmarkComparison& Comparison : Comparisons)
+	{
+		NumRegressed += Comparison.Verdict == EHexWfcBenchmarkVerdict::Regressed ? 1 : 0;
+		NumImproved += Comparison.Verdict == EHexWfcBenchmarkVerdict::Improved ? 1 : 0;
+		NumNew += Comparison.Verdict == EHexWfcBenchmarkVerdict::New ? 1 : 0;
+	}
+
+	IFileManager::Get().MakeDirectory(*OutputDir, true);
+
+	const FString Timestamp = FDateTime::UtcNow().ToString(TEXT("%Y%m%d_%H%M%S"));
+	const FString BasePath = OutputDir / FString::Printf(TEXT("%s_%s"), *OutputPrefix, *Timestamp);
+	const FString JsonPath = BasePath + TEXT(".json");
+	const FString CsvPath = BasePath + TEXT(".csv");
+
+	FString Json;
+	Json += TEXT("{\n");
+	Json += FString::Printf(TEXT("  \"start_seed\": %d,\n"), StartSeed);
+	Json += FString::Printf(TEXT("  \"seeds_per_case\": %d,\n"), SeedsPerCase);
+	Json += FString::Printf(TEXT("  \"propagator\": \"%s\",\n"), Propagator == EHexWfcPropagator::SupportCount ? TEXT("SupportCount") : TEXT("Filter"));
+	Json += FString::Printf(TEXT("  \"baseline\": \"%s\",\n"), BaselineByCase.Num() > 0 ? *BaselinePath : TEXT(""));
+	Json += FString::Printf(TEXT("  \"baseline_has_timings\": %s,\n"), NumBaselineTimedCases > 0 ? TEXT("true") : TEXT("false"));
+	Json += FString::Printf(TEXT("  \"tolerance\": %.3f,\n"), Tolerance);
+	Json += FString::Printf(TEXT("  \"num_cases\": %d,\n"), Results.Num());
+	Json += FString::Printf(TEXT("  \"num_skipped\": %d,\n"), NumSkipped);
+	Json += FString::Printf(TEXT("  \"num_regressed\": %d,\n"), NumRegressed);
+	Json += FString::Printf(TEXT("  \"num_improved\": %d,\n"), NumImproved);
+	Json += FString::Printf(TEXT("  \"num_new\": %d,\n"), NumNew);
+	Json += FString::Printf(TEXT("  \"elapsed_sweep_time_seconds\": %.6f,\n"), SweepSeconds);
+	Json += TEXT("  \"cases\": [\n");
+	for (int32 Index = 0; Index < Results.Num(); ++Index)
+	{
+		const FHexWfcBenchmarkResult& Result = Results[Index];
+		const FHexWfcBenchmarkComparison& Comparison = Comparisons[Index];
+
+		TArray<FString> QuotedChanges;
+		for (const FString& Change : Comparison.Changes)
+		{
+			QuotedChanges.Add(FString::Printf(TEXT("\"%s\""), *Change));
+		}
+
+		Json += TEXT("    {");
+		Json += FString::Printf(TEXT("\"case_id\": \"%s\", \"scenario\": \"%s\", "), *Result.CaseId, *Result.Scenario);
+		Json += FString::Printf(TEXT("\"grid_width\": %d, \"grid_height\": %d, "), Result.GridWidth, Result.GridHeight);
+		Json += FString::Printf(TEXT("\"tile_set_scale\": %d, \"num_variants\": %d, "), Result.TileSetScale, Result.NumVariants);
+		Json += FString::Printf(TEXT("\"num_seeds\": %d, \"num_solved\": %d, "), Result.NumSeeds, Result.NumSolved);
+		Json += FString::Printf(TEXT("\"average_attempts\": %.6f, "), Result.AverageAttempts);
+		Json += FString::Printf(TEXT("\"average_propagation_steps\": %.6f, "), Result.AveragePropagationSteps);
+		Json += FString::Printf(TEXT("\"solves_per_second\": %.6f, "), Result.SolvesPerSecond);
+		Json += FString::Printf(TEXT("\"average_solve_ms\": %.6f, "), Result.AverageSolveMilliseconds);
+		Json += FString::Printf(TEXT("\"ns_per_propagation_step\": %.6f, "), Result.NanosecondsPerPropagationStep);
+		Json += FString::Printf(TEXT("\"peak_domain_bytes\": %lld, "), Result.PeakDomainBytes);
+		Json += FString::Printf(TEXT("\"workspace_bytes\": %lld, "), Result.WorkspaceBytes);
+		Json += FString::Printf(TEXT("\"workspace_growth_bytes\": %lld, "), Result.WorkspaceGrowthBytes);
+		Json += FString::Printf(TEXT("\"verdict\": \"%s\", "), FHexWfcBenchmark::LexVerdict(Comparison.Verdict));
+		Json += FString::Printf(TEXT("\"changes\": [%s]"), *FString::Join(QuotedChanges, TEXT(", ")));
+		Json += FString::Printf(TEXT("}%s\n"), (Index + 1 < Results.Num()) ? TEXT(",") : TEXT(""));
+	}
+	Json += TEXT("  ]\n");
+	Json += TEXT("}\n");
+
+	// The CSV report is also the baseline format; ParseCsv ignores the extra verdict column.
+	FString Csv = FHexWfcBenchmark::GetCsvHeader() + TEXT(",verdict\n");
+	FString BaselineCsv = FHexWfcBenchmark::GetCsvHeader() + TEXT("\n");
+	for (int32 Index = 0; Index < Results.Num(); ++Index)
+	{
+		const FString Row = FHexWfcBenchmark::ToCsvRow(Results[Index]);
+		Csv += FString::Printf(TEXT("%s,%s\n"), *Row, FHexWfcBenchmark::LexVerdict(Comparisons[Index].Verdict));
+		BaselineCsv += Row + TEXT("\n");
+	}
+
+	if (!FFileHelper::SaveStringToFile(Json, *JsonPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to write JSON report: %s"), *JsonPath);
+		return 3;
+	}
+
+	if (!FFileHelper::SaveStringToFile(Csv, *CsvPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to write CSV report: %s"), *CsvPath);
+		return 4;
+	}
+
+	if (bUpdateBaseline)
+	{
+		IFileManager::Get().MakeDirectory(*FPaths::GetPath(BaselinePath), true);
+		if (!FFileHelper::SaveStringToFile(BaselineCsv, *BaselinePath))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to write benchmark baseline: %s"), *BaselinePath);
+			return 4;
+		}
+		UE_LOG(LogTemp, Display, TEXT("Baseline updated: %s"), *BaselinePath);
+	}
+
+	UE_LOG(
+		LogTemp,
+		Display,
+		TEXT("WFC benchmark complete: cases=%d skipped=%d regressed=%d improved=%d new=%d"),
+		Results.Num(),
+		NumSkipped,
+		NumRegressed,
+		NumImproved,
+		NumNew);
+	UE_LOG(LogTemp, Display, TEXT("Reports written: %s and %s"), *JsonPath, *CsvPath);
+	if (bFailOnRegression && bCountsOnlyBaseline)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Regression gate covered counts only: baseline '%s' has no timing or memory columns."), *BaselinePath);
+	}
+
+	return bFailOnRegression && NumRegressed > 0 ? 5 : 0;
+}
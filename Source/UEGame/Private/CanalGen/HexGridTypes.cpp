@@ -53,3 +53,28 @@ FVector FHexGridLayout::AxialToWorld(const FHexAxialCoord& Coord, const float Z)
 	const float Y = HexSize * 1.5f * static_cast<float>(Coord.R);
 	return FVector(X, Y, Z);
 }
+
+FHexAxialCoord FHexGridLayout::WorldToAxial(const FVector& Position) const
+{
+	const float FracR = static_cast<float>(Position.Y) / (HexSize * 1.5f);
+	const float FracQ = static_cast<float>(Position.X) / (HexSize * FMath::Sqrt(3.0f)) - FracR * 0.5f;
+	const float FracS = -FracQ - FracR;
+
+	// Cube rounding: round all three coordinates, then fix the one with the largest rounding error.
+	int32 Q = FMath::RoundToInt(FracQ);
+	int32 R = FMath::RoundToInt(FracR);
+	const int32 S = FMath::RoundToInt(FracS);
+	const float ErrorQ = FMath::Abs(static_cast<float>(Q) - FracQ);
+	const float ErrorR = FMath::Abs(static_cast<float>(R) - FracR);
+	const float ErrorS = FMath::Abs(static_cast<float>(S) - FracS);
+	if (ErrorQ > ErrorR && ErrorQ > ErrorS)
+	{
+		Q = -R - S;
+	}
+	else if (ErrorR > ErrorS)
+	{
+		R = -Q - S;
+	}
+
+	return FHexAxialCoord(Q, R);
+}
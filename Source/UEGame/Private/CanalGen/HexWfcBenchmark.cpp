@@ -0,0 +1,418 @@
+#include "CanalGen/HexWfcBenchmark.h"
+
+#include "CanalGen/CanalPrototypeTileSet.h"
+
+namespace
+{
+	const TCHAR* const CsvColumns[] =
+	{
+		TEXT("case_id"),
+		TEXT("scenario"),
+		TEXT("grid_width"),
+		TEXT("grid_height"),
+		TEXT("tile_set_scale"),
+		TEXT("num_variants"),
+		TEXT("start_seed"),
+		TEXT("num_seeds"),
+		TEXT("num_solved"),
+		TEXT("average_attempts"),
+		TEXT("average_propagation_steps"),
+		TEXT("solves_per_second"),
+		TEXT("average_solve_ms"),
+		TEXT("ns_per_propagation_step"),
+		TEXT("peak_domain_bytes"),
+		TEXT("workspace_bytes"),
+		TEXT("workspace_growth_bytes")
+	};
+
+	// Unrecorded values stay empty so a baseline can carry only the columns that transfer between machines.
+	FString FormatDouble(const double Value)
+	{
+		return Value < 0.0 ? FString() : FString::Printf(TEXT("%.6f"), Value);
+	}
+
+	FString FormatInt64(const int64 Value)
+	{
+		return Value < 0 ? FString() : FString::Printf(TEXT("%lld"), Value);
+	}
+
+	struct FBenchmarkMetric
+	{
+		const TCHAR* Name;
+		double Baseline;
+		double Current;
+		bool bHigherIsBetter;
+
+		// Counts that only depend on the seeds and tile set, compared only between runs of the same seeds.
+		bool bDeterministic;
+	};
+}
+
+FString FHexWfcBenchmarkCase::GetCaseId() const
+{
+	return FString::Printf(TEXT("%s_%dx%d_t%d"), *Scenario, GridWidth, GridHeight, TileSetScale);
+}
+
+const TArray<FString>& FHexWfcBenchmark::GetScenarioNames()
+{
+	static const TArray<FString> Names =
+	{
+		TEXT("relaxed"),
+		TEXT("strict"),
+		TEXT("connectivity"),
+		TEXT("carve")
+	};
+	return Names;
+}
+
+int32 FHexWfcBenchmark::GetScenarioMaxCells(const FString& Scenario)
+{
+	// Connectivity propagation re-checks water reachability across the grid after every collapse, so a solve grows
+	// with the square of the cell count: 128x128 already takes seconds per seed.
+	return Scenario == TEXT("connectivity") ? 64 * 64 : MAX_int32;
+}
+
+bool FHexWfcBenchmark::MakeScenarioConfig(const FString& Scenario, const FHexWfcGridConfig& Grid, FHexWfcSolveConfig& OutConfig, FString& OutError)
+{
+	FHexWfcSolveConfig Config;
+	Config.MaxAttempts = 8;
+	// Step budgets are sized for gameplay grids; the sweep should measure large grids rather than fail them.
+	Config.MaxPropagationSteps = MAX_int32;
+	Config.DomainMode = EHexWfcDomainMode::Bitset;
+	Config.Propagator = EHexWfcPropagator::SupportCount;
+
+	if (Scenario == TEXT("relaxed"))
+	{
+		Config.bRequireEntryExitPath = false;
+		Config.bRequireSingleWaterComponent = false;
+		Config.bAutoSelectBoundaryPorts = false;
+		Config.bDisallowUnassignedBoundaryWater = false;
+	}
+	else if (Scenario == TEXT("strict"))
+	{
+		// Solver-chosen ports with a required water path. The single-component and boundary-water rules are left
+		// off: with them the prototype set fails most seeds at every size, and the sweep would only time restarts.
+		Config.bRequireEntryExitPath = true;
+		Config.bRequireSingleWaterComponent = false;
+		Config.bAutoSelectBoundaryPorts = true;
+		Config.bDisallowUnassignedBoundaryWater = false;
+	}
+	else if (Scenario == TEXT("connectivity") || Scenario == TEXT("carve"))
+	{
+		Config.bRequireEntryExitPath = true;
+		Config.bAutoSelectBoundaryPorts = false;
+		Config.bDisallowUnassignedBoundaryWater = false;
+		Config.bEnableBacktracking = true;
+		Config.EntryPort.bEnabled = true;
+		Config.EntryPort.Coord = FHexAxialCoord(0, Grid.Height / 2);
+		Config.EntryPort.Direction = EHexDirection::West;
+		Config.ExitPort.bEnabled = true;
+		Config.ExitPort.Coord = FHexAxialCoord(Grid.Width - 1, Grid.Height / 2);
+		Config.ExitPort.Direction = EHexDirection::East;
+
+		if (Scenario == TEXT("connectivity"))
+		{
+			Config.bRequireSingleWaterComponent = true;
+			Config.bPropagateConnectivity = true;
+		}
+		else
+		{
+			Config.bRequireSingleWaterComponent = false;
+			Config.bCarveEntryExitPath = true;
+		}
+	}
+	else
+	{
+		OutError = FString::Printf(TEXT("Unknown benchmark scenario '%s'. Expected one of: %s."), *Scenario, *FString::Join(GetScenarioNames(), TEXT(", ")));
+		return false;
+	}
+
+	OutConfig = Config;
+	return true;
+}
+
+TArray<FCanalTopologyTileDefinition> FHexWfcBenchmark::BuildScaledPrototypeTileSet(const int32 Scale)
+{
+	const TArray<FCanalTopologyTileDefinition> Prototype = FCanalPrototypeTileSet::BuildV0();
+	if (Scale <= 1)
+	{
+		return Prototype;
+	}
+
+	TArray<FCanalTopologyTileDefinition> Tiles;
+	Tiles.Reserve(Prototype.Num() * Scale);
+	Tiles.Append(Prototype);
+	for (int32 Copy = 2; Copy <= Scale; ++Copy)
+	{
+		for (const FCanalTopologyTileDefinition& Tile : Prototype)
+		{
+			FCanalTopologyTileDefinition& Duplicate = Tiles.Add_GetRef(Tile);
+			Duplicate.TileId = FName(*FString::Printf(TEXT("%s_x%d"), *Tile.TileId.ToString(), Copy));
+		}
+	}
+	return Tiles;
+}
+
+FHexWfcBenchmarkResult FHexWfcBenchmark::RunCase(
+	const FCanalTileCompatibilityTable& Compatibility,
+	const FHexWfcBenchmarkCase& Case,
+	const FHexWfcSolveConfig& Config,
+	const int32 StartSeed,
+	const int32 NumSeeds)
+{
+	FHexWfcBenchmarkResult Result;
+	Result.CaseId = Case.GetCaseId();
+	Result.Scenario = Case.Scenario;
+	Result.GridWidth = Case.GridWidth;
+	Result.GridHeight = Case.GridHeight;
+	Result.TileSetScale = Case.TileSetScale;
+	Result.NumVariants = Compatibility.GetNumVariants();
+	Result.StartSeed = StartSeed;
+	Result.NumSeeds = FMath::Max(0, NumSeeds);
+	if (Result.NumSeeds == 0)
+	{
+		return Result;
+	}
+
+	FHexWfcGridConfig Grid;
+	Grid.Width = Case.GridWidth;
+	Grid.Height = Case.GridHeight;
+
+	const FHexWfcSolver Solver(Compatibility);
+	FHexWfcSolverWorkspace Workspace;
+	FHexWfcSolveConfig SeedConfig = Config;
+
+	// The warm-up sizes the workspace, so the timed loop measures the steady state that batch runs and the generator
+	// actor see.
+	SeedConfig.Seed = StartSeed;
+	Solver.Solve(Grid, SeedConfig, Workspace);
+	Result.WorkspaceBytes = static_cast<int64>(Workspace.GetAllocatedSize());
+
+	int64 TotalAttempts = 0;
+	FHexWfcSolveProfile TotalProfile;
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 Offset = 0; Offset < Result.NumSeeds; ++Offset)
+	{
+		SeedConfig.Seed = StartSeed + Offset;
+		const FHexWfcSolveResult SolveResult = Solver.Solve(Grid, SeedConfig, Workspace);
+		Result.NumSolved += SolveResult.bSolved ? 1 : 0;
+		TotalAttempts += SolveResult.AttemptsUsed;
+		TotalProfile.Accumulate(SolveResult.Profile);
+	}
+	const double ElapsedSeconds = FPlatformTime::Seconds() - StartTime;
+
+	Result.AverageAttempts = static_cast<double>(TotalAttempts) / Result.NumSeeds;
+	Result.AveragePropagationSteps = static_cast<double>(TotalProfile.PropagationSteps) / Result.NumSeeds;
+	Result.AverageSolveMilliseconds = ElapsedSeconds * 1000.0 / Result.NumSeeds;
+	if (ElapsedSeconds > 0.0)
+	{
+		Result.SolvesPerSecond = Result.NumSeeds / ElapsedSeconds;
+	}
+	if (TotalProfile.PropagationSteps > 0)
+	{
+		Result.NanosecondsPerPropagationStep = static_cast<double>(TotalProfile.PropagateSeconds) * 1.0e9 / static_cast<double>(TotalProfile.PropagationSteps);
+	}
+	Result.PeakDomainBytes = TotalProfile.PeakDomainBytes;
+	Result.WorkspaceGrowthBytes = static_cast<int64>(Workspace.GetAllocatedSize()) - Result.WorkspaceBytes;
+	return Result;
+}
+
+FString FHexWfcBenchmark::GetCsvHeader()
+{
+	TArray<FString> Columns;
+	for (const TCHAR* Column : CsvColumns)
+	{
+		Columns.Add(Column);
+	}
+	return FString::Join(Columns, TEXT(","));
+}
+
+FString FHexWfcBenchmark::ToCsvRow(const FHexWfcBenchmarkResult& Result)
+{
+	const TArray<FString> Fields =
+	{
+		Result.CaseId,
+		Result.Scenario,
+		FString::FromInt(Result.GridWidth),
+		FString::FromInt(Result.GridHeight),
+		FString::FromInt(Result.TileSetScale),
+		FString::FromInt(Result.NumVariants),
+		FString::FromInt(Result.StartSeed),
+		FString::FromInt(Result.NumSeeds),
+		FString::FromInt(Result.NumSolved),
+		FormatDouble(Result.AverageAttempts),
+		FormatDouble(Result.AveragePropagationSteps),
+		FormatDouble(Result.SolvesPerSecond),
+		FormatDouble(Result.AverageSolveMilliseconds),
+		FormatDouble(Result.NanosecondsPerPropagationStep),
+		FormatInt64(Result.PeakDomainBytes),
+		FormatInt64(Result.WorkspaceBytes),
+		FormatInt64(Result.WorkspaceGrowthBytes)
+	};
+	return FString::Join(Fields, TEXT(","));
+}
+
+bool FHexWfcBenchmark::ParseCsv(const FString& Csv, TArray<FHexWfcBenchmarkResult>& OutResults, FString& OutError)
+{
+	OutResults.Reset();
+
+	TArray<FString> Lines;
+	Csv.ParseIntoArrayLines(Lines, true);
+	if (Lines.Num() == 0)
+	{
+		OutError = TEXT("Benchmark CSV is empty.");
+		return false;
+	}
+
+	TArray<FString> Header;
+	Lines[0].TrimStartAndEnd().ParseIntoArray(Header, TEXT(","), false);
+	const int32 CaseIdColumn = Header.IndexOfByKey(TEXT("case_id"));
+	if (CaseIdColumn == INDEX_NONE)
+	{
+		OutError = TEXT("Benchmark CSV has no case_id column.");
+		return false;
+	}
+
+	for (int32 LineIndex = 1; LineIndex < Lines.Num(); ++LineIndex)
+	{
+		const FString Line = Lines[LineIndex].TrimStartAndEnd();
+		if (Line.IsEmpty() || Line.StartsWith(TEXT("#")))
+		{
+			continue;
+		}
+
+		TArray<FString> Fields;
+		Line.ParseIntoArray(Fields, TEXT(","), false);
+		if (Fields.Num() != Header.Num())
+		{
+			OutError = FString::Printf(TEXT("Benchmark CSV line %d has %d fields, expected %d."), LineIndex + 1, Fields.Num(), Header.Num());
+			return false;
+		}
+
+		const auto FindField = [&Header, &Fields](const TCHAR* Column) -> const FString*
+		{
+			const int32 ColumnIndex = Header.IndexOfByKey(Column);
+			return ColumnIndex != INDEX_NONE && !Fields[ColumnIndex].IsEmpty() ? &Fields[ColumnIndex] : nullptr;
+		};
+		const auto ReadInt32 = [&FindField](const TCHAR* Column, int32& OutValue)
+		{
+			if (const FString* Field = FindField(Column))
+			{
+				OutValue = FCString::Atoi(**Field);
+			}
+		};
+		const auto ReadInt64 = [&FindField](const TCHAR* Column, int64& OutValue)
+		{
+			if (const FString* Field = FindField(Column))
+			{
+				OutValue = FCString::Atoi64(**Field);
+			}
+		};
+		const auto ReadDouble = [&FindField](const TCHAR* Column, double& OutValue)
+		{
+			if (const FString* Field = FindField(Column))
+			{
+				OutValue = FCString::Atod(**Field);
+			}
+		};
+
+		FHexWfcBenchmarkResult& Result = OutResults.AddDefaulted_GetRef();
+		Result.CaseId = Fields[CaseIdColumn];
+		if (const FString* Scenario = FindField(TEXT("scenario")))
+		{
+			Result.Scenario = *Scenario;
+		}
+		ReadInt32(TEXT("grid_width"), Result.GridWidth);
+		ReadInt32(TEXT("grid_height"), Result.GridHeight);
+		ReadInt32(TEXT("tile_set_scale"), Result.TileSetScale);
+		ReadInt32(TEXT("num_variants"), Result.NumVariants);
+		ReadInt32(TEXT("start_seed"), Result.StartSeed);
+		ReadInt32(TEXT("num_seeds"), Result.NumSeeds);
+		ReadInt32(TEXT("num_solved"), Result.NumSolved);
+		ReadDouble(TEXT("average_attempts"), Result.AverageAttempts);
+		ReadDouble(TEXT("average_propagation_steps"), Result.AveragePropagationSteps);
+		ReadDouble(TEXT("solves_per_second"), Result.SolvesPerSecond);
+		ReadDouble(TEXT("average_solve_ms"), Result.AverageSolveMilliseconds);
+		ReadDouble(TEXT("ns_per_propagation_step"), Result.NanosecondsPerPropagationStep);
+		ReadInt64(TEXT("peak_domain_bytes"), Result.PeakDomainBytes);
+		ReadInt64(TEXT("workspace_bytes"), Result.WorkspaceBytes);
+		ReadInt64(TEXT("workspace_growth_bytes"), Result.WorkspaceGrowthBytes);
+	}
+
+	return true;
+}
+
+FHexWfcBenchmarkComparison FHexWfcBenchmark::Compare(const FHexWfcBenchmarkResult& Baseline, const FHexWfcBenchmarkResult& Current, const float Tolerance)
+{
+	const bool bSameWork = Baseline.StartSeed == Current.StartSeed && Baseline.NumSeeds == Current.NumSeeds && Baseline.NumVariants == Current.NumVariants;
+	const FBenchmarkMetric Metrics[] =
+	{
+		{TEXT("num_solved"), static_cast<double>(Baseline.NumSolved), static_cast<double>(Current.NumSolved), true, true},
+		{TEXT("average_attempts"), Baseline.AverageAttempts, Current.AverageAttempts, false, true},
+		{TEXT("average_propagation_steps"), Baseline.AveragePropagationSteps, Current.AveragePropagationSteps, false, true},
+		{TEXT("solves_per_second"), Baseline.SolvesPerSecond, Current.SolvesPerSecond, true, false},
+		{TEXT("ns_per_propagation_step"), Baseline.NanosecondsPerPropagationStep, Current.NanosecondsPerPropagationStep, false, false},
+		{TEXT("peak_domain_bytes"), static_cast<double>(Baseline.PeakDomainBytes), static_cast<double>(Current.PeakDomainBytes), false, false},
+		{TEXT("workspace_bytes"), static_cast<double>(Baseline.WorkspaceBytes), static_cast<double>(Current.WorkspaceBytes), false, false},
+		{TEXT("workspace_growth_bytes"), static_cast<double>(Baseline.WorkspaceGrowthBytes), static_cast<double>(Current.WorkspaceGrowthBytes), false, false}
+	};
+
+	bool bAnyRegression = false;
+	bool bAnyImprovement = false;
+	FHexWfcBenchmarkComparison Comparison;
+	for (const FBenchmarkMetric& Metric : Metrics)
+	{
+		if (Metric.Baseline < 0.0 || Metric.Current < 0.0 || (Metric.bDeterministic && !bSameWork) || Metric.Baseline == Metric.Current)
+		{
+			continue;
+		}
+
+		// Relative to the baseline; from a zero baseline any change counts as a full step.
+		const double Change = Metric.Baseline > 0.0 ? (Metric.Current - Metric.Baseline) / Metric.Baseline : (Metric.Current > 0.0 ? 1.0 : -1.0);
+		if (FMath::Abs(Change) <= Tolerance)
+		{
+			continue;
+		}
+
+		const bool bBetter = (Change > 0.0) == Metric.bHigherIsBetter;
+		bAnyImprovement |= bBetter;
+		bAnyRegression |= !bBetter;
+		Comparison.Changes.Add(FString::Printf(
+			TEXT("%s: %.3f -> %.3f (%+.1f%%, %s)"),
+			Metric.Name,
+			Metric.Baseline,
+			Metric.Current,
+			Change * 100.0,
+			bBetter ? TEXT("better") : TEXT("worse")));
+	}
+
+	Comparison.Verdict = bAnyRegression
+		? EHexWfcBenchmarkVerdict::Regressed
+		: (bAnyImprovement ? EHexWfcBenchmarkVerdict::Improved : EHexWfcBenchmarkVerdict::Unchanged);
+	return Comparison;
+}
+
+bool FHexWfcBenchmark::HasMachineMetrics(const FHexWfcBenchmarkResult& Result)
+{
+	return Result.SolvesPerSecond >= 0.0
+		|| Result.AverageSolveMilliseconds >= 0.0
+		|| Result.NanosecondsPerPropagationStep >= 0.0
+		|| Result.PeakDomainBytes >= 0
+		|| Result.WorkspaceBytes >= 0
+		|| Result.WorkspaceGrowthBytes >= 0;
+}
+
+const TCHAR* FHexWfcBenchmark::LexVerdict(const EHexWfcBenchmarkVerdict Verdict)
+{
+	switch (Verdict)
+	{
+	case EHexWfcBenchmarkVerdict::Unchanged:
+		return TEXT("unchanged");
+	case EHexWfcBenchmarkVerdict::Improved:
+		return TEXT("improved");
+	case EHexWfcBenchmarkVerdict::Regressed:
+		return TEXT("regressed");
+	default:
+		return TEXT("new");
+	}
+}
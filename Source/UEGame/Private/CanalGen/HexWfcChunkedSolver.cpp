@@ -0,0 +1,320 @@
+#include "CanalGen/HexWfcChunkedSolver.h"
+
+#include "Algo/Sort.h"
+
+namespace
+{
+	// Chunks share an edge (or the two acute corners of the parallelogram) exactly where hex neighbours would.
+	const FIntPoint ChunkNeighborOffsets[6] = {
+		FIntPoint(1, 0),
+		FIntPoint(1, -1),
+		FIntPoint(0, -1),
+		FIntPoint(-1, 0),
+		FIntPoint(-1, 1),
+		FIntPoint(0, 1)};
+
+	int32 FloorDivide(const int32 Value, const int32 Divisor)
+	{
+		return Value >= 0 ? Value / Divisor : (Value - Divisor + 1) / Divisor;
+	}
+}
+
+bool FHexWfcChunkConfig::EnsureValid(FString& OutError) const
+{
+	if (ChunkWidth < 2 || ChunkHeight < 2)
+	{
+		OutError = FString::Printf(TEXT("Chunk dimensions must be >= 2. ChunkWidth=%d ChunkHeight=%d"), ChunkWidth, ChunkHeight);
+		return false;
+	}
+	if (ViewRadiusChunks < 0 || MaxResidentChunks < 1)
+	{
+		OutError = FString::Printf(
+			TEXT("ViewRadiusChunks must be >= 0 and MaxResidentChunks >= 1. ViewRadiusChunks=%d MaxResidentChunks=%d"),
+			ViewRadiusChunks,
+			MaxResidentChunks);
+		return false;
+	}
+	return true;
+}
+
+FHexWfcChunkedSolver::FHexWfcChunkedSolver(
+	const FCanalTileCompatibilityTable& InCompatibility,
+	const FHexWfcChunkConfig& InChunkConfig,
+	const FHexWfcSolveConfig& InSolveConfig)
+	: Compatibility(InCompatibility)
+	, Solver(InCompatibility)
+	, ChunkConfig(InChunkConfig)
+	, SolveConfig(InSolveConfig)
+{
+	ChunkConfig.ChunkWidth = FMath::Max(2, ChunkConfig.ChunkWidth);
+	ChunkConfig.ChunkHeight = FMath::Max(2, ChunkConfig.ChunkHeight);
+	ChunkConfig.ViewRadiusChunks = FMath::Max(0, ChunkConfig.ViewRadiusChunks);
+	ChunkConfig.MaxResidentChunks = FMath::Max(1, ChunkConfig.MaxResidentChunks);
+
+	// Chunk borders are stitched with constraints; nothing in a chunk is a real world boundary.
+	SolveConfig.bRequireEntryExitPath = false;
+	SolveConfig.bRequireSingleWaterComponent = false;
+	SolveConfig.bDisallowUnassignedBoundaryWater = false;
+	SolveConfig.bAutoSelectBoundaryPorts = false;
+	SolveConfig.EntryPort.bEnabled = false;
+	SolveConfig.ExitPort.bEnabled = false;
+	SolveConfig.BoundarySocketConstraints.Reset();
+}
+
+FIntPoint FHexWfcChunkedSolver::GetChunkForCell(const FHexAxialCoord& Coord) const
+{
+	return FIntPoint(FloorDivide(Coord.Q, ChunkConfig.ChunkWidth), FloorDivide(Coord.R, ChunkConfig.ChunkHeight));
+}
+
+FHexAxialCoord FHexWfcChunkedSolver::GetChunkOrigin(const FIntPoint& ChunkCoord) const
+{
+	return FHexAxialCoord(ChunkCoord.X * ChunkConfig.ChunkWidth, ChunkCoord.Y * ChunkConfig.ChunkHeight);
+}
+
+bool FHexWfcChunkedSolver::UpdateFocus(const FHexAxialCoord& Focus, TArray<FIntPoint>* OutGenerated, TArray<FIntPoint>* OutEvicted)
+{
+	const FIntPoint FocusChunk = GetChunkForCell(Focus);
+	const int32 Radius = ChunkConfig.ViewRadiusChunks;
+	const FHexAxialCoord Center(0, 0);
+
+	// The chunk lattice is an affine copy of the axial lattice, so a hex-distance ball of chunk offsets covers a
+	// roughly round area of the world.
+	TArray<FIntPoint> Wanted;
+	for (int32 OffsetY = -Radius; OffsetY <= Radius; ++OffsetY)
+	{
+		for (int32 OffsetX = -Radius; OffsetX <= Radius; ++OffsetX)
+		{
+			if (FHexAxialCoord(OffsetX, OffsetY).DistanceTo(Center) <= Radius)
+			{
+				Wanted.Add(FocusChunk + FIntPoint(OffsetX, OffsetY));
+			}
+		}
+	}
+	Wanted.StableSort([&FocusChunk, &Center](const FIntPoint& A, const FIntPoint& B)
+	{
+		const FIntPoint OffsetA = A - FocusChunk;
+		const FIntPoint OffsetB = B - FocusChunk;
+		return FHexAxialCoord(OffsetA.X, OffsetA.Y).DistanceTo(Center) < FHexAxialCoord(OffsetB.X, OffsetB.Y).DistanceTo(Center);
+	});
+
+	++UseCounter;
+	bool bChanged = false;
+	for (const FIntPoint& ChunkCoord : Wanted)
+	{
+		const bool bWasResident = ResidentChunks.Contains(ChunkCoord);
+		if (GenerateChunk(ChunkCoord) && !bWasResident)
+		{
+			bChanged = true;
+			if (OutGenerated)
+			{
+				OutGenerated->Add(ChunkCoord);
+			}
+		}
+	}
+
+	if (ResidentChunks.Num() > ChunkConfig.MaxResidentChunks)
+	{
+		TArray<const FHexWfcChunk*> Evictable;
+		for (const TPair<FIntPoint, FHexWfcChunk>& Pair : ResidentChunks)
+		{
+			if (Pair.Value.LastUsed < UseCounter)
+			{
+				Evictable.Add(&Pair.Value);
+			}
+		}
+		Algo::Sort(Evictable, [](const FHexWfcChunk* A, const FHexWfcChunk* B)
+		{
+			if (A->LastUsed != B->LastUsed)
+			{
+				return A->LastUsed < B->LastUsed;
+			}
+			return A->ChunkCoord.Y != B->ChunkCoord.Y ? A->ChunkCoord.Y < B->ChunkCoord.Y : A->ChunkCoord.X < B->ChunkCoord.X;
+		});
+
+		TArray<FIntPoint> ToEvict;
+		for (int32 Index = 0; Index < Evictable.Num() && ResidentChunks.Num() - ToEvict.Num() > ChunkConfig.MaxResidentChunks; ++Index)
+		{
+			ToEvict.Add(Evictable[Index]->ChunkCoord);
+		}
+
+		for (const FIntPoint& ChunkCoord : ToEvict)
+		{
+			ResidentChunks.Remove(ChunkCoord);
+			bChanged = true;
+			if (OutEvicted)
+			{
+				OutEvicted->Add(ChunkCoord);
+			}
+		}
+	}
+
+	return bChanged;
+}
+
+const FHexWfcChunk* FHexWfcChunkedSolver::GenerateChunk(const FIntPoint& ChunkCoord)
+{
+	if (FHexWfcChunk* Existing = ResidentChunks.Find(ChunkCoord))
+	{
+		Existing->LastUsed = UseCounter;
+		return Existing;
+	}
+
+	const FChunkRecord* Record = Records.Find(ChunkCoord);
+	if (Record && Record->bFailed)
+	{
+		return nullptr;
+	}
+
+	FHexWfcSolveConfig ChunkSolveConfig = SolveConfig;
+	ChunkSolveConfig.Seed = GetChunkSeed(ChunkCoord);
+	if (Record)
+	{
+		// Same seed and constraints as the first time, so an evicted chunk comes back unchanged.
+		ChunkSolveConfig.BoundarySocketConstraints = Record->Constraints;
+	}
+	else
+	{
+		GatherNeighborConstraints(ChunkCoord, ChunkSolveConfig.BoundarySocketConstraints);
+	}
+
+	// Pins are given in world coordinates; each chunk takes the ones in its interior.
+	const FHexAxialCoord Origin = GetChunkOrigin(ChunkCoord);
+	ChunkSolveConfig.PinnedCells.Reset();
+	for (const FHexWfcPinnedCell& Pin : SolveConfig.PinnedCells)
+	{
+		if (GetChunkForCell(Pin.Coord) == ChunkCoord)
+		{
+			FHexWfcPinnedCell& LocalPin = ChunkSolveConfig.PinnedCells.Add_GetRef(Pin);
+			LocalPin.Coord = FHexAxialCoord(Pin.Coord.Q - Origin.Q + 1, Pin.Coord.R - Origin.R + 1);
+		}
+	}
+
+	FHexWfcGridConfig Grid;
+	Grid.Width = ChunkConfig.ChunkWidth + 2;
+	Grid.Height = ChunkConfig.ChunkHeight + 2;
+	FHexWfcSolveResult Result = Solver.Solve(Grid, ChunkSolveConfig, Workspace);
+	if (!Result.bSolved)
+	{
+		FChunkRecord& FailedRecord = Records.Add(ChunkCoord);
+		FailedRecord.Constraints = MoveTemp(ChunkSolveConfig.BoundarySocketConstraints);
+		FailedRecord.bFailed = true;
+		++NumFailedChunks;
+		UE_LOG(LogTemp, Warning, TEXT("Canal chunk (%d, %d) failed to solve: %s"), ChunkCoord.X, ChunkCoord.Y, *Result.Message);
+		return nullptr;
+	}
+
+	// Drop the ring and move the interior into world coordinates; row-major order is preserved.
+	TArray<FHexWfcCellResult> InteriorCells;
+	InteriorCells.Reserve(ChunkConfig.ChunkWidth * ChunkConfig.ChunkHeight);
+	for (const FHexWfcCellResult& Cell : Result.Cells)
+	{
+		if (Cell.Coord.Q >= 1 && Cell.Coord.Q <= ChunkConfig.ChunkWidth && Cell.Coord.R >= 1 && Cell.Coord.R <= ChunkConfig.ChunkHeight)
+		{
+			FHexWfcCellResult& InteriorCell = InteriorCells.Add_GetRef(Cell);
+			InteriorCell.Coord = FHexAxialCoord(Cell.Coord.Q - 1 + Origin.Q, Cell.Coord.R - 1 + Origin.R);
+		}
+	}
+	Result.Cells = MoveTemp(InteriorCells);
+	Result.TotalCells = Result.Cells.Num();
+	Result.CollapsedCells = Result.Cells.Num();
+
+	FHexWfcChunk& Chunk = ResidentChunks.Add(ChunkCoord);
+	Chunk.ChunkCoord = ChunkCoord;
+	Chunk.Result = MoveTemp(Result);
+	Chunk.LastUsed = UseCounter;
+
+	if (!Record)
+	{
+		FChunkRecord& NewRecord = Records.Add(ChunkCoord);
+		NewRecord.Constraints = MoveTemp(ChunkSolveConfig.BoundarySocketConstraints);
+		for (const FHexWfcCellResult& Cell : Chunk.Result.Cells)
+		{
+			if (IsBorderCell(Cell.Coord, ChunkCoord))
+			{
+				NewRecord.BorderCells.Add(Cell);
+			}
+		}
+	}
+
+	return &Chunk;
+}
+
+const FHexWfcChunk* FHexWfcChunkedSolver::FindChunk(const FIntPoint& ChunkCoord) const
+{
+	return ResidentChunks.Find(ChunkCoord);
+}
+
+void FHexWfcChunkedSolver::GetResidentChunks(TArray<const FHexWfcChunk*>& OutChunks) const
+{
+	OutChunks.Reset(ResidentChunks.Num());
+	for (const TPair<FIntPoint, FHexWfcChunk>& Pair : ResidentChunks)
+	{
+		OutChunks.Add(&Pair.Value);
+	}
+	Algo::Sort(OutChunks, [](const FHexWfcChunk* A, const FHexWfcChunk* B)
+	{
+		return A->ChunkCoord.Y != B->ChunkCoord.Y ? A->ChunkCoord.Y < B->ChunkCoord.Y : A->ChunkCoord.X < B->ChunkCoord.X;
+	});
+}
+
+void FHexWfcChunkedSolver::Reset()
+{
+	ResidentChunks.Reset();
+	Records.Reset();
+	UseCounter = 0;
+	NumFailedChunks = 0;
+}
+
+int32 FHexWfcChunkedSolver::GetChunkSeed(const FIntPoint& ChunkCoord) const
+{
+	// Masked to stay a non-negative seed.
+	return static_cast<int32>(HashCombine(GetTypeHash(SolveConfig.Seed), GetTypeHash(ChunkCoord)) & 0x3FFFFFFFu);
+}
+
+void FHexWfcChunkedSolver::GatherNeighborConstraints(const FIntPoint& ChunkCoord, TArray<FHexWfcBoundarySocketConstraint>& OutConstraints) const
+{
+	OutConstraints.Reset();
+
+	// Ring cell (Q, R) in world space sits at (Q - Origin.Q + 1, R - Origin.R + 1) in the ringed grid.
+	const FHexAxialCoord Origin = GetChunkOrigin(ChunkCoord);
+	for (const FIntPoint& Offset : ChunkNeighborOffsets)
+	{
+		const FChunkRecord* NeighborRecord = Records.Find(ChunkCoord + Offset);
+		if (!NeighborRecord || NeighborRecord->bFailed)
+		{
+			continue;
+		}
+
+		for (const FHexWfcCellResult& Cell : NeighborRecord->BorderCells)
+		{
+			const FHexAxialCoord LocalCoord(Cell.Coord.Q - Origin.Q + 1, Cell.Coord.R - Origin.R + 1);
+			if (LocalCoord.Q < 0 || LocalCoord.Q > ChunkConfig.ChunkWidth + 1 || LocalCoord.R < 0 || LocalCoord.R > ChunkConfig.ChunkHeight + 1)
+			{
+				continue;
+			}
+
+			const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(Cell.Variant.TileIndex);
+			if (!Tile)
+			{
+				continue;
+			}
+
+			// Pinning every side leaves only variants with the same socket layout, which are interchangeable here.
+			for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
+			{
+				FHexWfcBoundarySocketConstraint& Constraint = OutConstraints.AddDefaulted_GetRef();
+				Constraint.Coord = LocalCoord;
+				Constraint.Direction = HexDirectionFromIndex(DirIndex);
+				Constraint.Socket = Tile->GetSocket(Constraint.Direction, Cell.Variant.RotationSteps);
+			}
+		}
+	}
+}
+
+bool FHexWfcChunkedSolver::IsBorderCell(const FHexAxialCoord& Coord, const FIntPoint& ChunkCoord) const
+{
+	const FHexAxialCoord Origin = GetChunkOrigin(ChunkCoord);
+	const int32 LocalQ = Coord.Q - Origin.Q;
+	const int32 LocalR = Coord.R - Origin.R;
+	return LocalQ == 0 || LocalR == 0 || LocalQ == ChunkConfig.ChunkWidth - 1 || LocalR == ChunkConfig.ChunkHeight - 1;
+}
@@ -0,0 +1,580 @@
+#include "CanalGen/HexWfcHierarchicalSolver.h"
+
+#include "Async/ParallelFor.h"
+
+namespace
+{
+	int32 FloorDivide(const int32 Value, const int32 Divisor)
+	{
+		return Value >= 0 ? Value / Divisor : (Value - Divisor + 1) / Divisor;
+	}
+
+	bool IsWaterLikeSocket(const ECanalSocketType Socket)
+	{
+		return Socket == ECanalSocketType::Water || Socket == ECanalSocketType::Lock;
+	}
+
+	// Sockets that only match themselves and so run on in a straight line through every cell that carries them.
+	bool IsLineSocket(const ECanalSocketType Socket)
+	{
+		return Socket == ECanalSocketType::Lock || Socket == ECanalSocketType::Road;
+	}
+
+	// Seam water edges, keyed by macro cell index and side; line offsets come from a substream, keyed by the macro row
+	// or column a line runs along and its axis.
+	constexpr uint32 SeamStreamId = 0x5345414Du; // 'SEAM'
+
+	int32 GetPatchSeed(const int32 Seed, const FIntPoint& MacroCoord)
+	{
+		// Masked to stay a non-negative seed, like chunk seeds.
+		return static_cast<int32>(HashCombine(GetTypeHash(Seed), GetTypeHash(MacroCoord)) & 0x3FFFFFFFu);
+	}
+}
+
+bool FHexWfcHierarchicalConfig::EnsureValid(FString& OutError) const
+{
+	if (MacroWidth < 1 || MacroHeight < 1)
+	{
+		OutError = FString::Printf(TEXT("Macro dimensions must be >= 1. MacroWidth=%d MacroHeight=%d"), MacroWidth, MacroHeight);
+		return false;
+	}
+	if (PatchWidth < 4 || PatchHeight < 4)
+	{
+		OutError = FString::Printf(TEXT("Patch dimensions must be >= 4. PatchWidth=%d PatchHeight=%d"), PatchWidth, PatchHeight);
+		return false;
+	}
+	return true;
+}
+
+FHexWfcHierarchicalSolver::FHexWfcHierarchicalSolver(const FCanalTileCompatibilityTable& InCompatibility)
+	: Compatibility(InCompatibility)
+	, Solver(InCompatibility)
+{
+	for (const FCanalTileVariantKey& Key : Compatibility.GetAllVariants())
+	{
+		const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(Key.TileIndex);
+		bool bDry = Tile != nullptr;
+		for (int32 DirIndex = 0; bDry && DirIndex < 6; ++DirIndex)
+		{
+			bDry = !IsWaterLikeSocket(Tile->GetSocket(HexDirectionFromIndex(DirIndex), Key.RotationSteps));
+		}
+		if (bDry)
+		{
+			DryTileIds.AddUnique(Tile->TileId);
+		}
+	}
+}
+
+FHexWfcHierarchicalResult FHexWfcHierarchicalSolver::Solve(const FHexWfcHierarchicalConfig& HierarchyConfig, const FHexWfcSolveConfig& Config) const
+{
+	const double StartTime = FPlatformTime::Seconds();
+	FHexWfcHierarchicalResult Result;
+
+	FString ConfigError;
+	if (!HierarchyConfig.EnsureValid(ConfigError))
+	{
+		Result.Message = ConfigError;
+		return Result;
+	}
+
+	const int32 MacroWidth = HierarchyConfig.MacroWidth;
+	const int32 PatchWidth = HierarchyConfig.PatchWidth;
+	const int32 PatchHeight = HierarchyConfig.PatchHeight;
+	Result.FineGrid.Width = MacroWidth * PatchWidth;
+	Result.FineGrid.Height = HierarchyConfig.MacroHeight * PatchHeight;
+
+	// Pins are in fine coordinates and belong to the patches.
+	FHexWfcGridConfig MacroGrid;
+	MacroGrid.Width = MacroWidth;
+	MacroGrid.Height = HierarchyConfig.MacroHeight;
+	FHexWfcSolveConfig MacroConfig = Config;
+	MacroConfig.PinnedCells.Reset();
+	MacroConfig.BoundarySocketConstraints.Reset();
+
+	// Fine lines copy their macro tile, so each has to run straight through it. A diagonal one only stays inside the
+	// macro cells it crosses when it runs corner to corner, so on non-square patches a macro cell that took one is solved
+	// again without that tile. Every retry bans a new tile in some cell, so this ends.
+	for (bool bRetry = true; bRetry;)
+	{
+		bRetry = false;
+		Result.MacroResult = Solver.Solve(MacroGrid, MacroConfig);
+		if (!Result.MacroResult.bSolved)
+		{
+			Result.Message = FString::Printf(TEXT("Macro grid failed to solve: %s"), *Result.MacroResult.Message);
+			Result.SolveTimeSeconds = static_cast<float>(FPlatformTime::Seconds() - StartTime);
+			return Result;
+		}
+
+		for (const FHexWfcCellResult& MacroCell : Result.MacroResult.Cells)
+		{
+			const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(MacroCell.Variant.TileIndex);
+			for (int32 DirIndex = 0; Tile && DirIndex < 3; ++DirIndex)
+			{
+				const ECanalSocketType Socket = Tile->GetSocket(HexDirectionFromIndex(DirIndex), MacroCell.Variant.RotationSteps);
+				const ECanalSocketType Opposite = Tile->GetSocket(HexDirectionFromIndex(DirIndex + 3), MacroCell.Variant.RotationSteps);
+				if (!IsLineSocket(Socket) && !IsLineSocket(Opposite))
+				{
+					continue;
+				}
+
+				if (Socket != Opposite)
+				{
+					Result.Message = FString::Printf(
+						TEXT("Macro cell %s has tile '%s' with a lock or road on one side only; lines need the same socket on opposite sides."),
+						*MacroCell.Coord.ToString(),
+						*Tile->TileId.ToString());
+					Result.SolveTimeSeconds = static_cast<float>(FPlatformTime::Seconds() - StartTime);
+					return Result;
+				}
+
+				if (DirIndex == 1 && PatchWidth != PatchHeight)
+				{
+					FHexWfcPinnedCell& Ban = MacroConfig.PinnedCells.AddDefaulted_GetRef();
+					Ban.Coord = MacroCell.Coord;
+					for (const FCanalTileVariantKey& Key : Compatibility.GetAllVariants())
+					{
+						const FCanalTopologyTileDefinition* Other = Compatibility.GetTileDefinition(Key.TileIndex);
+						if (Other && Other != Tile)
+						{
+							Ban.AllowedTileIds.AddUnique(Other->TileId);
+						}
+					}
+					bRetry = true;
+				}
+			}
+		}
+	}
+
+	// Seam socket per fine cell side, Bank unless a macro seam crosses it. Both ends of every seam edge are listed, so
+	// each patch sees its own side.
+	TArray<ECanalSocketType> FineSeamSockets;
+	FineSeamSockets.Init(ECanalSocketType::Bank, Result.FineGrid.Width * Result.FineGrid.Height * 6);
+	TArray<int32> SeamPortCells;
+	SeamPortCells.Init(INDEX_NONE, MacroWidth * HierarchyConfig.MacroHeight * 6);
+	TArray<int32> FineLineMacroCells;
+	PlaceLines(HierarchyConfig, Config, Result.MacroResult, Result.FineGrid, FineLineMacroCells, SeamPortCells, FineSeamSockets);
+	PlaceSeamPorts(HierarchyConfig, Config, Result.MacroResult, Result.FineGrid, FineLineMacroCells, SeamPortCells, FineSeamSockets);
+
+	if (Result.MacroResult.bHasResolvedPorts)
+	{
+		auto ToFinePort = [&](const FHexBoundaryPort& MacroPort, FHexBoundaryPort& OutPort)
+		{
+			const int32 MacroIndex = MacroPort.Coord.R * MacroWidth + MacroPort.Coord.Q;
+			const int32 CellIndex = SeamPortCells[MacroIndex * 6 + HexDirectionToIndex(MacroPort.Direction)];
+			if (CellIndex == INDEX_NONE)
+			{
+				return false;
+			}
+
+			OutPort.bEnabled = true;
+			OutPort.Coord = FHexAxialCoord(CellIndex % Result.FineGrid.Width, CellIndex / Result.FineGrid.Width);
+			OutPort.Direction = MacroPort.Direction;
+			return true;
+		};
+		Result.bHasResolvedPorts = ToFinePort(Result.MacroResult.ResolvedEntryPort, Result.ResolvedEntryPort)
+			&& ToFinePort(Result.MacroResult.ResolvedExitPort, Result.ResolvedExitPort);
+	}
+
+	const int32 NumPatches = MacroGrid.Width * MacroGrid.Height;
+	TArray<FHexWfcSolveConfig> PatchConfigs;
+	PatchConfigs.SetNum(NumPatches);
+	Result.Patches.SetNum(NumPatches);
+	for (int32 PatchIndex = 0; PatchIndex < NumPatches; ++PatchIndex)
+	{
+		const FIntPoint MacroCoord(PatchIndex % MacroWidth, PatchIndex / MacroWidth);
+		BuildPatchConfig(HierarchyConfig, Config, Result.MacroResult, MacroCoord, Result.FineGrid, FineSeamSockets, FineLineMacroCells, PatchConfigs[PatchIndex], Result.Patches[PatchIndex]);
+	}
+
+	FHexWfcGridConfig PatchGrid;
+	PatchGrid.Width = PatchWidth;
+	PatchGrid.Height = PatchHeight;
+	TArray<FHexWfcSolveResult> PatchResults;
+	PatchResults.SetNum(NumPatches);
+	auto SolvePatch = [&](FHexWfcSolverWorkspace& Workspace, const int32 PatchIndex)
+	{
+		PatchResults[PatchIndex] = Solver.Solve(PatchGrid, PatchConfigs[PatchIndex], Workspace);
+	};
+
+	if (HierarchyConfig.bSolvePatchesInParallel && NumPatches > 1)
+	{
+		// Seams are fixed before any patch starts, so patches never wait on each other.
+		TArray<FHexWfcSolverWorkspace> Workspaces;
+		ParallelForWithTaskContext(Workspaces, NumPatches, SolvePatch, EParallelForFlags::Unbalanced);
+	}
+	else
+	{
+		FHexWfcSolverWorkspace Workspace;
+		for (int32 PatchIndex = 0; PatchIndex < NumPatches; ++PatchIndex)
+		{
+			SolvePatch(Workspace, PatchIndex);
+		}
+	}
+
+	FString FirstFailure;
+	for (int32 PatchIndex = 0; PatchIndex < NumPatches; ++PatchIndex)
+	{
+		const FHexWfcSolveResult& PatchResult = PatchResults[PatchIndex];
+		FHexWfcPatchResult& Patch = Result.Patches[PatchIndex];
+		Patch.bSolved = PatchResult.bSolved;
+		Patch.AttemptsUsed = PatchResult.AttemptsUsed;
+		Patch.Backtracks = PatchResult.Backtracks;
+		Patch.Message = PatchResult.Message;
+		if (!Patch.bSolved)
+		{
+			++Result.NumFailedPatches;
+			if (FirstFailure.IsEmpty())
+			{
+				FirstFailure = FString::Printf(TEXT("Patch (%d, %d): %s"), Patch.MacroCoord.X, Patch.MacroCoord.Y, *Patch.Message);
+			}
+		}
+	}
+
+	if (Result.NumFailedPatches > 0)
+	{
+		Result.Message = FString::Printf(TEXT("%d of %d patches failed to solve. %s"), Result.NumFailedPatches, NumPatches, *FirstFailure);
+		Result.SolveTimeSeconds = static_cast<float>(FPlatformTime::Seconds() - StartTime);
+		return Result;
+	}
+
+	// Patch cells are row-major within each patch; interleave them into fine rows.
+	Result.Cells.Reserve(Result.FineGrid.Width * Result.FineGrid.Height);
+	for (int32 R = 0; R < Result.FineGrid.Height; ++R)
+	{
+		for (int32 Q = 0; Q < Result.FineGrid.Width; ++Q)
+		{
+			const int32 PatchIndex = (R / PatchHeight) * MacroWidth + Q / PatchWidth;
+			FHexWfcCellResult& Cell = Result.Cells.Add_GetRef(PatchResults[PatchIndex].Cells[(R % PatchHeight) * PatchWidth + Q % PatchWidth]);
+			Cell.Coord = FHexAxialCoord(Q, R);
+		}
+	}
+
+	// Patches only see their own seams, so check that they really join up the way the macro grid promised. Every fine
+	// boundary side carries the macro boundary socket it stands in for, which the macro solve already cleared.
+	FHexWfcSolveConfig FineConfig = Config;
+	FineConfig.bAutoSelectBoundaryPorts = false;
+	FineConfig.bDisallowUnassignedBoundaryWater = false;
+	FineConfig.EntryPort = Result.bHasResolvedPorts ? Result.ResolvedEntryPort : FHexBoundaryPort();
+	FineConfig.ExitPort = Result.bHasResolvedPorts ? Result.ResolvedExitPort : FHexBoundaryPort();
+	FineConfig.bRequireEntryExitPath = Config.bRequireEntryExitPath && Result.bHasResolvedPorts;
+	FHexBoundaryPort FineEntry;
+	FHexBoundaryPort FineExit;
+	FString ValidationError;
+	if (!Solver.ValidateCells(Result.FineGrid, FineConfig, Result.Cells, FineEntry, FineExit, Result.Water, ValidationError))
+	{
+		Result.Message = FString::Printf(TEXT("Stitched fine grid failed validation: %s"), *ValidationError);
+		Result.SolveTimeSeconds = static_cast<float>(FPlatformTime::Seconds() - StartTime);
+		return Result;
+	}
+
+	Result.bSolved = true;
+	Result.Message = FString::Printf(TEXT("Solved %d patches of %dx%d cells."), NumPatches, PatchWidth, PatchHeight);
+	Result.SolveTimeSeconds = static_cast<float>(FPlatformTime::Seconds() - StartTime);
+	return Result;
+}
+
+void FHexWfcHierarchicalSolver::PlaceLines(
+	const FHexWfcHierarchicalConfig& HierarchyConfig,
+	const FHexWfcSolveConfig& Config,
+	const FHexWfcSolveResult& MacroResult,
+	const FHexWfcGridConfig& FineGrid,
+	TArray<int32>& OutFineLineMacroCells,
+	TArray<int32>& InOutSeamPortCells,
+	TArray<ECanalSocketType>& InOutFineSeamSockets) const
+{
+	const int32 MacroWidth = HierarchyConfig.MacroWidth;
+	const int32 PatchWidth = HierarchyConfig.PatchWidth;
+	const int32 PatchHeight = HierarchyConfig.PatchHeight;
+	OutFineLineMacroCells.Init(INDEX_NONE, FineGrid.Width * FineGrid.Height);
+
+	// The offset depends only on the line, keyed by the macro row or column it runs along, so every patch it crosses
+	// picks the same fine row or column and both sides of each seam land on the same edge.
+	const FCanalCounterRandom LineRandom = FCanalCounterRandom(Config.Seed, SeamStreamId).Substream(1);
+	for (int32 MacroIndex = 0; MacroIndex < MacroWidth * HierarchyConfig.MacroHeight; ++MacroIndex)
+	{
+		const FIntPoint MacroCoord(MacroIndex % MacroWidth, MacroIndex / MacroWidth);
+		const FCanalTileVariantRef& Variant = MacroResult.Cells[MacroIndex].Variant;
+		const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(Variant.TileIndex);
+		if (!Tile)
+		{
+			continue;
+		}
+
+		const FHexAxialCoord Origin(MacroCoord.X * PatchWidth, MacroCoord.Y * PatchHeight);
+		const auto IsInPatch = [&](const FHexAxialCoord& Coord)
+		{
+			return Coord.Q >= Origin.Q && Coord.Q < Origin.Q + PatchWidth && Coord.R >= Origin.R && Coord.R < Origin.R + PatchHeight;
+		};
+
+		for (int32 DirIndex = 0; DirIndex < 3; ++DirIndex)
+		{
+			if (!IsLineSocket(Tile->GetSocket(HexDirectionFromIndex(DirIndex), Variant.RotationSteps)))
+			{
+				continue;
+			}
+
+			// Start on the East, NorthEast or NorthWest seam and run straight back across the patch.
+			FHexAxialCoord LineCoord(Origin.Q + PatchWidth - 1, Origin.R);
+			if (DirIndex == 0)
+			{
+				LineCoord.R += LineRandom.RandRange(PatchHeight / 4, PatchHeight - 1 - PatchHeight / 4, MacroCoord.Y, 0);
+			}
+			else if (DirIndex == 2)
+			{
+				LineCoord.Q = Origin.Q + LineRandom.RandRange(PatchWidth / 4, PatchWidth - 1 - PatchWidth / 4, MacroCoord.X, 2);
+			}
+
+			InOutSeamPortCells[MacroIndex * 6 + DirIndex] = LineCoord.R * FineGrid.Width + LineCoord.Q;
+			for (; IsInPatch(LineCoord); LineCoord = LineCoord.Neighbor(HexDirectionFromIndex(DirIndex + 3)))
+			{
+				const int32 FineIndex = LineCoord.R * FineGrid.Width + LineCoord.Q;
+				OutFineLineMacroCells[FineIndex] = MacroIndex;
+				InOutSeamPortCells[MacroIndex * 6 + DirIndex + 3] = FineIndex;
+
+				// Every side leaving the patch takes the macro tile's socket, not just the line's own: a road's water
+				// crosses the seams beside it too.
+				for (int32 SideIndex = 0; SideIndex < 6; ++SideIndex)
+				{
+					const FHexAxialCoord Across = LineCoord.Neighbor(HexDirectionFromIndex(SideIndex));
+					if (IsInPatch(Across))
+					{
+						continue;
+					}
+
+					const ECanalSocketType Socket = Tile->GetSocket(HexDirectionFromIndex(SideIndex), Variant.RotationSteps);
+					InOutFineSeamSockets[FineIndex * 6 + SideIndex] = Socket;
+					if (FineGrid.Contains(Across))
+					{
+						InOutFineSeamSockets[(Across.R * FineGrid.Width + Across.Q) * 6 + (SideIndex + 3) % 6] = Socket;
+					}
+				}
+			}
+		}
+	}
+}
+
+void FHexWfcHierarchicalSolver::PlaceSeamPorts(
+	const FHexWfcHierarchicalConfig& HierarchyConfig,
+	const FHexWfcSolveConfig& Config,
+	const FHexWfcSolveResult& MacroResult,
+	const FHexWfcGridConfig& FineGrid,
+	const TArray<int32>& FineLineMacroCells,
+	TArray<int32>& InOutSeamPortCells,
+	TArray<ECanalSocketType>& InOutFineSeamSockets) const
+{
+	const int32 MacroWidth = HierarchyConfig.MacroWidth;
+	const int32 MacroHeight = HierarchyConfig.MacroHeight;
+	const int32 PatchWidth = HierarchyConfig.PatchWidth;
+	const int32 PatchHeight = HierarchyConfig.PatchHeight;
+
+	// Sides facing East, NorthEast or NorthWest, and sides on the grid edge, are placed first. The opposite side of an
+	// interior seam copies its neighbour's choice, so both patches put their water on the same fine edge.
+	const FCanalCounterRandom SeamRandom(Config.Seed, SeamStreamId);
+	TArray<int32> Candidates;
+	TArray<int32> WetCandidates;
+	for (int32 Pass = 0; Pass < 2; ++Pass)
+	{
+		for (int32 MacroIndex = 0; MacroIndex < MacroWidth * MacroHeight; ++MacroIndex)
+		{
+			const FIntPoint MacroCoord(MacroIndex % MacroWidth, MacroIndex / MacroWidth);
+			const FHexWfcCellResult& MacroCell = MacroResult.Cells[MacroIndex];
+			const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(MacroCell.Variant.TileIndex);
+			if (!Tile)
+			{
+				continue;
+			}
+
+			for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
+			{
+				const EHexDirection Direction = HexDirectionFromIndex(DirIndex);
+				const FHexAxialCoord NeighborMacro = FHexAxialCoord(MacroCoord.X, MacroCoord.Y).Neighbor(Direction);
+				const bool bMirrored = DirIndex >= 3
+					&& NeighborMacro.Q >= 0 && NeighborMacro.Q < MacroWidth
+					&& NeighborMacro.R >= 0 && NeighborMacro.R < MacroHeight;
+				if (bMirrored != (Pass == 1) || Tile->GetSocket(Direction, MacroCell.Variant.RotationSteps) != ECanalSocketType::Water)
+				{
+					continue;
+				}
+
+				const int32 Slot = MacroIndex * 6 + DirIndex;
+				if (bMirrored)
+				{
+					const int32 NeighborCell = InOutSeamPortCells[(NeighborMacro.R * MacroWidth + NeighborMacro.Q) * 6 + DirIndex - 3];
+					if (NeighborCell != INDEX_NONE)
+					{
+						const FHexAxialCoord Across = FHexAxialCoord(NeighborCell % FineGrid.Width, NeighborCell / FineGrid.Width)
+							.Neighbor(HexDirectionFromIndex(DirIndex - 3));
+						InOutSeamPortCells[Slot] = Across.R * FineGrid.Width + Across.Q;
+						InOutFineSeamSockets[InOutSeamPortCells[Slot] * 6 + DirIndex] = ECanalSocketType::Water;
+					}
+					continue;
+				}
+
+				// Cells whose Direction side leads into the neighbouring patch, in row-major order: a whole patch row or
+				// column for straight seams, a single corner cell for NorthEast and SouthWest. Edges a line already set
+				// are left alone, unless the line's own water crosses there.
+				Candidates.Reset();
+				WetCandidates.Reset();
+				const FHexAxialCoord Origin(MacroCoord.X * PatchWidth, MacroCoord.Y * PatchHeight);
+				for (int32 LocalR = 0; LocalR < PatchHeight; ++LocalR)
+				{
+					for (int32 LocalQ = 0; LocalQ < PatchWidth; ++LocalQ)
+					{
+						const FHexAxialCoord Across = FHexAxialCoord(Origin.Q + LocalQ, Origin.R + LocalR).Neighbor(Direction);
+						if (FloorDivide(Across.Q, PatchWidth) != NeighborMacro.Q || FloorDivide(Across.R, PatchHeight) != NeighborMacro.R)
+						{
+							continue;
+						}
+
+						const int32 FineIndex = (Origin.R + LocalR) * FineGrid.Width + Origin.Q + LocalQ;
+						if (InOutFineSeamSockets[FineIndex * 6 + DirIndex] == ECanalSocketType::Water)
+						{
+							WetCandidates.Add(FineIndex);
+						}
+						else if (FineLineMacroCells[FineIndex] == INDEX_NONE
+							&& (!FineGrid.Contains(Across) || FineLineMacroCells[Across.R * FineGrid.Width + Across.Q] == INDEX_NONE))
+						{
+							Candidates.Add(FineIndex);
+						}
+					}
+				}
+
+				// Water a line already carries across the seam serves; otherwise the middle half keeps seam water clear
+				// of the patch corners, where three seams meet. A seam with no free edge is left dry for the stitched
+				// validation to report.
+				if (WetCandidates.Num() > 0)
+				{
+					InOutSeamPortCells[Slot] = WetCandidates[SeamRandom.RandRange(0, WetCandidates.Num() - 1, MacroIndex, DirIndex)];
+				}
+				else if (Candidates.Num() > 0)
+				{
+					const int32 Margin = Candidates.Num() / 4;
+					InOutSeamPortCells[Slot] = Candidates[SeamRandom.RandRange(Margin, Candidates.Num() - 1 - Margin, MacroIndex, DirIndex)];
+					InOutFineSeamSockets[InOutSeamPortCells[Slot] * 6 + DirIndex] = ECanalSocketType::Water;
+				}
+			}
+		}
+	}
+}
+
+void FHexWfcHierarchicalSolver::BuildPatchConfig(
+	const FHexWfcHierarchicalConfig& HierarchyConfig,
+	const FHexWfcSolveConfig& Config,
+	const FHexWfcSolveResult& MacroResult,
+	const FIntPoint& MacroCoord,
+	const FHexWfcGridConfig& FineGrid,
+	const TArray<ECanalSocketType>& FineSeamSockets,
+	const TArray<int32>& FineLineMacroCells,
+	FHexWfcSolveConfig& OutPatchConfig,
+	FHexWfcPatchResult& OutPatch) const
+{
+	const int32 PatchWidth = HierarchyConfig.PatchWidth;
+	const int32 PatchHeight = HierarchyConfig.PatchHeight;
+	const FHexAxialCoord Origin(MacroCoord.X * PatchWidth, MacroCoord.Y * PatchHeight);
+	OutPatch.MacroCoord = MacroCoord;
+	OutPatch.Seed = GetPatchSeed(Config.Seed, MacroCoord);
+
+	// Patch edges are seams or stand-ins for the world edge; global validation already ran on the macro grid.
+	OutPatchConfig = Config;
+	OutPatchConfig.Seed = OutPatch.Seed;
+	OutPatchConfig.bRequireEntryExitPath = false;
+	OutPatchConfig.bRequireSingleWaterComponent = false;
+	OutPatchConfig.bDisallowUnassignedBoundaryWater = false;
+	OutPatchConfig.bAutoSelectBoundaryPorts = false;
+	OutPatchConfig.bCarveEntryExitPath = false;
+	OutPatchConfig.EntryPort = FHexBoundaryPort();
+	OutPatchConfig.ExitPort = FHexBoundaryPort();
+	OutPatchConfig.BoundarySocketConstraints.Reset();
+	OutPatchConfig.PinnedCells.Reset();
+
+	TArray<FHexBoundaryPort> SeamPorts;
+	for (int32 LocalR = 0; LocalR < PatchHeight; ++LocalR)
+	{
+		for (int32 LocalQ = 0; LocalQ < PatchWidth; ++LocalQ)
+		{
+			const FHexAxialCoord Coord(Origin.Q + LocalQ, Origin.R + LocalR);
+			const int32 FineIndex = Coord.R * FineGrid.Width + Coord.Q;
+			for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
+			{
+				const EHexDirection Direction = HexDirectionFromIndex(DirIndex);
+				const FHexAxialCoord Across = Coord.Neighbor(Direction);
+				if (Across.Q >= Origin.Q && Across.Q < Origin.Q + PatchWidth && Across.R >= Origin.R && Across.R < Origin.R + PatchHeight)
+				{
+					continue;
+				}
+
+				FHexWfcBoundarySocketConstraint& Constraint = OutPatchConfig.BoundarySocketConstraints.AddDefaulted_GetRef();
+				Constraint.Coord = FHexAxialCoord(LocalQ, LocalR);
+				Constraint.Direction = Direction;
+				Constraint.Socket = FineSeamSockets[FineIndex * 6 + DirIndex];
+				if (Constraint.Socket == ECanalSocketType::Water)
+				{
+					FHexBoundaryPort& Port = SeamPorts.AddDefaulted_GetRef();
+					Port.bEnabled = true;
+					Port.Coord = Constraint.Coord;
+					Port.Direction = Direction;
+				}
+				else if (IsLineSocket(Constraint.Socket))
+				{
+					++OutPatch.NumLineSeams;
+				}
+			}
+
+			// Line cells copy the macro tile, which fixes every socket the line carries across the patch.
+			if (FineLineMacroCells[FineIndex] != INDEX_NONE)
+			{
+				const FCanalTileVariantRef& LineVariant = MacroResult.Cells[FineLineMacroCells[FineIndex]].Variant;
+				FHexWfcPinnedCell& LinePin = OutPatchConfig.PinnedCells.AddDefaulted_GetRef();
+				LinePin.Coord = FHexAxialCoord(LocalQ, LocalR);
+				LinePin.AllowedTileIds.Add(LineVariant.TileId);
+				LinePin.AllowedRotations.Add(LineVariant.RotationSteps);
+			}
+		}
+	}
+	OutPatch.NumWaterSeams = SeamPorts.Num();
+
+	for (const FHexWfcPinnedCell& Pin : Config.PinnedCells)
+	{
+		if (FloorDivide(Pin.Coord.Q, PatchWidth) == MacroCoord.X && FloorDivide(Pin.Coord.R, PatchHeight) == MacroCoord.Y)
+		{
+			FHexWfcPinnedCell& LocalPin = OutPatchConfig.PinnedCells.Add_GetRef(Pin);
+			LocalPin.Coord = FHexAxialCoord(Pin.Coord.Q - Origin.Q, Pin.Coord.R - Origin.R);
+		}
+	}
+
+	// The macro tile joins its water sides, so the patch must too: a path between two seams, or one water component
+	// through three or more. The path is carved unless a line crosses the patch, since a carved path could run along
+	// the line instead of across it.
+	if (SeamPorts.Num() == 2)
+	{
+		OutPatchConfig.bRequireEntryExitPath = true;
+		OutPatchConfig.bCarveEntryExitPath = OutPatch.NumLineSeams == 0;
+		OutPatchConfig.bPropagateConnectivity |= OutPatch.NumLineSeams > 0;
+		OutPatchConfig.EntryPort = SeamPorts[0];
+		OutPatchConfig.ExitPort = SeamPorts[1];
+	}
+
+	if (SeamPorts.Num() > 2 || (Config.bRequireSingleWaterComponent && SeamPorts.Num() > 0))
+	{
+		OutPatchConfig.bRequireSingleWaterComponent = true;
+		OutPatchConfig.bPropagateConnectivity = true;
+	}
+	else if (Config.bRequireSingleWaterComponent)
+	{
+		// Any water in a patch without seams would be a separate component. A lock line is water too, but the macro
+		// grid already counted it.
+		for (int32 LocalR = 0; LocalR < PatchHeight; ++LocalR)
+		{
+			for (int32 LocalQ = 0; LocalQ < PatchWidth; ++LocalQ)
+			{
+				if (FineLineMacroCells[(Origin.R + LocalR) * FineGrid.Width + Origin.Q + LocalQ] != INDEX_NONE)
+				{
+					continue;
+				}
+
+				FHexWfcPinnedCell& DryPin = OutPatchConfig.PinnedCells.AddDefaulted_GetRef();
+				DryPin.Coord = FHexAxialCoord(LocalQ, LocalR);
+				DryPin.AllowedTileIds = DryTileIds;
+			}
+		}
+	}
+}
@@ -1,7 +1,127 @@
 #include "CanalGen/HexWfcSolver.h"
 
+#include "Algo/Reverse.h"
 #include "Algo/Sort.h"
-#include "Containers/Queue.h"
+#include "Async/ParallelFor.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Stats/Stats.h"
+
+// Whole solves, attempts and batches show up under "stat CanalWfc". Per-collapse phases are too fine for cycle stats;
+// they are traced on the CanalWfc channel (-trace=cpu,CanalWfc) and summed into FHexWfcSolveProfile.
+DECLARE_STATS_GROUP(TEXT("CanalWfc"), STATGROUP_CanalWfc, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Solve"), STAT_CanalWfc_Solve, STATGROUP_CanalWfc);
+DECLARE_CYCLE_STAT(TEXT("Prepare"), STAT_CanalWfc_Prepare, STATGROUP_CanalWfc);
+DECLARE_CYCLE_STAT(TEXT("Attempt"), STAT_CanalWfc_Attempt, STATGROUP_CanalWfc);
+DECLARE_CYCLE_STAT(TEXT("Validate"), STAT_CanalWfc_Validate, STATGROUP_CanalWfc);
+DECLARE_CYCLE_STAT(TEXT("Batch"), STAT_CanalWfc_Batch, STATGROUP_CanalWfc);
+
+UE_TRACE_CHANNEL(CanalWfcChannel)
+
+namespace
+{
+	// Fixed-point scale for the weighted-entropy sums kept per cell.
+	constexpr double EntropyWeightScale = 65536.0;
+
+	// Counter-based random streams. Every attempt draws from its own substream of the pick stream, keyed by cell index,
+	// so a cell's numbers do not depend on the order cells are collapsed or carved in.
+	constexpr uint32 PickStreamId = 0x5049434Bu; // 'PICK'
+	constexpr uint32 PortStreamId = 0x504F5254u; // 'PORT'
+	constexpr uint32 PickDraw = 0;
+	constexpr uint32 CarveCostDraw = 1;
+
+	enum class EPropagationOutcome : uint8
+	{
+		Settled,
+		Contradiction,
+		BudgetExceeded,
+		Cancelled
+	};
+
+	// The part of one batch seed's solve that feeds FHexWfcBatchStats.
+	struct FHexWfcSeedOutcome
+	{
+		bool bProcessed = false;
+		bool bSolved = false;
+		bool bContradiction = false;
+		bool bTimeBudgetExceeded = false;
+		bool bFailedSingleWaterComponent = false;
+		int32 AttemptsUsed = 0;
+		int32 Backtracks = 0;
+		float SolveTimeSeconds = 0.0f;
+		FHexWfcSolveProfile Profile;
+		TMap<FName, int32> TileCounts;
+	};
+
+	// Sorted histograms from per-key counts. Backtrack bucket 0 holds seeds without backtracks; bucket B > 0 covers
+	// [2^(B-1), 2^B - 1].
+	void BuildBatchHistograms(
+		const TMap<int32, int32>& AttemptCounts,
+		const TMap<int32, int32>& BacktrackBucketCounts,
+		const TMap<FName, int32>& TileCounts,
+		const int64 TotalSolvedCells,
+		FHexWfcBatchStats& Stats)
+	{
+		TArray<TPair<int32, int32>> AttemptPairs;
+		for (const TPair<int32, int32>& Pair : AttemptCounts)
+		{
+			AttemptPairs.Add(Pair);
+		}
+		AttemptPairs.Sort([](const TPair<int32, int32>& A, const TPair<int32, int32>& B)
+		{
+			return A.Key < B.Key;
+		});
+
+		for (const TPair<int32, int32>& Pair : AttemptPairs)
+		{
+			FHexWfcAttemptHistogramBin Bin;
+			Bin.Attempts = Pair.Key;
+			Bin.Count = Pair.Value;
+			Stats.AttemptHistogram.Add(Bin);
+		}
+
+		TArray<TPair<int32, int32>> BacktrackPairs;
+		for (const TPair<int32, int32>& Pair : BacktrackBucketCounts)
+		{
+			BacktrackPairs.Add(Pair);
+		}
+		BacktrackPairs.Sort([](const TPair<int32, int32>& A, const TPair<int32, int32>& B)
+		{
+			return A.Key < B.Key;
+		});
+
+		for (const TPair<int32, int32>& Pair : BacktrackPairs)
+		{
+			FHexWfcBacktrackHistogramBin Bin;
+			Bin.MinBacktracks = Pair.Key > 0 ? 1 << (Pair.Key - 1) : 0;
+			Bin.MaxBacktracks = Pair.Key > 0 ? (1 << (Pair.Key - 1)) * 2 - 1 : 0;
+			Bin.Count = Pair.Value;
+			Stats.BacktrackHistogram.Add(Bin);
+		}
+
+		TArray<TPair<FName, int32>> TilePairs;
+		for (const TPair<FName, int32>& Pair : TileCounts)
+		{
+			TilePairs.Add(Pair);
+		}
+		TilePairs.Sort([](const TPair<FName, int32>& A, const TPair<FName, int32>& B)
+		{
+			if (A.Value != B.Value)
+			{
+				return A.Value > B.Value;
+			}
+			return A.Key.LexicalLess(B.Key);
+		});
+
+		for (const TPair<FName, int32>& Pair : TilePairs)
+		{
+			FHexWfcTileHistogramBin Bin;
+			Bin.TileId = Pair.Key;
+			Bin.Count = Pair.Value;
+			Bin.Fraction = TotalSolvedCells > 0 ? static_cast<float>(Pair.Value) / static_cast<float>(TotalSolvedCells) : 0.0f;
+			Stats.TileHistogram.Add(Bin);
+		}
+	}
+}
 
 bool FHexWfcGridConfig::EnsureValid(FString& OutError) const
 {
@@ -18,328 +138,2113 @@ bool FHexWfcGridConfig::Contains(const FHexAxialCoord& Coord) const
 	return Coord.Q >= 0 && Coord.Q < Width && Coord.R >= 0 && Coord.R < Height;
 }
 
+void FHexWfcGridConfig::GetCellsInRadius(const FHexAxialCoord& Center, const int32 Radius, TArray<FHexAxialCoord>& OutCoords) const
+{
+	OutCoords.Reset();
+	for (int32 R = FMath::Max(0, Center.R - Radius); R <= FMath::Min(Height - 1, Center.R + Radius); ++R)
+	{
+		for (int32 Q = FMath::Max(0, Center.Q - Radius); Q <= FMath::Min(Width - 1, Center.Q + Radius); ++Q)
+		{
+			const FHexAxialCoord Coord(Q, R);
+			if (Coord.DistanceTo(Center) <= Radius)
+			{
+				OutCoords.Add(Coord);
+			}
+		}
+	}
+}
+
+void FHexWfcSolveProfile::Accumulate(const FHexWfcSolveProfile& Other)
+{
+	PrepareSeconds += Other.PrepareSeconds;
+	InitializeSeconds += Other.InitializeSeconds;
+	CarveSeconds += Other.CarveSeconds;
+	SelectSeconds += Other.SelectSeconds;
+	SampleSeconds += Other.SampleSeconds;
+	PropagateSeconds += Other.PropagateSeconds;
+	ConnectivitySeconds += Other.ConnectivitySeconds;
+	BacktrackSeconds += Other.BacktrackSeconds;
+	ValidateSeconds += Other.ValidateSeconds;
+	PropagationSteps += Other.PropagationSteps;
+	PeakDomainBytes = FMath::Max(PeakDomainBytes, Other.PeakDomainBytes);
+	PeakPropagationQueue = FMath::Max(PeakPropagationQueue, Other.PeakPropagationQueue);
+	PeakUndoTrail = FMath::Max(PeakUndoTrail, Other.PeakUndoTrail);
+}
+
+void FHexWfcSolveProfile::ScalePhases(const float Factor)
+{
+	PrepareSeconds *= Factor;
+	InitializeSeconds *= Factor;
+	CarveSeconds *= Factor;
+	SelectSeconds *= Factor;
+	SampleSeconds *= Factor;
+	PropagateSeconds *= Factor;
+	ConnectivitySeconds *= Factor;
+	BacktrackSeconds *= Factor;
+	ValidateSeconds *= Factor;
+}
+
+void FHexWfcBatchStats::UpdateAverages()
+{
+	if (NumSeedsProcessed <= 0)
+	{
+		ContradictionRate = 0.0f;
+		AverageAttemptsUsed = 0.0f;
+		AverageBacktracks = 0.0f;
+		AverageSolveTimeSeconds = 0.0f;
+		AverageProfile.PropagationSteps = 0;
+		return;
+	}
+
+	const double Seeds = static_cast<double>(NumSeedsProcessed);
+	ContradictionRate = static_cast<float>(NumContradictions / Seeds);
+	AverageAttemptsUsed = static_cast<float>(TotalAttemptsUsed / Seeds);
+	AverageBacktracks = static_cast<float>(TotalBacktracks / Seeds);
+	AverageSolveTimeSeconds = static_cast<float>(TotalSolveTimeSeconds / Seeds);
+	AverageProfile.PropagationSteps = TotalPropagationSteps / NumSeedsProcessed;
+}
+
+void FHexWfcSolver::FCellGrid::Build(const FHexWfcGridConfig& Grid)
+{
+	Width = Grid.Width;
+	Height = Grid.Height;
+	Neighbors.SetNumUninitialized(Num() * 6);
+
+	for (int32 CellIndex = 0; CellIndex < Num(); ++CellIndex)
+	{
+		const FHexAxialCoord Coord = ToCoord(CellIndex);
+		for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
+		{
+			const FHexAxialCoord Neighbor = Coord.Neighbor(HexDirectionFromIndex(DirIndex));
+			Neighbors[CellIndex * 6 + DirIndex] = Contains(Neighbor) ? ToIndex(Neighbor) : INDEX_NONE;
+		}
+	}
+}
+
 FHexWfcSolver::FHexWfcSolver(const FCanalTileCompatibilityTable& InCompatibility)
 	: Compatibility(InCompatibility)
 {
 }
 
-FHexWfcSolveResult FHexWfcSolver::Solve(const FHexWfcGridConfig& Grid, const FHexWfcSolveConfig& Config) const
+SIZE_T FHexWfcSolverWorkspace::GetAllocatedSize() const
+{
+	SIZE_T Size = Context.Cells.Neighbors.GetAllocatedSize()
+		+ Context.TileWeightScales.GetAllocatedSize()
+		+ Context.VariantPickWeights.GetAllocatedSize()
+		+ Context.VariantWeights.GetAllocatedSize()
+		+ Context.VariantWeightLogWeights.GetAllocatedSize()
+		+ Context.ConstrainedCells.GetAllocatedSize()
+		+ Context.ConstrainedMasks.GetAllocatedSize()
+		+ Context.FixedVariants.GetAllocatedSize()
+		+ Context.FrontierCells.GetAllocatedSize()
+		+ Context.WaterSideMasks.GetAllocatedSize()
+		+ Context.WaterCellMask.GetAllocatedSize()
+		+ Context.CarveSideMasks.GetAllocatedSize()
+		+ Context.ConstraintSlotByCell.GetAllocatedSize()
+		+ Context.MultiplierByTileId.GetAllocatedSize()
+		+ Attempts.GetAllocatedSize()
+		+ WaveResults.GetAllocatedSize();
+
+	for (const FHexWfcSolver::FAttemptWorkspace& Attempt : Attempts)
+	{
+		Size += Attempt.States.GetAllocatedSize()
+			+ Attempt.Queue.GetAllocatedSize()
+			+ Attempt.Support.Counts.GetAllocatedSize()
+			+ Attempt.Support.PendingRemovals.GetAllocatedSize()
+			+ Attempt.EntropyHeap.GetAllocatedSize()
+			+ Attempt.Trail.GetAllocatedSize()
+			+ Attempt.Decisions.GetAllocatedSize()
+			+ Attempt.AllowedBits.GetAllocatedSize()
+			+ Attempt.PickCandidates.GetAllocatedSize()
+			+ Attempt.Solved.GetAllocatedSize()
+			+ Attempt.WaterGraph.Sockets.GetAllocatedSize()
+			+ Attempt.WaterGraph.WaterCells.GetAllocatedSize()
+			+ Attempt.WaterGraph.Links.GetAllocatedSize()
+			+ Attempt.WaterGraph.Components.GetAllocatedSize()
+			+ Attempt.WaterGraph.Parents.GetAllocatedSize()
+			+ Attempt.WaterGraph.Queue.GetAllocatedSize()
+			+ Attempt.WaterSides.GetAllocatedSize()
+			+ Attempt.WaterReached.GetAllocatedSize()
+			+ Attempt.ConnectivityQueue.GetAllocatedSize()
+			+ Attempt.ConnectivityChanged.GetAllocatedSize()
+			+ Attempt.PathCosts.GetAllocatedSize()
+			+ Attempt.PathDistances.GetAllocatedSize()
+			+ Attempt.PathParents.GetAllocatedSize()
+			+ Attempt.PathHeap.GetAllocatedSize()
+			+ Attempt.CarvedPath.GetAllocatedSize()
+			+ Attempt.CarvedPathMask.GetAllocatedSize();
+
+		for (const FHexWfcSolver::FCellState& State : Attempt.States)
+		{
+			Size += State.Candidates.GetAllocatedSize() + State.DomainBits.GetAllocatedSize();
+		}
+	}
+
+	return Size;
+}
+
+void FHexWfcSolverWorkspace::Empty()
+{
+	Context.Cells.Neighbors.Empty();
+	Context.TileWeightScales.Empty();
+	Context.VariantPickWeights.Empty();
+	Context.VariantWeights.Empty();
+	Context.VariantWeightLogWeights.Empty();
+	Context.ConstrainedCells.Empty();
+	Context.ConstrainedMasks.Empty();
+	Context.FixedVariants.Empty();
+	Context.FrontierCells.Empty();
+	Context.WaterSideMasks.Empty();
+	Context.WaterCellMask.Empty();
+	Context.CarveSideMasks.Empty();
+	Context.ConstraintSlotByCell.Empty();
+	Context.MultiplierByTileId.Empty();
+	Attempts.Empty();
+	WaveResults.Empty();
+}
+
+FHexWfcSolveResult FHexWfcSolver::Solve(const FHexWfcGridConfig& Grid, const FHexWfcSolveConfig& Config, FHexWfcSolveControl* Control) const
 {
+	FHexWfcSolverWorkspace Workspace;
+	return Solve(Grid, Config, Workspace, Control);
+}
+
+FHexWfcSolveResult FHexWfcSolver::Solve(
+	const FHexWfcGridConfig& Grid,
+	const FHexWfcSolveConfig& Config,
+	FHexWfcSolverWorkspace& Workspace,
+	FHexWfcSolveControl* Control) const
+{
+	// Carving needs both ports. Missing ones are drawn from the seed once and kept for every attempt.
+	if (Config.bCarveEntryExitPath && (!Config.EntryPort.bEnabled || !Config.ExitPort.bEnabled) && Grid.Width > 0 && Grid.Height > 0)
+	{
+		FHexWfcSolveConfig PortConfig = Config;
+		const FCanalCounterRandom PortRandom(Config.Seed, PortStreamId);
+		if (!PortConfig.EntryPort.bEnabled)
+		{
+			PortConfig.EntryPort.bEnabled = true;
+			PortConfig.EntryPort.Coord = FHexAxialCoord(0, PortRandom.RandRange(0, Grid.Height - 1, 0));
+			PortConfig.EntryPort.Direction = EHexDirection::West;
+		}
+		if (!PortConfig.ExitPort.bEnabled)
+		{
+			PortConfig.ExitPort.bEnabled = true;
+			PortConfig.ExitPort.Coord = FHexAxialCoord(Grid.Width - 1, PortRandom.RandRange(0, Grid.Height - 1, 1));
+			PortConfig.ExitPort.Direction = EHexDirection::East;
+		}
+		return Solve(Grid, PortConfig, Workspace, Control);
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_CanalWfc_Solve);
+
 	FHexWfcSolveResult FinalResult;
 	FinalResult.TotalCells = Grid.Width * Grid.Height;
 	FinalResult.BiomeProfile = Config.BiomeProfile;
 
-	FString GridError;
-	if (!Grid.EnsureValid(GridError))
+	const double PrepareStartTime = FPlatformTime::Seconds();
+	FSolveContext& Context = Workspace.Context;
+	Context.Reset(Config);
+	Context.Control = Control;
+	if (!PrepareContext(Grid, Context, FinalResult.Message))
 	{
-		FinalResult.Message = GridError;
+		FinalResult.Profile.PrepareSeconds = static_cast<float>(FPlatformTime::Seconds() - PrepareStartTime);
 		return FinalResult;
 	}
 
-	if (Config.MaxAttempts <= 0)
+	Context.PrepareSeconds = static_cast<float>(FPlatformTime::Seconds() - PrepareStartTime);
+	return RunAttempts(Workspace);
+}
+
+FHexWfcSolveResult FHexWfcSolver::SolveRegion(
+	const FHexWfcGridConfig& Grid,
+	const FHexWfcSolveConfig& Config,
+	const FHexWfcSolveResult& Previous,
+	const TArray<FHexAxialCoord>& Region,
+	FHexWfcSolveControl* Control) const
+{
+	FHexWfcSolverWorkspace Workspace;
+	return SolveRegion(Grid, Config, Previous, Region, Workspace, Control);
+}
+
+FHexWfcSolveResult FHexWfcSolver::SolveRegion(
+	const FHexWfcGridConfig& Grid,
+	const FHexWfcSolveConfig& Config,
+	const FHexWfcSolveResult& Previous,
+	const TArray<FHexAxialCoord>& Region,
+	FHexWfcSolverWorkspace& Workspace,
+	FHexWfcSolveControl* Control) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_CanalWfc_Solve);
+
+	FHexWfcSolveResult FinalResult;
+	FinalResult.TotalCells = Grid.Width * Grid.Height;
+	FinalResult.BiomeProfile = Config.BiomeProfile;
+	const double PrepareStartTime = FPlatformTime::Seconds();
+
+	// Support counters would have to be seeded over the whole grid, which is the cost a region solve exists to avoid.
+	FHexWfcSolveConfig RegionConfig = Config;
+	RegionConfig.Propagator = EHexWfcPropagator::Filter;
+
+	// A path carved through kept cells would contradict them; the region fills around the existing water instead.
+	RegionConfig.bCarveEntryExitPath = false;
+
+	FSolveContext& Context = Workspace.Context;
+	Context.Reset(RegionConfig);
+	Context.Control = Control;
+	if (!PrepareContext(Grid, Context, FinalResult.Message))
 	{
-		FinalResult.Message = TEXT("MaxAttempts must be > 0.");
 		return FinalResult;
 	}
 
-	if (!Compatibility.IsBuilt() || Compatibility.GetAllVariants().Num() == 0)
+	const FCellGrid& Cells = Context.Cells;
+	if (!Previous.bSolved || Previous.Cells.Num() != Cells.Num())
 	{
-		FinalResult.Message = TEXT("Compatibility table is not built or has zero variants.");
+		FinalResult.Message = TEXT("Previous result must be a solved result for this grid.");
 		return FinalResult;
 	}
 
-	int32 MaxTileIndex = INDEX_NONE;
-	for (const FCanalTileVariantKey& Variant : Compatibility.GetAllVariants())
-	{
-		MaxTileIndex = FMath::Max(MaxTileIndex, Variant.TileIndex);
-	}
-	TArray<float> TileWeightScales;
-	if (MaxTileIndex >= 0)
+	Context.FixedVariants.Init(INDEX_NONE, Cells.Num());
+	for (const FHexWfcCellResult& Cell : Previous.Cells)
 	{
-		TileWeightScales.Init(1.0f, MaxTileIndex + 1);
+		FCanalTileVariantKey Key;
+		Key.TileIndex = Cell.Variant.TileIndex;
+		Key.RotationSteps = static_cast<uint8>(Cell.Variant.RotationSteps);
+		const int32 VariantIndex = Cells.Contains(Cell.Coord) ? Compatibility.FindVariantIndex(Key) : INDEX_NONE;
+		if (VariantIndex == INDEX_NONE)
+		{
+			FinalResult.Message = FString::Printf(TEXT("Previous result has no known variant at %s."), *Cell.Coord.ToString());
+			return FinalResult;
+		}
+		Context.FixedVariants[Cells.ToIndex(Cell.Coord)] = VariantIndex;
 	}
 
-	TMap<FName, float> MultiplierByTileId;
-	for (const FHexTileWeightMultiplier& Entry : Config.BiomeWeightMultipliers)
+	for (const FHexAxialCoord& Coord : Region)
 	{
-		if (!Entry.TileId.IsNone())
+		if (!Cells.Contains(Coord))
 		{
-			MultiplierByTileId.Add(Entry.TileId, FMath::Max(0.0f, Entry.Multiplier));
+			FinalResult.Message = FString::Printf(TEXT("Region cell %s is outside the grid."), *Coord.ToString());
+			return FinalResult;
 		}
+		Context.FixedVariants[Cells.ToIndex(Coord)] = INDEX_NONE;
 	}
 
-	for (int32 TileIndex = 0; TileIndex < TileWeightScales.Num(); ++TileIndex)
+	// Kept cells touching the region seed propagation; cells further out can only change through a contradiction.
+	for (int32 CellIndex = 0; CellIndex < Cells.Num(); ++CellIndex)
 	{
-		if (const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(TileIndex))
+		if (Context.FixedVariants[CellIndex] == INDEX_NONE)
 		{
-			if (const float* Multiplier = MultiplierByTileId.Find(Tile->TileId))
+			continue;
+		}
+
+		for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
+		{
+			const int32 Neighbor = Cells.GetNeighbor(CellIndex, DirIndex);
+			if (Neighbor != INDEX_NONE && Context.FixedVariants[Neighbor] == INDEX_NONE)
 			{
-				TileWeightScales[TileIndex] = *Multiplier;
+				Context.FrontierCells.Add(CellIndex);
+				break;
 			}
 		}
 	}
 
-	const double SolveStartTime = FPlatformTime::Seconds();
-	const auto GetElapsedSeconds = [&]() -> float
+	Context.PrepareSeconds = static_cast<float>(FPlatformTime::Seconds() - PrepareStartTime);
+	return RunAttempts(Workspace);
+}
+
+bool FHexWfcSolver::ValidateCells(
+	const FHexWfcGridConfig& Grid,
+	const FHexWfcSolveConfig& Config,
+	const TArray<FHexWfcCellResult>& Cells,
+	FHexBoundaryPort& OutResolvedEntry,
+	FHexBoundaryPort& OutResolvedExit,
+	FHexWfcWaterAnalysis& OutWater,
+	FString& OutError) const
+{
+	if (Grid.Width <= 0 || Grid.Height <= 0)
 	{
-		return static_cast<float>(FPlatformTime::Seconds() - SolveStartTime);
-	};
+		OutError = FString::Printf(TEXT("Grid dimensions must be > 0. Width=%d Height=%d"), Grid.Width, Grid.Height);
+		return false;
+	}
 
-	const auto IsTimeBudgetExceeded = [&](float& OutElapsed) -> bool
+	FCellGrid CellGrid;
+	CellGrid.Build(Grid);
+	if (Cells.Num() != CellGrid.Num())
 	{
-		OutElapsed = GetElapsedSeconds();
-		return Config.MaxSolveTimeSeconds > 0.0f && OutElapsed >= Config.MaxSolveTimeSeconds;
-	};
+		OutError = FString::Printf(TEXT("Expected %d cells for the grid, got %d."), CellGrid.Num(), Cells.Num());
+		return false;
+	}
 
-	FString LastFailure = TEXT("Unknown failure.");
-	bool bAnyContradiction = false;
-	bool bTimeBudgetExceeded = false;
-	bool bAnySingleComponentFailure = false;
-	int32 AttemptsUsed = 0;
+	TArray<FCanalTileVariantKey> Solved;
+	Solved.SetNum(Cells.Num());
+	for (int32 CellIndex = 0; CellIndex < Cells.Num(); ++CellIndex)
+	{
+		FCanalTileVariantKey& Key = Solved[CellIndex];
+		Key.TileIndex = Cells[CellIndex].Variant.TileIndex;
+		Key.RotationSteps = static_cast<uint8>(Cells[CellIndex].Variant.RotationSteps);
+		if (Compatibility.FindVariantIndex(Key) == INDEX_NONE)
+		{
+			OutError = FString::Printf(TEXT("Cell %s has no known variant."), *CellGrid.ToCoord(CellIndex).ToString());
+			return false;
+		}
+	}
+
+	FWaterGraph Graph;
+	bool bFailedSingleWaterComponent = false;
+	OutWater = FHexWfcWaterAnalysis();
+	if (!ValidateSolvedState(CellGrid, Solved, Config, Graph, OutResolvedEntry, OutResolvedExit, OutWater, bFailedSingleWaterComponent, OutError))
+	{
+		return false;
+	}
+
+	FindWaterPath(CellGrid, Graph, OutResolvedEntry, OutResolvedExit, OutWater);
+	return true;
+}
+
+void FHexWfcSolver::FSolveContext::Reset(const FHexWfcSolveConfig& InConfig)
+{
+	Config = &InConfig;
+	bSupportCount = false;
+	bBacktracking = false;
+	bBitsetDomains = false;
+	bWeightedEntropy = false;
+	TileWeightScales.Reset();
+	KernelWords = 0;
+	VariantPickWeights.Reset();
+	FullPickWeight = 0.0f;
+	VariantWeights.Reset();
+	VariantWeightLogWeights.Reset();
+	FullWeightSum = 0;
+	FullWeightLogWeightSum = 0;
+	ConstrainedCells.Reset();
+	ConstrainedMasks.Reset();
+	FixedVariants.Reset();
+	FrontierCells.Reset();
+	bConnectivity = false;
+	bConnectSingleComponent = false;
+	WaterSideMasks.Reset();
+	WaterCellMask.Reset();
+	ConnectivityRootCell = INDEX_NONE;
+	ConnectivityExitCell = INDEX_NONE;
+	bCarvePath = false;
+	CarveEntryCell = INDEX_NONE;
+	CarveEntryDirIndex = INDEX_NONE;
+	CarveExitCell = INDEX_NONE;
+	CarveExitDirIndex = INDEX_NONE;
+	CarveSideMasks.Reset();
+	SolveStartTime = 0.0;
+	PrepareSeconds = 0.0f;
+	Control = nullptr;
+	ProgressAttempt = 1;
+	FirstSolvedAttempt.store(MAX_int32);
+	ConstraintSlotByCell.Reset();
+	MultiplierByTileId.Reset();
+}
+
+bool FHexWfcSolver::PrepareContext(const FHexWfcGridConfig& Grid, FSolveContext& Context, FString& OutError) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_CanalWfc_Prepare);
+	const FHexWfcSolveConfig& Config = *Context.Config;
+
+	if (!Grid.EnsureValid(OutError))
+	{
+		return false;
+	}
+
+	if (Config.MaxAttempts <= 0)
+	{
+		OutError = TEXT("MaxAttempts must be > 0.");
+		return false;
+	}
+
+	if (!Compatibility.IsBuilt() || Compatibility.GetAllVariants().Num() == 0)
+	{
+		OutError = TEXT("Compatibility table is not built or has zero variants.");
+		return false;
+	}
+
+	const bool bSupportCount = Config.Propagator == EHexWfcPropagator::SupportCount;
+	if (bSupportCount && Compatibility.GetNumVariants() > MAX_uint16)
+	{
+		OutError = FString::Printf(TEXT("SupportCount propagation supports at most %d variants."), MAX_uint16);
+		return false;
+	}
 
-	for (int32 Attempt = 1; Attempt <= Config.MaxAttempts; ++Attempt)
+	Context.bSupportCount = bSupportCount;
+	Context.bBacktracking = Config.bEnableBacktracking;
+	Context.bConnectivity = Config.bPropagateConnectivity;
+	Context.bBitsetDomains = bSupportCount || Context.bBacktracking || Context.bConnectivity || Config.DomainMode == EHexWfcDomainMode::Bitset;
+	Context.bWeightedEntropy = Config.EntropyMode == EHexWfcEntropyMode::WeightedShannon;
+	Context.KernelWords = FHexWfcBitsetKernels::SelectFixedWords(Compatibility.GetVariantMaskWordCount());
+	Context.Cells.Build(Grid);
+
+	const int32 NumMaskWords = Compatibility.GetVariantMaskWordCount();
+	const TArray<FCanalTileVariantKey>& Variants = Compatibility.GetAllVariants();
+	TMap<int32, int32>& ConstraintSlotByCell = Context.ConstraintSlotByCell;
+	const auto FindOrAddConstraintMask = [&](const int32 CellIndex) -> uint64*
 	{
-		AttemptsUsed = Attempt;
-		float ElapsedSeconds = 0.0f;
-		if (IsTimeBudgetExceeded(ElapsedSeconds))
+		int32 Slot = INDEX_NONE;
+		if (const int32* ExistingSlot = ConstraintSlotByCell.Find(CellIndex))
 		{
-			bTimeBudgetExceeded = true;
-			LastFailure = FString::Printf(TEXT("Solve time budget exceeded before attempt %d (limit %.3fs)."), Attempt, Config.MaxSolveTimeSeconds);
-			break;
+			Slot = *ExistingSlot;
+		}
+		else
+		{
+			Slot = Context.ConstrainedCells.Add(CellIndex);
+			ConstraintSlotByCell.Add(CellIndex, Slot);
+			Context.ConstrainedMasks.Append(Compatibility.GetAllVariantsMask(), NumMaskWords);
+		}
+		return &Context.ConstrainedMasks[Slot * NumMaskWords];
+	};
+
+	for (const FHexWfcBoundarySocketConstraint& Constraint : Config.BoundarySocketConstraints)
+	{
+		if (!Context.Cells.Contains(Constraint.Coord))
+		{
+			OutError = FString::Printf(TEXT("Boundary socket constraint at %s is outside the grid."), *Constraint.Coord.ToString());
+			return false;
 		}
 
-		TMap<FHexAxialCoord, FCellState> States;
-		States.Reserve(FinalResult.TotalCells);
-		for (int32 R = 0; R < Grid.Height; ++R)
+		uint64* Mask = FindOrAddConstraintMask(Context.Cells.ToIndex(Constraint.Coord));
+		for (int32 VariantIndex = 0; VariantIndex < Variants.Num(); ++VariantIndex)
 		{
-			for (int32 Q = 0; Q < Grid.Width; ++Q)
+			const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(Variants[VariantIndex].TileIndex);
+			if (!Tile || Tile->GetSocket(Constraint.Direction, Variants[VariantIndex].RotationSteps) != Constraint.Socket)
 			{
-				FCellState Cell;
-				Cell.Candidates = Compatibility.GetAllVariants();
-				States.Add(FHexAxialCoord(Q, R), MoveTemp(Cell));
+				Mask[VariantIndex / 64] &= ~(uint64(1) << (VariantIndex % 64));
 			}
 		}
+	}
 
-		FRandomStream Random(Config.Seed + (Attempt - 1) * 7919);
-		FHexWfcSolveResult AttemptResult;
-		AttemptResult.TotalCells = FinalResult.TotalCells;
-		AttemptResult.AttemptsUsed = Attempt;
-		AttemptResult.BiomeProfile = Config.BiomeProfile;
+	for (const FHexWfcPinnedCell& Pin : Config.PinnedCells)
+	{
+		if (!Context.Cells.Contains(Pin.Coord))
+		{
+			OutError = FString::Printf(TEXT("Pinned cell %s is outside the grid."), *Pin.Coord.ToString());
+			return false;
+		}
 
-		bool bAttemptContradiction = false;
+		if (Pin.AllowedTileIds.Num() == 0)
+		{
+			OutError = FString::Printf(TEXT("Pinned cell %s allows no tiles."), *Pin.Coord.ToString());
+			return false;
+		}
 
-		while (true)
+		for (const int32 Rotation : Pin.AllowedRotations)
 		{
-			if (IsTimeBudgetExceeded(ElapsedSeconds))
+			if (Rotation < 0 || Rotation > 5)
 			{
-				bAttemptContradiction = true;
-				bTimeBudgetExceeded = true;
-				AttemptResult.bTimeBudgetExceeded = true;
-				AttemptResult.Message = FString::Printf(TEXT("Solve time budget exceeded (limit %.3fs)."), Config.MaxSolveTimeSeconds);
-				break;
+				OutError = FString::Printf(TEXT("Pinned cell %s allows rotation %d; rotations are 0-5."), *Pin.Coord.ToString(), Rotation);
+				return false;
 			}
+		}
 
-			FHexAxialCoord TargetCell;
-			int32 Entropy = 0;
-			if (!SelectLowestEntropyCell(States, TargetCell, Entropy))
+		for (const FName& TileId : Pin.AllowedTileIds)
+		{
+			const bool bKnownTile = Variants.ContainsByPredicate([this, &TileId](const FCanalTileVariantKey& Variant)
 			{
-				break;
+				const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(Variant.TileIndex);
+				return Tile && Tile->TileId == TileId;
+			});
+			if (!bKnownTile)
+			{
+				OutError = FString::Printf(TEXT("Pinned cell %s allows tile '%s', which is not in the tile set."), *Pin.Coord.ToString(), *TileId.ToString());
+				return false;
 			}
+		}
 
-			FCellState& TargetState = States[TargetCell];
-			const FCanalTileVariantKey Picked = ChooseVariant(TargetState.Candidates, Random, TileWeightScales);
-			TargetState.Candidates = {Picked};
+		// Folded variants stand for several rotations; one allowed rotation among them keeps the variant.
+		uint64* Mask = FindOrAddConstraintMask(Context.Cells.ToIndex(Pin.Coord));
+		for (int32 VariantIndex = 0; VariantIndex < Variants.Num(); ++VariantIndex)
+		{
+			const FCanalTileVariantKey& Variant = Variants[VariantIndex];
+			const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(Variant.TileIndex);
+			bool bAllowed = Tile && Pin.AllowedTileIds.Contains(Tile->TileId);
+			if (bAllowed && Pin.AllowedRotations.Num() > 0)
+			{
+				bAllowed = Pin.AllowedRotations.ContainsByPredicate([this, &Variant, VariantIndex](const int32 Rotation)
+				{
+					FCanalTileVariantKey RotatedKey;
+					RotatedKey.TileIndex = Variant.TileIndex;
+					RotatedKey.RotationSteps = static_cast<uint8>(Rotation);
+					return Compatibility.FindVariantIndex(RotatedKey) == VariantIndex;
+				});
+			}
 
-			TQueue<FHexAxialCoord> Queue;
-			Queue.Enqueue(TargetCell);
+			if (!bAllowed)
+			{
+				Mask[VariantIndex / 64] &= ~(uint64(1) << (VariantIndex % 64));
+			}
+		}
+	}
 
-			while (!Queue.IsEmpty())
+	if (Config.bCarveEntryExitPath)
+	{
+		const auto FindPortCell = [&Context](const FHexBoundaryPort& Port, int32& OutCell, int32& OutDirIndex) -> bool
+		{
+			if (!Port.bEnabled || !Context.Cells.Contains(Port.Coord))
 			{
-				if (IsTimeBudgetExceeded(ElapsedSeconds))
-				{
-					bAttemptContradiction = true;
-					bTimeBudgetExceeded = true;
-					AttemptResult.bTimeBudgetExceeded = true;
-					AttemptResult.Message = FString::Printf(TEXT("Solve time budget exceeded (limit %.3fs)."), Config.MaxSolveTimeSeconds);
-					break;
-				}
+				return false;
+			}
+			OutCell = Context.Cells.ToIndex(Port.Coord);
+			OutDirIndex = HexDirectionToIndex(Port.Direction);
+			return Context.Cells.GetNeighbor(OutCell, OutDirIndex) == INDEX_NONE;
+		};
 
-				if (AttemptResult.PropagationSteps >= Config.MaxPropagationSteps)
-				{
-					bAttemptContradiction = true;
-					AttemptResult.bContradiction = true;
-					AttemptResult.Message = FString::Printf(TEXT("Exceeded propagation budget (%d)."), Config.MaxPropagationSteps);
-					break;
-				}
+		if (!FindPortCell(Config.EntryPort, Context.CarveEntryCell, Context.CarveEntryDirIndex)
+			|| !FindPortCell(Config.ExitPort, Context.CarveExitCell, Context.CarveExitDirIndex))
+		{
+			OutError = TEXT("bCarveEntryExitPath needs entry and exit ports on grid cells, facing out of the grid.");
+			return false;
+		}
 
-				FHexAxialCoord Current;
-				Queue.Dequeue(Current);
-				const TArray<FCanalTileVariantKey>& CurrentCandidates = States[Current].Candidates;
+		Context.bCarvePath = true;
+		Context.CarveSideMasks.SetNumUninitialized(6 * NumMaskWords);
+		for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
+		{
+			const uint64* WaterMask = Compatibility.GetSocketVariantMask(DirIndex, static_cast<int32>(ECanalSocketType::Water));
+			const uint64* LockMask = Compatibility.GetSocketVariantMask(DirIndex, static_cast<int32>(ECanalSocketType::Lock));
+			for (int32 WordIndex = 0; WordIndex < NumMaskWords; ++WordIndex)
+			{
+				Context.CarveSideMasks[DirIndex * NumMaskWords + WordIndex] = WaterMask[WordIndex] | LockMask[WordIndex];
+			}
+		}
+	}
 
-				for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
+	if (Context.bConnectivity)
+	{
+		Context.WaterSideMasks.Init(0, 12 * NumMaskWords);
+		Context.WaterCellMask.Init(0, NumMaskWords);
+		for (int32 VariantIndex = 0; VariantIndex < Variants.Num(); ++VariantIndex)
+		{
+			const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(Variants[VariantIndex].TileIndex);
+			for (int32 DirIndex = 0; Tile && DirIndex < 6; ++DirIndex)
+			{
+				const ECanalSocketType Socket = Tile->GetSocket(HexDirectionFromIndex(DirIndex), Variants[VariantIndex].RotationSteps);
+				if (IsWaterLikeSocket(Socket))
 				{
-					const EHexDirection Direction = HexDirectionFromIndex(DirIndex);
-					const FHexAxialCoord Neighbor = Current.Neighbor(Direction);
+					const int32 Slot = Socket == ECanalSocketType::Water ? 0 : 1;
+					const uint64 Bit = uint64(1) << (VariantIndex % 64);
+					Context.WaterSideMasks[(DirIndex * 2 + Slot) * NumMaskWords + VariantIndex / 64] |= Bit;
+					Context.WaterCellMask[VariantIndex / 64] |= Bit;
+				}
+			}
+		}
 
-					FCellState* NeighborState = States.Find(Neighbor);
-					if (!NeighborState)
-					{
-						continue;
+		// Validation rejects any enabled port whose cell does not face water on the port side. Malformed ports are
+		// left to validation so they keep their existing error messages.
+		const auto ConstrainPort = [&](const FHexBoundaryPort& Port) -> int32
+		{
+			if (!Port.bEnabled || !Context.Cells.Contains(Port.Coord))
+			{
+				return INDEX_NONE;
+			}
+
+			const int32 CellIndex = Context.Cells.ToIndex(Port.Coord);
+			const int32 DirIndex = HexDirectionToIndex(Port.Direction);
+			if (Context.Cells.GetNeighbor(CellIndex, DirIndex) != INDEX_NONE)
+			{
+				return INDEX_NONE;
+			}
+
+			uint64* Mask = FindOrAddConstraintMask(CellIndex);
+			const uint64* WaterMask = &Context.WaterSideMasks[DirIndex * 2 * NumMaskWords];
+			const uint64* LockMask = &Context.WaterSideMasks[(DirIndex * 2 + 1) * NumMaskWords];
+			for (int32 WordIndex = 0; WordIndex < NumMaskWords; ++WordIndex)
+			{
+				Mask[WordIndex] &= WaterMask[WordIndex] | LockMask[WordIndex];
+			}
+			return CellIndex;
+		};
+
+		const int32 EntryCell = ConstrainPort(Config.EntryPort);
+		const int32 ExitCell = ConstrainPort(Config.ExitPort);
+		Context.bConnectSingleComponent = Config.bRequireSingleWaterComponent;
+		Context.ConnectivityRootCell = EntryCell != INDEX_NONE ? EntryCell : ExitCell;
+		if (Config.bRequireEntryExitPath && EntryCell != INDEX_NONE && ExitCell != INDEX_NONE && EntryCell != ExitCell)
+		{
+			Context.ConnectivityExitCell = ExitCell;
+		}
+	}
+
+	int32 MaxTileIndex = INDEX_NONE;
+	for (const FCanalTileVariantKey& Variant : Compatibility.GetAllVariants())
+	{
+		MaxTileIndex = FMath::Max(MaxTileIndex, Variant.TileIndex);
+	}
+	TArray<float>& TileWeightScales = Context.TileWeightScales;
+	if (MaxTileIndex >= 0)
+	{
+		TileWeightScales.Init(1.0f, MaxTileIndex + 1);
+	}
+
+	TMap<FName, float>& MultiplierByTileId = Context.MultiplierByTileId;
+	for (const FHexTileWeightMultiplier& Entry : Config.BiomeWeightMultipliers)
+	{
+		if (!Entry.TileId.IsNone())
+		{
+			MultiplierByTileId.Add(Entry.TileId, FMath::Max(0.0f, Entry.Multiplier));
+		}
+	}
+
+	for (int32 TileIndex = 0; TileIndex < TileWeightScales.Num(); ++TileIndex)
+	{
+		if (const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(TileIndex))
+		{
+			if (const float* Multiplier = MultiplierByTileId.Find(Tile->TileId))
+			{
+				TileWeightScales[TileIndex] = *Multiplier;
+			}
+		}
+	}
+
+	const TArray<FCanalTileVariantKey>& AllVariants = Compatibility.GetAllVariants();
+	Context.VariantPickWeights.SetNumUninitialized(AllVariants.Num());
+	for (int32 VariantIndex = 0; VariantIndex < AllVariants.Num(); ++VariantIndex)
+	{
+		const int32 TileIndex = AllVariants[VariantIndex].TileIndex;
+		const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(TileIndex);
+		const float Scale = TileWeightScales.IsValidIndex(TileIndex) ? FMath::Max(0.0f, TileWeightScales[TileIndex]) : 1.0f;
+		const float Multiplicity = static_cast<float>(Compatibility.GetVariantMultiplicity(VariantIndex));
+		Context.VariantPickWeights[VariantIndex] = Tile ? FMath::Max(0.0f, Tile->Weight) * Scale * Multiplicity : 0.0f;
+		Context.FullPickWeight += Context.VariantPickWeights[VariantIndex];
+	}
+
+	if (Context.bWeightedEntropy)
+	{
+		Context.VariantWeights.SetNumUninitialized(AllVariants.Num());
+		Context.VariantWeightLogWeights.SetNumUninitialized(AllVariants.Num());
+		for (int32 VariantIndex = 0; VariantIndex < AllVariants.Num(); ++VariantIndex)
+		{
+			const double Weight = static_cast<double>(Context.VariantPickWeights[VariantIndex]);
+			Context.VariantWeights[VariantIndex] = static_cast<int64>(FMath::RoundToDouble(Weight * EntropyWeightScale));
+			const double QuantizedWeight = static_cast<double>(Context.VariantWeights[VariantIndex]) / EntropyWeightScale;
+			Context.VariantWeightLogWeights[VariantIndex] = QuantizedWeight > 0.0
+				? static_cast<int64>(FMath::RoundToDouble(QuantizedWeight * FMath::Loge(QuantizedWeight) * EntropyWeightScale))
+				: 0;
+			Context.FullWeightSum += Context.VariantWeights[VariantIndex];
+			Context.FullWeightLogWeightSum += Context.VariantWeightLogWeights[VariantIndex];
+		}
+	}
+
+	return true;
+}
+
+FHexWfcSolveResult FHexWfcSolver::RunAttempts(FHexWfcSolverWorkspace& Workspace) const
+{
+	FSolveContext& Context = Workspace.Context;
+	const FHexWfcSolveConfig& Config = *Context.Config;
+	Context.SolveStartTime = FPlatformTime::Seconds();
+
+	// Attempts run in waves of SpeculativeAttempts. Folding each wave in attempt order reproduces the serial restart
+	// loop exactly; attempts above the first success are cancelled and never folded.
+	const int32 WaveSize = FMath::Clamp(Config.SpeculativeAttempts, 1, Config.MaxAttempts);
+	TArray<FAttemptWorkspace>& Workspaces = Workspace.Attempts;
+	if (Workspaces.Num() < WaveSize)
+	{
+		Workspaces.SetNum(WaveSize);
+	}
+	TArray<FHexWfcSolveResult>& WaveResults = Workspace.WaveResults;
+
+	FString LastFailure = TEXT("Unknown failure.");
+	bool bAnyContradiction = false;
+	bool bTimeBudgetExceeded = false;
+	bool bAnySingleComponentFailure = false;
+	bool bCancelled = false;
+	bool bConstraintsInfeasible = false;
+	int32 AttemptsUsed = 0;
+	int32 TotalBacktracks = 0;
+	FHexWfcSolveProfile Profile;
+	Profile.PrepareSeconds = Context.PrepareSeconds;
+
+	for (int32 FirstAttempt = 1; FirstAttempt <= Config.MaxAttempts && !bTimeBudgetExceeded && !bCancelled && !bConstraintsInfeasible; FirstAttempt += WaveSize)
+	{
+		const int32 NumInWave = FMath::Min(WaveSize, Config.MaxAttempts - FirstAttempt + 1);
+		Context.ProgressAttempt = FirstAttempt;
+		WaveResults.Reset();
+		WaveResults.SetNum(NumInWave);
+		if (NumInWave == 1)
+		{
+			WaveResults[0] = SolveAttempt(Context, Workspaces[0], FirstAttempt);
+		}
+		else
+		{
+			ParallelFor(NumInWave, [&](const int32 WaveIndex)
+			{
+				WaveResults[WaveIndex] = SolveAttempt(Context, Workspaces[WaveIndex], FirstAttempt + WaveIndex);
+			});
+		}
+
+		// The profile covers every attempt that ran, including speculative ones past the first success.
+		for (int32 WaveIndex = 0; WaveIndex < NumInWave; ++WaveIndex)
+		{
+			AccumulateAttemptProfile(Context, Workspaces[WaveIndex], Profile);
+			Profile.PropagationSteps += WaveResults[WaveIndex].PropagationSteps;
+		}
+
+		for (FHexWfcSolveResult& AttemptResult : WaveResults)
+		{
+			AttemptsUsed = AttemptResult.AttemptsUsed;
+			TotalBacktracks += AttemptResult.Backtracks;
+			if (AttemptResult.bSolved)
+			{
+				AttemptResult.Backtracks = TotalBacktracks;
+				AttemptResult.Profile = Profile;
+				return MoveTemp(AttemptResult);
+			}
+
+			bAnyContradiction |= AttemptResult.bContradiction;
+			bAnySingleComponentFailure |= AttemptResult.bFailedSingleWaterComponent;
+			LastFailure = AttemptResult.Message;
+			if (AttemptResult.bCancelled)
+			{
+				bCancelled = true;
+				break;
+			}
+			if (AttemptResult.bTimeBudgetExceeded)
+			{
+				bTimeBudgetExceeded = true;
+				break;
+			}
+			if (AttemptResult.bConstraintsInfeasible)
+			{
+				bConstraintsInfeasible = true;
+				break;
+			}
+		}
+	}
+
+	FHexWfcSolveResult FinalResult;
+	FinalResult.TotalCells = Context.Cells.Num();
+	FinalResult.BiomeProfile = Config.BiomeProfile;
+	FinalResult.bSolved = false;
+	FinalResult.bContradiction = bAnyContradiction;
+	FinalResult.bTimeBudgetExceeded = bTimeBudgetExceeded;
+	FinalResult.bFailedSingleWaterComponent = bAnySingleComponentFailure;
+	FinalResult.bCancelled = bCancelled;
+	FinalResult.bConstraintsInfeasible = bConstraintsInfeasible;
+	FinalResult.AttemptsUsed = AttemptsUsed;
+	FinalResult.Backtracks = TotalBacktracks;
+	FinalResult.Message = LastFailure;
+	FinalResult.SolveTimeSeconds = static_cast<float>(FPlatformTime::Seconds() - Context.SolveStartTime);
+	FinalResult.Profile = Profile;
+	return FinalResult;
+}
+
+void FHexWfcSolver::FPhaseClock::Reset(const EAttemptPhase Phase)
+{
+	FMemory::Memzero(Cycles, sizeof(Cycles));
+	Current = Phase;
+	Mark = FPlatformTime::Cycles64();
+}
+
+void FHexWfcSolver::AccumulateAttemptProfile(const FSolveContext& Context, const FAttemptWorkspace& Workspace, FHexWfcSolveProfile& InOutProfile)
+{
+	const auto GetPhaseSeconds = [&Workspace](const EAttemptPhase Phase) -> float
+	{
+		return static_cast<float>(FPlatformTime::ToSeconds64(Workspace.PhaseClock.Cycles[static_cast<int32>(Phase)]));
+	};
+
+	FHexWfcSolveProfile AttemptProfile;
+	AttemptProfile.InitializeSeconds = GetPhaseSeconds(EAttemptPhase::Initialize);
+	AttemptProfile.CarveSeconds = GetPhaseSeconds(EAttemptPhase::Carve);
+	AttemptProfile.SelectSeconds = GetPhaseSeconds(EAttemptPhase::Select);
+	AttemptProfile.SampleSeconds = GetPhaseSeconds(EAttemptPhase::Sample);
+	AttemptProfile.PropagateSeconds = GetPhaseSeconds(EAttemptPhase::Propagate);
+	AttemptProfile.ConnectivitySeconds = GetPhaseSeconds(EAttemptPhase::Connectivity);
+	AttemptProfile.BacktrackSeconds = GetPhaseSeconds(EAttemptPhase::Backtrack);
+	AttemptProfile.ValidateSeconds = GetPhaseSeconds(EAttemptPhase::Validate);
+	AttemptProfile.PeakPropagationQueue = Workspace.PeakPropagationQueue;
+	AttemptProfile.PeakUndoTrail = Workspace.PeakUndoTrail;
+
+	// Only the buffers of the active domain mode count; the other mode's arrays keep capacity from earlier solves.
+	// Domains start full and only shrink within an attempt, and support counts are sized once, so apart from the
+	// trail the end-of-attempt sizes are the peak.
+	int64 DomainBytes = static_cast<int64>(Workspace.States.Num()) * sizeof(FCellState);
+	for (const FCellState& State : Workspace.States)
+	{
+		DomainBytes += Context.bBitsetDomains ? State.DomainBits.GetAllocatedSize() : State.Candidates.GetAllocatedSize();
+	}
+	if (Context.bSupportCount)
+	{
+		DomainBytes += static_cast<int64>(Workspace.Support.Counts.Num()) * sizeof(uint16);
+	}
+	DomainBytes += static_cast<int64>(Workspace.PeakUndoTrail) * sizeof(TPair<int32, int32>);
+	AttemptProfile.PeakDomainBytes = DomainBytes;
+
+	InOutProfile.Accumulate(AttemptProfile);
+}
+
+template <int32 FixedWords>
+FHexWfcSolveResult FHexWfcSolver::SolveAttemptImpl(const FSolveContext& Context, FAttemptWorkspace& Workspace, const int32 Attempt) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_CanalWfc_Attempt);
+	using FKernels = THexWfcBitsetKernels<FixedWords>;
+
+	// Time outside the phases below counts as initialization; the outer scope charges the last stretch on return.
+	FPhaseClock& PhaseClock = Workspace.PhaseClock;
+	PhaseClock.Reset(EAttemptPhase::Initialize);
+	const FScopedPhase AttemptPhase(PhaseClock, EAttemptPhase::Initialize);
+	Workspace.PeakPropagationQueue = 0;
+	Workspace.PeakUndoTrail = 0;
+
+	const FHexWfcSolveConfig& Config = *Context.Config;
+	const FCellGrid& Cells = Context.Cells;
+	const int32 NumCells = Cells.Num();
+	const bool bSupportCount = Context.bSupportCount;
+	const bool bBacktracking = Context.bBacktracking;
+	const bool bBitsetDomains = Context.bBitsetDomains;
+	const bool bWeightedEntropy = Context.bWeightedEntropy;
+	// A compile-time constant when specialized, so every word loop below has a fixed trip count.
+	const int32 NumMaskWords = FKernels::GetNumWords(Compatibility);
+	const TArray<FCanalTileVariantKey>& AllVariants = Compatibility.GetAllVariants();
+	const TArray<float>& TileWeightScales = Context.TileWeightScales;
+	const TArray<int64>& VariantWeights = Context.VariantWeights;
+	const TArray<int64>& VariantWeightLogWeights = Context.VariantWeightLogWeights;
+
+	TArray<FCellState>& States = Workspace.States;
+	TArray<int32>& Queue = Workspace.Queue;
+	FSupportState& Support = Workspace.Support;
+	FEntropyHeap& EntropyHeap = Workspace.EntropyHeap;
+	TArray<TPair<int32, int32>>& Trail = Workspace.Trail;
+	TArray<FBacktrackDecision>& Decisions = Workspace.Decisions;
+	TArray<uint64, TInlineAllocator<4>>& AllowedBits = Workspace.AllowedBits;
+	AllowedBits.SetNumUninitialized(NumMaskWords);
+	TArray<FCanalTileVariantKey>& PickCandidates = Workspace.PickCandidates;
+	TArray<FCanalTileVariantKey>& Solved = Workspace.Solved;
+
+	const auto GetElapsedSeconds = [&]() -> float
+	{
+		return static_cast<float>(FPlatformTime::Seconds() - Context.SolveStartTime);
+	};
+
+	const auto IsTimeBudgetExceeded = [&](float& OutElapsed) -> bool
+	{
+		OutElapsed = GetElapsedSeconds();
+		return Config.MaxSolveTimeSeconds > 0.0f && OutElapsed >= Config.MaxSolveTimeSeconds;
+	};
+
+	const auto IsCancelled = [&]() -> bool
+	{
+		return Context.FirstSolvedAttempt.load(std::memory_order_relaxed) < Attempt
+			|| (Context.Control && Context.Control->IsCancelRequested());
+	};
+
+	// Brings a cell's heap entry in line with its domain after propagation changed it.
+	const auto RefreshCellEntropy = [&](const int32 CellIndex)
+	{
+		FCellState& State = States[CellIndex];
+		if (State.NumCandidates() <= 1)
+		{
+			EntropyHeap.Remove(CellIndex);
+			return;
+		}
+
+		if (bWeightedEntropy && !bBitsetDomains)
+		{
+			State.WeightSum = 0;
+			State.WeightLogWeightSum = 0;
+			for (const FCanalTileVariantKey& Candidate : State.Candidates)
+			{
+				const int32 VariantIndex = Compatibility.FindVariantIndex(Candidate);
+				State.WeightSum += VariantWeights[VariantIndex];
+				State.WeightLogWeightSum += VariantWeightLogWeights[VariantIndex];
+			}
+		}
+
+		EntropyHeap.Set(CellIndex, ComputeCellEntropy(State, bWeightedEntropy));
+	};
+
+	FHexWfcSolveResult AttemptResult;
+	AttemptResult.TotalCells = NumCells;
+	AttemptResult.AttemptsUsed = Attempt;
+	AttemptResult.BiomeProfile = Config.BiomeProfile;
+
+	float ElapsedSeconds = 0.0f;
+	if (IsTimeBudgetExceeded(ElapsedSeconds))
+	{
+		AttemptResult.bTimeBudgetExceeded = true;
+		AttemptResult.Message = FString::Printf(TEXT("Solve time budget exceeded before attempt %d (limit %.3fs)."), Attempt, Config.MaxSolveTimeSeconds);
+		return AttemptResult;
+	}
+
+	// States are reset in place: a copy of the full domain into buffers kept from earlier attempts and solves.
+	States.SetNum(NumCells);
+	for (FCellState& Cell : States)
+	{
+		if (bBitsetDomains)
+		{
+			Cell.DomainBits.SetNumUninitialized(NumMaskWords, EAllowShrinking::No);
+			FMemory::Memcpy(Cell.DomainBits.GetData(), Compatibility.GetAllVariantsMask(), NumMaskWords * sizeof(uint64));
+			Cell.DomainCount = Compatibility.GetNumVariants();
+			Cell.Candidates.Reset();
+		}
+		else
+		{
+			Cell.Candidates.Reset();
+			Cell.Candidates.Append(AllVariants);
+			Cell.DomainBits.Reset();
+		}
+		Cell.WeightSum = Context.FullWeightSum;
+		Cell.WeightLogWeightSum = Context.FullWeightLogWeightSum;
+	}
+
+	EntropyHeap.Build(AllVariants.Num() > 1 ? NumCells : 0, NumCells > 0 ? ComputeCellEntropy(States[0], bWeightedEntropy) : 0.0);
+
+	// Region solves start with every kept cell collapsed to its previous variant.
+	for (int32 CellIndex = 0; CellIndex < Context.FixedVariants.Num(); ++CellIndex)
+	{
+		const int32 FixedVariant = Context.FixedVariants[CellIndex];
+		if (FixedVariant == INDEX_NONE)
+		{
+			continue;
+		}
+
+		FCellState& State = States[CellIndex];
+		if (bBitsetDomains)
+		{
+			FMemory::Memzero(State.DomainBits.GetData(), NumMaskWords * sizeof(uint64));
+			State.DomainBits[FixedVariant / 64] = uint64(1) << (FixedVariant % 64);
+			State.DomainCount = 1;
+		}
+		else
+		{
+			State.Candidates.Reset();
+			State.Candidates.Add(AllVariants[FixedVariant]);
+		}
+		EntropyHeap.Remove(CellIndex);
+	}
+
+	const FCanalCounterRandom Random = FCanalCounterRandom(Config.Seed, PickStreamId).Substream(static_cast<uint32>(Attempt));
+
+	bool bAttemptContradiction = false;
+
+	// Every domain removal since the first decision, oldest first. SupportCount reuses its pending list, which
+	// already holds every removal in order; Filter only records removals when backtracking.
+	TArray<TPair<int32, int32>>& Removals = bSupportCount ? Support.PendingRemovals : Trail;
+	Trail.Reset();
+	Decisions.Reset();
+	int32 PendingHead = 0;
+
+	// Runs the propagator over the removals made since RemovalMark (SupportCount) or from SourceCell (Filter),
+	// then re-keys every cell it touched. Untouched cells keep their heap slot.
+	const auto PropagateChanges = [&](const int32 SourceCell, const int32 RemovalMark) -> EPropagationOutcome
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(CanalWfc_Propagate, CanalWfcChannel);
+		const FScopedPhase PropagatePhase(PhaseClock, EAttemptPhase::Propagate);
+
+		Queue.Reset();
+		Queue.Add(SourceCell);
+		int32 QueueHead = 0;
+
+		while (bSupportCount ? PendingHead < Support.PendingRemovals.Num() : QueueHead < Queue.Num())
+		{
+			Workspace.PeakPropagationQueue = FMath::Max(
+				Workspace.PeakPropagationQueue, bSupportCount ? Support.PendingRemovals.Num() - PendingHead : Queue.Num() - QueueHead);
+
+			if (IsTimeBudgetExceeded(ElapsedSeconds))
+			{
+				AttemptResult.bTimeBudgetExceeded = true;
+				AttemptResult.Message = FString::Printf(TEXT("Solve time budget exceeded (limit %.3fs)."), Config.MaxSolveTimeSeconds);
+				return EPropagationOutcome::BudgetExceeded;
+			}
+
+			if (IsCancelled())
+			{
+				return EPropagationOutcome::Cancelled;
+			}
+
+			if (AttemptResult.PropagationSteps >= Config.MaxPropagationSteps)
+			{
+				AttemptResult.bContradiction = true;
+				AttemptResult.Message = FString::Printf(TEXT("Exceeded propagation budget (%d)."), Config.MaxPropagationSteps);
+				return EPropagationOutcome::BudgetExceeded;
+			}
+
+			if (bSupportCount)
+			{
+				const TPair<int32, int32> Removal = Support.PendingRemovals[PendingHead++];
+				int32 ContradictionCell = INDEX_NONE;
+				if (!WithdrawSupports(Cells, States, Support, Removal, ContradictionCell))
+				{
+					AttemptResult.Message = FString::Printf(
+						TEXT("Contradiction at %s when propagating from %s."),
+						*Cells.ToCoord(ContradictionCell).ToString(),
+						*Cells.ToCoord(Removal.Key).ToString());
+					return EPropagationOutcome::Contradiction;
+				}
+
+				++AttemptResult.PropagationSteps;
+				continue;
+			}
+
+			const int32 Current = Queue[QueueHead++];
+			const FCellState& CurrentState = States[Current];
+			const TArray<FCanalTileVariantKey>& CurrentCandidates = CurrentState.Candidates;
+
+			for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
+			{
+				const int32 Neighbor = Cells.GetNeighbor(Current, DirIndex);
+				if (Neighbor == INDEX_NONE)
+				{
+					continue;
+				}
+
+				const EHexDirection Direction = HexDirectionFromIndex(DirIndex);
+				FCellState& NeighborState = States[Neighbor];
+
+				if (bBitsetDomains)
+				{
+					// Reduce the current domain to the socket types it can still show on this side; the neighbour keeps the
+					// variants showing one of them back. Cost is per socket type, not per variant in the domain.
+					const int32 FilteredCount = FKernels::Revise(
+						Compatibility, CurrentState.DomainBits.GetData(), NeighborState.DomainBits.GetData(), DirIndex, AllowedBits.GetData());
+
+					if (FilteredCount == 0)
+					{
+						AttemptResult.Message = FString::Printf(
+							TEXT("Contradiction at %s when propagating from %s."),
+							*Cells.ToCoord(Neighbor).ToString(),
+							*Cells.ToCoord(Current).ToString());
+						return EPropagationOutcome::Contradiction;
+					}
+
+					if (FilteredCount != NeighborState.DomainCount)
+					{
+						for (int32 WordIndex = 0; WordIndex < NumMaskWords; ++WordIndex)
+						{
+							if (bWeightedEntropy || bBacktracking)
+							{
+								uint64 Removed = NeighborState.DomainBits[WordIndex] & ~AllowedBits[WordIndex];
+								while (Removed != 0)
+								{
+									const int32 VariantIndex = WordIndex * 64 + static_cast<int32>(FMath::CountTrailingZeros64(Removed));
+									Removed &= Removed - 1;
+									if (bWeightedEntropy)
+									{
+										NeighborState.WeightSum -= VariantWeights[VariantIndex];
+										NeighborState.WeightLogWeightSum -= VariantWeightLogWeights[VariantIndex];
+									}
+									if (bBacktracking)
+									{
+										Trail.Emplace(Neighbor, VariantIndex);
+									}
+								}
+							}
+							NeighborState.DomainBits[WordIndex] &= AllowedBits[WordIndex];
+						}
+						NeighborState.DomainCount = FilteredCount;
+						Queue.Add(Neighbor);
+					}
+
+					++AttemptResult.PropagationSteps;
+					continue;
+				}
+
+				// Filtered in place; the removed candidates are not needed again this attempt.
+				const int32 PreviousCount = NeighborState.Candidates.Num();
+				NeighborState.Candidates.RemoveAll([this, &CurrentCandidates, Direction](const FCanalTileVariantKey& Candidate)
+				{
+					return !IsVariantAllowedByAnySource(Candidate, CurrentCandidates, Direction);
+				});
+
+				if (NeighborState.Candidates.Num() == 0)
+				{
+					AttemptResult.Message = FString::Printf(
+						TEXT("Contradiction at %s when propagating from %s."),
+						*Cells.ToCoord(Neighbor).ToString(),
+						*Cells.ToCoord(Current).ToString());
+					return EPropagationOutcome::Contradiction;
+				}
+
+				if (NeighborState.Candidates.Num() != PreviousCount)
+				{
+					Queue.Add(Neighbor);
+				}
+
+				++AttemptResult.PropagationSteps;
+			}
+		}
+
+		if (bSupportCount)
+		{
+			for (int32 RemovalIndex = RemovalMark; RemovalIndex < Support.PendingRemovals.Num(); ++RemovalIndex)
+			{
+				const TPair<int32, int32>& Removal = Support.PendingRemovals[RemovalIndex];
+				if (bWeightedEntropy)
+				{
+					States[Removal.Key].WeightSum -= VariantWeights[Removal.Value];
+					States[Removal.Key].WeightLogWeightSum -= VariantWeightLogWeights[Removal.Value];
+				}
+				RefreshCellEntropy(Removal.Key);
+			}
+		}
+		else
+		{
+			for (const int32 CellIndex : Queue)
+			{
+				RefreshCellEntropy(CellIndex);
+			}
+		}
+
+		return EPropagationOutcome::Settled;
+	};
+
+	// A settled state whose water network can no longer meet the requirements fails like any other contradiction.
+	// After a forward collapse only the cells that propagation touched are re-examined; RemovalMark is INDEX_NONE
+	// when domains may also have grown (backtracking) and everything must be rebuilt.
+	const auto CheckConnectivity = [&](const EPropagationOutcome Outcome, const int32 RemovalMark) -> EPropagationOutcome
+	{
+		if (Outcome != EPropagationOutcome::Settled || !Context.bConnectivity)
+		{
+			return Outcome;
+		}
+
+		TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(CanalWfc_Connectivity, CanalWfcChannel);
+		const FScopedPhase ConnectivityPhase(PhaseClock, EAttemptPhase::Connectivity);
+
+		TArray<int32>& ChangedCells = Workspace.ConnectivityChanged;
+		if (bSupportCount && RemovalMark != INDEX_NONE)
+		{
+			ChangedCells.Reset();
+			for (int32 RemovalIndex = RemovalMark; RemovalIndex < Removals.Num(); ++RemovalIndex)
+			{
+				ChangedCells.Add(Removals[RemovalIndex].Key);
+			}
+		}
+
+		int32 CutOffCell = INDEX_NONE;
+		const TArray<int32>* Changed = RemovalMark == INDEX_NONE ? nullptr : (bSupportCount ? &ChangedCells : &Queue);
+		if (IsWaterConnectivityPossible(Context, States, Workspace, Changed, CutOffCell))
+		{
+			return Outcome;
+		}
+
+		AttemptResult.Message = FString::Printf(TEXT("Water connectivity lost: %s is cut off from the water network."), *Cells.ToCoord(CutOffCell).ToString());
+		return EPropagationOutcome::Contradiction;
+	};
+
+	if (bSupportCount)
+	{
+		int32 ContradictionCell = INDEX_NONE;
+		bool bSupportsSeeded = InitializeSupports(Cells, States, Support, ContradictionCell);
+		for (; bSupportsSeeded && PendingHead < Support.PendingRemovals.Num(); ++PendingHead)
+		{
+			bSupportsSeeded = WithdrawSupports(Cells, States, Support, Support.PendingRemovals[PendingHead], ContradictionCell);
+		}
+
+		if (!bSupportsSeeded)
+		{
+			bAttemptContradiction = true;
+			AttemptResult.bContradiction = true;
+			AttemptResult.Message = FString::Printf(TEXT("Contradiction at %s while seeding variant supports."), *Cells.ToCoord(ContradictionCell).ToString());
+		}
+		else
+		{
+			for (const TPair<int32, int32>& Removal : Support.PendingRemovals)
+			{
+				if (bWeightedEntropy)
+				{
+					States[Removal.Key].WeightSum -= VariantWeights[Removal.Value];
+					States[Removal.Key].WeightLogWeightSum -= VariantWeightLogWeights[Removal.Value];
+				}
+				RefreshCellEntropy(Removal.Key);
+			}
+		}
+	}
+
+	for (int32 FrontierIndex = 0; !bAttemptContradiction && FrontierIndex < Context.FrontierCells.Num(); ++FrontierIndex)
+	{
+		const EPropagationOutcome Outcome = PropagateChanges(Context.FrontierCells[FrontierIndex], Removals.Num());
+		if (Outcome != EPropagationOutcome::Settled)
+		{
+			bAttemptContradiction = true;
+			AttemptResult.bContradiction |= Outcome == EPropagationOutcome::Contradiction;
+		}
+	}
+
+	// Narrows a cell to AllowedMask before the first collapse and propagates the change. Source names the restriction
+	// in the contradiction message. Returns false on a contradiction or budget stop.
+	const auto RestrictCell = [&](const int32 CellIndex, const uint64* AllowedMask, const TCHAR* Source) -> bool
+	{
+		FCellState& State = States[CellIndex];
+		const int32 PreviousCount = State.NumCandidates();
+		const int32 RemovalMark = Removals.Num();
+		if (bBitsetDomains)
+		{
+			for (int32 WordIndex = 0; WordIndex < NumMaskWords; ++WordIndex)
+			{
+				uint64 Removed = State.DomainBits[WordIndex] & ~AllowedMask[WordIndex];
+				while (Removed != 0)
+				{
+					const int32 VariantIndex = WordIndex * 64 + static_cast<int32>(FMath::CountTrailingZeros64(Removed));
+					Removed &= Removed - 1;
+					RemoveBitsetVariant(State, VariantIndex);
+					if (bSupportCount)
+					{
+						Support.PendingRemovals.Emplace(CellIndex, VariantIndex);
+					}
+					else if (bWeightedEntropy)
+					{
+						State.WeightSum -= VariantWeights[VariantIndex];
+						State.WeightLogWeightSum -= VariantWeightLogWeights[VariantIndex];
 					}
+				}
+			}
+		}
+		else
+		{
+			State.Candidates.RemoveAll([this, AllowedMask](const FCanalTileVariantKey& Candidate)
+			{
+				const int32 VariantIndex = Compatibility.FindVariantIndex(Candidate);
+				return (AllowedMask[VariantIndex / 64] & (uint64(1) << (VariantIndex % 64))) == 0;
+			});
+		}
+
+		if (State.NumCandidates() == 0)
+		{
+			AttemptResult.bContradiction = true;
+			AttemptResult.Message = FString::Printf(TEXT("%s leave no variant at %s."), Source, *Cells.ToCoord(CellIndex).ToString());
+			return false;
+		}
+
+		if (State.NumCandidates() != PreviousCount)
+		{
+			const EPropagationOutcome Outcome = PropagateChanges(CellIndex, RemovalMark);
+			if (Outcome != EPropagationOutcome::Settled)
+			{
+				AttemptResult.bContradiction |= Outcome == EPropagationOutcome::Contradiction;
+				return false;
+			}
+		}
+		return true;
+	};
+
+	// Boundary socket constraints and pins prune their cells before the first collapse; propagation carries them inward.
+	for (int32 Slot = 0; !bAttemptContradiction && Slot < Context.ConstrainedCells.Num(); ++Slot)
+	{
+		bAttemptContradiction = !RestrictCell(
+			Context.ConstrainedCells[Slot], &Context.ConstrainedMasks[Slot * NumMaskWords], TEXT("Boundary socket constraints and pins"));
+	}
+
+	// Everything so far is the same in every attempt; the carved path below is not.
+	const bool bContradictedBeforePath = AttemptResult.bContradiction;
+	if (!bAttemptContradiction && Context.bCarvePath)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(CanalWfc_Carve, CanalWfcChannel);
+		const FScopedPhase CarvePhase(PhaseClock, EAttemptPhase::Carve);
+		CarveWaterPath(Context, Workspace, Random);
+		const TArray<int32>& Path = Workspace.CarvedPath;
+		TArray<uint64, TInlineAllocator<4>>& PathMask = Workspace.CarvedPathMask;
+		PathMask.SetNumUninitialized(NumMaskWords);
+		for (int32 PathIndex = 0; !bAttemptContradiction && PathIndex < Path.Num(); ++PathIndex)
+		{
+			// Path cells carry water (or a lock) on the sides facing the previous and next cell, or the port.
+			const int32 CellIndex = Path[PathIndex];
+			const int32 InDirIndex = PathIndex == 0
+				? Context.CarveEntryDirIndex
+				: Cells.FindDirection(CellIndex, Path[PathIndex - 1]);
+			const int32 OutDirIndex = PathIndex == Path.Num() - 1
+				? Context.CarveExitDirIndex
+				: Cells.FindDirection(CellIndex, Path[PathIndex + 1]);
+			const uint64* InMask = &Context.CarveSideMasks[InDirIndex * NumMaskWords];
+			const uint64* OutMask = &Context.CarveSideMasks[OutDirIndex * NumMaskWords];
+			for (int32 WordIndex = 0; WordIndex < NumMaskWords; ++WordIndex)
+			{
+				PathMask[WordIndex] = InMask[WordIndex] & OutMask[WordIndex];
+			}
+			bAttemptContradiction = !RestrictCell(CellIndex, PathMask.GetData(), TEXT("Carved path sockets"));
+		}
+	}
+
+	Workspace.bWaterReachedValid = false;
+	if (!bAttemptContradiction && CheckConnectivity(EPropagationOutcome::Settled, INDEX_NONE) != EPropagationOutcome::Settled)
+	{
+		bAttemptContradiction = true;
+		AttemptResult.bContradiction = true;
+	}
+
+	// Nothing random has happened yet, so every other attempt would contradict the same way. A carved path differs per
+	// attempt, so only contradictions before it count.
+	AttemptResult.bConstraintsInfeasible = Context.bCarvePath ? bContradictedBeforePath : AttemptResult.bContradiction;
+
+	// Removals only shrink when a backtrack unwinds them, so sampling the trail after each propagation finds its peak.
+	const auto RecordUndoTrailPeak = [&]()
+	{
+		if (bBacktracking)
+		{
+			Workspace.PeakUndoTrail = FMath::Max(Workspace.PeakUndoTrail, Removals.Num());
+		}
+	};
+
+	while (!bAttemptContradiction)
+	{
+		int32 TargetCell = INDEX_NONE;
+		int32 RemovalMark = 0;
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(CanalWfc_Select, CanalWfcChannel);
+			const FScopedPhase SelectPhase(PhaseClock, EAttemptPhase::Select);
+
+			if (IsTimeBudgetExceeded(ElapsedSeconds))
+			{
+				bAttemptContradiction = true;
+				AttemptResult.bTimeBudgetExceeded = true;
+				AttemptResult.Message = FString::Printf(TEXT("Solve time budget exceeded (limit %.3fs)."), Config.MaxSolveTimeSeconds);
+				break;
+			}
+
+			if (IsCancelled())
+			{
+				bAttemptContradiction = true;
+				break;
+			}
+
+			if (EntropyHeap.IsEmpty())
+			{
+				break;
+			}
+
+			TargetCell = EntropyHeap.Top();
+			EntropyHeap.Remove(TargetCell);
+
+			if (!bBacktracking && bSupportCount)
+			{
+				// Without a trail the pending list only needs to hold the current collapse.
+				Support.PendingRemovals.Reset();
+				PendingHead = 0;
+			}
+			RemovalMark = Removals.Num();
+		}
+
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(CanalWfc_Sample, CanalWfcChannel);
+			const FScopedPhase SamplePhase(PhaseClock, EAttemptPhase::Sample);
+
+			FCellState& TargetState = States[TargetCell];
+			if (bBitsetDomains)
+			{
+				const int32 PickedIndex = FKernels::Choose(
+					Compatibility, TargetState.DomainBits.GetData(), TargetState.DomainCount, Context.VariantPickWeights.GetData(), Context.FullPickWeight, Random.GetFraction(TargetCell, PickDraw));
+				if (bSupportCount || bBacktracking)
+				{
+					for (int32 WordIndex = 0; WordIndex < NumMaskWords; ++WordIndex)
+					{
+						uint64 Word = TargetState.DomainBits[WordIndex];
+						while (Word != 0)
+						{
+							const int32 VariantIndex = WordIndex * 64 + static_cast<int32>(FMath::CountTrailingZeros64(Word));
+							Word &= Word - 1;
+							if (VariantIndex != PickedIndex)
+							{
+								Removals.Emplace(TargetCell, VariantIndex);
+							}
+						}
+					}
+				}
+				if (bBacktracking)
+				{
+					Decisions.Add({TargetCell, PickedIndex, RemovalMark});
+				}
+				FMemory::Memzero(TargetState.DomainBits.GetData(), NumMaskWords * sizeof(uint64));
+				TargetState.DomainBits[PickedIndex / 64] = uint64(1) << (PickedIndex % 64);
+				TargetState.DomainCount = 1;
+			}
+			else
+			{
+				const FCanalTileVariantKey Picked = ChooseVariant(TargetState.Candidates, Random.GetFraction(TargetCell, PickDraw), TileWeightScales);
+				TargetState.Candidates.Reset();
+				TargetState.Candidates.Add(Picked);
+			}
+		}
+
+		EPropagationOutcome Outcome = CheckConnectivity(PropagateChanges(TargetCell, RemovalMark), RemovalMark);
+		RecordUndoTrailPeak();
+		if (Context.Control && Attempt == Context.ProgressAttempt)
+		{
+			Context.Control->ReportProgress(Attempt, static_cast<float>(NumCells - EntropyHeap.Num()) / NumCells);
+		}
+
+		// Undo the most recent decision and ban its pick until the domains settle or the budget runs out.
+		while (Outcome == EPropagationOutcome::Contradiction && bBacktracking && Decisions.Num() > 0 && AttemptResult.Backtracks < Config.MaxBacktracks)
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(CanalWfc_Backtrack, CanalWfcChannel);
+			const FScopedPhase BacktrackPhase(PhaseClock, EAttemptPhase::Backtrack);
 
-					TArray<FCanalTileVariantKey> Filtered;
-					Filtered.Reserve(NeighborState->Candidates.Num());
-					for (const FCanalTileVariantKey& Candidate : NeighborState->Candidates)
+			++AttemptResult.Backtracks;
+			const FBacktrackDecision Decision = Decisions.Last();
+			Decisions.RemoveAt(Decisions.Num() - 1);
+
+			for (int32 RemovalIndex = Removals.Num() - 1; RemovalIndex >= Decision.RemovalMark; --RemovalIndex)
+			{
+				const TPair<int32, int32>& Removal = Removals[RemovalIndex];
+				if (bSupportCount && RemovalIndex < PendingHead)
+				{
+					RestoreSupports(Cells, Support, Removal);
+				}
+				FCellState& State = States[Removal.Key];
+				State.DomainBits[Removal.Value / 64] |= uint64(1) << (Removal.Value % 64);
+				++State.DomainCount;
+			}
+
+			for (int32 RemovalIndex = Decision.RemovalMark; RemovalIndex < Removals.Num(); ++RemovalIndex)
+			{
+				FCellState& State = States[Removals[RemovalIndex].Key];
+				if (bWeightedEntropy)
+				{
+					// SupportCount only subtracts weights once a propagation settles, so rebuild the sums from the bits.
+					State.WeightSum = 0;
+					State.WeightLogWeightSum = 0;
+					for (int32 WordIndex = 0; WordIndex < NumMaskWords; ++WordIndex)
 					{
-						if (IsVariantAllowedByAnySource(Candidate, CurrentCandidates, Direction))
+						uint64 Word = State.DomainBits[WordIndex];
+						while (Word != 0)
 						{
-							Filtered.Add(Candidate);
+							const int32 VariantIndex = WordIndex * 64 + static_cast<int32>(FMath::CountTrailingZeros64(Word));
+							Word &= Word - 1;
+							State.WeightSum += VariantWeights[VariantIndex];
+							State.WeightLogWeightSum += VariantWeightLogWeights[VariantIndex];
 						}
 					}
+				}
+				RefreshCellEntropy(Removals[RemovalIndex].Key);
+			}
 
-					if (Filtered.Num() == 0)
-					{
-						bAttemptContradiction = true;
-						AttemptResult.bContradiction = true;
-						AttemptResult.Message = FString::Printf(
-							TEXT("Contradiction at %s when propagating from %s."),
-							*Neighbor.ToString(),
-							*Current.ToString());
-						break;
-					}
+			Removals.SetNum(Decision.RemovalMark);
+			PendingHead = FMath::Min(PendingHead, Decision.RemovalMark);
 
-					if (Filtered.Num() != NeighborState->Candidates.Num())
-					{
-						NeighborState->Candidates = MoveTemp(Filtered);
-						Queue.Enqueue(Neighbor);
-					}
+			// The ban belongs to the previous decision's trail, so it is only lifted if that decision is undone too.
+			FCellState& DecisionState = States[Decision.CellIndex];
+			RemoveBitsetVariant(DecisionState, Decision.VariantIndex);
+			Removals.Emplace(Decision.CellIndex, Decision.VariantIndex);
+			if (bWeightedEntropy && !bSupportCount)
+			{
+				DecisionState.WeightSum -= VariantWeights[Decision.VariantIndex];
+				DecisionState.WeightLogWeightSum -= VariantWeightLogWeights[Decision.VariantIndex];
+			}
 
-					++AttemptResult.PropagationSteps;
+			if (DecisionState.DomainCount == 0)
+			{
+				AttemptResult.Message = FString::Printf(TEXT("Contradiction at %s after banning every candidate."), *Cells.ToCoord(Decision.CellIndex).ToString());
+				continue;
+			}
+
+			Outcome = CheckConnectivity(PropagateChanges(Decision.CellIndex, Decision.RemovalMark), INDEX_NONE);
+			RecordUndoTrailPeak();
+		}
+
+		if (Outcome != EPropagationOutcome::Settled)
+		{
+			bAttemptContradiction = true;
+			if (Outcome == EPropagationOutcome::Contradiction)
+			{
+				AttemptResult.bContradiction = true;
+				if (bBacktracking && Decisions.Num() > 0)
+				{
+					AttemptResult.Message += FString::Printf(TEXT(" Backtrack budget (%d) exhausted."), Config.MaxBacktracks);
 				}
+			}
+			break;
+		}
+	}
+
+	if (bAttemptContradiction)
+	{
+		AttemptResult.SolveTimeSeconds = GetElapsedSeconds();
+		AttemptResult.bCancelled = Context.Control && Context.Control->IsCancelRequested();
+		if (AttemptResult.bCancelled)
+		{
+			AttemptResult.Message = FString::Printf(TEXT("Attempt %d cancelled by the caller."), Attempt);
+		}
+		else if (IsCancelled())
+		{
+			AttemptResult.Message = FString::Printf(TEXT("Attempt %d cancelled: an earlier attempt solved."), Attempt);
+		}
+		else if (AttemptResult.bConstraintsInfeasible)
+		{
+			AttemptResult.Message = FString::Printf(
+				TEXT("Constraints are infeasible: attempt %d contradicted before its first collapse, so no seed can meet them. %s"),
+				Attempt,
+				*AttemptResult.Message);
+		}
+		else
+		{
+			AttemptResult.Message = FString::Printf(TEXT("Attempt %d failed: %s"), Attempt, *AttemptResult.Message);
+		}
+		return AttemptResult;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(CanalWfc_Validate, CanalWfcChannel);
+	const FScopedPhase ValidatePhase(PhaseClock, EAttemptPhase::Validate);
+
+	FString ValidationError;
+	Solved.SetNum(NumCells);
+	for (int32 CellIndex = 0; CellIndex < NumCells && ValidationError.IsEmpty(); ++CellIndex)
+	{
+		const FCellState& Cell = States[CellIndex];
+		if (Cell.NumCandidates() != 1)
+		{
+			ValidationError = FString::Printf(TEXT("Cell %s was not collapsed."), *Cells.ToCoord(CellIndex).ToString());
+		}
+		else if (bBitsetDomains)
+		{
+			GatherBitsetCandidates(Cell, PickCandidates);
+			Solved[CellIndex] = PickCandidates[0];
+		}
+		else
+		{
+			Solved[CellIndex] = Cell.Candidates[0];
+		}
+	}
+
+	FHexBoundaryPort ResolvedEntryPort;
+	FHexBoundaryPort ResolvedExitPort;
+	FHexWfcWaterAnalysis Water;
+	bool bFailedSingleWaterComponent = false;
+	if (!ValidationError.IsEmpty()
+		|| !ValidateSolvedState(
+			Cells, Solved, Config, Workspace.WaterGraph, ResolvedEntryPort, ResolvedExitPort, Water, bFailedSingleWaterComponent, ValidationError))
+	{
+		AttemptResult.bFailedSingleWaterComponent = bFailedSingleWaterComponent;
+		AttemptResult.Message = FString::Printf(TEXT("Attempt %d rejected by validation: %s"), Attempt, *ValidationError);
+		AttemptResult.SolveTimeSeconds = GetElapsedSeconds();
+		return AttemptResult;
+	}
+
+	// Later attempts still running speculatively can stop now; earlier ones must finish to keep serial order.
+	int32 FirstSolved = Context.FirstSolvedAttempt.load();
+	while (Attempt < FirstSolved && !Context.FirstSolvedAttempt.compare_exchange_weak(FirstSolved, Attempt))
+	{
+	}
+
+	if (Context.Control)
+	{
+		Context.Control->ReportProgress(Attempt, 1.0f);
+	}
+
+	AttemptResult.bSolved = true;
+	AttemptResult.Message = FString::Printf(TEXT("Solved in attempt %d."), Attempt);
+
+	// Cell order is row-major, which is already the (R, Q) order callers expect.
+	AttemptResult.Cells.SetNum(NumCells);
+	for (int32 CellIndex = 0; CellIndex < NumCells; ++CellIndex)
+	{
+		FHexWfcCellResult& Cell = AttemptResult.Cells[CellIndex];
+		Cell.Coord = Cells.ToCoord(CellIndex);
+		Cell.Variant = Compatibility.ToVariantRef(Solved[CellIndex]);
+	}
+
+	AttemptResult.CollapsedCells = AttemptResult.Cells.Num();
+	AttemptResult.ResolvedEntryPort = ResolvedEntryPort;
+	AttemptResult.ResolvedExitPort = ResolvedExitPort;
+	AttemptResult.bHasResolvedPorts = ResolvedEntryPort.bEnabled && ResolvedExitPort.bEnabled;
+	FindWaterPath(Cells, Workspace.WaterGraph, ResolvedEntryPort, ResolvedExitPort, Water);
+	AttemptResult.Water = MoveTemp(Water);
+	AttemptResult.SolveTimeSeconds = GetElapsedSeconds();
+	return AttemptResult;
+}
+
+FHexWfcSolveResult FHexWfcSolver::SolveAttempt(const FSolveContext& Context, FAttemptWorkspace& Workspace, const int32 Attempt) const
+{
+	switch (Context.KernelWords)
+	{
+	case 1:
+		return SolveAttemptImpl<1>(Context, Workspace, Attempt);
+	case 2:
+		return SolveAttemptImpl<2>(Context, Workspace, Attempt);
+	case 4:
+		return SolveAttemptImpl<4>(Context, Workspace, Attempt);
+	default:
+		return SolveAttemptImpl<0>(Context, Workspace, Attempt);
+	}
+}
+
+void FHexWfcSolver::CarveWaterPath(const FSolveContext& Context, FAttemptWorkspace& Workspace, const FCanalCounterRandom& Random) const
+{
+	const FCellGrid& Cells = Context.Cells;
+	const int32 NumCells = Cells.Num();
+	const float Meander = FMath::Max(0.0f, Context.Config->CarvedPathMeander);
+	TArray<float>& Costs = Workspace.PathCosts;
+	TArray<double>& Distances = Workspace.PathDistances;
+	TArray<int32>& Parents = Workspace.PathParents;
+	FEntropyHeap& Heap = Workspace.PathHeap;
+
+	// Boundary cells cost more so the path keeps off the edge, where its cells' open sides would face out of the grid.
+	Costs.SetNumUninitialized(NumCells);
+	for (int32 CellIndex = 0; CellIndex < NumCells; ++CellIndex)
+	{
+		Costs[CellIndex] = 1.0f + Meander * Random.GetFraction(CellIndex, CarveCostDraw);
+		for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
+		{
+			if (Cells.GetNeighbor(CellIndex, DirIndex) == INDEX_NONE)
+			{
+				Costs[CellIndex] *= 3.0f;
+				break;
+			}
+		}
+	}
+
+	Distances.Init(TNumericLimits<double>::Max(), NumCells);
+	Parents.Init(INDEX_NONE, NumCells);
+	Heap.Build(NumCells, TNumericLimits<double>::Max());
+	Distances[Context.CarveEntryCell] = Costs[Context.CarveEntryCell];
+	Heap.Set(Context.CarveEntryCell, Distances[Context.CarveEntryCell]);
+
+	while (!Heap.IsEmpty())
+	{
+		const int32 Current = Heap.Top();
+		Heap.Remove(Current);
+		if (Current == Context.CarveExitCell)
+		{
+			break;
+		}
+
+		for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
+		{
+			const int32 Neighbor = Cells.GetNeighbor(Current, DirIndex);
+			if (Neighbor == INDEX_NONE)
+			{
+				continue;
+			}
+
+			const double Distance = Distances[Current] + Costs[Neighbor];
+			if (Distance < Distances[Neighbor])
+			{
+				Distances[Neighbor] = Distance;
+				Parents[Neighbor] = Current;
+				Heap.Set(Neighbor, Distance);
+			}
+		}
+	}
+
+	TArray<int32>& Path = Workspace.CarvedPath;
+	Path.Reset();
+	for (int32 CellIndex = Context.CarveExitCell; CellIndex != INDEX_NONE; CellIndex = Parents[CellIndex])
+	{
+		Path.Add(CellIndex);
+	}
+	Algo::Reverse(Path);
+}
+
+bool FHexWfcSolver::IsWaterConnectivityPossible(
+	const FSolveContext& Context,
+	const TArray<FCellState>& States,
+	FAttemptWorkspace& Workspace,
+	const TArray<int32>* ChangedCells,
+	int32& OutCell) const
+{
+	const FCellGrid& Cells = Context.Cells;
+	const int32 NumMaskWords = Compatibility.GetVariantMaskWordCount();
+	TArray<uint16>& WaterSides = Workspace.WaterSides;
+	TArray<bool>& Reached = Workspace.WaterReached;
 
-				if (bAttemptContradiction)
+	const auto GetWaterSides = [&](const FCellState& State) -> uint16
+	{
+		uint16 Sides = 0;
+		for (int32 SideIndex = 0; SideIndex < 12; ++SideIndex)
+		{
+			const uint64* Mask = &Context.WaterSideMasks[SideIndex * NumMaskWords];
+			for (int32 WordIndex = 0; WordIndex < NumMaskWords; ++WordIndex)
+			{
+				if ((State.DomainBits[WordIndex] & Mask[WordIndex]) != 0)
 				{
+					Sides |= uint16(1) << SideIndex;
 					break;
 				}
 			}
+		}
+		return Sides;
+	};
 
-			if (bAttemptContradiction)
+	const auto MustHoldWater = [&](const FCellState& State)
+	{
+		for (int32 WordIndex = 0; WordIndex < NumMaskWords; ++WordIndex)
+		{
+			if ((State.DomainBits[WordIndex] & ~Context.WaterCellMask[WordIndex]) != 0)
 			{
-				break;
+				return false;
 			}
 		}
+		return true;
+	};
+
+	// Matching Water or matching Lock sockets across the edge, from the Sides bits of either end.
+	const auto CanConnect = [&](const uint16 Sides, const int32 Neighbor, const int32 DirIndex)
+	{
+		const int32 OppositeIndex = (DirIndex + 3) % 6;
+		return ((Sides >> (DirIndex * 2)) & (WaterSides[Neighbor] >> (OppositeIndex * 2)) & 3) != 0;
+	};
 
-		if (bAttemptContradiction)
+	if (ChangedCells && Workspace.bWaterReachedValid)
+	{
+		bool bEdgeLost = false;
+		for (const int32 CellIndex : *ChangedCells)
 		{
-			bAnyContradiction |= AttemptResult.bContradiction;
-			AttemptResult.SolveTimeSeconds = GetElapsedSeconds();
-			LastFailure = FString::Printf(TEXT("Attempt %d failed: %s"), Attempt, *AttemptResult.Message);
-			if (AttemptResult.bTimeBudgetExceeded)
+			const uint16 Sides = GetWaterSides(States[CellIndex]);
+			const uint16 Lost = WaterSides[CellIndex] & ~Sides;
+			WaterSides[CellIndex] = Sides;
+
+			// Reached sets only shrink as domains do, so an unreached cell that must now hold water is already cut off.
+			if (!Reached[CellIndex])
 			{
-				break;
+				if (Context.bConnectSingleComponent && MustHoldWater(States[CellIndex]))
+				{
+					OutCell = CellIndex;
+					return false;
+				}
+				continue;
+			}
+
+			for (int32 DirIndex = 0; DirIndex < 6 && !bEdgeLost && Lost != 0; ++DirIndex)
+			{
+				const int32 Neighbor = Cells.GetNeighbor(CellIndex, DirIndex);
+				bEdgeLost = Neighbor != INDEX_NONE && CanConnect(Lost, Neighbor, DirIndex);
+			}
+		}
+
+		if (!bEdgeLost)
+		{
+			return true;
+		}
+	}
+	else
+	{
+		WaterSides.SetNumUninitialized(Cells.Num());
+		for (int32 CellIndex = 0; CellIndex < Cells.Num(); ++CellIndex)
+		{
+			WaterSides[CellIndex] = GetWaterSides(States[CellIndex]);
+		}
+	}
+
+	int32 Root = Context.ConnectivityRootCell;
+	if (Root == INDEX_NONE && Context.bConnectSingleComponent)
+	{
+		for (int32 CellIndex = 0; CellIndex < Cells.Num() && Root == INDEX_NONE; ++CellIndex)
+		{
+			Root = MustHoldWater(States[CellIndex]) ? CellIndex : INDEX_NONE;
+		}
+	}
+
+	Workspace.bWaterReachedValid = false;
+	if (Root == INDEX_NONE || (Context.ConnectivityExitCell == INDEX_NONE && !Context.bConnectSingleComponent))
+	{
+		return true;
+	}
+
+	TArray<int32>& Queue = Workspace.ConnectivityQueue;
+	Reached.Init(false, Cells.Num());
+	Queue.Reset();
+	Queue.Add(Root);
+	Reached[Root] = true;
+	Workspace.bWaterReachedValid = true;
+
+	for (int32 QueueHead = 0; QueueHead < Queue.Num(); ++QueueHead)
+	{
+		const int32 Current = Queue[QueueHead];
+		for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
+		{
+			const int32 Neighbor = Cells.GetNeighbor(Current, DirIndex);
+			if (Neighbor == INDEX_NONE || Reached[Neighbor] || !CanConnect(WaterSides[Current], Neighbor, DirIndex))
+			{
+				continue;
+			}
+
+			Reached[Neighbor] = true;
+			Queue.Add(Neighbor);
+
+			// Stopping early leaves part of the component unmarked, which only makes later skips more conservative.
+			if (Neighbor == Context.ConnectivityExitCell && !Context.bConnectSingleComponent)
+			{
+				return true;
+			}
+		}
+	}
+
+	if (Context.ConnectivityExitCell != INDEX_NONE && !Reached[Context.ConnectivityExitCell])
+	{
+		OutCell = Context.ConnectivityExitCell;
+		return false;
+	}
+
+	for (int32 CellIndex = 0; Context.bConnectSingleComponent && CellIndex < Cells.Num(); ++CellIndex)
+	{
+		if (!Reached[CellIndex] && MustHoldWater(States[CellIndex]))
+		{
+			OutCell = CellIndex;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool FHexWfcSolver::InitializeSupports(
+	const FCellGrid& Cells,
+	TArray<FCellState>& States,
+	FSupportState& Support,
+	int32& OutContradictionCell) const
+{
+	const int32 NumVariants = Compatibility.GetNumVariants();
+	constexpr int32 NumSockets = FCanalTileCompatibilityTable::NumSocketTypes;
+
+	// Every neighbour starts with the full domain, so the initial count is the number of variants showing each socket.
+	uint16 InitialCounts[6 * NumSockets];
+	for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
+	{
+		const int32 BackDirIndex = (DirIndex + 3) % 6;
+		for (int32 Socket = 0; Socket < NumSockets; ++Socket)
+		{
+			const uint64* Mask = Compatibility.GetSocketVariantMask(BackDirIndex, Socket);
+			int32 Count = 0;
+			for (int32 WordIndex = 0; WordIndex < Compatibility.GetVariantMaskWordCount(); ++WordIndex)
+			{
+				Count += FMath::CountBits(Mask[WordIndex]);
+			}
+			InitialCounts[DirIndex * NumSockets + Socket] = static_cast<uint16>(Count);
+		}
+	}
+
+	Support.Counts.SetNumUninitialized(Cells.Num() * 6 * NumSockets);
+	Support.PendingRemovals.Reset();
+
+	for (int32 CellIndex = 0; CellIndex < Cells.Num(); ++CellIndex)
+	{
+		FMemory::Memcpy(&Support.Counts[CellIndex * 6 * NumSockets], InitialCounts, sizeof(InitialCounts));
+
+		for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
+		{
+			if (Cells.GetNeighbor(CellIndex, DirIndex) == INDEX_NONE)
+			{
+				continue;
+			}
+
+			for (int32 VariantIndex = 0; VariantIndex < NumVariants; ++VariantIndex)
+			{
+				FCellState& State = States[CellIndex];
+				const uint64 Bit = uint64(1) << (VariantIndex % 64);
+				const int32 Socket = Compatibility.GetVariantSocket(VariantIndex, DirIndex);
+				if (InitialCounts[DirIndex * NumSockets + Socket] == 0 && (State.DomainBits[VariantIndex / 64] & Bit) != 0)
+				{
+					RemoveBitsetVariant(State, VariantIndex);
+					Support.PendingRemovals.Emplace(CellIndex, VariantIndex);
+					if (State.DomainCount == 0)
+					{
+						OutContradictionCell = CellIndex;
+						return false;
+					}
+				}
 			}
+		}
+	}
+
+	return true;
+}
+
+bool FHexWfcSolver::WithdrawSupports(
+	const FCellGrid& Cells,
+	TArray<FCellState>& States,
+	FSupportState& Support,
+	const TPair<int32, int32>& Removal,
+	int32& OutContradictionCell) const
+{
+	const int32 NumMaskWords = Compatibility.GetVariantMaskWordCount();
+	constexpr int32 NumSockets = FCanalTileCompatibilityTable::NumSocketTypes;
+	int32 ContradictionCell = INDEX_NONE;
+
+	for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
+	{
+		const int32 Neighbor = Cells.GetNeighbor(Removal.Key, DirIndex);
+		if (Neighbor == INDEX_NONE)
+		{
 			continue;
 		}
 
-		FHexBoundaryPort ResolvedEntryPort;
-		FHexBoundaryPort ResolvedExitPort;
-		bool bFailedSingleWaterComponent = false;
-		FString ValidationError;
-		if (!ValidateSolvedState(States, Grid, Config, ResolvedEntryPort, ResolvedExitPort, bFailedSingleWaterComponent, ValidationError))
+		// The neighbour sees the removed variant's socket on its opposite side. Counts are always withdrawn, even past
+		// a contradiction, so RestoreSupports can undo them exactly.
+		const int32 BackDirIndex = (DirIndex + 3) % 6;
+		const int32 Socket = Compatibility.GetVariantSocket(Removal.Value, DirIndex);
+		if (--Support.Counts[(Neighbor * 6 + BackDirIndex) * NumSockets + Socket] != 0 || ContradictionCell != INDEX_NONE)
 		{
-			bAnySingleComponentFailure |= bFailedSingleWaterComponent;
-			LastFailure = FString::Printf(TEXT("Attempt %d rejected by validation: %s"), Attempt, *ValidationError);
 			continue;
 		}
 
-		AttemptResult.bSolved = true;
-		AttemptResult.Message = FString::Printf(TEXT("Solved in attempt %d."), Attempt);
-		AttemptResult.Cells.Reserve(FinalResult.TotalCells);
-		for (auto& Pair : States)
+		// The last variant showing this socket is gone: every neighbour variant that needs it loses its support.
+		FCellState& NeighborState = States[Neighbor];
+		const uint64* Unsupported = Compatibility.GetSocketVariantMask(BackDirIndex, Socket);
+		for (int32 WordIndex = 0; WordIndex < NumMaskWords && ContradictionCell == INDEX_NONE; ++WordIndex)
 		{
-			FHexWfcCellResult Cell;
-			Cell.Coord = Pair.Key;
-			if (Pair.Value.Candidates.Num() > 0)
+			uint64 Word = NeighborState.DomainBits[WordIndex] & Unsupported[WordIndex];
+			while (Word != 0)
 			{
-				Cell.Variant = Compatibility.ToVariantRef(Pair.Value.Candidates[0]);
+				const int32 Supported = WordIndex * 64 + static_cast<int32>(FMath::CountTrailingZeros64(Word));
+				Word &= Word - 1;
+				RemoveBitsetVariant(NeighborState, Supported);
+				Support.PendingRemovals.Emplace(Neighbor, Supported);
 			}
-			AttemptResult.Cells.Add(Cell);
+			if (NeighborState.DomainCount == 0)
+			{
+				ContradictionCell = Neighbor;
+			}
+		}
+	}
+
+	OutContradictionCell = ContradictionCell;
+	return ContradictionCell == INDEX_NONE;
+}
+
+void FHexWfcSolver::RestoreSupports(
+	const FCellGrid& Cells,
+	FSupportState& Support,
+	const TPair<int32, int32>& Removal) const
+{
+	constexpr int32 NumSockets = FCanalTileCompatibilityTable::NumSocketTypes;
+
+	for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
+	{
+		const int32 Neighbor = Cells.GetNeighbor(Removal.Key, DirIndex);
+		if (Neighbor == INDEX_NONE)
+		{
+			continue;
 		}
 
-		AttemptResult.Cells.Sort([](const FHexWfcCellResult& A, const FHexWfcCellResult& B)
-		{
-			if (A.Coord.R != B.Coord.R)
-			{
-				return A.Coord.R < B.Coord.R;
-			}
-			return A.Coord.Q < B.Coord.Q;
-		});
+		const int32 Socket = Compatibility.GetVariantSocket(Removal.Value, DirIndex);
+		++Support.Counts[(Neighbor * 6 + (DirIndex + 3) % 6) * NumSockets + Socket];
+	}
+}
+
+void FHexWfcSolver::RemoveBitsetVariant(FCellState& State, const int32 VariantIndex)
+{
+	State.DomainBits[VariantIndex / 64] &= ~(uint64(1) << (VariantIndex % 64));
+	--State.DomainCount;
+}
+
+void FHexWfcSolver::FEntropyHeap::Build(const int32 NumCells, const double InitialKey)
+{
+	Heap.SetNumUninitialized(NumCells);
+	SlotByCell.SetNumUninitialized(NumCells);
+	Keys.Init(InitialKey, NumCells);
+	for (int32 CellIndex = 0; CellIndex < NumCells; ++CellIndex)
+	{
+		Heap[CellIndex] = CellIndex;
+		SlotByCell[CellIndex] = CellIndex;
+	}
+}
+
+void FHexWfcSolver::FEntropyHeap::Set(const int32 CellIndex, const double Key)
+{
+	const int32 Slot = SlotByCell[CellIndex];
+	if (Slot == INDEX_NONE)
+	{
+		Keys[CellIndex] = Key;
+		Heap.Add(CellIndex);
+		SlotByCell[CellIndex] = Heap.Num() - 1;
+		SiftUp(Heap.Num() - 1);
+		return;
+	}
+
+	if (Keys[CellIndex] == Key)
+	{
+		return;
+	}
+
+	const bool bDecreased = Key < Keys[CellIndex];
+	Keys[CellIndex] = Key;
+	if (bDecreased)
+	{
+		SiftUp(Slot);
+	}
+	else
+	{
+		SiftDown(Slot);
+	}
+}
+
+void FHexWfcSolver::FEntropyHeap::Remove(const int32 CellIndex)
+{
+	const int32 Slot = SlotByCell.IsValidIndex(CellIndex) ? SlotByCell[CellIndex] : INDEX_NONE;
+	if (Slot == INDEX_NONE)
+	{
+		return;
+	}
 
-		AttemptResult.CollapsedCells = AttemptResult.Cells.Num();
-		AttemptResult.ResolvedEntryPort = ResolvedEntryPort;
-		AttemptResult.ResolvedExitPort = ResolvedExitPort;
-		AttemptResult.bHasResolvedPorts = ResolvedEntryPort.bEnabled && ResolvedExitPort.bEnabled;
-		AttemptResult.SolveTimeSeconds = GetElapsedSeconds();
-		return AttemptResult;
+	SlotByCell[CellIndex] = INDEX_NONE;
+	const int32 LastCell = Heap.Last();
+	Heap.RemoveAt(Heap.Num() - 1, 1, EAllowShrinking::No);
+	if (Slot == Heap.Num())
+	{
+		return;
 	}
 
-	FinalResult.bSolved = false;
-	FinalResult.bContradiction = bAnyContradiction;
-	FinalResult.bTimeBudgetExceeded = bTimeBudgetExceeded;
-	FinalResult.bFailedSingleWaterComponent = bAnySingleComponentFailure;
-	FinalResult.AttemptsUsed = AttemptsUsed;
-	FinalResult.Message = LastFailure;
-	FinalResult.SolveTimeSeconds = GetElapsedSeconds();
-	return FinalResult;
+	Place(Slot, LastCell);
+	SiftUp(Slot);
+	SiftDown(SlotByCell[LastCell]);
 }
 
-bool FHexWfcSolver::SelectLowestEntropyCell(
-	const TMap<FHexAxialCoord, FCellState>& States,
-	FHexAxialCoord& OutCoord,
-	int32& OutEntropy) const
+void FHexWfcSolver::FEntropyHeap::Place(const int32 Slot, const int32 CellIndex)
 {
-	bool bFound = false;
-	int32 BestEntropy = MAX_int32;
-	FHexAxialCoord BestCoord;
+	Heap[Slot] = CellIndex;
+	SlotByCell[CellIndex] = Slot;
+}
 
-	for (const TPair<FHexAxialCoord, FCellState>& Pair : States)
+void FHexWfcSolver::FEntropyHeap::SiftUp(int32 Slot)
+{
+	const int32 CellIndex = Heap[Slot];
+	while (Slot > 0)
 	{
-		const int32 Entropy = Pair.Value.Candidates.Num();
-		if (Entropy <= 1)
+		const int32 ParentSlot = (Slot - 1) / 2;
+		if (!Less(CellIndex, Heap[ParentSlot]))
 		{
-			continue;
+			break;
 		}
+		Place(Slot, Heap[ParentSlot]);
+		Slot = ParentSlot;
+	}
+	Place(Slot, CellIndex);
+}
 
-		if (!bFound || Entropy < BestEntropy)
+void FHexWfcSolver::FEntropyHeap::SiftDown(int32 Slot)
+{
+	const int32 CellIndex = Heap[Slot];
+	while (true)
+	{
+		int32 ChildSlot = Slot * 2 + 1;
+		if (ChildSlot >= Heap.Num())
 		{
-			bFound = true;
-			BestEntropy = Entropy;
-			BestCoord = Pair.Key;
-			continue;
+			break;
 		}
-
-		if (Entropy == BestEntropy)
+		if (ChildSlot + 1 < Heap.Num() && Less(Heap[ChildSlot + 1], Heap[ChildSlot]))
 		{
-			if (Pair.Key.R < BestCoord.R || (Pair.Key.R == BestCoord.R && Pair.Key.Q < BestCoord.Q))
-			{
-				BestCoord = Pair.Key;
-			}
+			++ChildSlot;
 		}
+		if (!Less(Heap[ChildSlot], CellIndex))
+		{
+			break;
+		}
+		Place(Slot, Heap[ChildSlot]);
+		Slot = ChildSlot;
 	}
+	Place(Slot, CellIndex);
+}
 
-	if (!bFound)
+double FHexWfcSolver::ComputeCellEntropy(const FCellState& State, const bool bWeightedEntropy)
+{
+	if (!bWeightedEntropy)
 	{
-		return false;
+		return static_cast<double>(State.NumCandidates());
 	}
 
-	OutCoord = BestCoord;
-	OutEntropy = BestEntropy;
-	return true;
+	// H = ln(S) - sum(w ln w) / S, evaluated from the fixed-point sums kept on the cell.
+	if (State.WeightSum <= 0)
+	{
+		return FMath::Loge(static_cast<double>(FMath::Max(1, State.NumCandidates())));
+	}
+
+	const double WeightSum = static_cast<double>(State.WeightSum) / EntropyWeightScale;
+	const double WeightLogWeightSum = static_cast<double>(State.WeightLogWeightSum) / EntropyWeightScale;
+	return FMath::Loge(WeightSum) - WeightLogWeightSum / WeightSum;
 }
 
 FCanalTileVariantKey FHexWfcSolver::ChooseVariant(
 	const TArray<FCanalTileVariantKey>& Candidates,
-	FRandomStream& Random,
+	const float PickFraction,
 	const TArray<float>& TileWeightScales) const
 {
 	check(Candidates.Num() > 0);
@@ -354,14 +2259,20 @@ FCanalTileVariantKey FHexWfcSolver::ChooseVariant(
 		return A.RotationSteps < B.RotationSteps;
 	});
 
+	// A variant stands for every rotation folded into it, so it carries their combined weight.
+	const auto GetCandidateWeight = [&](const FCanalTileVariantKey& Candidate)
+	{
+		const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(Candidate.TileIndex);
+		const float Scale = TileWeightScales.IsValidIndex(Candidate.TileIndex) ? FMath::Max(0.0f, TileWeightScales[Candidate.TileIndex]) : 1.0f;
+		const int32 VariantIndex = Compatibility.FindVariantIndex(Candidate);
+		const float Multiplicity = VariantIndex != INDEX_NONE ? static_cast<float>(Compatibility.GetVariantMultiplicity(VariantIndex)) : 1.0f;
+		return Tile ? FMath::Max(0.0f, Tile->Weight) * Scale * Multiplicity : 0.0f;
+	};
+
 	float TotalWeight = 0.0f;
 	for (const FCanalTileVariantKey& Candidate : Sorted)
 	{
-		if (const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(Candidate.TileIndex))
-		{
-			const float Scale = TileWeightScales.IsValidIndex(Candidate.TileIndex) ? FMath::Max(0.0f, TileWeightScales[Candidate.TileIndex]) : 1.0f;
-			TotalWeight += FMath::Max(0.0f, Tile->Weight) * Scale;
-		}
+		TotalWeight += GetCandidateWeight(Candidate);
 	}
 
 	if (TotalWeight <= KINDA_SMALL_NUMBER)
@@ -369,14 +2280,11 @@ FCanalTileVariantKey FHexWfcSolver::ChooseVariant(
 		return Sorted[0];
 	}
 
-	const float Pick = Random.FRandRange(0.0f, TotalWeight);
+	const float Pick = PickFraction * TotalWeight;
 	float Cumulative = 0.0f;
 	for (const FCanalTileVariantKey& Candidate : Sorted)
 	{
-		const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(Candidate.TileIndex);
-		const float Scale = TileWeightScales.IsValidIndex(Candidate.TileIndex) ? FMath::Max(0.0f, TileWeightScales[Candidate.TileIndex]) : 1.0f;
-		const float Weight = Tile ? FMath::Max(0.0f, Tile->Weight) * Scale : 0.0f;
-		Cumulative += Weight;
+		Cumulative += GetCandidateWeight(Candidate);
 		if (Pick <= Cumulative)
 		{
 			return Candidate;
@@ -386,6 +2294,22 @@ FCanalTileVariantKey FHexWfcSolver::ChooseVariant(
 	return Sorted.Last();
 }
 
+void FHexWfcSolver::GatherBitsetCandidates(const FCellState& State, TArray<FCanalTileVariantKey>& OutCandidates) const
+{
+	OutCandidates.Reset();
+	const TArray<FCanalTileVariantKey>& AllVariants = Compatibility.GetAllVariants();
+	for (int32 WordIndex = 0; WordIndex < State.DomainBits.Num(); ++WordIndex)
+	{
+		uint64 Word = State.DomainBits[WordIndex];
+		while (Word != 0)
+		{
+			const int32 VariantIndex = WordIndex * 64 + static_cast<int32>(FMath::CountTrailingZeros64(Word));
+			Word &= Word - 1;
+			OutCandidates.Add(AllVariants[VariantIndex]);
+		}
+	}
+}
+
 bool FHexWfcSolver::IsVariantAllowedByAnySource(
 	const FCanalTileVariantKey& Candidate,
 	const TArray<FCanalTileVariantKey>& SourceCandidates,
@@ -406,36 +2330,33 @@ bool FHexWfcSolver::IsVariantAllowedByAnySource(
 }
 
 bool FHexWfcSolver::ValidateSolvedState(
-	const TMap<FHexAxialCoord, FCellState>& States,
-	const FHexWfcGridConfig& Grid,
+	const FCellGrid& Cells,
+	const TArray<FCanalTileVariantKey>& Solved,
 	const FHexWfcSolveConfig& Config,
+	FWaterGraph& Graph,
 	FHexBoundaryPort& OutResolvedEntry,
 	FHexBoundaryPort& OutResolvedExit,
+	FHexWfcWaterAnalysis& OutWater,
 	bool& OutFailedSingleWaterComponent,
 	FString& OutError) const
 {
-	OutFailedSingleWaterComponent = false;
+	SCOPE_CYCLE_COUNTER(STAT_CanalWfc_Validate);
 
-	for (const TPair<FHexAxialCoord, FCellState>& Pair : States)
-	{
-		if (!Pair.Value.IsCollapsed())
-		{
-			OutError = FString::Printf(TEXT("Cell %s was not collapsed."), *Pair.Key.ToString());
-			return false;
-		}
-	}
+	OutFailedSingleWaterComponent = false;
 
 	OutResolvedEntry = Config.EntryPort;
 	OutResolvedExit = Config.ExitPort;
 
+	BuildWaterGraph(Cells, Solved, Graph, OutWater);
+
 	if (Config.bRequireEntryExitPath)
 	{
-		if (!ResolveBoundaryPorts(States, Grid, Config, OutResolvedEntry, OutResolvedExit, OutError))
+		if (!ResolveBoundaryPorts(Cells, Solved, Config, Graph, OutResolvedEntry, OutResolvedExit, OutError))
 		{
 			return false;
 		}
 
-		if (!HasEntryExitPath(States, Grid, OutResolvedEntry, OutResolvedExit))
+		if (!Graph.AreConnected(Cells.ToIndex(OutResolvedEntry.Coord), Cells.ToIndex(OutResolvedExit.Coord)))
 		{
 			OutError = TEXT("No water path exists between Entry and Exit ports.");
 			return false;
@@ -443,12 +2364,12 @@ bool FHexWfcSolver::ValidateSolvedState(
 	}
 	else
 	{
-		if (OutResolvedEntry.bEnabled && !ValidateBoundaryPort(States, Grid, OutResolvedEntry, OutError))
+		if (OutResolvedEntry.bEnabled && !ValidateBoundaryPort(Cells, Solved, OutResolvedEntry, OutError))
 		{
 			return false;
 		}
 
-		if (OutResolvedExit.bEnabled && !ValidateBoundaryPort(States, Grid, OutResolvedExit, OutError))
+		if (OutResolvedExit.bEnabled && !ValidateBoundaryPort(Cells, Solved, OutResolvedExit, OutError))
 		{
 			return false;
 		}
@@ -456,15 +2377,19 @@ bool FHexWfcSolver::ValidateSolvedState(
 
 	if (Config.bDisallowUnassignedBoundaryWater)
 	{
-		if (!ValidateBoundarySockets(States, Grid, OutResolvedEntry, OutResolvedExit, OutError))
+		if (!ValidateBoundarySockets(Cells, Solved, OutResolvedEntry, OutResolvedExit, OutError))
 		{
 			return false;
 		}
 	}
 
+	// Ports that passed validation lie inside the grid.
+	OutWater.bEntryExitConnected = OutResolvedEntry.bEnabled && OutResolvedExit.bEnabled
+		&& Graph.AreConnected(Cells.ToIndex(OutResolvedEntry.Coord), Cells.ToIndex(OutResolvedExit.Coord));
+
 	if (Config.bRequireSingleWaterComponent)
 	{
-		if (!HasSingleWaterComponent(States, Grid))
+		if (OutWater.NumWaterComponents > 1)
 		{
 			OutFailedSingleWaterComponent = true;
 			OutError = TEXT("Water graph has more than one connected component.");
@@ -476,9 +2401,10 @@ bool FHexWfcSolver::ValidateSolvedState(
 }
 
 bool FHexWfcSolver::ResolveBoundaryPorts(
-	const TMap<FHexAxialCoord, FCellState>& States,
-	const FHexWfcGridConfig& Grid,
+	const FCellGrid& Cells,
+	const TArray<FCanalTileVariantKey>& Solved,
 	const FHexWfcSolveConfig& Config,
+	FWaterGraph& Graph,
 	FHexBoundaryPort& OutEntry,
 	FHexBoundaryPort& OutExit,
 	FString& OutError) const
@@ -488,11 +2414,11 @@ bool FHexWfcSolver::ResolveBoundaryPorts(
 
 	if (bEntryProvided && bExitProvided)
 	{
-		if (!ValidateBoundaryPort(States, Grid, Config.EntryPort, OutError))
+		if (!ValidateBoundaryPort(Cells, Solved, Config.EntryPort, OutError))
 		{
 			return false;
 		}
-		if (!ValidateBoundaryPort(States, Grid, Config.ExitPort, OutError))
+		if (!ValidateBoundaryPort(Cells, Solved, Config.ExitPort, OutError))
 		{
 			return false;
 		}
@@ -513,7 +2439,7 @@ bool FHexWfcSolver::ResolveBoundaryPorts(
 	}
 
 	TArray<FHexBoundaryPort> Candidates;
-	CollectBoundaryWaterSockets(States, Grid, true, Candidates);
+	CollectBoundaryWaterSockets(Cells, Solved, true, Candidates);
 	if (Candidates.Num() < 2)
 	{
 		OutError = TEXT("Could not auto-select Entry/Exit ports: fewer than two explicit boundary water sockets found.");
@@ -536,7 +2462,7 @@ bool FHexWfcSolver::ResolveBoundaryPorts(
 	if (bEntryProvided || bExitProvided)
 	{
 		const FHexBoundaryPort Fixed = bEntryProvided ? Config.EntryPort : Config.ExitPort;
-		if (!ValidateBoundaryPort(States, Grid, Fixed, OutError))
+		if (!ValidateBoundaryPort(Cells, Solved, Fixed, OutError))
 		{
 			return false;
 		}
@@ -551,7 +2477,7 @@ bool FHexWfcSolver::ResolveBoundaryPorts(
 			{
 				continue;
 			}
-			if (!HasEntryExitPath(States, Grid, Fixed, Candidate))
+			if (!Graph.AreConnected(Cells.ToIndex(Fixed.Coord), Cells.ToIndex(Candidate.Coord)))
 			{
 				continue;
 			}
@@ -599,7 +2525,7 @@ bool FHexWfcSolver::ResolveBoundaryPorts(
 			{
 				continue;
 			}
-			if (!HasEntryExitPath(States, Grid, A, B))
+			if (!Graph.AreConnected(Cells.ToIndex(A.Coord), Cells.ToIndex(B.Coord)))
 			{
 				continue;
 			}
@@ -628,14 +2554,14 @@ bool FHexWfcSolver::ResolveBoundaryPorts(
 }
 
 bool FHexWfcSolver::ValidateBoundarySockets(
-	const TMap<FHexAxialCoord, FCellState>& States,
-	const FHexWfcGridConfig& Grid,
+	const FCellGrid& Cells,
+	const TArray<FCanalTileVariantKey>& Solved,
 	const FHexBoundaryPort& Entry,
 	const FHexBoundaryPort& Exit,
 	FString& OutError) const
 {
 	TArray<FHexBoundaryPort> BoundaryWaterSockets;
-	CollectBoundaryWaterSockets(States, Grid, false, BoundaryWaterSockets);
+	CollectBoundaryWaterSockets(Cells, Solved, false, BoundaryWaterSockets);
 
 	for (const FHexBoundaryPort& SocketPort : BoundaryWaterSockets)
 	{
@@ -644,13 +2570,7 @@ bool FHexWfcSolver::ValidateBoundarySockets(
 			continue;
 		}
 
-		const FCellState* Cell = States.Find(SocketPort.Coord);
-		if (!Cell || Cell->Candidates.Num() != 1)
-		{
-			continue;
-		}
-
-		const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(Cell->Candidates[0].TileIndex);
+		const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(Solved[Cells.ToIndex(SocketPort.Coord)].TileIndex);
 		const bool bExplicitlyAllowed = Tile && Tile->bAllowAsBoundaryPort;
 		if (!bExplicitlyAllowed)
 		{
@@ -666,56 +2586,45 @@ bool FHexWfcSolver::ValidateBoundarySockets(
 }
 
 void FHexWfcSolver::CollectBoundaryWaterSockets(
-	const TMap<FHexAxialCoord, FCellState>& States,
-	const FHexWfcGridConfig& Grid,
+	const FCellGrid& Cells,
+	const TArray<FCanalTileVariantKey>& Solved,
 	const bool bRequireExplicitBoundaryFlag,
 	TArray<FHexBoundaryPort>& OutPorts) const
 {
 	OutPorts.Reset();
 
-	for (int32 R = 0; R < Grid.Height; ++R)
+	for (int32 CellIndex = 0; CellIndex < Cells.Num(); ++CellIndex)
 	{
-		for (int32 Q = 0; Q < Grid.Width; ++Q)
+		const FCanalTileVariantKey& Variant = Solved[CellIndex];
+		const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(Variant.TileIndex);
+		if (!Tile)
 		{
-			const FHexAxialCoord Coord(Q, R);
-			const FCellState* Cell = States.Find(Coord);
-			if (!Cell || Cell->Candidates.Num() != 1)
-			{
-				continue;
-			}
+			continue;
+		}
+		if (bRequireExplicitBoundaryFlag && !Tile->bAllowAsBoundaryPort)
+		{
+			continue;
+		}
 
-			const FCanalTileVariantKey Variant = Cell->Candidates[0];
-			const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(Variant.TileIndex);
-			if (!Tile)
+		for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
+		{
+			if (Cells.GetNeighbor(CellIndex, DirIndex) != INDEX_NONE)
 			{
 				continue;
 			}
-			if (bRequireExplicitBoundaryFlag && !Tile->bAllowAsBoundaryPort)
+
+			const EHexDirection Direction = HexDirectionFromIndex(DirIndex);
+			const ECanalSocketType Socket = Tile->GetSocket(Direction, Variant.RotationSteps);
+			if (!IsWaterLikeSocket(Socket))
 			{
 				continue;
 			}
 
-			for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
-			{
-				const EHexDirection Direction = HexDirectionFromIndex(DirIndex);
-				const FHexAxialCoord OutsideNeighbor = Coord.Neighbor(Direction);
-				if (Grid.Contains(OutsideNeighbor))
-				{
-					continue;
-				}
-
-				const ECanalSocketType Socket = Tile->GetSocket(Direction, Variant.RotationSteps);
-				if (!IsWaterLikeSocket(Socket))
-				{
-					continue;
-				}
-
-				FHexBoundaryPort Port;
-				Port.bEnabled = true;
-				Port.Coord = Coord;
-				Port.Direction = Direction;
-				OutPorts.Add(Port);
-			}
+			FHexBoundaryPort Port;
+			Port.bEnabled = true;
+			Port.Coord = Cells.ToCoord(CellIndex);
+			Port.Direction = Direction;
+			OutPorts.Add(Port);
 		}
 	}
 }
@@ -726,32 +2635,25 @@ bool FHexWfcSolver::IsSamePort(const FHexBoundaryPort& A, const FHexBoundaryPort
 }
 
 bool FHexWfcSolver::ValidateBoundaryPort(
-	const TMap<FHexAxialCoord, FCellState>& States,
-	const FHexWfcGridConfig& Grid,
+	const FCellGrid& Cells,
+	const TArray<FCanalTileVariantKey>& Solved,
 	const FHexBoundaryPort& Port,
 	FString& OutError) const
 {
-	if (!Grid.Contains(Port.Coord))
+	if (!Cells.Contains(Port.Coord))
 	{
 		OutError = FString::Printf(TEXT("Port coord %s is outside grid."), *Port.Coord.ToString());
 		return false;
 	}
 
-	const FHexAxialCoord OutsideNeighbor = Port.Coord.Neighbor(Port.Direction);
-	if (Grid.Contains(OutsideNeighbor))
+	const int32 CellIndex = Cells.ToIndex(Port.Coord);
+	if (Cells.GetNeighbor(CellIndex, HexDirectionToIndex(Port.Direction)) != INDEX_NONE)
 	{
 		OutError = FString::Printf(TEXT("Port at %s is not on boundary for direction %d."), *Port.Coord.ToString(), HexDirectionToIndex(Port.Direction));
 		return false;
 	}
 
-	const FCellState* Cell = States.Find(Port.Coord);
-	if (!Cell || Cell->Candidates.Num() != 1)
-	{
-		OutError = FString::Printf(TEXT("Port cell %s is not collapsed."), *Port.Coord.ToString());
-		return false;
-	}
-
-	const FCanalTileVariantKey Variant = Cell->Candidates[0];
+	const FCanalTileVariantKey& Variant = Solved[CellIndex];
 	const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(Variant.TileIndex);
 	if (!Tile)
 	{
@@ -769,183 +2671,211 @@ bool FHexWfcSolver::ValidateBoundaryPort(
 	return true;
 }
 
-bool FHexWfcSolver::HasEntryExitPath(
-	const TMap<FHexAxialCoord, FCellState>& States,
-	const FHexWfcGridConfig& Grid,
-	const FHexBoundaryPort& Entry,
-	const FHexBoundaryPort& Exit) const
+int32 FHexWfcSolver::FWaterGraph::FindComponent(int32 CellIndex)
 {
-	if (Entry.Coord == Exit.Coord)
+	while (Components[CellIndex] != CellIndex)
 	{
-		return true;
+		Components[CellIndex] = Components[Components[CellIndex]];
+		CellIndex = Components[CellIndex];
 	}
+	return CellIndex;
+}
 
-	TSet<FHexAxialCoord> Visited;
-	TQueue<FHexAxialCoord> Queue;
-
-	Queue.Enqueue(Entry.Coord);
-	Visited.Add(Entry.Coord);
-
-	while (!Queue.IsEmpty())
+void FHexWfcSolver::BuildWaterGraph(
+	const FCellGrid& Cells,
+	const TArray<FCanalTileVariantKey>& Solved,
+	FWaterGraph& Graph,
+	FHexWfcWaterAnalysis& OutWater) const
+{
+	const int32 NumCells = Cells.Num();
+	TArray<ECanalSocketType>& Sockets = Graph.Sockets;
+	Sockets.SetNumUninitialized(NumCells * 6);
+	Graph.WaterCells.SetNumUninitialized(NumCells);
+	Graph.Links.SetNumZeroed(NumCells);
+	Graph.Components.SetNumUninitialized(NumCells);
+
+	OutWater = FHexWfcWaterAnalysis();
+	for (int32 CellIndex = 0; CellIndex < NumCells; ++CellIndex)
 	{
-		FHexAxialCoord Current;
-		Queue.Dequeue(Current);
-
+		const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(Solved[CellIndex].TileIndex);
+		bool bWaterCell = false;
 		for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
 		{
-			const EHexDirection Direction = HexDirectionFromIndex(DirIndex);
-			const FHexAxialCoord Neighbor = Current.Neighbor(Direction);
-			if (!Grid.Contains(Neighbor) || Visited.Contains(Neighbor))
-			{
-				continue;
-			}
+			const ECanalSocketType Socket = Tile ? Tile->GetSocket(HexDirectionFromIndex(DirIndex), Solved[CellIndex].RotationSteps) : ECanalSocketType::Bank;
+			Sockets[CellIndex * 6 + DirIndex] = Socket;
+			bWaterCell |= IsWaterLikeSocket(Socket);
+		}
+		Graph.WaterCells[CellIndex] = bWaterCell;
+		Graph.Components[CellIndex] = CellIndex;
+		OutWater.NumWaterCells += bWaterCell ? 1 : 0;
+	}
 
-			if (!AreCellsWaterConnected(States, Current, Neighbor, Direction))
+	// Each edge is seen from both ends; union it from the lower-index one.
+	OutWater.NumWaterComponents = OutWater.NumWaterCells;
+	for (int32 CellIndex = 0; CellIndex < NumCells; ++CellIndex)
+	{
+		for (int32 DirIndex = 0; Graph.WaterCells[CellIndex] && DirIndex < 6; ++DirIndex)
+		{
+			const int32 Neighbor = Cells.GetNeighbor(CellIndex, DirIndex);
+			const ECanalSocketType Socket = Sockets[CellIndex * 6 + DirIndex];
+			if (Neighbor == INDEX_NONE || !IsWaterLikeSocket(Socket) || Sockets[Neighbor * 6 + (DirIndex + 3) % 6] != Socket)
 			{
 				continue;
 			}
 
-			if (Neighbor == Exit.Coord)
+			Graph.Links[CellIndex] |= uint8(1) << DirIndex;
+			if (Neighbor > CellIndex)
 			{
-				return true;
+				const int32 Root = Graph.FindComponent(CellIndex);
+				const int32 NeighborRoot = Graph.FindComponent(Neighbor);
+				if (Root != NeighborRoot)
+				{
+					Graph.Components[FMath::Max(Root, NeighborRoot)] = FMath::Min(Root, NeighborRoot);
+					--OutWater.NumWaterComponents;
+				}
 			}
-
-			Visited.Add(Neighbor);
-			Queue.Enqueue(Neighbor);
 		}
 	}
-
-	return false;
 }
 
-bool FHexWfcSolver::HasSingleWaterComponent(
-	const TMap<FHexAxialCoord, FCellState>& States,
-	const FHexWfcGridConfig& Grid) const
+void FHexWfcSolver::FindWaterPath(
+	const FCellGrid& Cells,
+	FWaterGraph& Graph,
+	const FHexBoundaryPort& Entry,
+	const FHexBoundaryPort& Exit,
+	FHexWfcWaterAnalysis& InOutWater) const
 {
-	TSet<FHexAxialCoord> WaterCells;
-	for (const TPair<FHexAxialCoord, FCellState>& Pair : States)
+	InOutWater.WaterPath.Reset();
+	if (InOutWater.bEntryExitConnected)
 	{
-		if (IsWaterCell(States, Pair.Key))
-		{
-			WaterCells.Add(Pair.Key);
-		}
+		SearchWaterLinks(Cells, Graph, Cells.ToIndex(Entry.Coord), Cells.ToIndex(Exit.Coord), &InOutWater.WaterPath);
+		return;
 	}
 
-	if (WaterCells.Num() <= 1)
+	if (InOutWater.NumWaterCells < 2)
 	{
-		return true;
+		return;
 	}
 
-	TSet<FHexAxialCoord> Visited;
-	int32 Components = 0;
-
-	for (const FHexAxialCoord& Start : WaterCells)
+	// Roots are the lowest cell of their component, so ties go to the component that starts first.
+	TArray<int32>& Sizes = Graph.Parents;
+	Sizes.Init(0, Cells.Num());
+	int32 LargestRoot = INDEX_NONE;
+	for (int32 CellIndex = 0; CellIndex < Cells.Num(); ++CellIndex)
 	{
-		if (Visited.Contains(Start))
+		if (Graph.WaterCells[CellIndex])
 		{
-			continue;
+			++Sizes[Graph.FindComponent(CellIndex)];
 		}
-
-		++Components;
-		if (Components > 1)
+	}
+	for (int32 CellIndex = 0; CellIndex < Cells.Num(); ++CellIndex)
+	{
+		if (Sizes[CellIndex] > 0 && (LargestRoot == INDEX_NONE || Sizes[CellIndex] > Sizes[LargestRoot]))
 		{
-			return false;
+			LargestRoot = CellIndex;
 		}
+	}
 
-		TQueue<FHexAxialCoord> Queue;
-		Queue.Enqueue(Start);
-		Visited.Add(Start);
+	const int32 FarEnd = SearchWaterLinks(Cells, Graph, LargestRoot, INDEX_NONE, nullptr);
+	SearchWaterLinks(Cells, Graph, FarEnd, INDEX_NONE, &InOutWater.WaterPath);
+	if (InOutWater.WaterPath.Num() < 2)
+	{
+		InOutWater.WaterPath.Reset();
+	}
+}
 
-		while (!Queue.IsEmpty())
+int32 FHexWfcSolver::SearchWaterLinks(
+	const FCellGrid& Cells,
+	FWaterGraph& Graph,
+	const int32 Start,
+	const int32 Goal,
+	TArray<FHexAxialCoord>* OutPath)
+{
+	TArray<int32>& Parents = Graph.Parents;
+	TArray<int32>& Queue = Graph.Queue;
+	Parents.Init(INDEX_NONE, Cells.Num());
+	Queue.Reset();
+	Queue.Add(Start);
+	Parents[Start] = Start;
+
+	int32 End = Start;
+	for (int32 QueueHead = 0; QueueHead < Queue.Num() && End != Goal; ++QueueHead)
+	{
+		const int32 Current = Queue[QueueHead];
+		End = Current;
+		for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
 		{
-			FHexAxialCoord Current;
-			Queue.Dequeue(Current);
-
-			for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
+			const int32 Neighbor = Cells.GetNeighbor(Current, DirIndex);
+			if ((Graph.Links[Current] & (uint8(1) << DirIndex)) != 0 && Parents[Neighbor] == INDEX_NONE)
 			{
-				const EHexDirection Direction = HexDirectionFromIndex(DirIndex);
-				const FHexAxialCoord Neighbor = Current.Neighbor(Direction);
-				if (!Grid.Contains(Neighbor) || !WaterCells.Contains(Neighbor) || Visited.Contains(Neighbor))
-				{
-					continue;
-				}
-
-				if (!AreCellsWaterConnected(States, Current, Neighbor, Direction))
-				{
-					continue;
-				}
-
-				Visited.Add(Neighbor);
-				Queue.Enqueue(Neighbor);
+				Parents[Neighbor] = Current;
+				Queue.Add(Neighbor);
 			}
 		}
 	}
 
-	return true;
-}
-
-bool FHexWfcSolver::AreCellsWaterConnected(
-	const TMap<FHexAxialCoord, FCellState>& States,
-	const FHexAxialCoord& Source,
-	const FHexAxialCoord& Target,
-	const EHexDirection Direction) const
-{
-	const FCellState* SourceCell = States.Find(Source);
-	const FCellState* TargetCell = States.Find(Target);
-	if (!SourceCell || !TargetCell || SourceCell->Candidates.Num() != 1 || TargetCell->Candidates.Num() != 1)
+	if (Goal != INDEX_NONE && End != Goal)
 	{
-		return false;
+		End = Parents[Goal] != INDEX_NONE ? Goal : INDEX_NONE;
 	}
 
-	const FCanalTileVariantKey SourceVariant = SourceCell->Candidates[0];
-	const FCanalTileVariantKey TargetVariant = TargetCell->Candidates[0];
-
-	const FCanalTopologyTileDefinition* SourceTile = Compatibility.GetTileDefinition(SourceVariant.TileIndex);
-	const FCanalTopologyTileDefinition* TargetTile = Compatibility.GetTileDefinition(TargetVariant.TileIndex);
-	if (!SourceTile || !TargetTile)
+	if (OutPath)
 	{
-		return false;
+		OutPath->Reset();
+		for (int32 Cursor = End; Cursor != INDEX_NONE; Cursor = Cursor == Start ? INDEX_NONE : Parents[Cursor])
+		{
+			OutPath->Add(Cells.ToCoord(Cursor));
+		}
+		Algo::Reverse(*OutPath);
 	}
+	return End;
+}
 
-	const ECanalSocketType SourceSocket = SourceTile->GetSocket(Direction, SourceVariant.RotationSteps);
-	const ECanalSocketType TargetSocket = TargetTile->GetSocket(OppositeHexDirection(Direction), TargetVariant.RotationSteps);
-	return SourceSocket == TargetSocket && IsWaterLikeSocket(SourceSocket);
+bool FHexWfcSolver::IsWaterLikeSocket(const ECanalSocketType Socket)
+{
+	return Socket == ECanalSocketType::Water || Socket == ECanalSocketType::Lock;
 }
 
-bool FHexWfcSolver::IsWaterCell(const TMap<FHexAxialCoord, FCellState>& States, const FHexAxialCoord& Coord) const
+FHexWfcSolveResult UCanalWfcBlueprintLibrary::SolveHexWfc(
+	const UCanalTopologyTileSetAsset* TileSet,
+	const FHexWfcGridConfig& Grid,
+	const FHexWfcSolveConfig& Config)
 {
-	const FCellState* Cell = States.Find(Coord);
-	if (!Cell || Cell->Candidates.Num() != 1)
+	FHexWfcSolveResult Result;
+	if (!TileSet)
 	{
-		return false;
+		Result.Message = TEXT("TileSet is null.");
+		return Result;
 	}
 
-	const FCanalTileVariantKey Variant = Cell->Candidates[0];
-	const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(Variant.TileIndex);
-	if (!Tile)
+	const FCanalTileCompatibilityTable& Compatibility = TileSet->GetCompatibilityTable();
+	if (!Compatibility.IsBuilt())
 	{
-		return false;
+		Result.Message = TEXT("TileSet compatibility cache is not built. Validate tile definitions first.");
+		return Result;
 	}
 
-	for (int32 DirectionIndex = 0; DirectionIndex < 6; ++DirectionIndex)
-	{
-		if (IsWaterLikeSocket(Tile->GetSocket(HexDirectionFromIndex(DirectionIndex), Variant.RotationSteps)))
-		{
-			return true;
-		}
-	}
-	return false;
+	const FHexWfcSolver Solver(Compatibility);
+	return Solver.Solve(Grid, Config);
 }
 
-bool FHexWfcSolver::IsWaterLikeSocket(const ECanalSocketType Socket)
+FHexWfcSolveResult UCanalWfcBlueprintLibrary::SolveHexWfcRegion(
+	const UCanalTopologyTileSetAsset* TileSet,
+	const FHexWfcGridConfig& Grid,
+	const FHexWfcSolveConfig& Config,
+	const FHexWfcSolveResult& Previous,
+	const TArray<FHexAxialCoord>& Region)
 {
-	return Socket == ECanalSocketType::Water || Socket == ECanalSocketType::Lock;
+	return SolveHexWfcRegion(TileSet, Grid, Config, Previous, Region, nullptr);
 }
 
-FHexWfcSolveResult UCanalWfcBlueprintLibrary::SolveHexWfc(
+FHexWfcSolveResult UCanalWfcBlueprintLibrary::SolveHexWfcRegion(
 	const UCanalTopologyTileSetAsset* TileSet,
 	const FHexWfcGridConfig& Grid,
-	const FHexWfcSolveConfig& Config)
+	const FHexWfcSolveConfig& Config,
+	const FHexWfcSolveResult& Previous,
+	const TArray<FHexAxialCoord>& Region,
+	FHexWfcSolveControl* Control)
 {
 	FHexWfcSolveResult Result;
 	if (!TileSet)
@@ -962,7 +2892,7 @@ FHexWfcSolveResult UCanalWfcBlueprintLibrary::SolveHexWfc(
 	}
 
 	const FHexWfcSolver Solver(Compatibility);
-	return Solver.Solve(Grid, Config);
+	return Solver.SolveRegion(Grid, Config, Previous, Region, Control);
 }
 
 FHexWfcBatchStats UCanalWfcBlueprintLibrary::RunHexWfcBatch(
@@ -971,6 +2901,8 @@ FHexWfcBatchStats UCanalWfcBlueprintLibrary::RunHexWfcBatch(
 	const FHexWfcSolveConfig& ConfigTemplate,
 	const FHexWfcBatchConfig& BatchConfig)
 {
+	SCOPE_CYCLE_COUNTER(STAT_CanalWfc_Batch);
+
 	FHexWfcBatchStats Stats;
 	Stats.NumSeedsRequested = FMath::Max(0, BatchConfig.NumSeeds);
 
@@ -994,36 +2926,90 @@ FHexWfcBatchStats UCanalWfcBlueprintLibrary::RunHexWfcBatch(
 	};
 
 	TMap<int32, int32> AttemptCounts;
+	TMap<int32, int32> BacktrackBucketCounts;
 	TMap<FName, int32> TileCounts;
-	int64 TotalAttempts = 0;
-	float TotalSolveTimeSeconds = 0.0f;
+	FHexWfcSolveProfile TotalProfile;
 	int32 TotalSolvedCells = 0;
 
-	for (int32 SeedOffset = 0; SeedOffset < Stats.NumSeedsRequested; ++SeedOffset)
+	TArray<FHexWfcSeedOutcome> Outcomes;
+	Outcomes.SetNum(Stats.NumSeedsRequested);
+
+	const auto RunSeed = [&](FHexWfcSolverWorkspace& Workspace, const int32 SeedOffset)
 	{
 		const float BatchElapsed = GetBatchElapsedSeconds();
 		if (BatchConfig.MaxBatchTimeSeconds > 0.0f && BatchElapsed >= BatchConfig.MaxBatchTimeSeconds)
 		{
-			Stats.bBatchTimeLimitExceeded = true;
-			break;
+			return;
 		}
 
 		FHexWfcSolveConfig Config = ConfigTemplate;
 		Config.Seed = BatchConfig.StartSeed + SeedOffset;
 
-		const FHexWfcSolveResult Result = Solver.Solve(Grid, Config);
-		++Stats.NumSeedsProcessed;
-		TotalAttempts += Result.AttemptsUsed;
-		TotalSolveTimeSeconds += Result.SolveTimeSeconds;
-		AttemptCounts.FindOrAdd(Result.AttemptsUsed) += 1;
-
+		const FHexWfcSolveResult Result = Solver.Solve(Grid, Config, Workspace);
+		FHexWfcSeedOutcome& Outcome = Outcomes[SeedOffset];
+		Outcome.bProcessed = true;
+		Outcome.bSolved = Result.bSolved;
+		Outcome.bContradiction = Result.bContradiction;
+		Outcome.bTimeBudgetExceeded = Result.bTimeBudgetExceeded;
+		Outcome.bFailedSingleWaterComponent = Result.bFailedSingleWaterComponent;
+		Outcome.AttemptsUsed = Result.AttemptsUsed;
+		Outcome.Backtracks = Result.Backtracks;
+		Outcome.SolveTimeSeconds = Result.SolveTimeSeconds;
+		Outcome.Profile = Result.Profile;
 		if (Result.bSolved)
 		{
-			++Stats.NumSolved;
 			for (const FHexWfcCellResult& Cell : Result.Cells)
 			{
-				TileCounts.FindOrAdd(Cell.Variant.TileId) += 1;
-				++TotalSolvedCells;
+				Outcome.TileCounts.FindOrAdd(Cell.Variant.TileId) += 1;
+			}
+		}
+	};
+
+	if (BatchConfig.bRunInParallel)
+	{
+		// Seeds are handed out one at a time so a few slow seeds do not hold up a whole chunk. Each worker keeps one
+		// solver workspace for all the seeds it runs.
+		TArray<FHexWfcSolverWorkspace> Workspaces;
+		ParallelForWithTaskContext(Workspaces, Stats.NumSeedsRequested, RunSeed, EParallelForFlags::Unbalanced);
+	}
+	else
+	{
+		FHexWfcSolverWorkspace Workspace;
+		for (int32 SeedOffset = 0; SeedOffset < Stats.NumSeedsRequested; ++SeedOffset)
+		{
+			RunSeed(Workspace, SeedOffset);
+			if (!Outcomes[SeedOffset].bProcessed)
+			{
+				break;
+			}
+		}
+	}
+
+	// Aggregate in seed order over the leading run of processed seeds, so a parallel batch reports exactly what a
+	// serial batch cut off at the same seed would. Seeds finished past the first skipped one are dropped.
+	for (const FHexWfcSeedOutcome& Outcome : Outcomes)
+	{
+		if (!Outcome.bProcessed)
+		{
+			Stats.bBatchTimeLimitExceeded = true;
+			break;
+		}
+
+		++Stats.NumSeedsProcessed;
+		Stats.TotalAttemptsUsed += Outcome.AttemptsUsed;
+		Stats.TotalSolveTimeSeconds += Outcome.SolveTimeSeconds;
+		TotalProfile.Accumulate(Outcome.Profile);
+		AttemptCounts.FindOrAdd(Outcome.AttemptsUsed) += 1;
+		Stats.TotalBacktracks += Outcome.Backtracks;
+		BacktrackBucketCounts.FindOrAdd(Outcome.Backtracks > 0 ? FMath::FloorLog2(static_cast<uint32>(Outcome.Backtracks)) + 1 : 0) += 1;
+
+		if (Outcome.bSolved)
+		{
+			++Stats.NumSolved;
+			for (const TPair<FName, int32>& TileCount : Outcome.TileCounts)
+			{
+				TileCounts.FindOrAdd(TileCount.Key) += TileCount.Value;
+				TotalSolvedCells += TileCount.Value;
 			}
 		}
 		else
@@ -1031,69 +3017,88 @@ FHexWfcBatchStats UCanalWfcBlueprintLibrary::RunHexWfcBatch(
 			++Stats.NumFailed;
 		}
 
-		if (Result.bContradiction)
+		if (Outcome.bContradiction)
 		{
 			++Stats.NumContradictions;
 		}
-		if (Result.bTimeBudgetExceeded)
+		if (Outcome.bTimeBudgetExceeded)
 		{
 			++Stats.NumTimeBudgetExceeded;
 		}
-		if (Result.bFailedSingleWaterComponent)
+		if (Outcome.bFailedSingleWaterComponent)
 		{
 			++Stats.NumSingleWaterComponentFailures;
 		}
 	}
 
+	Stats.TotalPropagationSteps = TotalProfile.PropagationSteps;
+	Stats.AverageProfile = TotalProfile;
 	if (Stats.NumSeedsProcessed > 0)
 	{
-		Stats.ContradictionRate = static_cast<float>(Stats.NumContradictions) / static_cast<float>(Stats.NumSeedsProcessed);
-		Stats.AverageAttemptsUsed = static_cast<float>(TotalAttempts) / static_cast<float>(Stats.NumSeedsProcessed);
-		Stats.AverageSolveTimeSeconds = TotalSolveTimeSeconds / static_cast<float>(Stats.NumSeedsProcessed);
+		Stats.AverageProfile.ScalePhases(1.0f / static_cast<float>(Stats.NumSeedsProcessed));
 	}
+	Stats.UpdateAverages();
 
 	Stats.ElapsedBatchTimeSeconds = GetBatchElapsedSeconds();
+	BuildBatchHistograms(AttemptCounts, BacktrackBucketCounts, TileCounts, TotalSolvedCells, Stats);
 
-	TArray<TPair<int32, int32>> AttemptPairs;
-	for (const TPair<int32, int32>& Pair : AttemptCounts)
-	{
-		AttemptPairs.Add(Pair);
-	}
-	AttemptPairs.Sort([](const TPair<int32, int32>& A, const TPair<int32, int32>& B)
-	{
-		return A.Key < B.Key;
-	});
+	return Stats;
+}
 
-	for (const TPair<int32, int32>& Pair : AttemptPairs)
-	{
-		FHexWfcAttemptHistogramBin Bin;
-		Bin.Attempts = Pair.Key;
-		Bin.Count = Pair.Value;
-		Stats.AttemptHistogram.Add(Bin);
-	}
+FHexWfcBatchStats UCanalWfcBlueprintLibrary::MergeHexWfcBatchStats(const TArray<FHexWfcBatchStats>& Parts)
+{
+	FHexWfcBatchStats Stats;
+	TMap<int32, int32> AttemptCounts;
+	TMap<int32, int32> BacktrackBucketCounts;
+	TMap<FName, int32> TileCounts;
+	FHexWfcSolveProfile TotalProfile;
+	int64 TotalSolvedCells = 0;
 
-	TArray<TPair<FName, int32>> TilePairs;
-	for (const TPair<FName, int32>& Pair : TileCounts)
-	{
-		TilePairs.Add(Pair);
-	}
-	TilePairs.Sort([](const TPair<FName, int32>& A, const TPair<FName, int32>& B)
+	for (const FHexWfcBatchStats& Part : Parts)
 	{
-		if (A.Value != B.Value)
+		Stats.NumSeedsRequested += Part.NumSeedsRequested;
+		Stats.NumSeedsProcessed += Part.NumSeedsProcessed;
+		Stats.NumSolved += Part.NumSolved;
+		Stats.NumFailed += Part.NumFailed;
+		Stats.NumContradictions += Part.NumContradictions;
+		Stats.NumTimeBudgetExceeded += Part.NumTimeBudgetExceeded;
+		Stats.NumSingleWaterComponentFailures += Part.NumSingleWaterComponentFailures;
+		Stats.ElapsedBatchTimeSeconds += Part.ElapsedBatchTimeSeconds;
+		Stats.bBatchTimeLimitExceeded |= Part.bBatchTimeLimitExceeded;
+
+		Stats.TotalAttemptsUsed += Part.TotalAttemptsUsed;
+		Stats.TotalBacktracks += Part.TotalBacktracks;
+		Stats.TotalPropagationSteps += Part.TotalPropagationSteps;
+		Stats.TotalSolveTimeSeconds += Part.TotalSolveTimeSeconds;
+
+		// Phase times are only kept as averages, so they are weighted back up by each part's seed count.
+		FHexWfcSolveProfile PartProfile = Part.AverageProfile;
+		PartProfile.ScalePhases(static_cast<float>(Part.NumSeedsProcessed));
+		PartProfile.PropagationSteps = 0;
+		TotalProfile.Accumulate(PartProfile);
+
+		for (const FHexWfcAttemptHistogramBin& Bin : Part.AttemptHistogram)
 		{
-			return A.Value > B.Value;
+			AttemptCounts.FindOrAdd(Bin.Attempts) += Bin.Count;
 		}
-		return A.Key.LexicalLess(B.Key);
-	});
+		for (const FHexWfcBacktrackHistogramBin& Bin : Part.BacktrackHistogram)
+		{
+			BacktrackBucketCounts.FindOrAdd(Bin.MinBacktracks > 0 ? FMath::FloorLog2(static_cast<uint32>(Bin.MinBacktracks)) + 1 : 0) += Bin.Count;
+		}
+		for (const FHexWfcTileHistogramBin& Bin : Part.TileHistogram)
+		{
+			TileCounts.FindOrAdd(Bin.TileId) += Bin.Count;
+			TotalSolvedCells += Bin.Count;
+		}
+	}
 
-	for (const TPair<FName, int32>& Pair : TilePairs)
+	Stats.AverageProfile = TotalProfile;
+	if (Stats.NumSeedsProcessed > 0)
 	{
-		FHexWfcTileHistogramBin Bin;
-		Bin.TileId = Pair.Key;
-		Bin.Count = Pair.Value;
-		Bin.Fraction = TotalSolvedCells > 0 ? static_cast<float>(Pair.Value) / static_cast<float>(TotalSolvedCells) : 0.0f;
-		Stats.TileHistogram.Add(Bin);
+		Stats.AverageProfile.ScalePhases(1.0f / static_cast<float>(Stats.NumSeedsProcessed));
 	}
+	Stats.UpdateAverages();
 
+	BuildBatchHistograms(AttemptCounts, BacktrackBucketCounts, TileCounts, TotalSolvedCells, Stats);
 	return Stats;
 }
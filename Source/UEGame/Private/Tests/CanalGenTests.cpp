@@ -1,14 +1,23 @@
 #if WITH_DEV_AUTOMATION_TESTS
 
 #include "Misc/AutomationTest.h"
+#include "Async/ParallelFor.h"
 
+#include "CanalGen/CanalCounterRandom.h"
 #include "CanalGen/CanalPrototypeTileSet.h"
 #include "CanalGen/CanalScenarioInterface.h"
 #include "CanalGen/CanalTopologyGeneratorActor.h"
 #include "CanalGen/CanalTopologyTileSetAsset.h"
 #include "CanalGen/CanalTopologyTileTypes.h"
 #include "CanalGen/HexGridTypes.h"
+#include "CanalGen/HexWfcBenchmark.h"
+#include "CanalGen/HexWfcBitsetKernels.h"
+#include "CanalGen/HexWfcChunkedSolver.h"
+#include "CanalGen/HexWfcHierarchicalSolver.h"
 #include "CanalGen/HexWfcSolver.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
 
 namespace
 {
@@ -107,6 +116,33 @@ namespace
 		return Config;
 	}
 
+	void TestSameSolveResult(
+		FAutomationTestBase& Test,
+		const FString& Context,
+		const FHexWfcSolveResult& Expected,
+		const FHexWfcSolveResult& Actual)
+	{
+		Test.TestEqual(FString::Printf(TEXT("%s: solved flag should match."), *Context), Actual.bSolved, Expected.bSolved);
+		Test.TestEqual(FString::Printf(TEXT("%s: attempts should match."), *Context), Actual.AttemptsUsed, Expected.AttemptsUsed);
+		if (!Test.TestEqual(FString::Printf(TEXT("%s: cell count should match."), *Context), Actual.Cells.Num(), Expected.Cells.Num()))
+		{
+			return;
+		}
+
+		for (int32 CellIndex = 0; CellIndex < Expected.Cells.Num(); ++CellIndex)
+		{
+			const FHexWfcCellResult& ExpectedCell = Expected.Cells[CellIndex];
+			const FHexWfcCellResult& ActualCell = Actual.Cells[CellIndex];
+			if (ExpectedCell.Coord != ActualCell.Coord
+				|| ExpectedCell.Variant.TileIndex != ActualCell.Variant.TileIndex
+				|| ExpectedCell.Variant.RotationSteps != ActualCell.Variant.RotationSteps)
+			{
+				Test.AddError(FString::Printf(TEXT("%s: diverged at cell %s."), *Context, *ExpectedCell.Coord.ToString()));
+				return;
+			}
+		}
+	}
+
 	bool ValidateSolvedAdjacency(
 		FAutomationTestBase& Test,
 		const FCanalTileCompatibilityTable& Compatibility,
@@ -158,6 +194,40 @@ namespace
 
 		return true;
 	}
+
+	// Revise and choose over consecutive pairs of Domains, NumRounds times. The kernels are called directly, so they
+	// inline into this loop the way they do in the solver's attempt loop. Returns the elapsed seconds.
+	template <int32 FixedWords>
+	double RunBitsetKernelRounds(
+		const FCanalTileCompatibilityTable& Compatibility,
+		const TArray<uint64>& Domains,
+		const int32 NumRounds,
+		const TArray<float>& Weights,
+		TArray<uint64>& Kept,
+		int64& OutChecksum)
+	{
+		using FKernels = THexWfcBitsetKernels<FixedWords>;
+		const int32 NumWords = FKernels::GetNumWords(Compatibility);
+		const int32 NumDomains = Domains.Num() / NumWords;
+		const FCanalCounterRandom PickRandom(7, 0);
+		OutChecksum = 0;
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Round = 0; Round < NumRounds; ++Round)
+		{
+			for (int32 DomainIndex = 0; DomainIndex + 1 < NumDomains; ++DomainIndex)
+			{
+				const uint64* Source = &Domains[DomainIndex * NumWords];
+				const uint64* Target = &Domains[(DomainIndex + 1) * NumWords];
+				const int32 KeptCount = FKernels::Revise(Compatibility, Source, Target, (DomainIndex + Round) % 6, Kept.GetData());
+				OutChecksum = OutChecksum * 31 + KeptCount + static_cast<int64>(Kept[0] & 0xffff);
+				if (KeptCount > 0)
+				{
+					OutChecksum += FKernels::Choose(Compatibility, Kept.GetData(), KeptCount, Weights.GetData(), 0.0f, PickRandom.GetFraction(DomainIndex, Round));
+				}
+			}
+		}
+		return FPlatformTime::Seconds() - StartTime;
+	}
 }
 
 IMPLEMENT_SIMPLE_AUTOMATION_TEST(
@@ -292,6 +362,216 @@ bool FCanalTileCompatibilityDescribeTest::RunTest(const FString& Parameters)
 	return true;
 }
 
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FCanalTileCompatibilitySocketBucketsTest,
+	"UEGame.Canal.Tile.CompatibilitySocketBuckets",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCanalTileCompatibilitySocketBucketsTest::RunTest(const FString& Parameters)
+{
+	const TArray<FCanalTopologyTileDefinition> TileSet = FCanalPrototypeTileSet::BuildV0();
+
+	FCanalTileCompatibilityTable Compatibility;
+	FString Error;
+	if (!Compatibility.Build(TileSet, &Error))
+	{
+		AddError(FString::Printf(TEXT("Failed to build compatibility: %s"), *Error));
+		return false;
+	}
+
+	// Every compatibility query must agree with pairwise socket equality.
+	const TArray<FCanalTileVariantKey>& Variants = Compatibility.GetAllVariants();
+	int32 Mismatches = 0;
+	for (int32 SourceIndex = 0; SourceIndex < Variants.Num(); ++SourceIndex)
+	{
+		const FCanalTopologyTileDefinition& SourceTile = TileSet[Variants[SourceIndex].TileIndex];
+		for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
+		{
+			const EHexDirection Direction = HexDirectionFromIndex(DirIndex);
+			const ECanalSocketType SourceSocket = SourceTile.GetSocket(Direction, Variants[SourceIndex].RotationSteps);
+			const uint64* Mask = Compatibility.GetCompatibleVariantMask(SourceIndex, Direction);
+			const TConstArrayView<int32> Indices = Compatibility.GetCompatibleVariantIndices(SourceIndex, Direction);
+			const TArray<FCanalTileVariantKey>& Keys = Compatibility.GetCompatibleVariants(Variants[SourceIndex], Direction);
+			Mismatches += Compatibility.GetVariantSocket(SourceIndex, DirIndex) != static_cast<int32>(SourceSocket) ? 1 : 0;
+
+			TArray<int32> Expected;
+			for (int32 TargetIndex = 0; TargetIndex < Variants.Num(); ++TargetIndex)
+			{
+				const FCanalTopologyTileDefinition& TargetTile = TileSet[Variants[TargetIndex].TileIndex];
+				const bool bExpected = TargetTile.GetSocket(OppositeHexDirection(Direction), Variants[TargetIndex].RotationSteps) == SourceSocket;
+				const bool bInMask = (Mask[TargetIndex / 64] & (uint64(1) << (TargetIndex % 64))) != 0;
+				Mismatches += bExpected != bInMask ? 1 : 0;
+				if (bExpected)
+				{
+					Expected.Add(TargetIndex);
+				}
+			}
+
+			bool bListsMatch = Indices.Num() == Expected.Num() && Keys.Num() == Expected.Num();
+			for (int32 Index = 0; bListsMatch && Index < Expected.Num(); ++Index)
+			{
+				bListsMatch = Indices[Index] == Expected[Index] && Keys[Index] == Variants[Expected[Index]];
+			}
+			Mismatches += bListsMatch ? 0 : 1;
+		}
+	}
+	TestEqual(TEXT("Socket buckets should match pairwise socket equality."), Mismatches, 0);
+
+	// A domain's socket set on a side lists exactly the sockets its variants show there.
+	TArray<uint64> Domain;
+	Domain.Init(0, Compatibility.GetVariantMaskWordCount());
+	Domain[0] = uint64(1) | (uint64(1) << 7);
+	uint8 ExpectedSet = 0;
+	ExpectedSet |= static_cast<uint8>(1u << Compatibility.GetVariantSocket(0, 0));
+	ExpectedSet |= static_cast<uint8>(1u << Compatibility.GetVariantSocket(7, 0));
+	TestEqual(TEXT("Domain socket set should cover both variants."), static_cast<int32>(Compatibility.GetDomainSocketSet(Domain.GetData(), 0)), static_cast<int32>(ExpectedSet));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FCanalTileCompatibilitySymmetryTest,
+	"UEGame.Canal.Tile.CompatibilitySymmetry",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCanalTileCompatibilitySymmetryTest::RunTest(const FString& Parameters)
+{
+	const TArray<FCanalTopologyTileDefinition> TileSet = FCanalPrototypeTileSet::BuildV0();
+
+	FCanalTileCompatibilityTable Compatibility;
+	FString Error;
+	if (!Compatibility.Build(TileSet, &Error))
+	{
+		AddError(FString::Printf(TEXT("Failed to build compatibility: %s"), *Error));
+		return false;
+	}
+
+	const TArray<FCanalTileVariantKey>& Variants = Compatibility.GetAllVariants();
+	TestTrue(TEXT("Symmetric rotations should be folded."), Variants.Num() < TileSet.Num() * 6);
+
+	int32 TotalMultiplicity = 0;
+	TSet<FString> SocketLayouts;
+	for (int32 VariantIndex = 0; VariantIndex < Variants.Num(); ++VariantIndex)
+	{
+		TotalMultiplicity += Compatibility.GetVariantMultiplicity(VariantIndex);
+
+		FString Layout = FString::Printf(TEXT("%d:"), Variants[VariantIndex].TileIndex);
+		for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
+		{
+			Layout += FString::Printf(TEXT("%d"), Compatibility.GetVariantSocket(VariantIndex, DirIndex));
+		}
+		TestFalse(FString::Printf(TEXT("Variant %d should have a distinct socket layout."), VariantIndex), SocketLayouts.Contains(Layout));
+		SocketLayouts.Add(Layout);
+	}
+	TestEqual(TEXT("Multiplicities should account for every tile rotation."), TotalMultiplicity, TileSet.Num() * 6);
+
+	// Every rotation resolves to a variant with the same sockets, and expands to the same concrete rotation.
+	int32 Mismatches = 0;
+	for (int32 TileIndex = 0; TileIndex < TileSet.Num(); ++TileIndex)
+	{
+		for (int32 Rotation = 0; Rotation < 6; ++Rotation)
+		{
+			FCanalTileVariantKey Key;
+			Key.TileIndex = TileIndex;
+			Key.RotationSteps = static_cast<uint8>(Rotation);
+			const int32 VariantIndex = Compatibility.FindVariantIndex(Key);
+			if (VariantIndex == INDEX_NONE)
+			{
+				++Mismatches;
+				continue;
+			}
+
+			const FCanalTileVariantRef Ref = Compatibility.ToVariantRef(Key);
+			Mismatches += Ref.RotationSteps != Variants[VariantIndex].RotationSteps ? 1 : 0;
+			for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
+			{
+				const ECanalSocketType Socket = TileSet[TileIndex].GetSocket(HexDirectionFromIndex(DirIndex), Rotation);
+				Mismatches += Compatibility.GetVariantSocket(VariantIndex, DirIndex) != static_cast<int32>(Socket) ? 1 : 0;
+			}
+		}
+	}
+	TestEqual(TEXT("Every rotation should resolve to an equivalent variant."), Mismatches, 0);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FCanalTileCompatibilitySerializeTest,
+	"UEGame.Canal.Tile.CompatibilitySerialize",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCanalTileCompatibilitySerializeTest::RunTest(const FString& Parameters)
+{
+	TArray<FCanalTopologyTileDefinition> TileSet = FCanalPrototypeTileSet::BuildV0();
+
+	FCanalTileCompatibilityTable Built;
+	FString Error;
+	if (!Built.Build(TileSet, &Error))
+	{
+		AddError(FString::Printf(TEXT("Failed to build compatibility: %s"), *Error));
+		return false;
+	}
+
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+	TestTrue(TEXT("Saving the compiled table should succeed."), Built.Serialize(Writer));
+
+	FCanalTileCompatibilityTable Loaded;
+	FMemoryReader Reader(Data);
+	if (!Loaded.Serialize(Reader))
+	{
+		AddError(TEXT("Loading the compiled table failed."));
+		return false;
+	}
+
+	TestTrue(TEXT("Loaded table should be built."), Loaded.IsBuilt());
+	TestEqual(TEXT("Loaded table should keep its content hash."), Loaded.GetContentHash(), FCanalTileCompatibilityTable::ComputeContentHash(TileSet));
+	TestEqual(TEXT("Loaded table should keep every variant."), Loaded.GetNumVariants(), Built.GetNumVariants());
+
+	int32 Mismatches = 0;
+	const int32 NumWords = Built.GetVariantMaskWordCount();
+	for (int32 VariantIndex = 0; VariantIndex < Built.GetNumVariants(); ++VariantIndex)
+	{
+		const FCanalTileVariantKey& Key = Built.GetAllVariants()[VariantIndex];
+		Mismatches += Loaded.GetAllVariants()[VariantIndex] == Key ? 0 : 1;
+		Mismatches += Loaded.FindVariantIndex(Key) == VariantIndex ? 0 : 1;
+		Mismatches += Loaded.GetVariantMultiplicity(VariantIndex) == Built.GetVariantMultiplicity(VariantIndex) ? 0 : 1;
+		for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
+		{
+			const EHexDirection Direction = HexDirectionFromIndex(DirIndex);
+			const uint64* BuiltMask = Built.GetCompatibleVariantMask(VariantIndex, Direction);
+			const uint64* LoadedMask = Loaded.GetCompatibleVariantMask(VariantIndex, Direction);
+			Mismatches += FMemory::Memcmp(BuiltMask, LoadedMask, NumWords * sizeof(uint64)) == 0 ? 0 : 1;
+			Mismatches += Loaded.GetCompatibleVariants(Key, Direction).Num() == Built.GetCompatibleVariants(Key, Direction).Num() ? 0 : 1;
+		}
+	}
+	TestEqual(TEXT("Loaded table should answer every query like the built one."), Mismatches, 0);
+
+	// Any change to the tiles changes the hash, so a stale saved table is never reused.
+	TileSet[0].Weight += 1.0f;
+	TestNotEqual(TEXT("Editing a tile should change the content hash."), FCanalTileCompatibilityTable::ComputeContentHash(TileSet), Loaded.GetContentHash());
+
+	// Truncated data is rejected instead of producing a partial table.
+	Data.SetNum(Data.Num() / 2);
+	FCanalTileCompatibilityTable Truncated;
+	FMemoryReader TruncatedReader(Data);
+	TestFalse(TEXT("Truncated data should not load."), Truncated.Serialize(TruncatedReader));
+	TestFalse(TEXT("A failed load should leave the table unbuilt."), Truncated.IsBuilt());
+
+	// A corrupt tile count is rejected before anything is allocated for it. It follows the version and the hash.
+	TArray<uint8> Corrupt;
+	FMemoryWriter CorruptWriter(Corrupt);
+	Built.Serialize(CorruptWriter);
+	const int32 HugeTileCount = MAX_int32;
+	FMemory::Memcpy(Corrupt.GetData() + sizeof(int32) + sizeof(uint64), &HugeTileCount, sizeof(int32));
+	FCanalTileCompatibilityTable Oversized;
+	FMemoryReader CorruptReader(Corrupt);
+	TestFalse(TEXT("An implausible tile count should not load."), Oversized.Serialize(CorruptReader));
+	TestFalse(TEXT("A rejected table should stay unbuilt."), Oversized.IsBuilt());
+
+	return true;
+}
+
 IMPLEMENT_SIMPLE_AUTOMATION_TEST(
 	FHexWfcSolveSmokeTest,
 	"UEGame.Canal.WFC.SolveSmoke",
@@ -327,6 +607,316 @@ bool FHexWfcSolveSmokeTest::RunTest(const FString& Parameters)
 	return true;
 }
 
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FHexWfcDomainModeEquivalenceTest,
+	"UEGame.Canal.WFC.DomainModeEquivalence",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHexWfcDomainModeEquivalenceTest::RunTest(const FString& Parameters)
+{
+	const UCanalTopologyTileSetAsset* TileSetAsset = BuildPrototypeTileSetAsset(*this);
+	if (!TileSetAsset)
+	{
+		return false;
+	}
+
+	FHexWfcGridConfig Grid;
+	Grid.Width = 8;
+	Grid.Height = 6;
+
+	const FHexWfcSolver Solver(TileSetAsset->GetCompatibilityTable());
+	for (int32 Seed = 1; Seed <= 8; ++Seed)
+	{
+		FHexWfcSolveConfig ListConfig = MakeM1RelaxedSolveConfig();
+		ListConfig.Seed = Seed;
+		ListConfig.DomainMode = EHexWfcDomainMode::CandidateList;
+
+		FHexWfcSolveConfig BitsetConfig = ListConfig;
+		BitsetConfig.DomainMode = EHexWfcDomainMode::Bitset;
+
+		TestSameSolveResult(
+			*this,
+			FString::Printf(TEXT("Seed %d bitset vs candidate list"), Seed),
+			Solver.Solve(Grid, ListConfig),
+			Solver.Solve(Grid, BitsetConfig));
+
+		// Biome scaling (including a zeroed tile) goes through the precomputed bitset pick weights.
+		FHexTileWeightMultiplier BoostCross;
+		BoostCross.TileId = TEXT("water_cross");
+		BoostCross.Multiplier = 4.0f;
+		FHexTileWeightMultiplier DisableHardBend;
+		DisableHardBend.TileId = TEXT("water_bend_hard");
+		DisableHardBend.Multiplier = 0.0f;
+		ListConfig.BiomeWeightMultipliers = {BoostCross, DisableHardBend};
+		BitsetConfig.BiomeWeightMultipliers = ListConfig.BiomeWeightMultipliers;
+		TestSameSolveResult(
+			*this,
+			FString::Printf(TEXT("Seed %d biome-scaled bitset vs candidate list"), Seed),
+			Solver.Solve(Grid, ListConfig),
+			Solver.Solve(Grid, BitsetConfig));
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FHexWfcSupportCountPropagatorTest,
+	"UEGame.Canal.WFC.SupportCountPropagator",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHexWfcSupportCountPropagatorTest::RunTest(const FString& Parameters)
+{
+	const UCanalTopologyTileSetAsset* TileSetAsset = BuildPrototypeTileSetAsset(*this);
+	if (!TileSetAsset)
+	{
+		return false;
+	}
+
+	FHexWfcGridConfig Grid;
+	Grid.Width = 10;
+	Grid.Height = 8;
+
+	const FHexWfcSolver Solver(TileSetAsset->GetCompatibilityTable());
+	for (int32 Seed = 1; Seed <= 8; ++Seed)
+	{
+		FHexWfcSolveConfig FilterConfig = MakeM1RelaxedSolveConfig();
+		FilterConfig.Seed = Seed;
+		FilterConfig.Propagator = EHexWfcPropagator::Filter;
+
+		FHexWfcSolveConfig SupportConfig = FilterConfig;
+		SupportConfig.Propagator = EHexWfcPropagator::SupportCount;
+
+		const FHexWfcSolveResult SupportResult = Solver.Solve(Grid, SupportConfig);
+		TestSameSolveResult(*this, FString::Printf(TEXT("Seed %d support count vs filter"), Seed), Solver.Solve(Grid, FilterConfig), SupportResult);
+		if (SupportResult.bSolved)
+		{
+			ValidateSolvedAdjacency(*this, TileSetAsset->GetCompatibilityTable(), SupportResult.Cells);
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FHexWfcWeightedShannonEntropyTest,
+	"UEGame.Canal.WFC.WeightedShannonEntropy",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHexWfcWeightedShannonEntropyTest::RunTest(const FString& Parameters)
+{
+	const UCanalTopologyTileSetAsset* TileSetAsset = BuildPrototypeTileSetAsset(*this);
+	if (!TileSetAsset)
+	{
+		return false;
+	}
+
+	FHexWfcGridConfig Grid;
+	Grid.Width = 10;
+	Grid.Height = 8;
+
+	const FHexWfcSolver Solver(TileSetAsset->GetCompatibilityTable());
+	int32 SolvedCount = 0;
+	for (int32 Seed = 1; Seed <= 8; ++Seed)
+	{
+		FHexWfcSolveConfig Config = MakeM1RelaxedSolveConfig();
+		Config.Seed = Seed;
+		Config.EntropyMode = EHexWfcEntropyMode::WeightedShannon;
+
+		FHexWfcSolveConfig SupportConfig = Config;
+		SupportConfig.Propagator = EHexWfcPropagator::SupportCount;
+
+		const FHexWfcSolveResult Result = Solver.Solve(Grid, Config);
+		TestSameSolveResult(*this, FString::Printf(TEXT("Seed %d weighted entropy rerun"), Seed), Result, Solver.Solve(Grid, Config));
+		TestSameSolveResult(*this, FString::Printf(TEXT("Seed %d weighted entropy support count vs filter"), Seed), Result, Solver.Solve(Grid, SupportConfig));
+		if (Result.bSolved)
+		{
+			++SolvedCount;
+			ValidateSolvedAdjacency(*this, TileSetAsset->GetCompatibilityTable(), Result.Cells);
+		}
+	}
+
+	TestTrue(TEXT("Weighted entropy selection should solve at least one seed."), SolvedCount > 0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FHexWfcBacktrackingTest,
+	"UEGame.Canal.WFC.Backtracking",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHexWfcBacktrackingTest::RunTest(const FString& Parameters)
+{
+	// Three asymmetric three-socket tiles: unlike the prototype set, greedy collapses regularly paint a cell into a corner.
+	const auto MakeTile = [](const TCHAR* TileId, const TArray<ECanalSocketType>& Sockets)
+	{
+		FCanalTopologyTileDefinition Tile;
+		Tile.TileId = TileId;
+		Tile.Sockets = Sockets;
+		return Tile;
+	};
+
+	UCanalTopologyTileSetAsset* TileSetAsset = NewObject<UCanalTopologyTileSetAsset>(GetTransientPackage());
+	TileSetAsset->Tiles = {
+		MakeTile(TEXT("bt_pairs"), {ECanalSocketType::Water, ECanalSocketType::Bank, ECanalSocketType::Road, ECanalSocketType::Water, ECanalSocketType::Bank, ECanalSocketType::Road}),
+		MakeTile(TEXT("bt_halves"), {ECanalSocketType::Water, ECanalSocketType::Water, ECanalSocketType::Bank, ECanalSocketType::Bank, ECanalSocketType::Road, ECanalSocketType::Road}),
+		MakeTile(TEXT("bt_mixed"), {ECanalSocketType::Water, ECanalSocketType::Bank, ECanalSocketType::Water, ECanalSocketType::Road, ECanalSocketType::Bank, ECanalSocketType::Road})};
+	FString Error;
+	if (!TileSetAsset->BuildCompatibilityCache(Error))
+	{
+		AddError(FString::Printf(TEXT("Failed to build backtracking compatibility cache: %s"), *Error));
+		return false;
+	}
+
+	FHexWfcGridConfig Grid;
+	Grid.Width = 16;
+	Grid.Height = 12;
+
+	const FHexWfcSolver Solver(TileSetAsset->GetCompatibilityTable());
+	int32 RestartAttempts = 0;
+	int32 BacktrackAttempts = 0;
+	int32 RestartSolved = 0;
+	int32 BacktrackSolved = 0;
+	int32 TotalBacktracks = 0;
+	for (int32 Seed = 1; Seed <= 32; ++Seed)
+	{
+		FHexWfcSolveConfig RestartConfig = MakeM1RelaxedSolveConfig();
+		RestartConfig.Seed = Seed;
+
+		FHexWfcSolveConfig BacktrackConfig = RestartConfig;
+		BacktrackConfig.bEnableBacktracking = true;
+
+		FHexWfcSolveConfig SupportConfig = BacktrackConfig;
+		SupportConfig.Propagator = EHexWfcPropagator::SupportCount;
+
+		const FHexWfcSolveResult RestartResult = Solver.Solve(Grid, RestartConfig);
+		const FHexWfcSolveResult BacktrackResult = Solver.Solve(Grid, BacktrackConfig);
+		TestSameSolveResult(*this, FString::Printf(TEXT("Seed %d backtracking support count vs filter"), Seed), BacktrackResult, Solver.Solve(Grid, SupportConfig));
+		TestEqual(FString::Printf(TEXT("Seed %d: restarts never backtrack."), Seed), RestartResult.Backtracks, 0);
+
+		RestartAttempts += RestartResult.AttemptsUsed;
+		BacktrackAttempts += BacktrackResult.AttemptsUsed;
+		RestartSolved += RestartResult.bSolved ? 1 : 0;
+		BacktrackSolved += BacktrackResult.bSolved ? 1 : 0;
+		TotalBacktracks += BacktrackResult.Backtracks;
+		if (BacktrackResult.bSolved)
+		{
+			ValidateSolvedAdjacency(*this, TileSetAsset->GetCompatibilityTable(), BacktrackResult.Cells);
+		}
+	}
+
+	TestTrue(TEXT("The tile set should force at least one backtrack."), TotalBacktracks > 0);
+	TestTrue(TEXT("Backtracking should solve at least as many seeds as restarting."), BacktrackSolved >= RestartSolved);
+	TestTrue(TEXT("Backtracking should need fewer attempts than restarting."), BacktrackAttempts < RestartAttempts);
+
+	FHexWfcSolveConfig BatchSolveConfig = MakeM1RelaxedSolveConfig();
+	BatchSolveConfig.bEnableBacktracking = true;
+	FHexWfcBatchConfig BatchConfig;
+	BatchConfig.StartSeed = 1;
+	BatchConfig.NumSeeds = 32;
+	const FHexWfcBatchStats Stats = UCanalWfcBlueprintLibrary::RunHexWfcBatch(TileSetAsset, Grid, BatchSolveConfig, BatchConfig);
+
+	int32 HistogramSeeds = 0;
+	for (const FHexWfcBacktrackHistogramBin& Bin : Stats.BacktrackHistogram)
+	{
+		TestTrue(TEXT("Backtrack histogram bins should be ordered ranges."), Bin.MinBacktracks <= Bin.MaxBacktracks);
+		HistogramSeeds += Bin.Count;
+	}
+	TestEqual(TEXT("Backtrack histogram should cover every processed seed."), HistogramSeeds, Stats.NumSeedsProcessed);
+	TestTrue(
+		TEXT("Average backtracks should match the per-seed solves."),
+		FMath::IsNearlyEqual(Stats.AverageBacktracks, static_cast<float>(TotalBacktracks) / 32.0f, KINDA_SMALL_NUMBER));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FHexWfcSpeculativeAttemptsTest,
+	"UEGame.Canal.WFC.SpeculativeAttempts",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHexWfcSpeculativeAttemptsTest::RunTest(const FString& Parameters)
+{
+	const UCanalTopologyTileSetAsset* TileSetAsset = BuildPrototypeTileSetAsset(*this);
+	if (!TileSetAsset)
+	{
+		return false;
+	}
+
+	FHexWfcGridConfig Grid;
+	Grid.Width = 12;
+	Grid.Height = 8;
+
+	// Strict validation makes restarts common. A wave of 3 does not divide MaxAttempts, so the last wave is partial.
+	const FHexWfcSolver Solver(TileSetAsset->GetCompatibilityTable());
+	int32 RestartedSeeds = 0;
+	for (int32 Seed = 1; Seed <= 16; ++Seed)
+	{
+		FHexWfcSolveConfig SerialConfig = MakeM1RelaxedSolveConfig();
+		SerialConfig.Seed = Seed;
+		SerialConfig.bRequireEntryExitPath = true;
+		SerialConfig.bRequireSingleWaterComponent = true;
+
+		FHexWfcSolveConfig SpeculativeConfig = SerialConfig;
+		SpeculativeConfig.SpeculativeAttempts = 3;
+
+		const FHexWfcSolveResult SerialResult = Solver.Solve(Grid, SerialConfig);
+		const FHexWfcSolveResult SpeculativeResult = Solver.Solve(Grid, SpeculativeConfig);
+		const FString Context = FString::Printf(TEXT("Seed %d speculative vs serial attempts"), Seed);
+		TestSameSolveResult(*this, Context, SerialResult, SpeculativeResult);
+		TestEqual(FString::Printf(TEXT("%s: message should match."), *Context), SpeculativeResult.Message, SerialResult.Message);
+		TestEqual(
+			FString::Printf(TEXT("%s: single-component failure flag should match."), *Context),
+			SpeculativeResult.bFailedSingleWaterComponent,
+			SerialResult.bFailedSingleWaterComponent);
+		RestartedSeeds += SerialResult.AttemptsUsed > 1 ? 1 : 0;
+	}
+
+	TestTrue(TEXT("At least one seed should need more than one attempt."), RestartedSeeds > 0);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FHexWfcRowMajorCellOrderTest,
+	"UEGame.Canal.WFC.RowMajorCellOrder",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHexWfcRowMajorCellOrderTest::RunTest(const FString& Parameters)
+{
+	const UCanalTopologyTileSetAsset* TileSetAsset = BuildPrototypeTileSetAsset(*this);
+	if (!TileSetAsset)
+	{
+		return false;
+	}
+
+	FHexWfcGridConfig Grid;
+	Grid.Width = 7;
+	Grid.Height = 5;
+
+	FHexWfcSolveConfig Config = MakeM1RelaxedSolveConfig();
+	Config.Seed = 99;
+
+	const FHexWfcSolver Solver(TileSetAsset->GetCompatibilityTable());
+	const FHexWfcSolveResult Result = Solver.Solve(Grid, Config);
+	if (!TestTrue(FString::Printf(TEXT("Solve should succeed. Message: %s"), *Result.Message), Result.bSolved))
+	{
+		return false;
+	}
+
+	TestEqual(TEXT("Result should contain one cell per grid slot."), Result.Cells.Num(), Grid.Width * Grid.Height);
+	for (int32 CellIndex = 0; CellIndex < Result.Cells.Num(); ++CellIndex)
+	{
+		const FHexAxialCoord Expected(CellIndex % Grid.Width, CellIndex / Grid.Width);
+		if (Result.Cells[CellIndex].Coord != Expected)
+		{
+			AddError(FString::Printf(TEXT("Cell %d has coord %s, expected %s."), CellIndex, *Result.Cells[CellIndex].Coord.ToString(), *Expected.ToString()));
+			break;
+		}
+	}
+
+	return ValidateSolvedAdjacency(*this, TileSetAsset->GetCompatibilityTable(), Result.Cells);
+}
+
 IMPLEMENT_SIMPLE_AUTOMATION_TEST(
 	FHexWfcEntryExitAndComponentConstraintsTest,
 	"UEGame.Canal.WFC.EntryExitAndConnectedWater",
@@ -691,20 +1281,547 @@ bool FHexWfcBatchHarnessStatsTest::RunTest(const FString& Parameters)
 }
 
 IMPLEMENT_SIMPLE_AUTOMATION_TEST(
-	FCanalScenarioMetadataSetterTest,
-	"UEGame.Canal.Scenario.MetadataSetter",
+	FHexWfcParallelBatchTest,
+	"UEGame.Canal.WFC.ParallelBatch",
 	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
 
-bool FCanalScenarioMetadataSetterTest::RunTest(const FString& Parameters)
+bool FHexWfcParallelBatchTest::RunTest(const FString& Parameters)
 {
-	ACanalTopologyGeneratorActor* Generator = NewObject<ACanalTopologyGeneratorActor>(GetTransientPackage());
-	if (!Generator)
+	const UCanalTopologyTileSetAsset* TileSetAsset = BuildPrototypeTileSetAsset(*this);
+	if (!TileSetAsset)
 	{
-		AddError(TEXT("Failed to allocate topology generator actor."));
 		return false;
 	}
 
-	Generator->SetScenarioMetadata(TEXT("CaptureRun"), 45.5f);
+	FHexWfcGridConfig Grid;
+	Grid.Width = 12;
+	Grid.Height = 8;
+
+	FHexWfcSolveConfig Config = MakeM1RelaxedSolveConfig();
+	Config.MaxAttempts = 2;
+
+	FHexWfcBatchConfig SerialConfig;
+	SerialConfig.StartSeed = 500;
+	SerialConfig.NumSeeds = 48;
+
+	FHexWfcBatchConfig ParallelConfig = SerialConfig;
+	ParallelConfig.bRunInParallel = true;
+
+	const FHexWfcBatchStats Serial = UCanalWfcBlueprintLibrary::RunHexWfcBatch(TileSetAsset, Grid, Config, SerialConfig);
+	const FHexWfcBatchStats Parallel = UCanalWfcBlueprintLibrary::RunHexWfcBatch(TileSetAsset, Grid, Config, ParallelConfig);
+
+	TestEqual(TEXT("Parallel batch should process every seed."), Parallel.NumSeedsProcessed, SerialConfig.NumSeeds);
+	TestEqual(TEXT("Solved counts should match."), Parallel.NumSolved, Serial.NumSolved);
+	TestEqual(TEXT("Failed counts should match."), Parallel.NumFailed, Serial.NumFailed);
+	TestEqual(TEXT("Contradiction counts should match."), Parallel.NumContradictions, Serial.NumContradictions);
+	TestEqual(TEXT("Single-component failure counts should match."), Parallel.NumSingleWaterComponentFailures, Serial.NumSingleWaterComponentFailures);
+	TestTrue(TEXT("Average attempts should be bit-identical."), Parallel.AverageAttemptsUsed == Serial.AverageAttemptsUsed);
+	TestTrue(TEXT("Contradiction rate should be bit-identical."), Parallel.ContradictionRate == Serial.ContradictionRate);
+
+	if (TestEqual(TEXT("Attempt histogram sizes should match."), Parallel.AttemptHistogram.Num(), Serial.AttemptHistogram.Num()))
+	{
+		for (int32 Index = 0; Index < Serial.AttemptHistogram.Num(); ++Index)
+		{
+			TestEqual(TEXT("Attempt bins should match."), Parallel.AttemptHistogram[Index].Attempts, Serial.AttemptHistogram[Index].Attempts);
+			TestEqual(TEXT("Attempt bin counts should match."), Parallel.AttemptHistogram[Index].Count, Serial.AttemptHistogram[Index].Count);
+		}
+	}
+
+	if (TestEqual(TEXT("Tile histogram sizes should match."), Parallel.TileHistogram.Num(), Serial.TileHistogram.Num()))
+	{
+		for (int32 Index = 0; Index < Serial.TileHistogram.Num(); ++Index)
+		{
+			TestTrue(TEXT("Tile bins should be in the same order."), Parallel.TileHistogram[Index].TileId == Serial.TileHistogram[Index].TileId);
+			TestEqual(TEXT("Tile bin counts should match."), Parallel.TileHistogram[Index].Count, Serial.TileHistogram[Index].Count);
+			TestTrue(TEXT("Tile bin fractions should be bit-identical."), Parallel.TileHistogram[Index].Fraction == Serial.TileHistogram[Index].Fraction);
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FHexWfcBoundarySocketConstraintTest,
+	"UEGame.Canal.WFC.BoundarySocketConstraints",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHexWfcBoundarySocketConstraintTest::RunTest(const FString& Parameters)
+{
+	const UCanalTopologyTileSetAsset* TileSetAsset = BuildPrototypeTileSetAsset(*this);
+	if (!TileSetAsset)
+	{
+		return false;
+	}
+
+	const FCanalTileCompatibilityTable& Compatibility = TileSetAsset->GetCompatibilityTable();
+	const FHexWfcSolver Solver(Compatibility);
+
+	FHexWfcGridConfig Grid;
+	Grid.Width = 8;
+	Grid.Height = 6;
+
+	// Water must leave through the whole west edge; every other edge cell faces bank to the north.
+	TArray<FHexWfcBoundarySocketConstraint> Constraints;
+	for (int32 R = 0; R < Grid.Height; ++R)
+	{
+		FHexWfcBoundarySocketConstraint& Constraint = Constraints.AddDefaulted_GetRef();
+		Constraint.Coord = FHexAxialCoord(0, R);
+		Constraint.Direction = EHexDirection::West;
+		Constraint.Socket = ECanalSocketType::Water;
+	}
+	for (int32 Q = 1; Q < Grid.Width; ++Q)
+	{
+		FHexWfcBoundarySocketConstraint& Constraint = Constraints.AddDefaulted_GetRef();
+		Constraint.Coord = FHexAxialCoord(Q, 0);
+		Constraint.Direction = EHexDirection::NorthWest;
+		Constraint.Socket = ECanalSocketType::Bank;
+	}
+
+	for (int32 Seed = 1; Seed <= 4; ++Seed)
+	{
+		for (const EHexWfcPropagator Propagator : {EHexWfcPropagator::Filter, EHexWfcPropagator::SupportCount})
+		{
+			FHexWfcSolveConfig Config = MakeM1RelaxedSolveConfig();
+			Config.Seed = Seed;
+			Config.Propagator = Propagator;
+			Config.BoundarySocketConstraints = Constraints;
+
+			const FHexWfcSolveResult Result = Solver.Solve(Grid, Config);
+			if (!TestTrue(FString::Printf(TEXT("Seed %d should solve under socket constraints: %s"), Seed, *Result.Message), Result.bSolved))
+			{
+				continue;
+			}
+
+			for (const FHexWfcBoundarySocketConstraint& Constraint : Constraints)
+			{
+				const FHexWfcCellResult& Cell = Result.Cells[Constraint.Coord.Q + Constraint.Coord.R * Grid.Width];
+				const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(Cell.Variant.TileIndex);
+				TestTrue(
+					FString::Printf(TEXT("Seed %d: constrained side of %s should carry the requested socket."), Seed, *Constraint.Coord.ToString()),
+					Tile && Tile->GetSocket(Constraint.Direction, Cell.Variant.RotationSteps) == Constraint.Socket);
+			}
+			ValidateSolvedAdjacency(*this, Compatibility, Result.Cells);
+		}
+	}
+
+	FHexWfcSolveConfig OutsideConfig = MakeM1RelaxedSolveConfig();
+	FHexWfcBoundarySocketConstraint& Outside = OutsideConfig.BoundarySocketConstraints.AddDefaulted_GetRef();
+	Outside.Coord = FHexAxialCoord(Grid.Width, 0);
+	TestFalse(TEXT("Constraints outside the grid should be rejected."), Solver.Solve(Grid, OutsideConfig).bSolved);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FHexWfcChunkedStreamingTest,
+	"UEGame.Canal.WFC.ChunkedStreaming",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHexWfcChunkedStreamingTest::RunTest(const FString& Parameters)
+{
+	const UCanalTopologyTileSetAsset* TileSetAsset = BuildPrototypeTileSetAsset(*this);
+	if (!TileSetAsset)
+	{
+		return false;
+	}
+
+	FHexWfcChunkConfig ChunkConfig;
+	ChunkConfig.ChunkWidth = 8;
+	ChunkConfig.ChunkHeight = 6;
+	ChunkConfig.ViewRadiusChunks = 1;
+	ChunkConfig.MaxResidentChunks = 10;
+
+	FHexWfcSolveConfig SolveConfig = MakeM1RelaxedSolveConfig();
+	SolveConfig.Seed = 4242;
+
+	FHexWfcChunkedSolver Chunked(TileSetAsset->GetCompatibilityTable(), ChunkConfig, SolveConfig);
+	TestEqual(TEXT("Negative coordinates should floor into the previous chunk."), Chunked.GetChunkForCell(FHexAxialCoord(-1, -7)), FIntPoint(-1, -2));
+
+	// Walk east far enough to evict the start, then come back.
+	TMap<FIntPoint, TArray<FHexWfcCellResult>> FirstCells;
+	int32 RegeneratedChunks = 0;
+	for (int32 Step = 0; Step <= 20; ++Step)
+	{
+		const int32 FocusQ = (Step <= 10 ? Step : 20 - Step) * ChunkConfig.ChunkWidth;
+		TArray<FIntPoint> Generated;
+		Chunked.UpdateFocus(FHexAxialCoord(FocusQ, 0), &Generated);
+		TestTrue(TEXT("Resident chunks should stay within budget."), Chunked.GetNumResidentChunks() <= ChunkConfig.MaxResidentChunks);
+
+		for (const FIntPoint& ChunkCoord : Generated)
+		{
+			const FHexWfcChunk* Chunk = Chunked.FindChunk(ChunkCoord);
+			if (!TestNotNull(TEXT("Generated chunks should be resident."), Chunk))
+			{
+				continue;
+			}
+
+			if (const TArray<FHexWfcCellResult>* Previous = FirstCells.Find(ChunkCoord))
+			{
+				++RegeneratedChunks;
+				FHexWfcSolveResult Expected;
+				Expected.bSolved = true;
+				Expected.Cells = *Previous;
+				Expected.AttemptsUsed = Chunk->Result.AttemptsUsed;
+				TestSameSolveResult(*this, FString::Printf(TEXT("Chunk (%d, %d) regenerated"), ChunkCoord.X, ChunkCoord.Y), Expected, Chunk->Result);
+			}
+			else
+			{
+				FirstCells.Add(ChunkCoord, Chunk->Result.Cells);
+			}
+		}
+	}
+
+	TestTrue(TEXT("Walking back should regenerate evicted chunks."), RegeneratedChunks > 0);
+
+	TArray<const FHexWfcChunk*> Chunks;
+	Chunked.GetResidentChunks(Chunks);
+	TArray<FHexWfcCellResult> WorldCells;
+	for (const FHexWfcChunk* Chunk : Chunks)
+	{
+		WorldCells.Append(Chunk->Result.Cells);
+	}
+	TestTrue(TEXT("Streaming should keep several chunks resident."), Chunks.Num() > 1);
+	TestTrue(TEXT("Sockets should match across chunk seams."), ValidateSolvedAdjacency(*this, TileSetAsset->GetCompatibilityTable(), WorldCells));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FHexWfcRegionResolveTest,
+	"UEGame.Canal.WFC.RegionResolve",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHexWfcRegionResolveTest::RunTest(const FString& Parameters)
+{
+	const UCanalTopologyTileSetAsset* TileSetAsset = BuildPrototypeTileSetAsset(*this);
+	if (!TileSetAsset)
+	{
+		return false;
+	}
+
+	const FCanalTileCompatibilityTable& Compatibility = TileSetAsset->GetCompatibilityTable();
+	const FHexWfcSolver Solver(Compatibility);
+
+	FHexWfcGridConfig Grid;
+	Grid.Width = 16;
+	Grid.Height = 10;
+
+	FHexWfcSolveConfig Config = MakeM1RelaxedSolveConfig();
+	Config.Seed = 77;
+	const FHexWfcSolveResult Previous = Solver.Solve(Grid, Config);
+	if (!TestTrue(FString::Printf(TEXT("Base solve should succeed: %s"), *Previous.Message), Previous.bSolved))
+	{
+		return false;
+	}
+
+	TArray<FHexAxialCoord> Region;
+	Grid.GetCellsInRadius(FHexAxialCoord(8, 5), 2, Region);
+	TestEqual(TEXT("A radius-2 region away from the edges should hold 19 cells."), Region.Num(), 19);
+
+	int32 ChangedRerolls = 0;
+	for (int32 Seed = 1; Seed <= 8; ++Seed)
+	{
+		FHexWfcSolveConfig ListConfig = Config;
+		ListConfig.Seed = Seed;
+		ListConfig.DomainMode = EHexWfcDomainMode::CandidateList;
+		FHexWfcSolveConfig BitsetConfig = ListConfig;
+		BitsetConfig.DomainMode = EHexWfcDomainMode::Bitset;
+
+		const FHexWfcSolveResult ListResult = Solver.SolveRegion(Grid, ListConfig, Previous, Region);
+		const FHexWfcSolveResult BitsetResult = Solver.SolveRegion(Grid, BitsetConfig, Previous, Region);
+		TestSameSolveResult(*this, FString::Printf(TEXT("Region seed %d"), Seed), ListResult, BitsetResult);
+		if (!TestTrue(FString::Printf(TEXT("Region seed %d should re-solve: %s"), Seed, *BitsetResult.Message), BitsetResult.bSolved))
+		{
+			continue;
+		}
+
+		bool bChanged = false;
+		for (int32 CellIndex = 0; CellIndex < Previous.Cells.Num(); ++CellIndex)
+		{
+			const FHexWfcCellResult& Before = Previous.Cells[CellIndex];
+			const FHexWfcCellResult& After = BitsetResult.Cells[CellIndex];
+			const bool bSame = Before.Variant.TileIndex == After.Variant.TileIndex && Before.Variant.RotationSteps == After.Variant.RotationSteps;
+			if (!Region.Contains(Before.Coord))
+			{
+				TestTrue(FString::Printf(TEXT("Region seed %d: %s is outside the region and must be kept."), Seed, *Before.Coord.ToString()), bSame);
+			}
+			bChanged |= !bSame;
+		}
+		ChangedRerolls += bChanged ? 1 : 0;
+		ValidateSolvedAdjacency(*this, Compatibility, BitsetResult.Cells);
+	}
+	TestTrue(TEXT("Rerolling with new seeds should change the region."), ChangedRerolls > 0);
+
+	const TArray<FHexAxialCoord> Outside = {FHexAxialCoord(Grid.Width, 0)};
+	TestFalse(TEXT("Region cells outside the grid should be rejected."), Solver.SolveRegion(Grid, Config, Previous, Outside).bSolved);
+	TestFalse(TEXT("An unsolved previous result should be rejected."), Solver.SolveRegion(Grid, Config, FHexWfcSolveResult(), Region).bSolved);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FHexWfcSolveControlTest,
+	"UEGame.Canal.WFC.SolveControl",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHexWfcSolveControlTest::RunTest(const FString& Parameters)
+{
+	const UCanalTopologyTileSetAsset* TileSetAsset = BuildPrototypeTileSetAsset(*this);
+	if (!TileSetAsset)
+	{
+		return false;
+	}
+
+	const FHexWfcSolver Solver(TileSetAsset->GetCompatibilityTable());
+
+	FHexWfcGridConfig Grid;
+	Grid.Width = 12;
+	Grid.Height = 8;
+
+	FHexWfcSolveConfig Config = MakeM1RelaxedSolveConfig();
+	Config.Seed = 31;
+
+	const FHexWfcSolveResult Uncontrolled = Solver.Solve(Grid, Config);
+	for (const int32 SpeculativeAttempts : {1, 3})
+	{
+		Config.SpeculativeAttempts = SpeculativeAttempts;
+		FHexWfcSolveControl Control;
+		const FHexWfcSolveResult Result = Solver.Solve(Grid, Config, &Control);
+		TestSameSolveResult(*this, FString::Printf(TEXT("Controlled solve K=%d"), SpeculativeAttempts), Uncontrolled, Result);
+		TestFalse(TEXT("An uncancelled solve should not report cancellation."), Result.bCancelled);
+		TestEqual(TEXT("A finished solve should report full progress."), Control.GetProgress(), 1.0f);
+		TestEqual(TEXT("Progress should name the solving attempt."), Control.GetAttempt(), Result.AttemptsUsed);
+
+		FHexWfcSolveControl Cancelled;
+		Cancelled.Cancel();
+		const FHexWfcSolveResult CancelledResult = Solver.Solve(Grid, Config, &Cancelled);
+		TestFalse(TEXT("A cancelled solve should not succeed."), CancelledResult.bSolved);
+		TestTrue(TEXT("A cancelled solve should say so."), CancelledResult.bCancelled);
+		TestEqual(TEXT("A cancelled solve should stop after its first wave."), CancelledResult.AttemptsUsed, 1);
+	}
+
+	// Region solves take the same control, directly and through the blueprint library.
+	Config.SpeculativeAttempts = 1;
+	TArray<FHexAxialCoord> Region;
+	Grid.GetCellsInRadius(FHexAxialCoord(6, 4), 2, Region);
+	FHexWfcSolveControl RegionControl;
+	const FHexWfcSolveResult RegionResult = Solver.SolveRegion(Grid, Config, Uncontrolled, Region, &RegionControl);
+	TestTrue(TEXT("A controlled region solve should succeed."), RegionResult.bSolved);
+	TestEqual(TEXT("A finished region solve should report full progress."), RegionControl.GetProgress(), 1.0f);
+
+	FHexWfcSolveControl CancelledRegion;
+	CancelledRegion.Cancel();
+	const FHexWfcSolveResult CancelledRegionResult =
+		UCanalWfcBlueprintLibrary::SolveHexWfcRegion(TileSetAsset, Grid, Config, Uncontrolled, Region, &CancelledRegion);
+	TestFalse(TEXT("A cancelled region solve should not succeed."), CancelledRegionResult.bSolved);
+	TestTrue(TEXT("A cancelled region solve should say so."), CancelledRegionResult.bCancelled);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FHexWfcConnectivityPropagationTest,
+	"UEGame.Canal.WFC.ConnectivityPropagation",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHexWfcConnectivityPropagationTest::RunTest(const FString& Parameters)
+{
+	const UCanalTopologyTileSetAsset* TileSetAsset = BuildPrototypeTileSetAsset(*this);
+	if (!TileSetAsset)
+	{
+		return false;
+	}
+
+	const FHexWfcSolver Solver(TileSetAsset->GetCompatibilityTable());
+
+	FHexWfcGridConfig Grid;
+	Grid.Width = 12;
+	Grid.Height = 8;
+
+	FHexWfcSolveConfig Config;
+	Config.MaxAttempts = 2;
+	Config.bEnableBacktracking = true;
+	Config.bRequireEntryExitPath = true;
+	Config.bRequireSingleWaterComponent = true;
+	Config.bAutoSelectBoundaryPorts = false;
+	Config.bDisallowUnassignedBoundaryWater = false;
+	Config.EntryPort.bEnabled = true;
+	Config.EntryPort.Coord = FHexAxialCoord(0, 4);
+	Config.EntryPort.Direction = EHexDirection::West;
+	Config.ExitPort.bEnabled = true;
+	Config.ExitPort.Coord = FHexAxialCoord(11, 4);
+	Config.ExitPort.Direction = EHexDirection::East;
+
+	constexpr int32 NumSeeds = 16;
+	int32 NumSolvedValidated = 0;
+	int32 NumSolvedPropagated = 0;
+	for (int32 Seed = 1; Seed <= NumSeeds; ++Seed)
+	{
+		Config.Seed = Seed;
+		Config.bPropagateConnectivity = false;
+		NumSolvedValidated += Solver.Solve(Grid, Config).bSolved ? 1 : 0;
+
+		Config.bPropagateConnectivity = true;
+		const FHexWfcSolveResult Result = Solver.Solve(Grid, Config);
+		NumSolvedPropagated += Result.bSolved ? 1 : 0;
+		TestFalse(
+			FString::Printf(TEXT("Seed %d: propagated connectivity should never leave a split water graph for validation."), Seed),
+			Result.bFailedSingleWaterComponent);
+		if (Result.bSolved)
+		{
+			ValidateSolvedAdjacency(*this, TileSetAsset->GetCompatibilityTable(), Result.Cells);
+		}
+	}
+
+	TestEqual(TEXT("Every seed should solve with connectivity propagation."), NumSolvedPropagated, NumSeeds);
+	TestTrue(TEXT("Connectivity propagation should solve at least as many seeds as validation alone."), NumSolvedPropagated >= NumSolvedValidated);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FHexWfcWaterAnalysisTest,
+	"UEGame.Canal.WFC.WaterAnalysis",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHexWfcWaterAnalysisTest::RunTest(const FString& Parameters)
+{
+	const UCanalTopologyTileSetAsset* TileSetAsset = BuildPrototypeTileSetAsset(*this);
+	if (!TileSetAsset)
+	{
+		return false;
+	}
+
+	const FCanalTileCompatibilityTable& Compatibility = TileSetAsset->GetCompatibilityTable();
+	const FHexWfcSolver Solver(Compatibility);
+
+	FHexWfcGridConfig Grid;
+	Grid.Width = 12;
+	Grid.Height = 8;
+
+	TMap<FHexAxialCoord, const FHexWfcCellResult*> CellByCoord;
+	const auto GetSocket = [&](const FHexAxialCoord& Coord, const EHexDirection Direction)
+	{
+		const FHexWfcCellResult* Cell = CellByCoord.FindRef(Coord);
+		const FCanalTopologyTileDefinition* Tile = Cell ? Compatibility.GetTileDefinition(Cell->Variant.TileIndex) : nullptr;
+		return Tile ? Tile->GetSocket(Direction, Cell->Variant.RotationSteps) : ECanalSocketType::Bank;
+	};
+	const auto IsWaterLike = [](const ECanalSocketType Socket)
+	{
+		return Socket == ECanalSocketType::Water || Socket == ECanalSocketType::Lock;
+	};
+	const auto AreJoined = [&](const FHexAxialCoord& A, const EHexDirection Direction)
+	{
+		const ECanalSocketType Socket = GetSocket(A, Direction);
+		return IsWaterLike(Socket) && CellByCoord.Contains(A.Neighbor(Direction))
+			&& GetSocket(A.Neighbor(Direction), OppositeHexDirection(Direction)) == Socket;
+	};
+
+	for (int32 Seed = 1; Seed <= 8; ++Seed)
+	{
+		FHexWfcSolveConfig Config = MakeM1RelaxedSolveConfig();
+		Config.Seed = Seed;
+		const FHexWfcSolveResult Result = Solver.Solve(Grid, Config);
+		if (!Result.bSolved)
+		{
+			continue;
+		}
+
+		CellByCoord.Reset();
+		for (const FHexWfcCellResult& Cell : Result.Cells)
+		{
+			CellByCoord.Add(Cell.Coord, &Cell);
+		}
+
+		// Reference flood fill over the same join rule.
+		TSet<FHexAxialCoord> Visited;
+		int32 NumWaterCells = 0;
+		int32 NumComponents = 0;
+		for (const FHexWfcCellResult& Cell : Result.Cells)
+		{
+			bool bWaterCell = false;
+			for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
+			{
+				bWaterCell |= IsWaterLike(GetSocket(Cell.Coord, HexDirectionFromIndex(DirIndex)));
+			}
+			if (!bWaterCell)
+			{
+				continue;
+			}
+
+			++NumWaterCells;
+			if (Visited.Contains(Cell.Coord))
+			{
+				continue;
+			}
+
+			++NumComponents;
+			TArray<FHexAxialCoord> Stack = {Cell.Coord};
+			Visited.Add(Cell.Coord);
+			while (Stack.Num() > 0)
+			{
+				const FHexAxialCoord Current = Stack.Pop();
+				for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
+				{
+					const EHexDirection Direction = HexDirectionFromIndex(DirIndex);
+					if (AreJoined(Current, Direction) && !Visited.Contains(Current.Neighbor(Direction)))
+					{
+						Visited.Add(Current.Neighbor(Direction));
+						Stack.Add(Current.Neighbor(Direction));
+					}
+				}
+			}
+		}
+
+		const FHexWfcWaterAnalysis& Water = Result.Water;
+		TestEqual(FString::Printf(TEXT("Seed %d: water cell count should match a flood fill."), Seed), Water.NumWaterCells, NumWaterCells);
+		TestEqual(FString::Printf(TEXT("Seed %d: component count should match a flood fill."), Seed), Water.NumWaterComponents, NumComponents);
+		TestTrue(FString::Printf(TEXT("Seed %d: two or more water cells should give a path."), Seed), NumWaterCells < 2 || Water.WaterPath.Num() >= 2);
+
+		for (int32 PathIndex = 1; PathIndex < Water.WaterPath.Num(); ++PathIndex)
+		{
+			const FHexAxialCoord& From = Water.WaterPath[PathIndex - 1];
+			const FHexAxialCoord& To = Water.WaterPath[PathIndex];
+			bool bStepJoined = false;
+			for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
+			{
+				bStepJoined |= From.Neighbor(HexDirectionFromIndex(DirIndex)) == To && AreJoined(From, HexDirectionFromIndex(DirIndex));
+			}
+			if (!bStepJoined)
+			{
+				AddError(FString::Printf(TEXT("Seed %d: path step %s -> %s does not follow water."), Seed, *From.ToString(), *To.ToString()));
+				break;
+			}
+		}
+
+		if (Water.bEntryExitConnected)
+		{
+			TestTrue(
+				FString::Printf(TEXT("Seed %d: a connected port pair should bound the path."), Seed),
+				Water.WaterPath.Num() > 0
+					&& Water.WaterPath[0] == Result.ResolvedEntryPort.Coord
+					&& Water.WaterPath.Last() == Result.ResolvedExitPort.Coord);
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FCanalScenarioMetadataSetterTest,
+	"UEGame.Canal.Scenario.MetadataSetter",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCanalScenarioMetadataSetterTest::RunTest(const FString& Parameters)
+{
+	ACanalTopologyGeneratorActor* Generator = NewObject<ACanalTopologyGeneratorActor>(GetTransientPackage());
+	if (!Generator)
+	{
+		AddError(TEXT("Failed to allocate topology generator actor."));
+		return false;
+	}
+
+	Generator->SetScenarioMetadata(TEXT("CaptureRun"), 45.5f);
 	TestEqual(TEXT("Scenario name should be recorded to generation metadata."), Generator->LastGenerationMetadata.ScenarioName, FName(TEXT("CaptureRun")));
 	TestTrue(TEXT("Scenario duration should be recorded to generation metadata."), FMath::IsNearlyEqual(Generator->LastGenerationMetadata.ScenarioDurationSeconds, 45.5f));
 
@@ -1021,4 +2138,969 @@ bool FCanalM1TowpathPropCoverageTest::RunTest(const FString& Parameters)
 	return true;
 }
 
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FCanalM1RerollRegionTest,
+	"UEGame.Canal.M1.RerollRegion",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCanalM1RerollRegionTest::RunTest(const FString& Parameters)
+{
+	UCanalTopologyTileSetAsset* TileSetAsset = BuildPrototypeTileSetAsset(*this);
+	if (!TileSetAsset)
+	{
+		return false;
+	}
+
+	ACanalTopologyGeneratorActor* Generator = NewObject<ACanalTopologyGeneratorActor>(GetTransientPackage());
+	if (!Generator)
+	{
+		AddError(TEXT("Failed to allocate topology generator actor."));
+		return false;
+	}
+
+	Generator->TileSet = TileSetAsset;
+	Generator->GridConfig.Width = 16;
+	Generator->GridConfig.Height = 8;
+	Generator->SolveConfig = MakeM1RelaxedSolveConfig();
+	Generator->SolveConfig.Seed = 4300;
+	Generator->bGenerateSpline = false;
+	Generator->bSpawnTowpathProps = false;
+
+	TestFalse(TEXT("Reroll should refuse before anything is generated."), Generator->RerollRegion(FHexAxialCoord(8, 4), 2, 1));
+
+	Generator->GenerateTopology();
+	if (!TestTrue(TEXT("Generator should solve for reroll test."), Generator->LastSolveResult.bSolved))
+	{
+		return false;
+	}
+
+	const TArray<FHexWfcCellResult> Before = Generator->LastSolveResult.Cells;
+	TestTrue(TEXT("Reroll should re-solve the region."), Generator->RerollRegion(FHexAxialCoord(8, 4), 2, 99));
+	TestEqual(TEXT("Reroll should keep the cell count."), Generator->LastSolveResult.Cells.Num(), Before.Num());
+	TestTrue(
+		TEXT("Rerolled map should still match at every seam."),
+		ValidateSolvedAdjacency(*this, TileSetAsset->GetCompatibilityTable(), Generator->LastSolveResult.Cells));
+
+	// Six socket instances per cell stay live; changed sides either reuse a hidden instance or add one.
+	TArray<UHierarchicalInstancedStaticMeshComponent*> SocketComponents;
+	Generator->GetComponents(SocketComponents);
+	int32 VisibleInstances = 0;
+	for (const UHierarchicalInstancedStaticMeshComponent* Component : SocketComponents)
+	{
+		for (int32 InstanceIndex = 0; InstanceIndex < Component->GetInstanceCount(); ++InstanceIndex)
+		{
+			FTransform InstanceXf;
+			if (Component->GetInstanceTransform(InstanceIndex, InstanceXf) && !InstanceXf.GetScale3D().IsNearlyZero())
+			{
+				++VisibleInstances;
+			}
+		}
+	}
+	TestEqual(TEXT("Every solved cell side should have exactly one visible socket instance."), VisibleInstances, Before.Num() * 6);
+
+	// With props on, a reroll only replaces props on changed towpath sides; everything well outside the region stays.
+	ACanalTopologyGeneratorActor* PropGenerator = NewObject<ACanalTopologyGeneratorActor>(GetTransientPackage());
+	PropGenerator->TileSet = TileSetAsset;
+	PropGenerator->GridConfig = Generator->GridConfig;
+	PropGenerator->SolveConfig = Generator->SolveConfig;
+	PropGenerator->bGenerateSpline = false;
+	PropGenerator->GenerateTopology();
+	if (!TestTrue(TEXT("Prop generator should solve."), PropGenerator->LastSolveResult.bSolved))
+	{
+		return false;
+	}
+
+	const FHexAxialCoord RerollCenter(8, 4);
+	const FVector CenterLocation = PropGenerator->GridLayout.AxialToWorld(RerollCenter);
+	const float FarDistance = PropGenerator->GridLayout.HexSize * 4.0f * FMath::Sqrt(3.0f);
+	const auto CollectFarInstances = [&]()
+	{
+		TArray<FVector> Locations;
+		TArray<UHierarchicalInstancedStaticMeshComponent*> Components;
+		PropGenerator->GetComponents(Components);
+		for (const UHierarchicalInstancedStaticMeshComponent* Component : Components)
+		{
+			for (int32 InstanceIndex = 0; InstanceIndex < Component->GetInstanceCount(); ++InstanceIndex)
+			{
+				FTransform InstanceXf;
+				if (Component->GetInstanceTransform(InstanceIndex, InstanceXf, true)
+					&& !InstanceXf.GetScale3D().IsNearlyZero()
+					&& FVector::Dist2D(InstanceXf.GetLocation(), CenterLocation) > FarDistance)
+				{
+					Locations.Add(InstanceXf.GetLocation());
+				}
+			}
+		}
+		return Locations;
+	};
+
+	const TArray<FVector> FarBefore = CollectFarInstances();
+	TestTrue(TEXT("Props should be placed before the reroll."), PropGenerator->GetTotalTowpathPropCount() > 0);
+	TestTrue(TEXT("Prop reroll should re-solve the region."), PropGenerator->RerollRegion(RerollCenter, 2, 99));
+	const TArray<FVector> FarAfter = CollectFarInstances();
+	TestEqual(TEXT("Instances outside the region should be kept."), FarAfter.Num(), FarBefore.Num());
+	for (const FVector& Location : FarBefore)
+	{
+		if (!FarAfter.ContainsByPredicate([&Location](const FVector& Other) { return Other.Equals(Location, 0.01); }))
+		{
+			AddError(FString::Printf(TEXT("Instance at %s outside the rerolled region moved."), *Location.ToString()));
+			break;
+		}
+	}
+
+	TArray<FName> PropTags;
+	PropGenerator->GetTowpathPropSemanticTags(PropTags);
+	int32 PropsByTag = 0;
+	for (const FName Tag : PropTags)
+	{
+		PropsByTag += PropGenerator->GetTowpathPropCountByTag(Tag);
+	}
+	TestEqual(TEXT("Hidden props should not be counted."), PropsByTag, PropGenerator->GetTotalTowpathPropCount());
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FCanalM1StreamedInstancesTest,
+	"UEGame.Canal.M1.StreamedInstances",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCanalM1StreamedInstancesTest::RunTest(const FString& Parameters)
+{
+	UCanalTopologyTileSetAsset* TileSetAsset = BuildPrototypeTileSetAsset(*this);
+	if (!TileSetAsset)
+	{
+		return false;
+	}
+
+	ACanalTopologyGeneratorActor* Generator = NewObject<ACanalTopologyGeneratorActor>(GetTransientPackage());
+	if (!Generator)
+	{
+		AddError(TEXT("Failed to allocate topology generator actor."));
+		return false;
+	}
+
+	Generator->TileSet = TileSetAsset;
+	Generator->SolveConfig = MakeM1RelaxedSolveConfig();
+	Generator->SolveConfig.Seed = 4242;
+	Generator->bStreamChunks = true;
+	Generator->ChunkConfig.ChunkWidth = 8;
+	Generator->ChunkConfig.ChunkHeight = 6;
+	Generator->ChunkConfig.ViewRadiusChunks = 1;
+	Generator->ChunkConfig.MaxResidentChunks = 10;
+
+	const int32 InstancesPerChunk = Generator->ChunkConfig.ChunkWidth * Generator->ChunkConfig.ChunkHeight * 6;
+	TArray<UHierarchicalInstancedStaticMeshComponent*> Components;
+	Generator->GetComponents(Components);
+
+	// Walk east far enough to evict the start. Every resident chunk side keeps one visible instance, and evicted
+	// instances are reused rather than accumulating. Parked instances are reused per component, whose peaks need not
+	// coincide, so the bound has slack; without reuse this walk would add over three times the budget.
+	Generator->GenerateTopology();
+	for (int32 Step = 0; Step <= 10; ++Step)
+	{
+		Generator->UpdateStreamingFocus(Generator->GridLayout.AxialToWorld(FHexAxialCoord(Step * Generator->ChunkConfig.ChunkWidth, 0)));
+
+		int32 VisibleInstances = 0;
+		int32 TotalInstances = 0;
+		for (const UHierarchicalInstancedStaticMeshComponent* Component : Components)
+		{
+			TotalInstances += Component->GetInstanceCount();
+			for (int32 InstanceIndex = 0; InstanceIndex < Component->GetInstanceCount(); ++InstanceIndex)
+			{
+				FTransform InstanceXf;
+				if (Component->GetInstanceTransform(InstanceIndex, InstanceXf) && !InstanceXf.GetScale3D().IsNearlyZero())
+				{
+					++VisibleInstances;
+				}
+			}
+		}
+
+		TestEqual(TEXT("Every resident chunk side should have one visible instance."), VisibleInstances, Generator->GetStreamedChunkCount() * InstancesPerChunk);
+		TestTrue(TEXT("Evicted instances should be reused."), TotalInstances <= 2 * Generator->ChunkConfig.MaxResidentChunks * InstancesPerChunk);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FHexWfcBitsetKernelBenchmarkTest,
+	"UEGame.Canal.WFC.BitsetKernelBenchmark",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHexWfcBitsetKernelBenchmarkTest::RunTest(const FString& Parameters)
+{
+	// Prototype set (one mask word) plus random asymmetric sets wide enough for two and four words.
+	TArray<TArray<FCanalTopologyTileDefinition>> TileSets;
+	TileSets.Add(FCanalPrototypeTileSet::BuildV0());
+	for (const int32 NumTiles : {20, 40})
+	{
+		FRandomStream TileRandom(NumTiles);
+		TArray<FCanalTopologyTileDefinition>& Tiles = TileSets.AddDefaulted_GetRef();
+		for (int32 TileIndex = 0; TileIndex < NumTiles; ++TileIndex)
+		{
+			FCanalTopologyTileDefinition& Tile = Tiles.AddDefaulted_GetRef();
+			Tile.TileId = FName(*FString::Printf(TEXT("bench_%d"), TileIndex));
+			for (int32 SocketIndex = 0; SocketIndex < 6; ++SocketIndex)
+			{
+				Tile.Sockets.Add(static_cast<ECanalSocketType>(TileRandom.RandRange(0, FCanalTileCompatibilityTable::NumSocketTypes - 1)));
+			}
+		}
+	}
+
+	constexpr int32 NumDomains = 256;
+	constexpr int32 NumRounds = 200;
+	for (const TArray<FCanalTopologyTileDefinition>& Tiles : TileSets)
+	{
+		FCanalTileCompatibilityTable Compatibility;
+		FString Error;
+		if (!Compatibility.Build(Tiles, &Error))
+		{
+			AddError(FString::Printf(TEXT("Failed to build compatibility: %s"), *Error));
+			return false;
+		}
+
+		const int32 NumWords = Compatibility.GetVariantMaskWordCount();
+		TestEqual(
+			FString::Printf(TEXT("%d-word table should get a specialized solve loop."), NumWords),
+			FHexWfcBitsetKernels::SelectFixedWords(NumWords),
+			NumWords);
+
+		// Random partial domains, as a mid-solve grid would hold.
+		FRandomStream DomainRandom(NumWords);
+		TArray<uint64> Domains;
+		Domains.SetNumZeroed(NumDomains * NumWords);
+		for (int32 DomainIndex = 0; DomainIndex < NumDomains; ++DomainIndex)
+		{
+			uint64* Domain = &Domains[DomainIndex * NumWords];
+			for (int32 VariantIndex = 0; VariantIndex < Compatibility.GetNumVariants(); ++VariantIndex)
+			{
+				if (DomainRandom.FRand() < 0.3f)
+				{
+					Domain[VariantIndex / 64] |= uint64(1) << (VariantIndex % 64);
+				}
+			}
+		}
+
+		TArray<float> Weights;
+		Weights.Init(1.0f, Compatibility.GetNumVariants());
+		TArray<uint64> SpecializedKept;
+		TArray<uint64> GenericKept;
+		SpecializedKept.SetNumZeroed(NumWords);
+		GenericKept.SetNumZeroed(NumWords);
+
+		int64 SpecializedChecksum = 0;
+		int64 GenericChecksum = 0;
+		const double GenericSeconds = RunBitsetKernelRounds<0>(Compatibility, Domains, NumRounds, Weights, GenericKept, GenericChecksum);
+		double SpecializedSeconds = 0.0;
+		switch (FHexWfcBitsetKernels::SelectFixedWords(NumWords))
+		{
+		case 1:
+			SpecializedSeconds = RunBitsetKernelRounds<1>(Compatibility, Domains, NumRounds, Weights, SpecializedKept, SpecializedChecksum);
+			break;
+		case 2:
+			SpecializedSeconds = RunBitsetKernelRounds<2>(Compatibility, Domains, NumRounds, Weights, SpecializedKept, SpecializedChecksum);
+			break;
+		case 4:
+			SpecializedSeconds = RunBitsetKernelRounds<4>(Compatibility, Domains, NumRounds, Weights, SpecializedKept, SpecializedChecksum);
+			break;
+		default:
+			SpecializedSeconds = RunBitsetKernelRounds<0>(Compatibility, Domains, NumRounds, Weights, SpecializedKept, SpecializedChecksum);
+			break;
+		}
+		TestEqual(FString::Printf(TEXT("%d-word specialized kernels should match the generic path."), NumWords), SpecializedChecksum, GenericChecksum);
+
+		AddInfo(FString::Printf(
+			TEXT("%d variants (%d words): generic %.3f ms, specialized %.3f ms (%.2fx)."),
+			Compatibility.GetNumVariants(),
+			NumWords,
+			GenericSeconds * 1000.0,
+			SpecializedSeconds * 1000.0,
+			SpecializedSeconds > 0.0 ? GenericSeconds / SpecializedSeconds : 0.0));
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FHexWfcSolverWorkspaceReuseTest,
+	"UEGame.Canal.WFC.SolverWorkspaceReuse",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHexWfcSolverWorkspaceReuseTest::RunTest(const FString& Parameters)
+{
+	const UCanalTopologyTileSetAsset* TileSetAsset = BuildPrototypeTileSetAsset(*this);
+	if (!TileSetAsset)
+	{
+		return false;
+	}
+
+	FHexWfcGridConfig Grid;
+	Grid.Width = 12;
+	Grid.Height = 10;
+
+	TArray<FHexWfcSolveConfig> Configs;
+	for (int32 Mode = 0; Mode < 4; ++Mode)
+	{
+		FHexWfcSolveConfig& Config = Configs.Add_GetRef(MakeM1RelaxedSolveConfig());
+		Config.Propagator = (Mode & 1) ? EHexWfcPropagator::SupportCount : EHexWfcPropagator::Filter;
+		Config.bEnableBacktracking = (Mode & 2) != 0;
+	}
+	Configs.Add_GetRef(MakeM1RelaxedSolveConfig()).DomainMode = EHexWfcDomainMode::CandidateList;
+	Configs.Add_GetRef(MakeM1RelaxedSolveConfig()).SpeculativeAttempts = 3;
+
+	// One workspace serves every config and seed. The first pass grows it to its high-water mark and must match fresh
+	// solves; replaying the same solves must then leave every buffer's allocation untouched.
+	const FHexWfcSolver Solver(TileSetAsset->GetCompatibilityTable());
+	FHexWfcSolverWorkspace Workspace;
+	constexpr int32 NumSeeds = 8;
+	for (int32 ConfigIndex = 0; ConfigIndex < Configs.Num(); ++ConfigIndex)
+	{
+		for (int32 Seed = 1; Seed <= NumSeeds; ++Seed)
+		{
+			FHexWfcSolveConfig Config = Configs[ConfigIndex];
+			Config.Seed = Seed;
+			const FHexWfcSolveResult Fresh = Solver.Solve(Grid, Config);
+			const FHexWfcSolveResult Reused = Solver.Solve(Grid, Config, Workspace);
+			TestSameSolveResult(*this, FString::Printf(TEXT("Config %d, seed %d"), ConfigIndex, Seed), Fresh, Reused);
+		}
+	}
+
+	const SIZE_T SteadySize = Workspace.GetAllocatedSize();
+	int32 NumReallocatingSolves = 0;
+	for (const FHexWfcSolveConfig& Template : Configs)
+	{
+		for (int32 Seed = 1; Seed <= NumSeeds; ++Seed)
+		{
+			FHexWfcSolveConfig Config = Template;
+			Config.Seed = Seed;
+			Solver.Solve(Grid, Config, Workspace);
+			NumReallocatingSolves += Workspace.GetAllocatedSize() != SteadySize ? 1 : 0;
+		}
+	}
+
+	TestTrue(TEXT("A warmed workspace should hold memory."), SteadySize > 0);
+	TestEqual(TEXT("Solves on a warmed workspace should not reallocate its buffers."), NumReallocatingSolves, 0);
+	AddInfo(FString::Printf(TEXT("Workspace high-water mark: %llu bytes."), static_cast<uint64>(SteadySize)));
+
+	Workspace.Empty();
+	TestEqual(TEXT("Empty should free every buffer."), Workspace.GetAllocatedSize(), static_cast<SIZE_T>(0));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FHexWfcPinnedCellsTest,
+	"UEGame.Canal.WFC.PinnedCells",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHexWfcPinnedCellsTest::RunTest(const FString& Parameters)
+{
+	const UCanalTopologyTileSetAsset* TileSetAsset = BuildPrototypeTileSetAsset(*this);
+	if (!TileSetAsset)
+	{
+		return false;
+	}
+
+	const FCanalTileCompatibilityTable& Compatibility = TileSetAsset->GetCompatibilityTable();
+	const FHexWfcSolver Solver(Compatibility);
+
+	FHexWfcGridConfig Grid;
+	Grid.Width = 10;
+	Grid.Height = 8;
+
+	// A lock turned one step, so it runs north-east to south-west; lock_gate repeats every three steps.
+	FHexWfcPinnedCell LockPin;
+	LockPin.Coord = FHexAxialCoord(5, 4);
+	LockPin.AllowedTileIds = {TEXT("lock_gate")};
+	LockPin.AllowedRotations = {1};
+
+	FHexWfcSolveConfig Config = MakeM1RelaxedSolveConfig();
+	Config.bEnableBacktracking = true;
+	Config.PinnedCells = {LockPin};
+	for (int32 Seed = 1; Seed <= 6; ++Seed)
+	{
+		Config.Seed = Seed;
+		const FHexWfcSolveResult Result = Solver.Solve(Grid, Config);
+		if (!TestTrue(FString::Printf(TEXT("Seed %d should solve with the lock pinned."), Seed), Result.bSolved))
+		{
+			continue;
+		}
+
+		const FHexWfcCellResult& Cell = Result.Cells[Grid.Width * LockPin.Coord.R + LockPin.Coord.Q];
+		const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(Cell.Variant.TileIndex);
+		TestTrue(FString::Printf(TEXT("Seed %d should place the lock on the pinned cell."), Seed), Tile && Tile->TileId == TEXT("lock_gate"));
+		TestTrue(FString::Printf(TEXT("Seed %d should turn the lock as pinned."), Seed), Cell.Variant.RotationSteps % 3 == 1);
+		ValidateSolvedAdjacency(*this, Compatibility, Result.Cells);
+	}
+
+	// A solid bank directly west of an unturned lock faces the lock's west socket with a bank.
+	FHexWfcPinnedCell BankPin;
+	BankPin.Coord = FHexAxialCoord(3, 3);
+	BankPin.AllowedTileIds = {TEXT("solid_bank")};
+	FHexWfcPinnedCell FacingLockPin;
+	FacingLockPin.Coord = FHexAxialCoord(4, 3);
+	FacingLockPin.AllowedTileIds = {TEXT("lock_gate")};
+	FacingLockPin.AllowedRotations = {0};
+
+	FHexWfcSolveConfig InfeasibleConfig = MakeM1RelaxedSolveConfig();
+	InfeasibleConfig.PinnedCells = {BankPin, FacingLockPin};
+	const FHexWfcSolveResult Infeasible = Solver.Solve(Grid, InfeasibleConfig);
+	TestFalse(TEXT("Contradicting pins should not solve."), Infeasible.bSolved);
+	TestTrue(TEXT("Contradicting pins should be reported as infeasible."), Infeasible.bConstraintsInfeasible);
+	TestEqual(TEXT("Infeasible pins should stop after the first attempt."), Infeasible.AttemptsUsed, 1);
+	TestTrue(TEXT("The report should name the contradiction."), Infeasible.Message.Contains(TEXT("infeasible")));
+
+	FHexWfcSolveConfig UnknownTileConfig = MakeM1RelaxedSolveConfig();
+	FHexWfcPinnedCell UnknownPin;
+	UnknownPin.Coord = FHexAxialCoord(1, 1);
+	UnknownPin.AllowedTileIds = {TEXT("no_such_tile")};
+	UnknownTileConfig.PinnedCells = {UnknownPin};
+	const FHexWfcSolveResult Unknown = Solver.Solve(Grid, UnknownTileConfig);
+	TestEqual(TEXT("Unknown pinned tiles should be rejected before any attempt."), Unknown.AttemptsUsed, 0);
+	TestTrue(TEXT("The rejection should name the tile."), Unknown.Message.Contains(TEXT("no_such_tile")));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FHexWfcCarvedEntryExitPathTest,
+	"UEGame.Canal.WFC.CarvedEntryExitPath",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHexWfcCarvedEntryExitPathTest::RunTest(const FString& Parameters)
+{
+	const UCanalTopologyTileSetAsset* TileSetAsset = BuildPrototypeTileSetAsset(*this);
+	if (!TileSetAsset)
+	{
+		return false;
+	}
+
+	const FHexWfcSolver Solver(TileSetAsset->GetCompatibilityTable());
+
+	FHexWfcGridConfig Grid;
+	Grid.Width = 20;
+	Grid.Height = 14;
+
+	FHexWfcSolveConfig Config = MakeM1RelaxedSolveConfig();
+	Config.bRequireEntryExitPath = true;
+	Config.bCarveEntryExitPath = true;
+	Config.bAutoSelectBoundaryPorts = false;
+	Config.EntryPort.bEnabled = true;
+	Config.EntryPort.Coord = FHexAxialCoord(0, 7);
+	Config.EntryPort.Direction = EHexDirection::West;
+	Config.ExitPort.bEnabled = true;
+	Config.ExitPort.Coord = FHexAxialCoord(19, 7);
+	Config.ExitPort.Direction = EHexDirection::East;
+
+	for (int32 Seed = 1; Seed <= 8; ++Seed)
+	{
+		Config.Seed = Seed;
+		const FHexWfcSolveResult Result = Solver.Solve(Grid, Config);
+		if (!TestTrue(FString::Printf(TEXT("Seed %d should solve with a carved path."), Seed), Result.bSolved))
+		{
+			continue;
+		}
+
+		TestEqual(FString::Printf(TEXT("Seed %d should solve on its first attempt."), Seed), Result.AttemptsUsed, 1);
+		TestTrue(FString::Printf(TEXT("Seed %d should join the ports by water."), Seed), Result.Water.bEntryExitConnected);
+		TestTrue(
+			FString::Printf(TEXT("Seed %d should keep the configured ports."), Seed),
+			Result.ResolvedEntryPort.Coord == Config.EntryPort.Coord && Result.ResolvedExitPort.Coord == Config.ExitPort.Coord);
+		ValidateSolvedAdjacency(*this, TileSetAsset->GetCompatibilityTable(), Result.Cells);
+	}
+
+	// Without explicit ports the solver picks them from the seed, on the west and east edges.
+	FHexWfcSolveConfig AutoPortConfig = Config;
+	AutoPortConfig.EntryPort = FHexBoundaryPort();
+	AutoPortConfig.ExitPort = FHexBoundaryPort();
+	AutoPortConfig.Seed = 3;
+	const FHexWfcSolveResult AutoPorts = Solver.Solve(Grid, AutoPortConfig);
+	TestTrue(TEXT("Carving should pick its own ports when none are given."), AutoPorts.bSolved);
+	TestEqual(TEXT("Picked entry should sit on the west edge."), AutoPorts.ResolvedEntryPort.Coord.Q, 0);
+	TestEqual(TEXT("Picked exit should sit on the east edge."), AutoPorts.ResolvedExitPort.Coord.Q, Grid.Width - 1);
+
+	FHexWfcSolveConfig InteriorPortConfig = Config;
+	InteriorPortConfig.EntryPort.Coord = FHexAxialCoord(5, 7);
+	const FHexWfcSolveResult InteriorPort = Solver.Solve(Grid, InteriorPortConfig);
+	TestEqual(TEXT("A port facing into the grid should be rejected before any attempt."), InteriorPort.AttemptsUsed, 0);
+	TestTrue(TEXT("The rejection should name the carving option."), InteriorPort.Message.Contains(TEXT("bCarveEntryExitPath")));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FHexWfcHierarchicalSolveTest,
+	"UEGame.Canal.WFC.HierarchicalSolve",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHexWfcHierarchicalSolveTest::RunTest(const FString& Parameters)
+{
+	const UCanalTopologyTileSetAsset* TileSetAsset = BuildPrototypeTileSetAsset(*this);
+	if (!TileSetAsset)
+	{
+		return false;
+	}
+
+	const FCanalTileCompatibilityTable& Compatibility = TileSetAsset->GetCompatibilityTable();
+	const FHexWfcHierarchicalSolver Solver(Compatibility);
+
+	FHexWfcHierarchicalConfig HierarchyConfig;
+	HierarchyConfig.MacroWidth = 5;
+	HierarchyConfig.MacroHeight = 4;
+	HierarchyConfig.PatchWidth = 8;
+	HierarchyConfig.PatchHeight = 8;
+
+	// Global requirements apply to the macro grid, in macro coordinates.
+	FHexWfcSolveConfig Config = MakeM1RelaxedSolveConfig();
+	Config.bEnableBacktracking = true;
+	Config.bRequireEntryExitPath = true;
+	Config.bRequireSingleWaterComponent = true;
+	Config.bPropagateConnectivity = true;
+	Config.bAutoSelectBoundaryPorts = false;
+	Config.EntryPort.bEnabled = true;
+	Config.EntryPort.Coord = FHexAxialCoord(0, 2);
+	Config.EntryPort.Direction = EHexDirection::West;
+	Config.ExitPort.bEnabled = true;
+	Config.ExitPort.Coord = FHexAxialCoord(4, 2);
+	Config.ExitPort.Direction = EHexDirection::East;
+
+	for (int32 Seed = 1; Seed <= 3; ++Seed)
+	{
+		Config.Seed = Seed;
+		HierarchyConfig.bSolvePatchesInParallel = true;
+		const FHexWfcHierarchicalResult Result = Solver.Solve(HierarchyConfig, Config);
+		if (!TestTrue(FString::Printf(TEXT("Seed %d should solve: %s"), Seed, *Result.Message), Result.bSolved))
+		{
+			continue;
+		}
+
+		TestEqual(FString::Printf(TEXT("Seed %d should cover the fine grid."), Seed), Result.Cells.Num(), 40 * 32);
+		TestEqual(FString::Printf(TEXT("Seed %d should solve one patch per macro cell."), Seed), Result.Patches.Num(), 20);
+		TestTrue(
+			FString::Printf(TEXT("Seed %d should carry the ports to the fine grid edge."), Seed),
+			Result.bHasResolvedPorts && Result.ResolvedEntryPort.Coord.Q == 0 && Result.ResolvedExitPort.Coord.Q == 39);
+		ValidateSolvedAdjacency(*this, Compatibility, Result.Cells);
+
+		HierarchyConfig.bSolvePatchesInParallel = false;
+		const FHexWfcHierarchicalResult Serial = Solver.Solve(HierarchyConfig, Config);
+		bool bSameCells = Serial.Cells.Num() == Result.Cells.Num();
+		for (int32 Index = 0; bSameCells && Index < Result.Cells.Num(); ++Index)
+		{
+			bSameCells = Serial.Cells[Index].Variant.TileIndex == Result.Cells[Index].Variant.TileIndex
+				&& Serial.Cells[Index].Variant.RotationSteps == Result.Cells[Index].Variant.RotationSteps;
+		}
+		TestTrue(FString::Printf(TEXT("Seed %d should not depend on solving patches in parallel."), Seed), bSameCells);
+	}
+
+	HierarchyConfig.PatchWidth = 2;
+	const FHexWfcHierarchicalResult Invalid = Solver.Solve(HierarchyConfig, Config);
+	TestFalse(TEXT("Patches smaller than 4 cells should be rejected."), Invalid.bSolved);
+	TestTrue(TEXT("The rejection should name the patch size."), Invalid.Message.Contains(TEXT("PatchWidth")));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FHexWfcHierarchicalLinesTest,
+	"UEGame.Canal.WFC.HierarchicalLines",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHexWfcHierarchicalLinesTest::RunTest(const FString& Parameters)
+{
+	const UCanalTopologyTileSetAsset* TileSetAsset = BuildPrototypeTileSetAsset(*this);
+	if (!TileSetAsset)
+	{
+		return false;
+	}
+
+	const FCanalTileCompatibilityTable& Compatibility = TileSetAsset->GetCompatibilityTable();
+	const FHexWfcHierarchicalSolver Solver(Compatibility);
+	const FName LockId(TEXT("lock_gate"));
+	const FName RoadId(TEXT("road_crossing"));
+
+	FHexWfcHierarchicalConfig HierarchyConfig;
+	HierarchyConfig.MacroWidth = 5;
+	HierarchyConfig.MacroHeight = 4;
+	HierarchyConfig.PatchWidth = 8;
+	HierarchyConfig.PatchHeight = 8;
+
+	FHexWfcSolveConfig Config = MakeM1RelaxedSolveConfig();
+	Config.bEnableBacktracking = true;
+	Config.bRequireEntryExitPath = true;
+	Config.bRequireSingleWaterComponent = true;
+	Config.bPropagateConnectivity = true;
+	Config.bAutoSelectBoundaryPorts = false;
+	Config.EntryPort.bEnabled = true;
+	Config.EntryPort.Coord = FHexAxialCoord(0, 2);
+	Config.EntryPort.Direction = EHexDirection::West;
+	Config.ExitPort.bEnabled = true;
+	Config.ExitPort.Coord = FHexAxialCoord(4, 2);
+	Config.ExitPort.Direction = EHexDirection::East;
+
+	// Every macro lock or road has to come out as a straight run of the same tile across its patch, in a stitched grid
+	// that still meets the water rules.
+	int32 NumMacroLocks = 0;
+	int32 NumMacroRoads = 0;
+	for (int32 Seed = 1; Seed <= 20; ++Seed)
+	{
+		Config.Seed = Seed;
+		const FHexWfcHierarchicalResult Result = Solver.Solve(HierarchyConfig, Config);
+		if (!TestTrue(FString::Printf(TEXT("Seed %d should solve: %s"), Seed, *Result.Message), Result.bSolved))
+		{
+			continue;
+		}
+
+		TestTrue(
+			FString::Printf(TEXT("Seed %d should keep one connected water network on the fine grid."), Seed),
+			Result.Water.bEntryExitConnected && Result.Water.NumWaterComponents == 1);
+		for (int32 MacroIndex = 0; MacroIndex < Result.MacroResult.Cells.Num(); ++MacroIndex)
+		{
+			const FCanalTileVariantRef& MacroVariant = Result.MacroResult.Cells[MacroIndex].Variant;
+			if (MacroVariant.TileId != LockId && MacroVariant.TileId != RoadId)
+			{
+				continue;
+			}
+
+			(MacroVariant.TileId == LockId ? NumMacroLocks : NumMacroRoads)++;
+			const FHexWfcPatchResult& Patch = Result.Patches[MacroIndex];
+			TestEqual(FString::Printf(TEXT("Seed %d patch %s should carry its line across two seams."), Seed, *Patch.MacroCoord.ToString()), Patch.NumLineSeams, 2);
+
+			int32 NumLineCells = 0;
+			for (const FHexWfcCellResult& Cell : Result.Cells)
+			{
+				const bool bInPatch = Cell.Coord.Q / HierarchyConfig.PatchWidth == Patch.MacroCoord.X
+					&& Cell.Coord.R / HierarchyConfig.PatchHeight == Patch.MacroCoord.Y;
+				NumLineCells += bInPatch && Cell.Variant.TileId == MacroVariant.TileId ? 1 : 0;
+			}
+			TestTrue(
+				FString::Printf(TEXT("Seed %d patch %s should hold a fine %s line."), Seed, *Patch.MacroCoord.ToString(), *MacroVariant.TileId.ToString()),
+				NumLineCells >= HierarchyConfig.PatchWidth);
+		}
+	}
+	TestTrue(TEXT("Some seed should place a macro lock."), NumMacroLocks > 0);
+	TestTrue(TEXT("Some seed should place a macro road."), NumMacroRoads > 0);
+
+	// A diagonal line cannot cross a non-square patch corner to corner, so the macro grid has to avoid one.
+	HierarchyConfig.PatchWidth = 10;
+	HierarchyConfig.PatchHeight = 6;
+	for (int32 Seed = 1; Seed <= 20; ++Seed)
+	{
+		Config.Seed = Seed;
+		const FHexWfcHierarchicalResult Result = Solver.Solve(HierarchyConfig, Config);
+		if (!TestTrue(FString::Printf(TEXT("Seed %d should solve with non-square patches: %s"), Seed, *Result.Message), Result.bSolved))
+		{
+			continue;
+		}
+
+		const bool bDiagonalLine = Result.MacroResult.Cells.ContainsByPredicate([&Compatibility](const FHexWfcCellResult& Cell)
+		{
+			const FCanalTopologyTileDefinition* Tile = Compatibility.GetTileDefinition(Cell.Variant.TileIndex);
+			const ECanalSocketType Socket = Tile ? Tile->GetSocket(EHexDirection::NorthEast, Cell.Variant.RotationSteps) : ECanalSocketType::Bank;
+			return Socket == ECanalSocketType::Lock || Socket == ECanalSocketType::Road;
+		});
+		TestFalse(FString::Printf(TEXT("Seed %d should not put a diagonal line on non-square patches."), Seed), bDiagonalLine);
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FCanalCounterRandomTest,
+	"UEGame.Canal.WFC.CounterRandom",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCanalCounterRandomTest::RunTest(const FString& Parameters)
+{
+	const FCanalCounterRandom Random(1234, 0x54455354u); // 'TEST'
+	constexpr int32 NumValues = 4096;
+
+	// Values depend only on (index, draw): filling the table in parallel gives what a serial loop gives.
+	TArray<uint32> Serial;
+	Serial.SetNumUninitialized(NumValues);
+	for (int32 Index = 0; Index < NumValues; ++Index)
+	{
+		Serial[Index] = Random.GetUInt32(Index, 3);
+	}
+	TArray<uint32> Parallel;
+	Parallel.SetNumZeroed(NumValues);
+	ParallelFor(NumValues, [&](const int32 Index)
+	{
+		Parallel[NumValues - 1 - Index] = Random.GetUInt32(NumValues - 1 - Index, 3);
+	});
+	TestTrue(TEXT("Parallel draws in reverse order should match the serial ones."), Parallel == Serial);
+
+	double Sum = 0.0;
+	int32 NumDifferentFromSubstream = 0;
+	int32 NumDifferentFromSeed = 0;
+	bool bRangeInBounds = true;
+	bool bHitMin = false;
+	bool bHitMax = false;
+	const FCanalCounterRandom Substream = Random.Substream(1);
+	const FCanalCounterRandom OtherSeed(1235, 0x54455354u);
+	for (int32 Index = 0; Index < NumValues; ++Index)
+	{
+		const float Fraction = Random.GetFraction(Index);
+		bRangeInBounds &= Fraction >= 0.0f && Fraction < 1.0f;
+		Sum += Fraction;
+
+		const int32 Value = Random.RandRange(-2, 2, Index, 1);
+		bRangeInBounds &= Value >= -2 && Value <= 2;
+		bHitMin |= Value == -2;
+		bHitMax |= Value == 2;
+
+		NumDifferentFromSubstream += Substream.GetUInt32(Index) != Random.GetUInt32(Index) ? 1 : 0;
+		NumDifferentFromSeed += OtherSeed.GetUInt32(Index) != Random.GetUInt32(Index) ? 1 : 0;
+	}
+
+	TestTrue(TEXT("Fractions and ranges should stay in bounds."), bRangeInBounds);
+	TestTrue(TEXT("RandRange should include both ends."), bHitMin && bHitMax);
+	TestTrue(TEXT("Fractions should average about one half."), FMath::Abs(Sum / NumValues - 0.5) < 0.02);
+	TestTrue(TEXT("Substreams should draw different values."), NumDifferentFromSubstream > NumValues - 4);
+	TestTrue(TEXT("Different seeds should draw different values."), NumDifferentFromSeed > NumValues - 4);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FHexWfcSolveProfileTest,
+	"UEGame.Canal.WFC.SolveProfile",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHexWfcSolveProfileTest::RunTest(const FString& Parameters)
+{
+	const UCanalTopologyTileSetAsset* TileSetAsset = BuildPrototypeTileSetAsset(*this);
+	if (!TileSetAsset)
+	{
+		return false;
+	}
+
+	const FHexWfcSolver Solver(TileSetAsset->GetCompatibilityTable());
+
+	FHexWfcGridConfig Grid;
+	Grid.Width = 12;
+	Grid.Height = 8;
+
+	FHexWfcSolveConfig Config = MakeM1RelaxedSolveConfig();
+	Config.Seed = 3;
+	Config.Propagator = EHexWfcPropagator::SupportCount;
+	Config.bEnableBacktracking = true;
+	Config.bRequireEntryExitPath = true;
+	Config.bPropagateConnectivity = true;
+	Config.bCarveEntryExitPath = true;
+
+	const FHexWfcSolveResult Result = Solver.Solve(Grid, Config);
+	if (!TestTrue(FString::Printf(TEXT("Profiled solve should succeed: %s"), *Result.Message), Result.bSolved))
+	{
+		return false;
+	}
+
+	const FHexWfcSolveProfile& Profile = Result.Profile;
+	const float PhaseSeconds[] =
+	{
+		Profile.InitializeSeconds,
+		Profile.CarveSeconds,
+		Profile.SelectSeconds,
+		Profile.SampleSeconds,
+		Profile.PropagateSeconds,
+		Profile.ConnectivitySeconds,
+		Profile.BacktrackSeconds,
+		Profile.ValidateSeconds
+	};
+	float AttemptSeconds = 0.0f;
+	bool bAllNonNegative = Profile.PrepareSeconds >= 0.0f;
+	for (const float Seconds : PhaseSeconds)
+	{
+		bAllNonNegative &= Seconds >= 0.0f;
+		AttemptSeconds += Seconds;
+	}
+
+	TestTrue(TEXT("Phase times should not be negative."), bAllNonNegative);
+	TestTrue(TEXT("Propagation, carving and connectivity checks should be timed."), Profile.PropagateSeconds > 0.0f && Profile.CarveSeconds > 0.0f && Profile.ConnectivitySeconds > 0.0f);
+
+	// Attempts run one after another here, so their phases cannot add up to more than the solve took.
+	TestTrue(
+		FString::Printf(TEXT("Phases (%.6fs) should fit in the solve time (%.6fs)."), AttemptSeconds, Result.SolveTimeSeconds),
+		AttemptSeconds <= Result.SolveTimeSeconds + 0.001f);
+	TestTrue(TEXT("Domain memory should be measured."), Profile.PeakDomainBytes >= static_cast<int64>(Grid.Width * Grid.Height) * 8);
+	TestTrue(TEXT("The propagation queue should have held work."), Profile.PeakPropagationQueue > 0);
+	TestTrue(TEXT("Backtracking should keep an undo trail."), Profile.PeakUndoTrail > 0);
+
+	FHexWfcSolveConfig PlainConfig = MakeM1RelaxedSolveConfig();
+	PlainConfig.Seed = 3;
+	const FHexWfcSolveResult PlainResult = Solver.Solve(Grid, PlainConfig);
+	TestTrue(TEXT("Plain solve should succeed."), PlainResult.bSolved);
+	TestEqual(TEXT("Without backtracking there is no undo trail."), PlainResult.Profile.PeakUndoTrail, 0);
+	TestTrue(
+		TEXT("Phases a config does not use should stay at zero."),
+		PlainResult.Profile.CarveSeconds == 0.0f && PlainResult.Profile.ConnectivitySeconds == 0.0f && PlainResult.Profile.BacktrackSeconds == 0.0f);
+
+	FHexWfcBatchConfig BatchConfig;
+	BatchConfig.NumSeeds = 4;
+	const FHexWfcBatchStats Stats = UCanalWfcBlueprintLibrary::RunHexWfcBatch(TileSetAsset, Grid, Config, BatchConfig);
+	TestEqual(TEXT("Batch should process every seed."), Stats.NumSeedsProcessed, BatchConfig.NumSeeds);
+	TestTrue(TEXT("Batch should report average phase times."), Stats.AverageProfile.PropagateSeconds > 0.0f);
+	TestTrue(TEXT("Batch peaks should cover the profiled seed's."), Stats.AverageProfile.PeakDomainBytes >= Profile.PeakDomainBytes);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FHexWfcBenchmarkBaselineTest,
+	"UEGame.Canal.WFC.BenchmarkBaseline",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHexWfcBenchmarkBaselineTest::RunTest(const FString& Parameters)
+{
+	FCanalTileCompatibilityTable Compatibility;
+	FCanalTileCompatibilityTable ScaledCompatibility;
+	FString BuildError;
+	if (!TestTrue(TEXT("Prototype tiles should build."), Compatibility.Build(FHexWfcBenchmark::BuildScaledPrototypeTileSet(1), &BuildError))
+		|| !TestTrue(TEXT("Scaled prototype tiles should build."), ScaledCompatibility.Build(FHexWfcBenchmark::BuildScaledPrototypeTileSet(2), &BuildError)))
+	{
+		AddError(BuildError);
+		return false;
+	}
+	TestEqual(TEXT("Scaling the tile set should scale the variant count."), ScaledCompatibility.GetNumVariants(), Compatibility.GetNumVariants() * 2);
+
+	FHexWfcBenchmarkCase Case;
+	Case.Scenario = TEXT("carve");
+	Case.GridWidth = 8;
+	Case.GridHeight = 8;
+
+	FHexWfcGridConfig Grid;
+	Grid.Width = Case.GridWidth;
+	Grid.Height = Case.GridHeight;
+
+	FHexWfcSolveConfig Config;
+	FString ConfigError;
+	TestFalse(TEXT("Unknown scenarios should be rejected."), FHexWfcBenchmark::MakeScenarioConfig(TEXT("bogus"), Grid, Config, ConfigError));
+	if (!TestTrue(TEXT("The carve scenario should exist."), FHexWfcBenchmark::MakeScenarioConfig(Case.Scenario, Grid, Config, ConfigError)))
+	{
+		return false;
+	}
+
+	const FHexWfcBenchmarkResult Result = FHexWfcBenchmark::RunCase(Compatibility, Case, Config, 1, 3);
+	TestEqual(TEXT("Case ID"), Result.CaseId, FString(TEXT("carve_8x8_t1")));
+	TestEqual(TEXT("Every carve seed should solve."), Result.NumSolved, 3);
+	TestTrue(TEXT("Propagation steps should be counted."), Result.AveragePropagationSteps > 0.0);
+	TestTrue(TEXT("Throughput should be measured."), Result.SolvesPerSecond > 0.0 && Result.NanosecondsPerPropagationStep > 0.0);
+	TestTrue(TEXT("Workspace size should be measured."), Result.WorkspaceBytes > 0 && Result.WorkspaceGrowthBytes >= 0);
+
+	const FString Csv = FHexWfcBenchmark::GetCsvHeader() + TEXT("\n") + FHexWfcBenchmark::ToCsvRow(Result) + TEXT("\n");
+	TArray<FHexWfcBenchmarkResult> Parsed;
+	FString ParseError;
+	if (!TestTrue(TEXT("The CSV report should parse."), FHexWfcBenchmark::ParseCsv(Csv, Parsed, ParseError)) || !TestEqual(TEXT("Parsed rows"), Parsed.Num(), 1))
+	{
+		AddError(ParseError);
+		return false;
+	}
+	TestEqual(TEXT("Round-tripped solves"), Parsed[0].NumSolved, Result.NumSolved);
+	TestEqual(TEXT("Round-tripped workspace bytes"), Parsed[0].WorkspaceBytes, Result.WorkspaceBytes);
+	TestTrue(TEXT("A run should match its own report."), FHexWfcBenchmark::Compare(Parsed[0], Result, 0.15f).Verdict == EHexWfcBenchmarkVerdict::Unchanged);
+
+	// A baseline with only the deterministic counts, like the checked-in one, still catches extra search work.
+	FHexWfcBenchmarkResult Baseline = Result;
+	Baseline.SolvesPerSecond = -1.0;
+	Baseline.NanosecondsPerPropagationStep = -1.0;
+	Baseline.PeakDomainBytes = -1;
+	Baseline.WorkspaceBytes = -1;
+	Baseline.WorkspaceGrowthBytes = -1;
+	TestTrue(TEXT("A measured run should carry machine metrics."), FHexWfcBenchmark::HasMachineMetrics(Result));
+	TestTrue(TEXT("A partially stripped baseline still carries machine metrics."), FHexWfcBenchmark::HasMachineMetrics(Baseline));
+	Baseline.AverageSolveMilliseconds = -1.0;
+	TestFalse(TEXT("A counts-only baseline should carry no machine metrics."), FHexWfcBenchmark::HasMachineMetrics(Baseline));
+	TestTrue(TEXT("Missing timings should be skipped."), FHexWfcBenchmark::Compare(Baseline, Result, 0.15f).Verdict == EHexWfcBenchmarkVerdict::Unchanged);
+
+	Baseline.AveragePropagationSteps = Result.AveragePropagationSteps * 0.5;
+	const FHexWfcBenchmarkComparison Regressed = FHexWfcBenchmark::Compare(Baseline, Result, 0.15f);
+	TestTrue(TEXT("Doubled propagation work should regress."), Regressed.Verdict == EHexWfcBenchmarkVerdict::Regressed);
+	TestEqual(TEXT("Only the changed metric should be reported."), Regressed.Changes.Num(), 1);
+
+	Baseline.NumSeeds = Result.NumSeeds + 1;
+	TestTrue(TEXT("Counts from other seeds should not be compared."), FHexWfcBenchmark::Compare(Baseline, Result, 0.15f).Verdict == EHexWfcBenchmarkVerdict::Unchanged);
+
+	Baseline = Result;
+	Baseline.SolvesPerSecond = Result.SolvesPerSecond * 0.5;
+	TestTrue(TEXT("Doubled throughput should improve."), FHexWfcBenchmark::Compare(Baseline, Result, 0.15f).Verdict == EHexWfcBenchmarkVerdict::Improved);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FCanalWfcBatchStatsMergeTest,
+	"UEGame.Canal.WFC.BatchStatsMerge",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCanalWfcBatchStatsMergeTest::RunTest(const FString& Parameters)
+{
+	UCanalTopologyTileSetAsset* TileSetAsset = BuildPrototypeTileSetAsset(*this);
+	if (!TileSetAsset)
+	{
+		return false;
+	}
+
+	FHexWfcGridConfig Grid;
+	Grid.Width = 8;
+	Grid.Height = 6;
+
+	const FHexWfcSolveConfig Config = MakeM1RelaxedSolveConfig();
+
+	FHexWfcBatchConfig BatchConfig;
+	BatchConfig.StartSeed = 300;
+	BatchConfig.NumSeeds = 12;
+	const FHexWfcBatchStats Whole = UCanalWfcBlueprintLibrary::RunHexWfcBatch(TileSetAsset, Grid, Config, BatchConfig);
+
+	// Uneven shards, the way a resumed run or a sharded run splits the same seed range.
+	TArray<FHexWfcBatchStats> Parts;
+	BatchConfig.NumSeeds = 5;
+	Parts.Add(UCanalWfcBlueprintLibrary::RunHexWfcBatch(TileSetAsset, Grid, Config, BatchConfig));
+	BatchConfig.StartSeed = 305;
+	BatchConfig.NumSeeds = 7;
+	Parts.Add(UCanalWfcBlueprintLibrary::RunHexWfcBatch(TileSetAsset, Grid, Config, BatchConfig));
+
+	const FHexWfcBatchStats Merged = UCanalWfcBlueprintLibrary::MergeHexWfcBatchStats(Parts);
+	TestEqual(TEXT("Merged seeds requested"), Merged.NumSeedsRequested, Whole.NumSeedsRequested);
+	TestEqual(TEXT("Merged seeds processed"), Merged.NumSeedsProcessed, Whole.NumSeedsProcessed);
+	TestEqual(TEXT("Merged solves"), Merged.NumSolved, Whole.NumSolved);
+	TestEqual(TEXT("Merged failures"), Merged.NumFailed, Whole.NumFailed);
+	TestEqual(TEXT("Merged contradictions"), Merged.NumContradictions, Whole.NumContradictions);
+	TestEqual(TEXT("Merged total attempts"), Merged.TotalAttemptsUsed, Whole.TotalAttemptsUsed);
+	TestEqual(TEXT("Merged total backtracks"), Merged.TotalBacktracks, Whole.TotalBacktracks);
+	TestEqual(TEXT("Merged total propagation steps"), Merged.TotalPropagationSteps, Whole.TotalPropagationSteps);
+	TestTrue(TEXT("Merged averages come from the totals"), Merged.AverageAttemptsUsed == Whole.AverageAttemptsUsed);
+	TestTrue(TEXT("Merged average backtracks"), Merged.AverageBacktracks == Whole.AverageBacktracks);
+	TestEqual(TEXT("Merged average propagation steps"), Merged.AverageProfile.PropagationSteps, Whole.AverageProfile.PropagationSteps);
+
+	TestEqual(TEXT("Attempt histogram bins"), Merged.AttemptHistogram.Num(), Whole.AttemptHistogram.Num());
+	for (int32 Index = 0; Index < FMath::Min(Merged.AttemptHistogram.Num(), Whole.AttemptHistogram.Num()); ++Index)
+	{
+		TestEqual(TEXT("Attempt bin"), Merged.AttemptHistogram[Index].Attempts, Whole.AttemptHistogram[Index].Attempts);
+		TestEqual(TEXT("Attempt bin count"), Merged.AttemptHistogram[Index].Count, Whole.AttemptHistogram[Index].Count);
+	}
+
+	TestEqual(TEXT("Backtrack histogram bins"), Merged.BacktrackHistogram.Num(), Whole.BacktrackHistogram.Num());
+	for (int32 Index = 0; Index < FMath::Min(Merged.BacktrackHistogram.Num(), Whole.BacktrackHistogram.Num()); ++Index)
+	{
+		TestEqual(TEXT("Backtrack bin"), Merged.BacktrackHistogram[Index].MinBacktracks, Whole.BacktrackHistogram[Index].MinBacktracks);
+		TestEqual(TEXT("Backtrack bin count"), Merged.BacktrackHistogram[Index].Count, Whole.BacktrackHistogram[Index].Count);
+	}
+
+	TestEqual(TEXT("Tile histogram bins"), Merged.TileHistogram.Num(), Whole.TileHistogram.Num());
+	for (int32 Index = 0; Index < FMath::Min(Merged.TileHistogram.Num(), Whole.TileHistogram.Num()); ++Index)
+	{
+		TestEqual(TEXT("Tile bin"), Merged.TileHistogram[Index].TileId, Whole.TileHistogram[Index].TileId);
+		TestEqual(TEXT("Tile bin count"), Merged.TileHistogram[Index].Count, Whole.TileHistogram[Index].Count);
+		TestTrue(TEXT("Tile bin fraction"), FMath::IsNearlyEqual(Merged.TileHistogram[Index].Fraction, Whole.TileHistogram[Index].Fraction, 1.0e-5f));
+	}
+
+	// Re-merging a running total chunk by chunk, as checkpoints do, must not lose anything either.
+	FHexWfcBatchStats Running;
+	for (int32 Chunk = 0; Chunk < 4; ++Chunk)
+	{
+		BatchConfig.StartSeed = 300 + Chunk * 3;
+		BatchConfig.NumSeeds = 3;
+		Running = UCanalWfcBlueprintLibrary::MergeHexWfcBatchStats({Running, UCanalWfcBlueprintLibrary::RunHexWfcBatch(TileSetAsset, Grid, Config, BatchConfig)});
+	}
+	TestEqual(TEXT("Chunked total propagation steps"), Running.TotalPropagationSteps, Whole.TotalPropagationSteps);
+	TestEqual(TEXT("Chunked total attempts"), Running.TotalAttemptsUsed, Whole.TotalAttemptsUsed);
+
+	const FHexWfcBatchStats Single = UCanalWfcBlueprintLibrary::MergeHexWfcBatchStats({Whole});
+	TestEqual(TEXT("Merging one batch should keep its counts."), Single.NumSolved, Whole.NumSolved);
+	TestEqual(TEXT("Merging nothing should be empty."), UCanalWfcBlueprintLibrary::MergeHexWfcBatchStats({}).NumSeedsProcessed, 0);
+	return true;
+}
+
 #endif // WITH_DEV_AUTOMATION_TESTS
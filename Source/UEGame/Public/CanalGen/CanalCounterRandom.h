@@ -0,0 +1,67 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Counter-based random numbers (Widynski's "Squares" generator). A value is a pure function of the key, which is
+// derived from (seed, stream), and a counter built from (index, draw), so a cell or instance can compute its own
+// numbers on any thread, in any order, and get exactly what a serial loop would. Streams nest through Substream, e.g.
+// one per solve attempt.
+struct FCanalCounterRandom
+{
+	FCanalCounterRandom(const int32 Seed, const uint32 StreamId)
+		: Key(MakeKey((static_cast<uint64>(static_cast<uint32>(Seed)) << 32) | StreamId))
+	{
+	}
+
+	FCanalCounterRandom Substream(const uint32 StreamId) const
+	{
+		FCanalCounterRandom Result(*this);
+		Result.Key = MakeKey(Key ^ (static_cast<uint64>(StreamId) * 0xD1342543DE82EF95ull));
+		return Result;
+	}
+
+	uint32 GetUInt32(const uint32 Index, const uint32 Draw = 0) const
+	{
+		const uint64 Counter = (static_cast<uint64>(Draw) << 32) | Index;
+		uint64 X = Counter * Key;
+		const uint64 Y = X;
+		const uint64 Z = Y + Key;
+		X = X * X + Y;
+		X = (X >> 32) | (X << 32);
+		X = X * X + Z;
+		X = (X >> 32) | (X << 32);
+		X = X * X + Y;
+		X = (X >> 32) | (X << 32);
+		return static_cast<uint32>((X * X + Z) >> 32);
+	}
+
+	// Uniform in [0, 1).
+	float GetFraction(const uint32 Index, const uint32 Draw = 0) const
+	{
+		return static_cast<float>(GetUInt32(Index, Draw) >> 8) * (1.0f / 16777216.0f);
+	}
+
+	float FRandRange(const float Min, const float Max, const uint32 Index, const uint32 Draw = 0) const
+	{
+		return Min + (Max - Min) * GetFraction(Index, Draw);
+	}
+
+	// Uniform in [Min, Max], inclusive like FRandomStream::RandRange.
+	int32 RandRange(const int32 Min, const int32 Max, const uint32 Index, const uint32 Draw = 0) const
+	{
+		const uint64 Range = static_cast<uint64>(static_cast<int64>(Max) - Min + 1);
+		return Max <= Min ? Min : static_cast<int32>(Min + static_cast<int64>((GetUInt32(Index, Draw) * Range) >> 32));
+	}
+
+private:
+	// SplitMix64 finalizer, forced odd: Squares needs a key with well-mixed bits.
+	static uint64 MakeKey(uint64 Value)
+	{
+		Value += 0x9E3779B97F4A7C15ull;
+		Value = (Value ^ (Value >> 30)) * 0xBF58476D1CE4E5B9ull;
+		Value = (Value ^ (Value >> 27)) * 0x94D049BB133111EBull;
+		return (Value ^ (Value >> 31)) | 1ull;
+	}
+
+	uint64 Key = 0;
+};
@@ -2,7 +2,10 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Async/Future.h"
+#include "Containers/Ticker.h"
 #include "CanalGen/CanalTopologyTileTypes.h"
+#include "CanalGen/HexWfcChunkedSolver.h"
 #include "CanalGen/HexWfcSolver.h"
 #include "CanalTopologyGeneratorActor.generated.h"
 
@@ -127,6 +130,9 @@ struct UEGAME_API FCanalTowpathPropDefinition
 	float Weight = 1.0f;
 };
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FCanalGenerationProgressSignature, float, Progress);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FCanalGenerationFinishedSignature, bool, bSolved);
+
 UCLASS(BlueprintType, Blueprintable)
 class UEGAME_API ACanalTopologyGeneratorActor : public AActor
 {
@@ -138,9 +144,37 @@ public:
 	UFUNCTION(BlueprintCallable, CallInEditor, Category = "Canal|Generation")
 	void GenerateTopology();
 
+	// Solves and finds the spline path on a worker thread, then applies instances, props and spline on the game thread.
+	// Starting any generation, or clearing, cancels the one in flight.
+	UFUNCTION(BlueprintCallable, CallInEditor, Category = "Canal|Generation")
+	void GenerateTopologyAsync();
+
+	// Stops the async generation in flight without applying it. OnGenerationFinished is not broadcast.
+	UFUNCTION(BlueprintCallable, Category = "Canal|Generation")
+	void CancelGeneration();
+
+	UFUNCTION(BlueprintPure, Category = "Canal|Generation")
+	bool IsGenerating() const;
+
 	UFUNCTION(BlueprintCallable, CallInEditor, Category = "Canal|Generation")
 	void ClearGenerated();
 
+	// Re-solves the cells within Radius of Center with Seed and keeps the rest of the current map, then updates only
+	// the socket instances that changed. Returns false and leaves the map untouched if the region cannot be re-solved.
+	UFUNCTION(BlueprintCallable, Category = "Canal|Generation")
+	bool RerollRegion(const FHexAxialCoord& Center, int32 Radius, int32 Seed);
+
+	// RerollRegion around RerollCenter/RerollRadius with a new seed on every call.
+	UFUNCTION(BlueprintCallable, CallInEditor, Category = "Canal|Generation|Reroll")
+	void RerollSelectedRegion();
+
+	// With bStreamChunks, generates chunks around WorldLocation and evicts distant ones. Call after GenerateTopology.
+	UFUNCTION(BlueprintCallable, Category = "Canal|Generation|Streaming")
+	void UpdateStreamingFocus(const FVector& WorldLocation);
+
+	UFUNCTION(BlueprintPure, Category = "Canal|Generation|Streaming")
+	int32 GetStreamedChunkCount() const;
+
 	UFUNCTION(BlueprintPure, Category = "Canal|Generation")
 	bool HasGeneratedSpline() const;
 
@@ -173,12 +207,30 @@ public:
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void BeginDestroy() override;
 
 private:
 	bool ValidateTileSet(FString& OutError) const;
 	void RefreshInstanceMeshes();
-	void AddSocketInstance(ECanalSocketType SocketType, const FTransform& WorldTransform);
-	void BuildSplineFromSolvedCells(const FCanalTileCompatibilityTable& Compatibility, const TArray<FHexWfcCellResult>& Cells);
+	UHierarchicalInstancedStaticMeshComponent* ResolveSocketComponent(ECanalSocketType SocketType) const;
+	FTransform GetSocketInstanceTransform(const FHexAxialCoord& Coord, EHexDirection Direction) const;
+	int32 AddSocketInstance(ECanalSocketType SocketType, const FTransform& WorldTransform);
+	void AddCellSocketInstances(
+		const FCanalTileCompatibilityTable& Compatibility,
+		const TArray<FHexWfcCellResult>& Cells,
+		TArray<int32>* OutInstanceIndices = nullptr);
+	// Parks the socket instances of evicted chunks and adds instances for newly generated ones; other chunks keep theirs.
+	void UpdateStreamedInstances(const TArray<FIntPoint>& Generated, const TArray<FIntPoint>& Evicted);
+	// Shared start of both generate paths. Returns false if generation stops here (invalid setup or streamed chunks).
+	bool BeginGeneration(FHexWfcSolveConfig& OutTopologySolveConfig, int32& OutDressingSeed);
+	void ApplySolvedTopology(
+		const FCanalTileCompatibilityTable& Compatibility,
+		const FHexWfcSolveConfig& TopologySolveConfig,
+		int32 DressingSeed);
+	bool PollAsyncGeneration(float DeltaTime);
+	// Follows the water path the solver found (LastSolveResult.Water).
+	void ApplySplinePath(const TArray<FHexAxialCoord>& Path);
 	FVector GetBoundaryPortWorldPosition(const FHexBoundaryPort& Port) const;
 	void DrawPortDebug() const;
 	void DrawGridDebug(const FCanalTileCompatibilityTable& Compatibility) const;
@@ -188,13 +240,17 @@ private:
 		UHierarchicalInstancedStaticMeshComponent* Component,
 		TObjectPtr<UMaterialInstanceDynamic>& OutRuntimeMaterial,
 		const FCanalPrototypeMaterialProfile& Profile,
-		FRandomStream& Random,
+		const FCanalCounterRandom& Random,
+		int32 ProfileIndex,
 		FCanalResolvedMaterialProfile& OutResolvedProfile);
 	void RefreshTowpathPropMeshes();
 	void SpawnTowpathProps(int32 DressingSeed);
+	// Hides the props on removed towpath instances and rolls props for added ones, leaving every other prop in place.
+	void RespawnTowpathProps(const TArray<int32>& RemovedTowpathInstances, const TArray<int32>& AddedTowpathInstances, int32 DressingSeed);
+	void ClearTowpathProps();
 	UHierarchicalInstancedStaticMeshComponent* ResolveTowpathPropComponent(FName SemanticTag) const;
-	bool PlaceTowpathPropAtInstance(const FCanalTowpathPropDefinition& Definition, int32 TowpathInstanceIndex, FRandomStream& Random);
-	const FCanalTowpathPropDefinition* PickWeightedTowpathProp(FRandomStream& Random) const;
+	bool PlaceTowpathPropAtInstance(const FCanalTowpathPropDefinition& Definition, int32 TowpathInstanceIndex, const FCanalCounterRandom& Random);
+	const FCanalTowpathPropDefinition* PickWeightedTowpathProp(float PickFraction) const;
 	bool IsWaterConnection(
 		const FCanalTileCompatibilityTable& Compatibility,
 		const FHexWfcCellResult& A,
@@ -259,9 +315,23 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|Generation")
 	FHexWfcSolveConfig SolveConfig;
 
+	// Generate the world in chunks around UpdateStreamingFocus instead of solving GridConfig in one piece.
+	// Streamed worlds only place socket instances; spline, ports and towpath props need a bounded grid.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|Generation|Streaming")
+	bool bStreamChunks = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|Generation|Streaming", meta = (EditCondition = "bStreamChunks"))
+	FHexWfcChunkConfig ChunkConfig;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|Generation")
 	FHexGridLayout GridLayout;
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|Generation|Reroll")
+	FHexAxialCoord RerollCenter;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|Generation|Reroll", meta = (ClampMin = "0"))
+	int32 RerollRadius = 2;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|Generation|Determinism")
 	bool bDeriveSeedStreamsFromMaster = true;
 
@@ -277,6 +347,13 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|Generation")
 	bool bGenerateSpline = true;
 
+	// Collapsed fraction of the running async solve, broadcast on the game thread while it runs.
+	UPROPERTY(BlueprintAssignable, Category = "Canal|Generation")
+	FCanalGenerationProgressSignature OnGenerationProgress;
+
+	UPROPERTY(BlueprintAssignable, Category = "Canal|Generation")
+	FCanalGenerationFinishedSignature OnGenerationFinished;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|Materials")
 	FCanalPrototypeMaterialProfile WaterMaterialProfile;
 
@@ -404,4 +481,32 @@ private:
 
 	UPROPERTY(Transient)
 	TObjectPtr<UMaterialInstanceDynamic> TowpathRuntimeMaterial;
+
+	TUniquePtr<FHexWfcChunkedSolver> ChunkedSolver;
+
+	// Instance index of every solved cell side in its socket component, [CellIndex * 6 + DirIndex]. Bounded grids only.
+	TArray<int32> SocketInstanceIndices;
+
+	// Socket instances RerollRegion hid (zero scale) and AddSocketInstance reuses before adding new ones.
+	TMap<UHierarchicalInstancedStaticMeshComponent*, TArray<int32>> ParkedSocketInstances;
+
+	// Socket component and instance of every side of each streamed chunk, so eviction can park exactly those.
+	TMap<FIntPoint, TArray<TPair<UHierarchicalInstancedStaticMeshComponent*, int32>>> StreamedChunkInstances;
+
+	// Prop component and instance placed on each towpath instance, keyed by towpath instance index.
+	TMap<int32, TPair<UHierarchicalInstancedStaticMeshComponent*, int32>> TowpathPropsByInstance;
+
+	// Prop instances RerollRegion hid (zero scale) and PlaceTowpathPropAtInstance reuses before adding new ones.
+	TMap<UHierarchicalInstancedStaticMeshComponent*, TArray<int32>> ParkedPropInstances;
+
+	int32 RegionRerollCount = 0;
+
+	// In-flight GenerateTopologyAsync state; the config, seed and the table the worker solved against are applied
+	// with the result.
+	TSharedPtr<FHexWfcSolveControl, ESPMode::ThreadSafe> GenerationControl;
+	TSharedPtr<const FCanalTileCompatibilityTable, ESPMode::ThreadSafe> PendingCompatibility;
+	TFuture<FHexWfcSolveResult> PendingGeneration;
+	FTSTicker::FDelegateHandle GenerationTickerHandle;
+	FHexWfcSolveConfig PendingSolveConfig;
+	int32 PendingDressingSeed = 0;
 };
@@ -33,10 +33,23 @@ public:
 
 protected:
 	virtual void PostLoad() override;
+	virtual void PreSave(FObjectPreSaveContext SaveContext) override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
 
 private:
 	void RebuildCompatibilityIfNeeded() const;
 
+	// Restores Compatibility from CompiledCompatibility. Fails if there is no saved table, it was written by another
+	// format version, or its content hash no longer matches Tiles.
+	bool LoadCompiledCompatibility();
+
+	// Compiled FCanalTileCompatibilityTable, written on save so loading skips the build while Tiles are unchanged.
+	UPROPERTY()
+	TArray<uint8> CompiledCompatibility;
+
 	mutable bool bCompatibilityBuilt = false;
 	mutable FCanalTileCompatibilityTable Compatibility;
 };
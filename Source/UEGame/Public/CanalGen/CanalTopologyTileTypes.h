@@ -71,9 +71,14 @@ struct UEGAME_API FCanalTileVariantRef
 	float Weight = 1.0f;
 };
 
+// Compatibility is socket equality: a variant fits on the OutDirection side of a source variant when its socket
+// facing back matches the source's socket on OutDirection. The table therefore stores one bucket of variants per
+// (direction, socket type) instead of pairwise lists; building it and querying it are linear in the variant count.
 class UEGAME_API FCanalTileCompatibilityTable
 {
 public:
+	static constexpr int32 NumSocketTypes = 6;
+
 	bool Build(const TArray<FCanalTopologyTileDefinition>& InTiles, FString* OutError = nullptr);
 
 	bool IsBuilt() const
@@ -81,33 +86,112 @@ public:
 		return bBuilt;
 	}
 
+	// Hash of everything Build reads from the tiles, plus the table format version. A saved table is only
+	// reused while its hash matches the current tiles.
+	static uint64 ComputeContentHash(const TArray<FCanalTopologyTileDefinition>& InTiles);
+
+	uint64 GetContentHash() const
+	{
+		return ContentHash;
+	}
+
+	// Saves or loads the compiled table. Loading restores the lookups from the stored masks and buckets without
+	// rebuilding them; it returns false (and leaves the table unbuilt) for data written by another format version.
+	bool Serialize(FArchive& Ar);
+
+	// One variant per rotationally distinct orientation of each tile, at its lowest rotation. Rotations that
+	// reproduce the same sockets are folded into that variant and counted by GetVariantMultiplicity.
 	const TArray<FCanalTileVariantKey>& GetAllVariants() const
 	{
 		return AllVariants;
 	}
 
+	int32 GetNumVariants() const
+	{
+		return AllVariants.Num();
+	}
+
+	// Number of uint64 words in a variant bit mask. Bit N of a mask refers to GetAllVariants()[N].
+	int32 GetVariantMaskWordCount() const
+	{
+		return VariantMaskWordCount;
+	}
+
+	// Accepts any rotation; rotations folded into a variant resolve to it.
+	int32 FindVariantIndex(const FCanalTileVariantKey& Key) const;
+
+	// Number of tile rotations the variant stands for (6 / rotational period). Sampling weights scale by it.
+	int32 GetVariantMultiplicity(const int32 VariantIndex) const
+	{
+		return VariantMultiplicities[VariantIndex];
+	}
+
+	// Socket the variant exposes on side DirIndex, as an ECanalSocketType value.
+	int32 GetVariantSocket(const int32 VariantIndex, const int32 DirIndex) const
+	{
+		return VariantSockets[VariantIndex * 6 + DirIndex];
+	}
+
+	// Mask of variants exposing Socket on side DirIndex (GetVariantMaskWordCount() words).
+	const uint64* GetSocketVariantMask(const int32 DirIndex, const int32 Socket) const
+	{
+		return &SocketMasks[(DirIndex * NumSocketTypes + Socket) * VariantMaskWordCount];
+	}
+
+	// Bit S is set when some variant in DomainBits exposes socket type S on side DirIndex.
+	uint8 GetDomainSocketSet(const uint64* DomainBits, int32 DirIndex) const;
+
 	const TArray<FCanalTileVariantKey>& GetCompatibleVariants(const FCanalTileVariantKey& Source, EHexDirection OutDirection) const;
+
+	// Mask of variants allowed on the OutDirection side of the source variant (GetVariantMaskWordCount() words).
+	const uint64* GetCompatibleVariantMask(int32 SourceVariantIndex, EHexDirection OutDirection) const;
+
+	// Same set as GetCompatibleVariantMask, as ascending variant indices.
+	TConstArrayView<int32> GetCompatibleVariantIndices(int32 SourceVariantIndex, EHexDirection OutDirection) const;
+
+	// Mask with every variant bit set (GetVariantMaskWordCount() words).
+	const uint64* GetAllVariantsMask() const
+	{
+		return AllVariantsMask.GetData();
+	}
+
+	// Equivalent rotations all map to the variant's lowest rotation.
 	FCanalTileVariantRef ToVariantRef(const FCanalTileVariantKey& Key) const;
 	const FCanalTopologyTileDefinition* GetTileDefinition(int32 TileIndex) const;
 	FString DescribeCompatibility(const FCanalTileVariantKey& Source, EHexDirection OutDirection) const;
 
 private:
-	struct FVariantAdjacency
+	// Bucket holding the variants a source with this socket on OutDirection accepts on that side.
+	int32 GetCompatibleBucket(int32 SourceVariantIndex, int32 OutDirIndex) const
 	{
-		TArray<FCanalTileVariantKey> ByDirection[6];
-	};
+		return ((OutDirIndex + 3) % 6) * NumSocketTypes + VariantSockets[SourceVariantIndex * 6 + OutDirIndex];
+	}
+
+	// Bump when Build or Serialize change what a compiled table contains.
+	static constexpr int32 FormatVersion = 1;
 
-	static bool CanConnect(
-		const FCanalTopologyTileDefinition& Source,
-		int32 SourceRotation,
-		EHexDirection SourceDirection,
-		const FCanalTopologyTileDefinition& Target,
-		int32 TargetRotation);
+	// Loads claiming more tiles than this are treated as corrupt rather than allocated.
+	static constexpr int32 MaxSerializedTiles = 1 << 16;
 
-	static bool IsDeterministicLess(const FCanalTileVariantKey& A, const FCanalTileVariantKey& B);
+	// Fills VariantIndexByKey and SocketBucketVariants from the variant and bucket arrays.
+	void RebuildLookups();
 
 	bool bBuilt = false;
+	uint64 ContentHash = 0;
 	TArray<FCanalTopologyTileDefinition> TileDefinitions;
+	// Smallest rotation that maps each tile's sockets onto themselves (1, 2, 3 or 6).
+	TArray<uint8> TileRotationPeriods;
 	TArray<FCanalTileVariantKey> AllVariants;
-	TMap<FCanalTileVariantKey, FVariantAdjacency> Compatibility;
+	TArray<uint8> VariantMultiplicities;
+	TMap<FCanalTileVariantKey, int32> VariantIndexByKey;
+	int32 VariantMaskWordCount = 0;
+	TArray<uint64> AllVariantsMask;
+	// [VariantIndex * 6 + DirectionIndex] -> ECanalSocketType value.
+	TArray<uint8> VariantSockets;
+	// Buckets are indexed DirectionIndex * NumSocketTypes + Socket and hold the variants exposing Socket on that side,
+	// in ascending variant index order: as a flattened mask, as CSR indices and as keys.
+	TArray<uint64> SocketMasks;
+	TArray<int32> SocketBucketOffsets;
+	TArray<int32> SocketBucketIndices;
+	TArray<FCanalTileVariantKey> SocketBucketVariants[6 * NumSocketTypes];
 };
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "CanalWfcBenchmarkCommandlet.generated.h"
+
+UCLASS()
+class UEGAME_API UCanalWfcBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UCanalWfcBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -68,6 +68,9 @@ struct UEGAME_API FHexGridLayout
 
 	// Pointy-top axial conversion: X is forward, Y is right.
 	FVector AxialToWorld(const FHexAxialCoord& Coord, float Z = 0.0f) const;
+
+	// Inverse of AxialToWorld; returns the hex containing the XY position (Z is ignored).
+	FHexAxialCoord WorldToAxial(const FVector& Position) const;
 };
 
 UEGAME_API int32 HexDirectionToIndex(EHexDirection Direction);
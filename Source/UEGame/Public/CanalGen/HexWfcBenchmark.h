@@ -0,0 +1,110 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CanalGen/HexWfcSolver.h"
+
+// One point of a benchmark sweep: a constraint scenario on a grid, with the prototype tile set repeated TileSetScale
+// times.
+struct UEGAME_API FHexWfcBenchmarkCase
+{
+	FString Scenario;
+	int32 GridWidth = 16;
+	int32 GridHeight = 16;
+	int32 TileSetScale = 1;
+
+	// "<scenario>_<W>x<H>_t<scale>", the key rows are matched on against a baseline.
+	FString GetCaseId() const;
+};
+
+// Measurements for one case. Counts are deterministic per seed range; times and memory depend on the machine and
+// build. Negative values mean "not recorded", e.g. timings in a baseline taken on another machine.
+struct UEGAME_API FHexWfcBenchmarkResult
+{
+	FString CaseId;
+	FString Scenario;
+	int32 GridWidth = 0;
+	int32 GridHeight = 0;
+	int32 TileSetScale = 1;
+	int32 NumVariants = 0;
+	int32 StartSeed = 1;
+	int32 NumSeeds = 0;
+
+	int32 NumSolved = 0;
+	double AverageAttempts = -1.0;
+
+	// Summed over every attempt of a seed, then averaged over seeds.
+	double AveragePropagationSteps = -1.0;
+
+	double SolvesPerSecond = -1.0;
+	double AverageSolveMilliseconds = -1.0;
+
+	// Time in the propagate phase divided by propagation steps.
+	double NanosecondsPerPropagationStep = -1.0;
+
+	int64 PeakDomainBytes = -1;
+
+	// Solver workspace size after a warm-up solve, and how much it still grew over the measured seeds. Growth above
+	// zero means the steady state still allocates in the search.
+	int64 WorkspaceBytes = -1;
+	int64 WorkspaceGrowthBytes = -1;
+};
+
+enum class EHexWfcBenchmarkVerdict : uint8
+{
+	// No baseline row for the case.
+	New,
+	Unchanged,
+	Improved,
+	Regressed
+};
+
+struct UEGAME_API FHexWfcBenchmarkComparison
+{
+	EHexWfcBenchmarkVerdict Verdict = EHexWfcBenchmarkVerdict::New;
+
+	// One "metric: baseline -> current" entry per metric outside the tolerance.
+	TArray<FString> Changes;
+};
+
+// Throughput sweep for the hex WFC solver, shared by the CanalWfcBenchmark commandlet and its tests. Results are
+// written as CSV rows, and a previous CSV report serves as the baseline for the next run.
+class UEGAME_API FHexWfcBenchmark
+{
+public:
+	// Scenario names, from least to most constrained: relaxed, strict, connectivity, carve.
+	static const TArray<FString>& GetScenarioNames();
+
+	// Largest grid, in cells, the default sweep runs a scenario on.
+	static int32 GetScenarioMaxCells(const FString& Scenario);
+
+	// Solve config for a scenario on Grid. Connectivity and carve use fixed west/east ports at mid height.
+	static bool MakeScenarioConfig(const FString& Scenario, const FHexWfcGridConfig& Grid, FHexWfcSolveConfig& OutConfig, FString& OutError);
+
+	// The prototype tile set repeated Scale times under distinct tile IDs. Copies have the same sockets and weights,
+	// so solutions keep the same shape while domains grow Scale-fold.
+	static TArray<FCanalTopologyTileDefinition> BuildScaledPrototypeTileSet(int32 Scale);
+
+	// Solves StartSeed .. StartSeed + NumSeeds - 1 in one workspace after an untimed warm-up solve of StartSeed.
+	static FHexWfcBenchmarkResult RunCase(
+		const FCanalTileCompatibilityTable& Compatibility,
+		const FHexWfcBenchmarkCase& Case,
+		const FHexWfcSolveConfig& Config,
+		int32 StartSeed,
+		int32 NumSeeds);
+
+	static FString GetCsvHeader();
+	static FString ToCsvRow(const FHexWfcBenchmarkResult& Result);
+
+	// Reads a CSV report by column name, so reports with extra or reordered columns still load.
+	static bool ParseCsv(const FString& Csv, TArray<FHexWfcBenchmarkResult>& OutResults, FString& OutError);
+
+	// Metrics missing from either side are skipped, and the deterministic counts are only compared when both runs
+	// used the same seeds. Tolerance is relative, e.g. 0.15 flags changes above 15%.
+	static FHexWfcBenchmarkComparison Compare(const FHexWfcBenchmarkResult& Baseline, const FHexWfcBenchmarkResult& Current, float Tolerance);
+
+	// True when the result carries any timing or memory column. The checked-in baseline holds counts only, so
+	// comparisons against it cannot catch a throughput or memory regression.
+	static bool HasMachineMetrics(const FHexWfcBenchmarkResult& Result);
+
+	static const TCHAR* LexVerdict(EHexWfcBenchmarkVerdict Verdict);
+};
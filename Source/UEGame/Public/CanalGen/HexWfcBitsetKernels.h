@@ -0,0 +1,141 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CanalGen/CanalTopologyTileTypes.h"
+
+// Inner loops of the bitset solver. Each kernel is compiled for a fixed mask width (FixedWords > 0), so loops over
+// domain words have a constant trip count the compiler can unroll and keep in registers; FixedWords == 0 is the
+// dynamic-width fallback that reads the word count from the compatibility table.
+template <int32 FixedWords>
+struct THexWfcBitsetKernels
+{
+	static int32 GetNumWords(const FCanalTileCompatibilityTable& Compatibility)
+	{
+		return FixedWords > 0 ? FixedWords : Compatibility.GetVariantMaskWordCount();
+	}
+
+	// Keeps the TargetBits variants that can sit on the DirIndex side of some SourceBits variant. Writes them to
+	// OutKeptBits (may not alias the inputs) and returns how many there are.
+	static int32 Revise(
+		const FCanalTileCompatibilityTable& Compatibility,
+		const uint64* SourceBits,
+		const uint64* TargetBits,
+		const int32 DirIndex,
+		uint64* OutKeptBits)
+	{
+		const int32 NumWords = GetNumWords(Compatibility);
+		const int32 BackDirIndex = (DirIndex + 3) % 6;
+
+		// Fixed widths accumulate in a local array the compiler can keep in registers; writes through OutKeptBits would
+		// have to be stored on every socket since it might alias the masks.
+		uint64 LocalKeptBits[FixedWords > 0 ? FixedWords : 1];
+		uint64* KeptBits = FixedWords > 0 ? LocalKeptBits : OutKeptBits;
+		for (int32 WordIndex = 0; WordIndex < NumWords; ++WordIndex)
+		{
+			KeptBits[WordIndex] = 0;
+		}
+
+		// A socket type the source can still show on this side admits every target variant showing it back. A side's
+		// socket masks are stored back to back, NumWords apart.
+		const uint64* SideMasks = Compatibility.GetSocketVariantMask(DirIndex, 0);
+		const uint64* BackMasks = Compatibility.GetSocketVariantMask(BackDirIndex, 0);
+		for (int32 Socket = 0; Socket < FCanalTileCompatibilityTable::NumSocketTypes; ++Socket)
+		{
+			const uint64* SideMask = SideMasks + Socket * NumWords;
+			uint64 Present = 0;
+			for (int32 WordIndex = 0; WordIndex < NumWords; ++WordIndex)
+			{
+				Present |= SourceBits[WordIndex] & SideMask[WordIndex];
+			}
+
+			const uint64 Select = uint64(0) - static_cast<uint64>(Present != 0);
+			const uint64* BackMask = BackMasks + Socket * NumWords;
+			for (int32 WordIndex = 0; WordIndex < NumWords; ++WordIndex)
+			{
+				KeptBits[WordIndex] |= BackMask[WordIndex] & Select;
+			}
+		}
+
+		int32 KeptCount = 0;
+		for (int32 WordIndex = 0; WordIndex < NumWords; ++WordIndex)
+		{
+			OutKeptBits[WordIndex] = KeptBits[WordIndex] & TargetBits[WordIndex];
+			KeptCount += FMath::CountBits(OutKeptBits[WordIndex]);
+		}
+		return KeptCount;
+	}
+
+	// Weighted pick over a domain in variant order at PickFraction ([0, 1)) of the total weight. FullPickWeight stands
+	// in for the sum when the domain is full. Returns the lowest variant when the domain carries no weight.
+	static int32 Choose(
+		const FCanalTileCompatibilityTable& Compatibility,
+		const uint64* DomainBits,
+		const int32 DomainCount,
+		const float* VariantPickWeights,
+		const float FullPickWeight,
+		const float PickFraction)
+	{
+		// The walk costs one step per set bit whatever the width, and unrolling it over a fixed word count only grows
+		// the code, so it keeps the table's word count.
+		const int32 NumWords = Compatibility.GetVariantMaskWordCount();
+		int32 FirstIndex = INDEX_NONE;
+		float TotalWeight = 0.0f;
+		for (int32 WordIndex = 0; WordIndex < NumWords; ++WordIndex)
+		{
+			uint64 Word = DomainBits[WordIndex];
+			if (Word != 0 && FirstIndex == INDEX_NONE)
+			{
+				FirstIndex = WordIndex * 64 + static_cast<int32>(FMath::CountTrailingZeros64(Word));
+				if (DomainCount == Compatibility.GetNumVariants())
+				{
+					TotalWeight = FullPickWeight;
+					break;
+				}
+			}
+
+			while (Word != 0)
+			{
+				const int32 VariantIndex = WordIndex * 64 + static_cast<int32>(FMath::CountTrailingZeros64(Word));
+				Word &= Word - 1;
+				TotalWeight += VariantPickWeights[VariantIndex];
+			}
+		}
+
+		if (TotalWeight <= KINDA_SMALL_NUMBER)
+		{
+			return FirstIndex;
+		}
+
+		const float Pick = PickFraction * TotalWeight;
+		float Cumulative = 0.0f;
+		int32 LastIndex = FirstIndex;
+		for (int32 WordIndex = 0; WordIndex < NumWords; ++WordIndex)
+		{
+			uint64 Word = DomainBits[WordIndex];
+			while (Word != 0)
+			{
+				LastIndex = WordIndex * 64 + static_cast<int32>(FMath::CountTrailingZeros64(Word));
+				Word &= Word - 1;
+				Cumulative += VariantPickWeights[LastIndex];
+				if (Pick <= Cumulative)
+				{
+					return LastIndex;
+				}
+			}
+		}
+
+		return LastIndex;
+	}
+};
+
+// Mask width the solver specializes its attempt loop for. The solver switches on it once per attempt, so the
+// fixed-width kernels above inline into its propagate and select loops instead of being called through a pointer.
+struct FHexWfcBitsetKernels
+{
+	// 1, 2 or 4 for tables with that many mask words (up to 64, 128 and 256 variants); 0, the dynamic-width fallback,
+	// otherwise or when bAllowSpecialized is false.
+	static int32 SelectFixedWords(const int32 NumWords, const bool bAllowSpecialized = true)
+	{
+		return bAllowSpecialized && (NumWords == 1 || NumWords == 2 || NumWords == 4) ? NumWords : 0;
+	}
+};
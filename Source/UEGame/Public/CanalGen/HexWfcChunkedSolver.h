@@ -0,0 +1,110 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CanalGen/HexWfcSolver.h"
+#include "HexWfcChunkedSolver.generated.h"
+
+USTRUCT(BlueprintType)
+struct UEGAME_API FHexWfcChunkConfig
+{
+	GENERATED_BODY()
+
+	// Chunk size in cells. Chunks tile axial space as ChunkWidth x ChunkHeight parallelograms.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC|Chunks", meta = (ClampMin = "2"))
+	int32 ChunkWidth = 16;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC|Chunks", meta = (ClampMin = "2"))
+	int32 ChunkHeight = 16;
+
+	// Chunks whose offset from the focus chunk is within this hex distance are kept generated.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC|Chunks", meta = (ClampMin = "0"))
+	int32 ViewRadiusChunks = 2;
+
+	// Resident chunk budget. Least recently used chunks outside the view radius are evicted above it.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC|Chunks", meta = (ClampMin = "1"))
+	int32 MaxResidentChunks = 64;
+
+	bool EnsureValid(FString& OutError) const;
+};
+
+// A solved chunk. Result cells use world axial coordinates.
+struct UEGAME_API FHexWfcChunk
+{
+	FIntPoint ChunkCoord = FIntPoint::ZeroValue;
+	FHexWfcSolveResult Result;
+	uint64 LastUsed = 0;
+};
+
+// Generates an unbounded grid in fixed-size chunks on demand. Each chunk is solved together with a one-cell ring
+// around it; ring cells that belong to already generated neighbours are pinned to their solved sockets through
+// BoundarySocketConstraints, so adjacent chunks always join up and the seam never asks for an unbuildable cell.
+// The ring is discarded after solving. Evicted chunks keep only their border cells and the constraints they were
+// solved with; regenerating one reproduces it exactly.
+//
+// Chunk contents depend on which neighbours existed when a chunk was first generated, i.e. on the focus path.
+// Global validation (entry/exit path, single water component, boundary water) does not apply per chunk and is
+// disabled in the chunk solve config. Pinned cells use world axial coordinates and go to the chunk containing them.
+class UEGAME_API FHexWfcChunkedSolver
+{
+public:
+	FHexWfcChunkedSolver(
+		const FCanalTileCompatibilityTable& InCompatibility,
+		const FHexWfcChunkConfig& InChunkConfig,
+		const FHexWfcSolveConfig& InSolveConfig);
+
+	FIntPoint GetChunkForCell(const FHexAxialCoord& Coord) const;
+	FHexAxialCoord GetChunkOrigin(const FIntPoint& ChunkCoord) const;
+
+	// Generates missing chunks around Focus (nearest first), then evicts down to MaxResidentChunks.
+	// Returns true if the resident set changed.
+	bool UpdateFocus(const FHexAxialCoord& Focus, TArray<FIntPoint>* OutGenerated = nullptr, TArray<FIntPoint>* OutEvicted = nullptr);
+
+	// Solves a chunk against its neighbours' seams. Returns the resident chunk, or nullptr if the chunk failed to solve
+	// (failures are remembered and not retried).
+	const FHexWfcChunk* GenerateChunk(const FIntPoint& ChunkCoord);
+
+	const FHexWfcChunk* FindChunk(const FIntPoint& ChunkCoord) const;
+	void GetResidentChunks(TArray<const FHexWfcChunk*>& OutChunks) const;
+
+	int32 GetNumResidentChunks() const
+	{
+		return ResidentChunks.Num();
+	}
+
+	int32 GetNumFailedChunks() const
+	{
+		return NumFailedChunks;
+	}
+
+	void Reset();
+
+private:
+	// Kept for every chunk ever generated, resident or not.
+	struct FChunkRecord
+	{
+		// Constraints the ringed chunk grid was solved with.
+		TArray<FHexWfcBoundarySocketConstraint> Constraints;
+
+		// The chunk's own outermost cells in world coordinates; neighbours pin their ring to these.
+		TArray<FHexWfcCellResult> BorderCells;
+
+		bool bFailed = false;
+	};
+
+	int32 GetChunkSeed(const FIntPoint& ChunkCoord) const;
+	void GatherNeighborConstraints(const FIntPoint& ChunkCoord, TArray<FHexWfcBoundarySocketConstraint>& OutConstraints) const;
+	bool IsBorderCell(const FHexAxialCoord& Coord, const FIntPoint& ChunkCoord) const;
+
+	const FCanalTileCompatibilityTable& Compatibility;
+	FHexWfcSolver Solver;
+
+	// Every chunk solves the same ringed grid, so one workspace serves them all.
+	FHexWfcSolverWorkspace Workspace;
+	FHexWfcChunkConfig ChunkConfig;
+	FHexWfcSolveConfig SolveConfig;
+
+	TMap<FIntPoint, FHexWfcChunk> ResidentChunks;
+	TMap<FIntPoint, FChunkRecord> Records;
+	uint64 UseCounter = 0;
+	int32 NumFailedChunks = 0;
+};
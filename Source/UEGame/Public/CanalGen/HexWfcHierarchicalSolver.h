@@ -0,0 +1,146 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CanalGen/HexWfcSolver.h"
+#include "HexWfcHierarchicalSolver.generated.h"
+
+USTRUCT(BlueprintType)
+struct UEGAME_API FHexWfcHierarchicalConfig
+{
+	GENERATED_BODY()
+
+	// Macro grid size. The macro solve places corridors, junctions and crossings with the same tile set.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC|Hierarchy", meta = (ClampMin = "1"))
+	int32 MacroWidth = 6;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC|Hierarchy", meta = (ClampMin = "1"))
+	int32 MacroHeight = 4;
+
+	// Fine cells per macro cell. Patches tile axial space as PatchWidth x PatchHeight parallelograms, like chunks.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC|Hierarchy", meta = (ClampMin = "4"))
+	int32 PatchWidth = 10;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC|Hierarchy", meta = (ClampMin = "4"))
+	int32 PatchHeight = 10;
+
+	// Solve patches across worker threads. Results are the same either way.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC|Hierarchy")
+	bool bSolvePatchesInParallel = true;
+
+	bool EnsureValid(FString& OutError) const;
+};
+
+// Outcome of one macro cell's fine patch.
+struct UEGAME_API FHexWfcPatchResult
+{
+	FIntPoint MacroCoord = FIntPoint::ZeroValue;
+	int32 Seed = 0;
+
+	// Patch sides the macro tile carries water across.
+	int32 NumWaterSeams = 0;
+
+	// Patch sides a macro lock or road line crosses.
+	int32 NumLineSeams = 0;
+
+	bool bSolved = false;
+	int32 AttemptsUsed = 0;
+	int32 Backtracks = 0;
+	FString Message;
+};
+
+struct UEGAME_API FHexWfcHierarchicalResult
+{
+	bool bSolved = false;
+	FString Message;
+
+	FHexWfcSolveResult MacroResult;
+
+	// MacroWidth * PatchWidth by MacroHeight * PatchHeight.
+	FHexWfcGridConfig FineGrid;
+
+	// Fine grid cells in row-major order. Filled when every patch solved.
+	TArray<FHexWfcCellResult> Cells;
+
+	// One per macro cell in row-major order. Empty if the macro solve failed.
+	TArray<FHexWfcPatchResult> Patches;
+	int32 NumFailedPatches = 0;
+
+	// The macro solve's resolved ports, moved to the fine cells that carry their water out of the grid.
+	bool bHasResolvedPorts = false;
+	FHexBoundaryPort ResolvedEntryPort;
+	FHexBoundaryPort ResolvedExitPort;
+
+	// Water analysis of the stitched fine grid, which is validated against the caller's water rules.
+	FHexWfcWaterAnalysis Water;
+
+	float SolveTimeSeconds = 0.0f;
+};
+
+// Two-level generator for grids too large to solve flat. A macro grid is solved first with the caller's config, so its
+// ports, carving and water validation shape the whole network at macro scale. Every macro side that carries water
+// becomes one Water socket at a seeded spot in the middle of the matching fine seam; every other fine seam side is
+// Bank. Each macro cell is then solved as an independent fine patch with those seam sockets as
+// BoundarySocketConstraints, so patches agree on every seam without seeing each other and can run in parallel.
+//
+// A patch with two water seams carves a path between them (bCarveEntryExitPath); one with three or more requires a
+// single water component so its seams meet. With bRequireSingleWaterComponent every patch with a seam requires one
+// water component and patches without one only get dry tiles, so no pond can split the fine network.
+//
+// Lock and Road sockets only match themselves, so on either grid they form straight lines from edge to edge. A macro
+// line becomes a straight run of fine cells pinned to the macro tile, on a fine row shared along the line for
+// East/West, a shared column for NorthWest/SouthEast, or the patch diagonal for NorthEast/SouthWest, which needs square
+// patches. Every seam side of those cells takes the tile's socket, so a road's crossing water reaches the next patch
+// too, and macro water seams keep off them. Patches a line crosses connect their water seams through connectivity
+// propagation instead of a carved path, which could run along the line. The stitched fine grid is validated against
+// the caller's port and water rules. PinnedCells use fine coordinates and go to the patch containing them;
+// BoundarySocketConstraints are not supported.
+class UEGAME_API FHexWfcHierarchicalSolver
+{
+public:
+	explicit FHexWfcHierarchicalSolver(const FCanalTileCompatibilityTable& InCompatibility);
+
+	FHexWfcHierarchicalResult Solve(const FHexWfcHierarchicalConfig& HierarchyConfig, const FHexWfcSolveConfig& Config) const;
+
+private:
+	// Seam cells are kept per macro cell and side (MacroIndex * 6 + DirIndex): the fine cell whose side DirIndex carries
+	// the seam's water, lock or road, or INDEX_NONE.
+	//
+	// Marks the fine cells every macro lock or road line runs through with the macro cell they copy, records the line
+	// ends as seam cells, and writes the macro tile's sockets onto both ends of each seam edge the line cells touch.
+	void PlaceLines(
+		const FHexWfcHierarchicalConfig& HierarchyConfig,
+		const FHexWfcSolveConfig& Config,
+		const FHexWfcSolveResult& MacroResult,
+		const FHexWfcGridConfig& FineGrid,
+		TArray<int32>& OutFineLineMacroCells,
+		TArray<int32>& InOutSeamPortCells,
+		TArray<ECanalSocketType>& InOutFineSeamSockets) const;
+
+	// Picks the seam cell for every macro water side, away from the line cells, and writes Water onto both ends of its
+	// fine edge.
+	void PlaceSeamPorts(
+		const FHexWfcHierarchicalConfig& HierarchyConfig,
+		const FHexWfcSolveConfig& Config,
+		const FHexWfcSolveResult& MacroResult,
+		const FHexWfcGridConfig& FineGrid,
+		const TArray<int32>& FineLineMacroCells,
+		TArray<int32>& InOutSeamPortCells,
+		TArray<ECanalSocketType>& InOutFineSeamSockets) const;
+
+	void BuildPatchConfig(
+		const FHexWfcHierarchicalConfig& HierarchyConfig,
+		const FHexWfcSolveConfig& Config,
+		const FHexWfcSolveResult& MacroResult,
+		const FIntPoint& MacroCoord,
+		const FHexWfcGridConfig& FineGrid,
+		const TArray<ECanalSocketType>& FineSeamSockets,
+		const TArray<int32>& FineLineMacroCells,
+		FHexWfcSolveConfig& OutPatchConfig,
+		FHexWfcPatchResult& OutPatch) const;
+
+	const FCanalTileCompatibilityTable& Compatibility;
+	FHexWfcSolver Solver;
+
+	// Tiles without water or lock sockets, for patches the macro grid leaves dry.
+	TArray<FName> DryTileIds;
+};
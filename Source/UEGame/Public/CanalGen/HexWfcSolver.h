@@ -2,7 +2,10 @@
 
 #include "CoreMinimal.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
+#include "CanalGen/CanalCounterRandom.h"
 #include "CanalGen/CanalTopologyTileSetAsset.h"
+#include "CanalGen/HexWfcBitsetKernels.h"
+#include <atomic>
 #include "HexWfcSolver.generated.h"
 
 USTRUCT(BlueprintType)
@@ -18,6 +21,9 @@ struct UEGAME_API FHexWfcGridConfig
 
 	bool EnsureValid(FString& OutError) const;
 	bool Contains(const FHexAxialCoord& Coord) const;
+
+	// Grid cells within Radius steps of Center, in row-major order.
+	void GetCellsInRadius(const FHexAxialCoord& Center, int32 Radius, TArray<FHexAxialCoord>& OutCoords) const;
 };
 
 USTRUCT(BlueprintType)
@@ -47,6 +53,68 @@ struct UEGAME_API FHexTileWeightMultiplier
 	float Multiplier = 1.0f;
 };
 
+// Requires the side of Coord facing Direction to carry Socket, e.g. to stitch a grid onto an already solved neighbour.
+USTRUCT(BlueprintType)
+struct UEGAME_API FHexWfcBoundarySocketConstraint
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC")
+	FHexAxialCoord Coord;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC")
+	EHexDirection Direction = EHexDirection::East;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC")
+	ECanalSocketType Socket = ECanalSocketType::Bank;
+};
+
+// Restricts a cell to the listed tiles before the first collapse, e.g. to put a lock where a scenario needs one.
+USTRUCT(BlueprintType)
+struct UEGAME_API FHexWfcPinnedCell
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC")
+	FHexAxialCoord Coord;
+
+	// Tiles the cell may hold. Must not be empty.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC")
+	TArray<FName> AllowedTileIds;
+
+	// Rotation steps (0-5) the tiles may take; empty allows every rotation.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC")
+	TArray<int32> AllowedRotations;
+};
+
+UENUM(BlueprintType)
+enum class EHexWfcDomainMode : uint8
+{
+	// Per-cell candidate arrays filtered through FCanalTileCompatibilityTable::GetCompatibleVariants.
+	CandidateList = 0,
+	// One fixed-width variant bit mask per cell, filtered with precomputed per-direction compatibility masks.
+	Bitset = 1
+};
+
+UENUM(BlueprintType)
+enum class EHexWfcPropagator : uint8
+{
+	// Re-filters a neighbour against the union of everything the changed cell still allows (AC-3 style).
+	Filter = 0,
+	// Keeps per (cell, direction, variant) counts of supporting neighbour variants and bans a variant
+	// when its count reaches zero (AC-4 style). Always uses bitset domains.
+	SupportCount = 1
+};
+
+UENUM(BlueprintType)
+enum class EHexWfcEntropyMode : uint8
+{
+	// Fewest remaining candidates first. Matches the original solver, so existing seeds reproduce.
+	CandidateCount = 0,
+	// Lowest Shannon entropy of the remaining candidates' effective weights (tile weight x biome multiplier).
+	WeightedShannon = 1
+};
+
 USTRUCT(BlueprintType)
 struct UEGAME_API FHexWfcSolveConfig
 {
@@ -61,6 +129,55 @@ struct UEGAME_API FHexWfcSolveConfig
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC", meta = (ClampMin = "1"))
 	int32 MaxPropagationSteps = 100000;
 
+	// Domain representation used while solving. Both modes produce identical results for the same seed.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC")
+	EHexWfcDomainMode DomainMode = EHexWfcDomainMode::Bitset;
+
+	// Constraint propagation engine. SupportCount scales to much larger grids. Both reach the same domains after
+	// every collapse for tile sets where each variant has a compatible neighbour on all six sides, so seeds reproduce;
+	// PropagationSteps counts neighbour revisions for Filter and withdrawn variant supports for SupportCount.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC")
+	EHexWfcPropagator Propagator = EHexWfcPropagator::Filter;
+
+	// Cell selection heuristic. Ties always go to the lowest R, then Q.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC")
+	EHexWfcEntropyMode EntropyMode = EHexWfcEntropyMode::CandidateCount;
+
+	// On a propagation contradiction, undo the last collapse from the removal trail and ban its pick instead of
+	// restarting the attempt. Always uses bitset domains.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC")
+	bool bEnableBacktracking = false;
+
+	// Backtracks allowed per attempt before it is abandoned and the next attempt's seed is tried.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC", meta = (ClampMin = "0", EditCondition = "bEnableBacktracking"))
+	int32 MaxBacktracks = 1000;
+
+	// Attempts run concurrently on the task graph; the lowest-numbered success wins and later attempts are
+	// cancelled, so the result always matches running the attempts one after another.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC", meta = (ClampMin = "1"))
+	int32 SpeculativeAttempts = 1;
+
+	// Socket constraints applied to every attempt before the first collapse. Coordinates must lie inside the grid.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC")
+	TArray<FHexWfcBoundarySocketConstraint> BoundarySocketConstraints;
+
+	// Cells restricted to given tiles, applied and propagated together with the socket constraints above. Coordinates
+	// must lie inside the grid and tile IDs must be in the tile set.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC")
+	TArray<FHexWfcPinnedCell> PinnedCells;
+
+	// Before the first collapse of each attempt, carve a random water path from EntryPort to ExitPort and restrict
+	// its cells to variants with Water or Lock sockets along it; the solve fills in the rest. Ports that are not
+	// enabled are picked from Seed, the entry on the west edge and the exit on the east edge. Each attempt carves a
+	// different path.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC")
+	bool bCarveEntryExitPath = false;
+
+	// How far carved paths wander. Each cell costs 1 plus up to this much at random and paths take the cheapest
+	// route, so 0 gives a shortest path.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC", meta = (ClampMin = "0.0", EditCondition = "bCarveEntryExitPath"))
+	float CarvedPathMeander = 2.0f;
+
 	// Max wall clock solve time in seconds. <= 0 disables the time limit.
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC", meta = (ClampMin = "0.0"))
 	float MaxSolveTimeSeconds = 0.0f;
@@ -71,6 +188,14 @@ struct UEGAME_API FHexWfcSolveConfig
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC")
 	bool bRequireSingleWaterComponent = false;
 
+	// Enforce the two requirements above while solving instead of only validating the finished grid. Explicit ports
+	// are pruned to water-facing variants up front, and a collapse after which the ports (or two cells that must hold
+	// water) can no longer be joined through the remaining domains counts as a contradiction, so backtracking undoes it
+	// and restarts happen early. Auto-selected ports are only known once solved and stay validation-only.
+	// Always uses bitset domains.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC")
+	bool bPropagateConnectivity = false;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC")
 	FHexBoundaryPort EntryPort;
 
@@ -106,6 +231,96 @@ struct UEGAME_API FHexWfcCellResult
 	FCanalTileVariantRef Variant;
 };
 
+// Water graph summary of a solved grid, computed once while validating it. Two cells are joined when they face each
+// other with the same water or lock socket.
+USTRUCT(BlueprintType)
+struct UEGAME_API FHexWfcWaterAnalysis
+{
+	GENERATED_BODY()
+
+	// Cells with at least one water or lock socket.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	int32 NumWaterCells = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	int32 NumWaterComponents = 0;
+
+	// The resolved entry and exit ports are joined by water.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	bool bEntryExitConnected = false;
+
+	// Shortest water path from the resolved entry to the exit when they are connected, otherwise the longest
+	// shortest path of the largest component found by two breadth-first sweeps. Empty below two water cells.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	TArray<FHexAxialCoord> WaterPath;
+};
+
+// Where a solve spent its time and memory. Phases are exclusive: propagation run while restricting cells or
+// backtracking counts as propagation only. Phase times are summed over every attempt that ran, so with
+// SpeculativeAttempts > 1 they measure CPU time and can exceed SolveTimeSeconds.
+USTRUCT(BlueprintType)
+struct UEGAME_API FHexWfcSolveProfile
+{
+	GENERATED_BODY()
+
+	// Input validation and the constraint, weight and region tables shared by all attempts.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	float PrepareSeconds = 0.0f;
+
+	// Domain resets, support seeding and applying socket constraints and pins.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	float InitializeSeconds = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	float CarveSeconds = 0.0f;
+
+	// Picking the lowest-entropy cell, plus the budget and cancel checks made once per collapse.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	float SelectSeconds = 0.0f;
+
+	// Drawing the collapsed cell's variant.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	float SampleSeconds = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	float PropagateSeconds = 0.0f;
+
+	// Water reachability checks for bPropagateConnectivity.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	float ConnectivitySeconds = 0.0f;
+
+	// Undoing decisions and restoring domains, excluding the propagation that follows.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	float BacktrackSeconds = 0.0f;
+
+	// Whole-grid validation of a finished attempt and its water path.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	float ValidateSeconds = 0.0f;
+
+	// Propagation steps of every attempt that ran, where FHexWfcSolveResult::PropagationSteps counts the returned
+	// attempt only. Divide PropagateSeconds by this for the cost of one step.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	int64 PropagationSteps = 0;
+
+	// Largest memory any attempt's cell domains, support counts and undo trail reached.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	int64 PeakDomainBytes = 0;
+
+	// Most cells (Filter) or removed variants (SupportCount) waiting in the propagation queue at once.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	int32 PeakPropagationQueue = 0;
+
+	// Most domain removals held for undo at once. Always 0 unless bEnableBacktracking is set.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	int32 PeakUndoTrail = 0;
+
+	// Sums the phase times and step counts and keeps the larger peaks.
+	void Accumulate(const FHexWfcSolveProfile& Other);
+
+	// Multiplies every phase time by Factor, e.g. to turn totals into per-seed averages.
+	void ScalePhases(float Factor);
+};
+
 USTRUCT(BlueprintType)
 struct UEGAME_API FHexWfcSolveResult
 {
@@ -132,15 +347,31 @@ struct UEGAME_API FHexWfcSolveResult
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
 	int32 PropagationSteps = 0;
 
+	// Decisions undone across all attempts. Always 0 unless bEnableBacktracking is set.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	int32 Backtracks = 0;
+
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
 	bool bTimeBudgetExceeded = false;
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
 	bool bFailedSingleWaterComponent = false;
 
+	// Pinned cells, socket constraints or a region solve's kept cells contradicted before the first collapse. That does
+	// not depend on the seed, so the solve stops after one attempt instead of using up MaxAttempts.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	bool bConstraintsInfeasible = false;
+
+	// Stopped through FHexWfcSolveControl::Cancel before finishing.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	bool bCancelled = false;
+
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
 	float SolveTimeSeconds = 0.0f;
 
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	FHexWfcSolveProfile Profile;
+
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
 	FName BiomeProfile = NAME_None;
 
@@ -155,6 +386,10 @@ struct UEGAME_API FHexWfcSolveResult
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
 	FHexBoundaryPort ResolvedExitPort;
+
+	// Filled for solved results only.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	FHexWfcWaterAnalysis Water;
 };
 
 USTRUCT(BlueprintType)
@@ -171,6 +406,11 @@ struct UEGAME_API FHexWfcBatchConfig
 	// Max total wall clock time for the whole batch in seconds. <= 0 disables the time limit.
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC", meta = (ClampMin = "0.0"))
 	float MaxBatchTimeSeconds = 0.0f;
+
+	// Solve seeds concurrently across worker threads. Stats other than timings match the serial run; when
+	// MaxBatchTimeSeconds cuts the batch short, only the leading run of finished seeds is counted.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Canal|WFC")
+	bool bRunInParallel = false;
 };
 
 USTRUCT(BlueprintType)
@@ -185,6 +425,22 @@ struct UEGAME_API FHexWfcAttemptHistogramBin
 	int32 Count = 0;
 };
 
+// Seeds whose solve needed between MinBacktracks and MaxBacktracks (inclusive) backtracks.
+USTRUCT(BlueprintType)
+struct UEGAME_API FHexWfcBacktrackHistogramBin
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	int32 MinBacktracks = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	int32 MaxBacktracks = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	int32 Count = 0;
+};
+
 USTRUCT(BlueprintType)
 struct UEGAME_API FHexWfcTileHistogramBin
 {
@@ -226,15 +482,38 @@ struct UEGAME_API FHexWfcBatchStats
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
 	int32 NumSingleWaterComponentFailures = 0;
 
+	// Sums over the processed seeds. Merges add these up rather than the averages, so a merged or resumed batch
+	// reports exactly what one run over the same seeds would.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	int64 TotalAttemptsUsed = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	int64 TotalBacktracks = 0;
+
+	// Steps of every attempt that ran, as in FHexWfcSolveProfile::PropagationSteps.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	int64 TotalPropagationSteps = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	double TotalSolveTimeSeconds = 0.0;
+
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
 	float ContradictionRate = 0.0f;
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
 	float AverageAttemptsUsed = 0.0f;
 
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	float AverageBacktracks = 0.0f;
+
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
 	float AverageSolveTimeSeconds = 0.0f;
 
+	// Phase times and propagation steps averaged over the processed seeds, like AverageSolveTimeSeconds; peaks are the
+	// largest any seed reached.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	FHexWfcSolveProfile AverageProfile;
+
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
 	float ElapsedBatchTimeSeconds = 0.0f;
 
@@ -244,102 +523,581 @@ struct UEGAME_API FHexWfcBatchStats
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
 	TArray<FHexWfcAttemptHistogramBin> AttemptHistogram;
 
+	// Power-of-two buckets (0, 1, 2-3, 4-7, ...); empty buckets are omitted.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
+	TArray<FHexWfcBacktrackHistogramBin> BacktrackHistogram;
+
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Canal|WFC")
 	TArray<FHexWfcTileHistogramBin> TileHistogram;
+
+	// Derives ContradictionRate, the averages and AverageProfile.PropagationSteps from the counts and totals. Phase
+	// times in AverageProfile are left as they are.
+	void UpdateAverages();
+};
+
+// Lets another thread cancel a running solve and follow its progress. Share one instance per solve.
+class UEGAME_API FHexWfcSolveControl
+{
+public:
+	// The solve stops at its next check and returns unsolved with bCancelled set.
+	void Cancel()
+	{
+		bCancelRequested.store(true, std::memory_order_relaxed);
+	}
+
+	bool IsCancelRequested() const
+	{
+		return bCancelRequested.load(std::memory_order_relaxed);
+	}
+
+	// Fraction of cells collapsed in the lowest running attempt, in [0, 1]. Drops back when an attempt restarts.
+	float GetProgress() const
+	{
+		return Progress.load(std::memory_order_relaxed);
+	}
+
+	int32 GetAttempt() const
+	{
+		return Attempt.load(std::memory_order_relaxed);
+	}
+
+	void ReportProgress(const int32 InAttempt, const float InProgress)
+	{
+		Attempt.store(InAttempt, std::memory_order_relaxed);
+		Progress.store(InProgress, std::memory_order_relaxed);
+	}
+
+private:
+	std::atomic<bool> bCancelRequested{false};
+	std::atomic<int32> Attempt{0};
+	std::atomic<float> Progress{0.0f};
 };
 
+class FHexWfcSolverWorkspace;
+
 class UEGAME_API FHexWfcSolver
 {
 public:
 	explicit FHexWfcSolver(const FCanalTileCompatibilityTable& InCompatibility);
 
-	FHexWfcSolveResult Solve(const FHexWfcGridConfig& Grid, const FHexWfcSolveConfig& Config) const;
+	// Control, when given, may be used from another thread to cancel the solve or read its progress.
+	FHexWfcSolveResult Solve(const FHexWfcGridConfig& Grid, const FHexWfcSolveConfig& Config, FHexWfcSolveControl* Control = nullptr) const;
+
+	// Same as above, solving in Workspace's buffers instead of fresh ones. Results do not depend on what the workspace
+	// solved before.
+	FHexWfcSolveResult Solve(
+		const FHexWfcGridConfig& Grid,
+		const FHexWfcSolveConfig& Config,
+		FHexWfcSolverWorkspace& Workspace,
+		FHexWfcSolveControl* Control = nullptr) const;
+
+	// Re-solves only the cells in Region and keeps every other cell of Previous, which must be a solved result for
+	// Grid. Kept cells start collapsed and propagation starts at the region's edge, so the cost scales with the region
+	// rather than the grid. Seed, restarts, backtracking and whole-grid validation follow Config; the SupportCount
+	// propagator runs as Filter here. Control works as in Solve.
+	FHexWfcSolveResult SolveRegion(
+		const FHexWfcGridConfig& Grid,
+		const FHexWfcSolveConfig& Config,
+		const FHexWfcSolveResult& Previous,
+		const TArray<FHexAxialCoord>& Region,
+		FHexWfcSolveControl* Control = nullptr) const;
+
+	FHexWfcSolveResult SolveRegion(
+		const FHexWfcGridConfig& Grid,
+		const FHexWfcSolveConfig& Config,
+		const FHexWfcSolveResult& Previous,
+		const TArray<FHexAxialCoord>& Region,
+		FHexWfcSolverWorkspace& Workspace,
+		FHexWfcSolveControl* Control = nullptr) const;
+
+	// Runs a solve's whole-grid checks (ports, entry/exit path, boundary water, single water component) on cells
+	// solved elsewhere, e.g. stitched together from independent patches. Cells must cover Grid in row-major order.
+	// Fills the resolved ports and the water analysis, path included; returns false with OutError on the first failure.
+	bool ValidateCells(
+		const FHexWfcGridConfig& Grid,
+		const FHexWfcSolveConfig& Config,
+		const TArray<FHexWfcCellResult>& Cells,
+		FHexBoundaryPort& OutResolvedEntry,
+		FHexBoundaryPort& OutResolvedExit,
+		FHexWfcWaterAnalysis& OutWater,
+		FString& OutError) const;
 
 private:
+	friend class FHexWfcSolverWorkspace;
+
+	// Dense row-major cell layout (index = Q + R * Width) with a precomputed neighbour table.
+	struct FCellGrid
+	{
+		int32 Width = 0;
+		int32 Height = 0;
+
+		// Six entries per cell in EHexDirection order; INDEX_NONE where the neighbour is outside the grid.
+		TArray<int32> Neighbors;
+
+		void Build(const FHexWfcGridConfig& Grid);
+
+		int32 Num() const
+		{
+			return Width * Height;
+		}
+
+		bool Contains(const FHexAxialCoord& Coord) const
+		{
+			return Coord.Q >= 0 && Coord.Q < Width && Coord.R >= 0 && Coord.R < Height;
+		}
+
+		int32 ToIndex(const FHexAxialCoord& Coord) const
+		{
+			return Coord.Q + Coord.R * Width;
+		}
+
+		FHexAxialCoord ToCoord(const int32 CellIndex) const
+		{
+			return FHexAxialCoord(CellIndex % Width, CellIndex / Width);
+		}
+
+		int32 GetNeighbor(const int32 CellIndex, const int32 DirIndex) const
+		{
+			return Neighbors[CellIndex * 6 + DirIndex];
+		}
+
+		// Direction from CellIndex to an adjacent cell, or INDEX_NONE if they are not adjacent.
+		int32 FindDirection(const int32 CellIndex, const int32 NeighborIndex) const
+		{
+			for (int32 DirIndex = 0; DirIndex < 6; ++DirIndex)
+			{
+				if (GetNeighbor(CellIndex, DirIndex) == NeighborIndex)
+				{
+					return DirIndex;
+				}
+			}
+			return INDEX_NONE;
+		}
+	};
+
 	struct FCellState
 	{
 		TArray<FCanalTileVariantKey> Candidates;
 
-		bool IsCollapsed() const
+		// Only used in EHexWfcDomainMode::Bitset.
+		TArray<uint64, TInlineAllocator<2>> DomainBits;
+		int32 DomainCount = 0;
+
+		// Only maintained in EHexWfcEntropyMode::WeightedShannon: fixed-point sums of w and w*ln(w) over the
+		// remaining candidates. Integer sums keep equal domains at bit-identical entropy, so ties stay index-ordered.
+		int64 WeightSum = 0;
+		int64 WeightLogWeightSum = 0;
+
+		int32 NumCandidates() const
+		{
+			return DomainBits.Num() > 0 ? DomainCount : Candidates.Num();
+		}
+	};
+
+	// Indexed binary min-heap over uncollapsed cells, ordered by (entropy, cell index).
+	struct FEntropyHeap
+	{
+		// Inserts every cell with the same key; index order already satisfies the heap property.
+		void Build(int32 NumCells, double InitialKey);
+
+		// Inserts the cell or moves it to its new key. Backtracking re-inserts cells it un-collapses.
+		void Set(int32 CellIndex, double Key);
+		void Remove(int32 CellIndex);
+
+		bool IsEmpty() const
+		{
+			return Heap.Num() == 0;
+		}
+
+		int32 Num() const
+		{
+			return Heap.Num();
+		}
+
+		int32 Top() const
+		{
+			return Heap[0];
+		}
+
+		SIZE_T GetAllocatedSize() const
+		{
+			return Heap.GetAllocatedSize() + SlotByCell.GetAllocatedSize() + Keys.GetAllocatedSize();
+		}
+
+	private:
+		bool Less(int32 CellA, int32 CellB) const
+		{
+			return Keys[CellA] < Keys[CellB] || (Keys[CellA] == Keys[CellB] && CellA < CellB);
+		}
+
+		void Place(int32 Slot, int32 CellIndex);
+		void SiftUp(int32 Slot);
+		void SiftDown(int32 Slot);
+
+		TArray<int32> Heap;
+		TArray<int32> SlotByCell;
+		TArray<double> Keys;
+	};
+
+	static double ComputeCellEntropy(const FCellState& State, bool bWeightedEntropy);
+
+	// AC-4 bookkeeping for EHexWfcPropagator::SupportCount.
+	struct FSupportState
+	{
+		// Compatibility is socket equality, so every variant showing the same socket on a side has the same supports.
+		// Counts are kept per socket type: variants left in the neighbour on DirIndex that show Socket back,
+		// [(CellIndex * 6 + DirIndex) * NumSocketTypes + Socket].
+		TArray<uint16> Counts;
+
+		// Removed (cell, variant index) pairs; entries past the solver's pending head have not been withdrawn from
+		// neighbours yet. With backtracking the list is kept for the whole attempt and doubles as the undo trail.
+		TArray<TPair<int32, int32>> PendingRemovals;
+	};
+
+	// A collapse that backtracking can undo: removals at or after RemovalMark on the trail belong to it.
+	struct FBacktrackDecision
+	{
+		int32 CellIndex = INDEX_NONE;
+		int32 VariantIndex = INDEX_NONE;
+		int32 RemovalMark = 0;
+	};
+
+	// Exclusive phases of one attempt, in FHexWfcSolveProfile's order.
+	enum class EAttemptPhase : uint8
+	{
+		Initialize,
+		Carve,
+		Select,
+		Sample,
+		Propagate,
+		Connectivity,
+		Backtrack,
+		Validate,
+		Num
+	};
+
+	// Charges an attempt's time to one phase at a time. Enter charges the time since the last switch to the phase being
+	// left and returns it, so a nested phase can hand the clock back when it ends.
+	struct FPhaseClock
+	{
+		void Reset(EAttemptPhase Phase);
+
+		EAttemptPhase Enter(const EAttemptPhase Phase)
+		{
+			const uint64 Now = FPlatformTime::Cycles64();
+			Cycles[static_cast<int32>(Current)] += Now - Mark;
+			Mark = Now;
+			const EAttemptPhase Previous = Current;
+			Current = Phase;
+			return Previous;
+		}
+
+		uint64 Cycles[static_cast<int32>(EAttemptPhase::Num)] = {};
+		EAttemptPhase Current = EAttemptPhase::Initialize;
+		uint64 Mark = 0;
+	};
+
+	struct FScopedPhase
+	{
+		FScopedPhase(FPhaseClock& InClock, const EAttemptPhase Phase)
+			: Clock(InClock)
+			, Previous(InClock.Enter(Phase))
+		{
+		}
+
+		~FScopedPhase()
+		{
+			Clock.Enter(Previous);
+		}
+
+		FPhaseClock& Clock;
+		const EAttemptPhase Previous;
+	};
+
+	// Read-only inputs shared by every attempt of one Solve call. Lives in a solver workspace and is reset, not
+	// rebuilt, for each solve.
+	struct FSolveContext
+	{
+		// Clears the per-solve state for InConfig and empties every table, keeping their allocations.
+		void Reset(const FHexWfcSolveConfig& InConfig);
+
+		const FHexWfcSolveConfig* Config = nullptr;
+		FCellGrid Cells;
+		bool bSupportCount = false;
+		bool bBacktracking = false;
+		bool bBitsetDomains = false;
+		bool bWeightedEntropy = false;
+		TArray<float> TileWeightScales;
+
+		// Mask width SolveAttempt is specialized for (see FHexWfcBitsetKernels). The kernels' Choose makes the same
+		// draws and pick as ChooseVariant on the gathered candidates, without copying or sorting them.
+		int32 KernelWords = 0;
+
+		// Effective pick weight per variant (tile weight * biome scale) and their sum over the full domain, accumulated
+		// in variant order so sampling reproduces the per-candidate float sums exactly.
+		TArray<float> VariantPickWeights;
+		float FullPickWeight = 0.0f;
+
+		TArray<int64> VariantWeights;
+		TArray<int64> VariantWeightLogWeights;
+		int64 FullWeightSum = 0;
+		int64 FullWeightLogWeightSum = 0;
+
+		// Cells named by BoundarySocketConstraints or PinnedCells and the variants each one still allows (mask words
+		// per cell).
+		TArray<int32> ConstrainedCells;
+		TArray<uint64> ConstrainedMasks;
+
+		// Region solves only: the variant index each kept cell is fixed to (INDEX_NONE for cells being re-solved), and
+		// the kept cells that border the region.
+		TArray<int32> FixedVariants;
+		TArray<int32> FrontierCells;
+
+		// Connectivity propagation only. WaterSideMasks holds, per direction, the variants exposing a Water and a Lock
+		// socket on that side ((DirIndex * 2 + Slot) * mask words); WaterCellMask the variants with any water-like socket.
+		// The entry cell roots the search when a port is given; the exit cell is only set when a path is required.
+		bool bConnectivity = false;
+		bool bConnectSingleComponent = false;
+		TArray<uint64> WaterSideMasks;
+		TArray<uint64> WaterCellMask;
+		int32 ConnectivityRootCell = INDEX_NONE;
+		int32 ConnectivityExitCell = INDEX_NONE;
+
+		// Path carving only: the port cells and their outward sides, and per direction the variants showing a Water or
+		// Lock socket on that side (mask words per direction).
+		bool bCarvePath = false;
+		int32 CarveEntryCell = INDEX_NONE;
+		int32 CarveEntryDirIndex = INDEX_NONE;
+		int32 CarveExitCell = INDEX_NONE;
+		int32 CarveExitDirIndex = INDEX_NONE;
+		TArray<uint64> CarveSideMasks;
+
+		double SolveStartTime = 0.0;
+		float PrepareSeconds = 0.0f;
+
+		// Optional caller control; only the attempt numbered ProgressAttempt (the lowest in its wave) reports progress.
+		FHexWfcSolveControl* Control = nullptr;
+		int32 ProgressAttempt = 1;
+
+		// Lowest attempt that has solved so far; attempts above it stop at their next check.
+		mutable std::atomic<int32> FirstSolvedAttempt{MAX_int32};
+
+		// PrepareContext scratch.
+		TMap<int32, int32> ConstraintSlotByCell;
+		TMap<FName, float> MultiplierByTileId;
+	};
+
+	// Flat water graph of one solved grid. Links holds a bit per side joined to the neighbour by matching water-like
+	// sockets; Components is a union-find forest over those links.
+	struct FWaterGraph
+	{
+		// Six sockets per cell, looked up once per solved grid.
+		TArray<ECanalSocketType> Sockets;
+		TArray<bool> WaterCells;
+		TArray<uint8> Links;
+		TArray<int32> Components;
+		TArray<int32> Parents;
+		TArray<int32> Queue;
+
+		int32 FindComponent(int32 CellIndex);
+
+		bool AreConnected(const int32 A, const int32 B)
 		{
-			return Candidates.Num() == 1;
+			return FindComponent(A) == FindComponent(B);
 		}
 	};
 
-	bool SelectLowestEntropyCell(
-		const TMap<FHexAxialCoord, FCellState>& States,
-		FHexAxialCoord& OutCoord,
-		int32& OutEntropy) const;
+	// Per-attempt scratch state. Each concurrently running attempt owns one; buffers are reused across waves and, through
+	// FHexWfcSolverWorkspace, across solves.
+	struct FAttemptWorkspace
+	{
+		TArray<FCellState> States;
+		TArray<int32> Queue;
+		FSupportState Support;
+		FEntropyHeap EntropyHeap;
+		TArray<TPair<int32, int32>> Trail;
+		TArray<FBacktrackDecision> Decisions;
+		TArray<uint64, TInlineAllocator<4>> AllowedBits;
+		TArray<FCanalTileVariantKey> PickCandidates;
+		TArray<FCanalTileVariantKey> Solved;
+		FWaterGraph WaterGraph;
+
+		// Connectivity propagation: per cell, the water-like sockets its domain can still expose ((DirIndex * 2 + Slot)
+		// bits), and the cells reached by the last search. Valid until a backtrack restores domains.
+		TArray<uint16> WaterSides;
+		TArray<bool> WaterReached;
+		TArray<int32> ConnectivityQueue;
+		TArray<int32> ConnectivityChanged;
+		bool bWaterReachedValid = false;
+
+		// Path carving: random cell costs, a cheapest-path search over them, the carved cells from entry to exit, and
+		// the socket mask for the cell being pinned.
+		TArray<float> PathCosts;
+		TArray<double> PathDistances;
+		TArray<int32> PathParents;
+		FEntropyHeap PathHeap;
+		TArray<int32> CarvedPath;
+		TArray<uint64, TInlineAllocator<4>> CarvedPathMask;
+
+		// Profile of the attempt last run in this workspace.
+		FPhaseClock PhaseClock;
+		int32 PeakPropagationQueue = 0;
+		int32 PeakUndoTrail = 0;
+	};
+
+	// Validates the inputs and fills the grid, constraint and weight tables shared by all attempts.
+	bool PrepareContext(const FHexWfcGridConfig& Grid, FSolveContext& Context, FString& OutError) const;
+	FHexWfcSolveResult RunAttempts(FHexWfcSolverWorkspace& Workspace) const;
+	FHexWfcSolveResult SolveAttempt(const FSolveContext& Context, FAttemptWorkspace& Workspace, int32 Attempt) const;
+
+	// SolveAttempt for a fixed mask width; FixedWords == 0 reads the width from the table.
+	template <int32 FixedWords>
+	FHexWfcSolveResult SolveAttemptImpl(const FSolveContext& Context, FAttemptWorkspace& Workspace, int32 Attempt) const;
+
+	// Adds the phase times and peaks of the attempt last run in Workspace to InOutProfile.
+	static void AccumulateAttemptProfile(const FSolveContext& Context, const FAttemptWorkspace& Workspace, FHexWfcSolveProfile& InOutProfile);
+
+	// Searches the water edges the current domains still allow. Returns false with OutCell set if the exit cell, or a
+	// cell that can only hold water, is cut off from the root, i.e. no completion of this state can pass validation.
+	// With ChangedCells, domains may only have shrunk since the last call, and the search is skipped unless one of
+	// those cells lost an edge inside the reached set.
+	bool IsWaterConnectivityPossible(
+		const FSolveContext& Context,
+		const TArray<FCellState>& States,
+		FAttemptWorkspace& Workspace,
+		const TArray<int32>* ChangedCells,
+		int32& OutCell) const;
+
+	// Fills Workspace.CarvedPath with a cheapest entry-to-exit path over random cell costs drawn from Random.
+	void CarveWaterPath(const FSolveContext& Context, FAttemptWorkspace& Workspace, const FCanalCounterRandom& Random) const;
+
+	// Resets support counts for a fresh attempt and queues variants that have no support on an interior side.
+	// Returns false with OutContradictionCell set if that empties a domain.
+	bool InitializeSupports(
+		const FCellGrid& Cells,
+		TArray<FCellState>& States,
+		FSupportState& Support,
+		int32& OutContradictionCell) const;
+
+	// Withdraws the supports a removed variant provided to its neighbours, banning variants that lose their last one.
+	bool WithdrawSupports(
+		const FCellGrid& Cells,
+		TArray<FCellState>& States,
+		FSupportState& Support,
+		const TPair<int32, int32>& Removal,
+		int32& OutContradictionCell) const;
+
+	// Inverse of WithdrawSupports for a removal that is being undone.
+	void RestoreSupports(const FCellGrid& Cells, FSupportState& Support, const TPair<int32, int32>& Removal) const;
+
+	static void RemoveBitsetVariant(FCellState& State, int32 VariantIndex);
 
 	FCanalTileVariantKey ChooseVariant(
 		const TArray<FCanalTileVariantKey>& Candidates,
-		FRandomStream& Random,
+		float PickFraction,
 		const TArray<float>& TileWeightScales) const;
 
+	void GatherBitsetCandidates(const FCellState& State, TArray<FCanalTileVariantKey>& OutCandidates) const;
+
 	bool IsVariantAllowedByAnySource(
 		const FCanalTileVariantKey& Candidate,
 		const TArray<FCanalTileVariantKey>& SourceCandidates,
 		EHexDirection SourceToTargetDirection) const;
 
+	// The validators below take one resolved variant per cell, indexed like FCellGrid.
+	// Builds Graph and fills OutWater's counts and port connectivity; the path is left to FindWaterPath.
 	bool ValidateSolvedState(
-		const TMap<FHexAxialCoord, FCellState>& States,
-		const FHexWfcGridConfig& Grid,
+		const FCellGrid& Cells,
+		const TArray<FCanalTileVariantKey>& Solved,
 		const FHexWfcSolveConfig& Config,
+		FWaterGraph& Graph,
 		FHexBoundaryPort& OutResolvedEntry,
 		FHexBoundaryPort& OutResolvedExit,
+		FHexWfcWaterAnalysis& OutWater,
 		bool& OutFailedSingleWaterComponent,
 		FString& OutError) const;
 
+	void BuildWaterGraph(
+		const FCellGrid& Cells,
+		const TArray<FCanalTileVariantKey>& Solved,
+		FWaterGraph& Graph,
+		FHexWfcWaterAnalysis& OutWater) const;
+
+	// Entry-to-exit path when connected, otherwise a double sweep over the largest component.
+	void FindWaterPath(
+		const FCellGrid& Cells,
+		FWaterGraph& Graph,
+		const FHexBoundaryPort& Entry,
+		const FHexBoundaryPort& Exit,
+		FHexWfcWaterAnalysis& InOutWater) const;
+
+	// Breadth-first search over water links from Start. Returns Goal if reached, or the last cell reached when Goal
+	// is INDEX_NONE, with OutPath (if given) running from Start to it.
+	static int32 SearchWaterLinks(
+		const FCellGrid& Cells,
+		FWaterGraph& Graph,
+		int32 Start,
+		int32 Goal,
+		TArray<FHexAxialCoord>* OutPath);
+
 	bool ResolveBoundaryPorts(
-		const TMap<FHexAxialCoord, FCellState>& States,
-		const FHexWfcGridConfig& Grid,
+		const FCellGrid& Cells,
+		const TArray<FCanalTileVariantKey>& Solved,
 		const FHexWfcSolveConfig& Config,
+		FWaterGraph& Graph,
 		FHexBoundaryPort& OutEntry,
 		FHexBoundaryPort& OutExit,
 		FString& OutError) const;
 
 	bool ValidateBoundarySockets(
-		const TMap<FHexAxialCoord, FCellState>& States,
-		const FHexWfcGridConfig& Grid,
+		const FCellGrid& Cells,
+		const TArray<FCanalTileVariantKey>& Solved,
 		const FHexBoundaryPort& Entry,
 		const FHexBoundaryPort& Exit,
 		FString& OutError) const;
 
 	void CollectBoundaryWaterSockets(
-		const TMap<FHexAxialCoord, FCellState>& States,
-		const FHexWfcGridConfig& Grid,
+		const FCellGrid& Cells,
+		const TArray<FCanalTileVariantKey>& Solved,
 		bool bRequireExplicitBoundaryFlag,
 		TArray<FHexBoundaryPort>& OutPorts) const;
 
 	static bool IsSamePort(const FHexBoundaryPort& A, const FHexBoundaryPort& B);
 
 	bool ValidateBoundaryPort(
-		const TMap<FHexAxialCoord, FCellState>& States,
-		const FHexWfcGridConfig& Grid,
+		const FCellGrid& Cells,
+		const TArray<FCanalTileVariantKey>& Solved,
 		const FHexBoundaryPort& Port,
 		FString& OutError) const;
 
-	bool HasEntryExitPath(
-		const TMap<FHexAxialCoord, FCellState>& States,
-		const FHexWfcGridConfig& Grid,
-		const FHexBoundaryPort& Entry,
-		const FHexBoundaryPort& Exit) const;
+	static bool IsWaterLikeSocket(ECanalSocketType Socket);
+
+	const FCanalTileCompatibilityTable& Compatibility;
+};
 
-	bool HasSingleWaterComponent(
-		const TMap<FHexAxialCoord, FCellState>& States,
-		const FHexWfcGridConfig& Grid) const;
+// Buffers for FHexWfcSolver::Solve that a caller keeps between solves: the per-solve tables and one attempt workspace
+// per speculative attempt. Every buffer is reset in place, so once a workspace has solved a grid of a given size with
+// a given attempt wave, the search itself allocates nothing on further solves of that shape; only the returned result,
+// failure messages and end-of-attempt validation still do. Use one workspace per thread.
+class UEGAME_API FHexWfcSolverWorkspace
+{
+public:
+	FHexWfcSolverWorkspace() = default;
+	FHexWfcSolverWorkspace(const FHexWfcSolverWorkspace&) = delete;
+	FHexWfcSolverWorkspace& operator=(const FHexWfcSolverWorkspace&) = delete;
 
-	bool AreCellsWaterConnected(
-		const TMap<FHexAxialCoord, FCellState>& States,
-		const FHexAxialCoord& Source,
-		const FHexAxialCoord& Target,
-		EHexDirection Direction) const;
+	// Heap memory held by the workspace's buffers. Stays constant while repeated solves reuse them.
+	SIZE_T GetAllocatedSize() const;
 
-	bool IsWaterCell(const TMap<FHexAxialCoord, FCellState>& States, const FHexAxialCoord& Coord) const;
+	// Frees every buffer.
+	void Empty();
 
-	static bool IsWaterLikeSocket(ECanalSocketType Socket);
+private:
+	friend class FHexWfcSolver;
 
-	const FCanalTileCompatibilityTable& Compatibility;
+	FHexWfcSolver::FSolveContext Context;
+	TArray<FHexWfcSolver::FAttemptWorkspace> Attempts;
+	TArray<FHexWfcSolveResult> WaveResults;
 };
 
 UCLASS()
@@ -354,10 +1112,33 @@ public:
 		const FHexWfcGridConfig& Grid,
 		const FHexWfcSolveConfig& Config);
 
+	UFUNCTION(BlueprintCallable, Category = "Canal|WFC")
+	static FHexWfcSolveResult SolveHexWfcRegion(
+		const UCanalTopologyTileSetAsset* TileSet,
+		const FHexWfcGridConfig& Grid,
+		const FHexWfcSolveConfig& Config,
+		const FHexWfcSolveResult& Previous,
+		const TArray<FHexAxialCoord>& Region);
+
+	// C++ overload for callers that cancel the region solve or read its progress from another thread.
+	static FHexWfcSolveResult SolveHexWfcRegion(
+		const UCanalTopologyTileSetAsset* TileSet,
+		const FHexWfcGridConfig& Grid,
+		const FHexWfcSolveConfig& Config,
+		const FHexWfcSolveResult& Previous,
+		const TArray<FHexAxialCoord>& Region,
+		FHexWfcSolveControl* Control);
+
 	UFUNCTION(BlueprintCallable, Category = "Canal|WFC")
 	static FHexWfcBatchStats RunHexWfcBatch(
 		const UCanalTopologyTileSetAsset* TileSet,
 		const FHexWfcGridConfig& Grid,
 		const FHexWfcSolveConfig& ConfigTemplate,
 		const FHexWfcBatchConfig& BatchConfig);
+
+	// Combines batches over disjoint seed ranges, such as shards or resumed chunks of one run. Counts, totals and
+	// histograms add up exactly and the averages are derived from them; phase times are weighted by processed seeds,
+	// peaks keep the largest and elapsed times add up.
+	UFUNCTION(BlueprintCallable, Category = "Canal|WFC")
+	static FHexWfcBatchStats MergeHexWfcBatchStats(const TArray<FHexWfcBatchStats>& Parts);
 };